@@ -54,8 +54,19 @@ connection::do_read()
                 }
                 else if (result == request_parser::good)
                 {
-                    request_handler_.handle_request(request_, reply_);
-                    do_write();
+                    if (request_handler_.handle_request(
+                            request_, reply_, socket_,
+                            [this, self](bool sendReply) {
+                                // Back from the stream thread to the
+                                // connection's strand
+                                asio::post(socket_.get_executor(),
+                                           [this, self, sendReply]() {
+                                               on_stream_done(sendReply);
+                                           });
+                            }))
+                    {
+                        do_write();
+                    }
                 }
                 else
                 {
@@ -70,6 +81,21 @@ connection::do_read()
         });
 }
 
+void
+connection::on_stream_done(bool sendReply)
+{
+    if (sendReply)
+    {
+        do_write();
+    }
+    else
+    {
+        // The reply was streamed to the socket already
+        asio::error_code ignored_ec;
+        socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ignored_ec);
+    }
+}
+
 void
 connection::do_write()
 {
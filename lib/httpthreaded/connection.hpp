@@ -48,6 +48,10 @@ class connection : public std::enable_shared_from_this<connection>
     /// Perform an asynchronous write operation.
     void do_write();
 
+    /// Finish the connection once a streaming reply is done, sending reply_
+    /// if nothing was streamed.
+    void on_stream_done(bool sendReply);
+
     /// Socket for the connection.
     asio::ip::tcp::socket socket_;
 
@@ -310,11 +310,7 @@ request_parser::initializeForBody(request const& req)
 request_parser::result_type
 request_parser::consumeBody(request& req, char input)
 {
-    if (is_ctl(input))
-    {
-        return bad;
-    }
-
+    // The body is delimited by Content-Length and may be binary
     req.body.push_back(input);
     ++body_consumed_bytes_;
     if (body_consumed_bytes_ == body_content_length_)
@@ -12,6 +12,7 @@
 #include "util/GlobalChecks.h"
 #include "util/Thread.h"
 
+#include <exception>
 #include <signal.h>
 #include <sstream>
 #include <thread>
@@ -22,6 +23,20 @@ namespace httpThreaded
 namespace server
 {
 
+namespace
+{
+void
+set404(reply& rep)
+{
+    rep.status = reply::not_found;
+    rep.headers.resize(2);
+    rep.headers[0].name = "Content-Length";
+    rep.headers[0].value = std::to_string(rep.content.size());
+    rep.headers[1].name = "Content-Type";
+    rep.headers[1].value = "text/html";
+}
+}
+
 server::server(const std::string& address, unsigned short port, int maxClient,
                std::size_t threadPoolSize)
     : thread_pool_size_(threadPoolSize)
@@ -66,6 +81,16 @@ server::start()
         pids.emplace_back(worker_threads_[i].get_id());
     }
 
+    stream_work_ = std::make_unique<asio::io_context::work>(stream_context_);
+    for (std::size_t i = 0; i < thread_pool_size_; ++i)
+    {
+        stream_threads_.emplace_back([this] {
+            stellar::runCurrentThreadWithMediumPriority();
+            stream_context_.run();
+        });
+        pids.emplace_back(stream_threads_[i].get_id());
+    }
+
     return pids;
 }
 
@@ -76,9 +101,18 @@ server::add404(routeHandler callback)
 }
 
 void
-server::addRoute(const std::string& routeName, routeHandler callback)
+server::addRoute(const std::string& routeName, routeHandler callback,
+                 const std::string& contentType, bool decodeBody)
+{
+    mRoutes[routeName] = route{callback, contentType, decodeBody};
+}
+
+void
+server::addStreamingRoute(const std::string& routeName,
+                          streamingRouteHandler callback,
+                          const std::string& contentType)
 {
-    mRoutes[routeName] = callback;
+    mStreamingRoutes[routeName] = streamingRoute{callback, contentType};
 }
 
 void
@@ -114,6 +148,16 @@ server::stop()
     {
         t.join();
     }
+    worker_threads_.clear();
+
+    // Streams already running finish, queued ones are dropped
+    stream_work_.reset();
+    stream_context_.stop();
+    for (auto& t : stream_threads_)
+    {
+        t.join();
+    }
+    stream_threads_.clear();
 }
 
 void
@@ -128,22 +172,20 @@ server::~server()
     stop();
 }
 
-void
-server::handle_request(const request& req, reply& rep)
+bool
+server::parse_uri(const std::string& uri, std::string& command,
+                  std::string& params)
 {
     // Decode url to path.
     std::string request_path;
-    if (!url_decode(req.uri, request_path))
+    if (!url_decode(uri, request_path))
     {
-        rep = reply::stock_reply(reply::bad_request);
-        return;
+        return false;
     }
 
     if (request_path.size() && request_path[0] == '/')
         request_path = request_path.substr(1);
 
-    std::string command;
-    std::string params;
     auto pos = request_path.find('?');
     if (pos == std::string::npos)
         command = request_path;
@@ -152,38 +194,68 @@ server::handle_request(const request& req, reply& rep)
         command = request_path.substr(0, pos);
         params = request_path.substr(pos);
     }
+    return true;
+}
 
-    std::string parsed_body;
-    if (!url_decode(req.body, parsed_body))
+bool
+server::handle_request(const request& req, reply& rep,
+                       asio::ip::tcp::socket& socket,
+                       streamDoneHandler onStreamDone)
+{
+    std::string command;
+    std::string params;
+    if (!parse_uri(req.uri, command, params))
     {
         rep = reply::stock_reply(reply::bad_request);
-        return;
+        return true;
     }
 
-    auto add404 = [&](auto& rep) {
-        rep.status = reply::not_found;
-        rep.headers.resize(2);
-        rep.headers[0].name = "Content-Length";
-        rep.headers[0].value = std::to_string(rep.content.size());
-        rep.headers[1].name = "Content-Type";
-        rep.headers[1].value = "text/html";
-    };
+    auto streamIt = mStreamingRoutes.find(command);
+    if (streamIt != mStreamingRoutes.end())
+    {
+        std::string parsed_body;
+        if (!url_decode(req.body, parsed_body))
+        {
+            rep = reply::stock_reply(reply::bad_request);
+            return true;
+        }
+
+        // The connection doesn't touch the socket or rep until onStreamDone
+        // is called
+        asio::post(stream_context_, [&route = streamIt->second, params,
+                                     body = std::move(parsed_body), &rep,
+                                     &socket, onStreamDone]() {
+            onStreamDone(stream(route, params, body, rep, socket));
+        });
+        return false;
+    }
 
     auto it = mRoutes.find(command);
     if (it != mRoutes.end())
     {
-        if (it->second(params, parsed_body, rep.content))
+        std::string parsed_body;
+        if (!it->second.decodeBody)
+        {
+            parsed_body = req.body;
+        }
+        else if (!url_decode(req.body, parsed_body))
+        {
+            rep = reply::stock_reply(reply::bad_request);
+            return true;
+        }
+
+        if (it->second.handler(params, parsed_body, rep.content))
         {
             rep.status = reply::ok;
             rep.headers.resize(2);
             rep.headers[0].name = "Content-Length";
             rep.headers[0].value = std::to_string(rep.content.size());
             rep.headers[1].name = "Content-Type";
-            rep.headers[1].value = "application/json";
+            rep.headers[1].value = it->second.contentType;
         }
         else
         {
-            add404(rep);
+            set404(rep);
         }
     }
     else
@@ -191,16 +263,68 @@ server::handle_request(const request& req, reply& rep)
         it = mRoutes.find("404");
         if (it != mRoutes.end())
         {
-            it->second(params, parsed_body, rep.content);
+            std::string parsed_body;
+            if (!url_decode(req.body, parsed_body))
+            {
+                rep = reply::stock_reply(reply::bad_request);
+                return true;
+            }
+            it->second.handler(params, parsed_body, rep.content);
 
-            add404(rep);
+            set404(rep);
         }
         else
         {
             rep = reply::stock_reply(reply::not_found);
-            return;
         }
     }
+    return true;
+}
+
+bool
+server::stream(const streamingRoute& route, const std::string& params,
+               const std::string& body, reply& rep,
+               asio::ip::tcp::socket& socket)
+{
+    // Headers go out with the first chunk, so that errors found before any
+    // output can still be reported with an error status. There is no
+    // Content-Length, the end of the body is marked by closing the
+    // connection.
+    bool started = false;
+    auto write = [&](const std::string& chunk) {
+        if (!started)
+        {
+            std::string headers = "HTTP/1.0 200 OK\r\nContent-Type: " +
+                                  route.contentType + "\r\n\r\n";
+            asio::write(socket, asio::buffer(headers));
+            started = true;
+        }
+        asio::write(socket, asio::buffer(chunk));
+    };
+
+    std::string error;
+    try
+    {
+        if (route.handler(params, body, write, error))
+        {
+            // Make sure the client gets the headers of an empty reply
+            write("");
+            return false;
+        }
+    }
+    catch (std::exception& e)
+    {
+        // Most likely the client closed the connection while we were writing
+        // to it
+        error = e.what();
+    }
+    if (started)
+    {
+        return false;
+    }
+    rep.content = error;
+    set404(rep);
+    return true;
 }
 
 bool
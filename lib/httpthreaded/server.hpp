@@ -18,7 +18,9 @@
 #include "connection.hpp"
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace httpThreaded
@@ -36,6 +38,19 @@ class server
     typedef std::function<bool(const std::string&, const std::string&,
                                std::string&)>
         routeHandler;
+
+    // Writes a chunk of the response body to the client. Throws
+    // std::system_error if the client has gone away.
+    typedef std::function<void(const std::string&)> chunkWriter;
+
+    // Streaming route handlers write the response body incrementally instead
+    // of returning it. If the handler returns false before writing anything,
+    // the error in the last argument is sent with 404 Not Found. If it returns
+    // false after writing, the connection is closed without further output.
+    typedef std::function<bool(const std::string&, const std::string&,
+                               const chunkWriter&, std::string&)>
+        streamingRouteHandler;
+
     server(const server&) = delete;
     server& operator=(const server&) = delete;
 
@@ -44,12 +59,31 @@ class server
                     int maxClient, std::size_t threadPoolSize);
     ~server();
 
-    void addRoute(const std::string& routeName, routeHandler callback);
+    // If decodeBody is false, the request body is passed to the handler as
+    // received, which allows binary request bodies.
+    void addRoute(const std::string& routeName, routeHandler callback,
+                  const std::string& contentType = "application/json",
+                  bool decodeBody = true);
+    void addStreamingRoute(const std::string& routeName,
+                           streamingRouteHandler callback,
+                           const std::string& contentType);
     void add404(routeHandler callback);
 
-    void handle_request(const request& req, reply& rep);
-
-    /// Start the server's io_context loop. Returns PIDs of all worker threads.
+    /// Called on a stream thread once a streaming reply is done. If the
+    /// argument is true, nothing was written and rep must still be sent.
+    typedef std::function<void(bool)> streamDoneHandler;
+
+    /// Handles the request. Requests to streaming routes are handed to the
+    /// stream threads, which write the reply directly to the socket and then
+    /// call onStreamDone; in that case this returns false and rep must be
+    /// left alone until then. Otherwise rep is filled in and this returns
+    /// true.
+    bool handle_request(const request& req, reply& rep,
+                        asio::ip::tcp::socket& socket,
+                        streamDoneHandler onStreamDone);
+
+    /// Start the server's io_context loop and the stream threads. Returns PIDs
+    /// of all threads running route handlers.
     std::vector<std::thread::id> start();
 
     static void parseParams(const std::string& params,
@@ -59,6 +93,30 @@ class server
                     std::map<std::string, std::vector<std::string>>& retMap);
 
   private:
+    struct route
+    {
+        routeHandler handler;
+        std::string contentType;
+        bool decodeBody;
+    };
+
+    struct streamingRoute
+    {
+        streamingRouteHandler handler;
+        std::string contentType;
+    };
+
+    /// Split the request URI into command and parameters. Returns false if
+    /// the URI encoding was invalid.
+    static bool parse_uri(const std::string& uri, std::string& command,
+                          std::string& params);
+
+    /// Runs a streaming route on the calling stream thread. Returns true if
+    /// nothing was written, in which case rep holds the error to send.
+    static bool stream(const streamingRoute& route, const std::string& params,
+                       const std::string& body, reply& rep,
+                       asio::ip::tcp::socket& socket);
+
     /// Perform an asynchronous accept operation.
     void do_accept();
 
@@ -86,7 +144,15 @@ class server
 
     std::vector<std::thread> worker_threads_{};
 
-    std::map<std::string, routeHandler> mRoutes;
+    /// Streaming replies write to their socket synchronously, for as long as
+    /// the client takes to read them, so they run on threads of their own
+    /// rather than holding up the io_context workers.
+    asio::io_context stream_context_;
+    std::unique_ptr<asio::io_context::work> stream_work_;
+    std::vector<std::thread> stream_threads_{};
+
+    std::map<std::string, route> mRoutes;
+    std::map<std::string, streamingRoute> mStreamingRoutes;
 };
 
 } // namespace server
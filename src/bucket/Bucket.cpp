@@ -145,7 +145,7 @@ Bucket::apply(Application& app) const
         return true;
     };
 
-    std::unordered_set<LedgerKey> emptySet;
+    SeenKeySet emptySet;
     BucketApplicator applicator(
         app, app.getConfig().LEDGER_PROTOCOL_VERSION,
         0 /*set to 0 so we always load from the parent to check state*/,
@@ -156,6 +156,12 @@ Bucket::apply(Application& app) const
     BucketApplicator::Counters counters(app.getClock().now());
     while (applicator)
     {
+        if (!applicator.ready())
+        {
+            // Wait for the next batch read on a worker thread
+            app.getClock().crank(true);
+            continue;
+        }
         applicator.advance(counters);
     }
     counters.logInfo("direct", 0, app.getClock().now());
@@ -234,7 +240,7 @@ Bucket::fresh(BucketManager& bucketManager, uint32_t protocolVersion,
               std::vector<LedgerEntry> const& initEntries,
               std::vector<LedgerEntry> const& liveEntries,
               std::vector<LedgerKey> const& deadEntries, bool countMergeEvents,
-              asio::io_context& ctx, bool doFsync)
+              asio::io_context& ctx, bool doFsync, MultisetHash* offerHash)
 {
     ZoneScoped;
     // When building fresh buckets after protocol version 10 (i.e. version
@@ -250,7 +256,7 @@ Bucket::fresh(BucketManager& bucketManager, uint32_t protocolVersion,
 
     MergeCounters mc;
     BucketOutputIterator out(bucketManager.getTmpDir(), true, meta, mc, ctx,
-                             doFsync);
+                             doFsync, offerHash);
     for (auto const& e : entries)
     {
         out.put(e);
@@ -41,6 +41,7 @@ namespace stellar
 class AbstractLedgerTxn;
 class Application;
 class BucketManager;
+class MultisetHash;
 class SearchableBucketListSnapshot;
 struct EvictionResultEntry;
 class EvictionStatistics;
@@ -151,13 +152,15 @@ class Bucket : public std::enable_shared_from_this<Bucket>,
 
     // Create a fresh bucket from given vectors of init (created) and live
     // (updated) LedgerEntries, and dead LedgerEntryKeys. The bucket will
-    // be sorted, hashed, and adopted in the provided BucketManager.
+    // be sorted, hashed, and adopted in the provided BucketManager. If
+    // `offerHash` is provided, the live offers in the bucket are added to it.
     static std::shared_ptr<Bucket>
     fresh(BucketManager& bucketManager, uint32_t protocolVersion,
           std::vector<LedgerEntry> const& initEntries,
           std::vector<LedgerEntry> const& liveEntries,
           std::vector<LedgerKey> const& deadEntries, bool countMergeEvents,
-          asio::io_context& ctx, bool doFsync);
+          asio::io_context& ctx, bool doFsync,
+          MultisetHash* offerHash = nullptr);
 
     // Merge two buckets together, producing a fresh one. Entries in `oldBucket`
     // are overridden in the fresh bucket by keywise-equal entries in
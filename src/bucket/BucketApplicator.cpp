@@ -6,23 +6,203 @@
 #include "bucket/BucketApplicator.h"
 #include "bucket/Bucket.h"
 #include "bucket/BucketList.h"
+#include "crypto/SHA.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "main/Application.h"
+#include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/types.h"
+#include <Tracy.hpp>
+#include <cstring>
 #include <fmt/format.h>
 
 namespace stellar
 {
 
+namespace
+{
+// Number of batches each applicator reads ahead of the one being applied
+size_t const READ_AHEAD_BATCHES = 2;
+
+bool
+shouldApplyEntry(std::function<bool(LedgerEntryType)> const& filter,
+                 BucketEntry const& e)
+{
+    if (e.type() == LIVEENTRY || e.type() == INITENTRY)
+    {
+        return filter(e.liveEntry().data.type());
+    }
+
+    if (e.type() != DEADENTRY)
+    {
+        throw std::runtime_error(
+            "Malformed bucket: unexpected non-INIT/LIVE/DEAD entry.");
+    }
+    return filter(e.deadEntry().type());
+}
+}
+
+SeenKeySet::Digest
+SeenKeySet::digest(LedgerKey const& key)
+{
+    auto hash = xdrSha256(key);
+    Digest d;
+    std::copy(hash.begin(), hash.begin() + d.size(), d.begin());
+    return d;
+}
+
+size_t
+SeenKeySet::DigestHash::operator()(Digest const& d) const noexcept
+{
+    // Digests are uniformly distributed already. Skip the first byte, which
+    // picks the shard.
+    size_t h;
+    std::memcpy(&h, d.data() + 1, sizeof(h));
+    return h;
+}
+
+void
+SeenKeySet::reserve(size_t n)
+{
+    for (auto& shard : mShards)
+    {
+        shard.reserve(n / NUM_SHARDS + 1);
+    }
+}
+
+bool
+SeenKeySet::insert(Digest const& d)
+{
+    return mShards[d[0] % NUM_SHARDS].insert(d).second;
+}
+
+size_t
+SeenKeySet::size() const
+{
+    size_t size = 0;
+    for (auto const& shard : mShards)
+    {
+        size += shard.size();
+    }
+    return size;
+}
+
+void
+SeenKeySet::clear()
+{
+    for (auto& shard : mShards)
+    {
+        shard.clear();
+    }
+}
+
+BucketApplicator::ReadAhead::ReadAhead(
+    std::shared_ptr<Bucket const> bucket, std::streamoff lowOffset,
+    std::streamoff highOffset, uint32_t maxProtocolVersion,
+    std::function<bool(LedgerEntryType)> filter)
+    : mIter(bucket)
+    , mUpperBoundOffset(highOffset)
+    , mMaxProtocolVersion(maxProtocolVersion)
+    , mEntryTypeFilter(filter)
+{
+    mIter.seek(lowOffset);
+}
+
+void
+BucketApplicator::ReadAhead::start(Application& app)
+{
+    if (mReading || mDone || mReady.size() >= READ_AHEAD_BATCHES)
+    {
+        return;
+    }
+    mReading = true;
+
+    // The worker holds a strong reference so the iterator outlives the read,
+    // the main thread a weak one as the applicator may be gone by then
+    auto self = shared_from_this();
+    std::weak_ptr<ReadAhead> weak = self;
+    app.postOnBackgroundThread(
+        [&app, self, weak]() {
+            auto batch = self->readBatch();
+            app.postOnMainThread(
+                [&app, weak, batch]() {
+                    auto readAhead = weak.lock();
+                    if (!readAhead)
+                    {
+                        return;
+                    }
+                    readAhead->mReading = false;
+                    readAhead->mDone = batch->mLast;
+                    readAhead->mReady.emplace_back(batch);
+                    readAhead->start(app);
+                    if (readAhead->mOnReady)
+                    {
+                        auto onReady = std::move(readAhead->mOnReady);
+                        readAhead->mOnReady = nullptr;
+                        onReady();
+                    }
+                },
+                "BucketApplicator: batch read");
+        },
+        "BucketApplicator: read batch");
+}
+
+std::shared_ptr<BucketApplicator::Batch>
+BucketApplicator::ReadAhead::readBatch()
+{
+    ZoneScoped;
+    auto batch = std::make_shared<Batch>();
+    try
+    {
+        for (; mIter; ++mIter)
+        {
+            // Note: mUpperBoundOffset is not inclusive. However, mIter.pos()
+            // returns the file offset at the end of the currently loaded
+            // entry. This means we must read until pos is strictly greater
+            // than the upper bound so that we don't skip the last offer in
+            // the range.
+            if (mIter.pos() > mUpperBoundOffset)
+            {
+                break;
+            }
+
+            BucketEntry const& e = *mIter;
+            Bucket::checkProtocolLegality(e, mMaxProtocolVersion);
+            if (!shouldApplyEntry(mEntryTypeFilter, e))
+            {
+                continue;
+            }
+
+            batch->mDigests.emplace_back(SeenKeySet::digest(
+                e.type() == DEADENTRY ? e.deadEntry()
+                                      : LedgerEntryKey(e.liveEntry())));
+            batch->mEntries.emplace_back(e);
+            if (batch->mEntries.size() == LEDGER_ENTRY_BATCH_COMMIT_SIZE)
+            {
+                ++mIter;
+                break;
+            }
+        }
+        batch->mLast = !mIter || mIter.pos() > mUpperBoundOffset;
+        batch->mPos = mIter.pos();
+    }
+    catch (...)
+    {
+        // Rethrown on the main thread when the batch gets applied
+        batch->mError = std::current_exception();
+        batch->mLast = true;
+    }
+    return batch;
+}
+
 BucketApplicator::BucketApplicator(Application& app,
                                    uint32_t maxProtocolVersion,
                                    uint32_t minProtocolVersionSeen,
                                    uint32_t level,
                                    std::shared_ptr<Bucket const> bucket,
                                    std::function<bool(LedgerEntryType)> filter,
-                                   std::unordered_set<LedgerKey>& seenKeys)
+                                   SeenKeySet& seenKeys)
     : mApp(app)
     , mMaxProtocolVersion(maxProtocolVersion)
     , mMinProtocolVersionSeen(minProtocolVersionSeen)
@@ -41,14 +221,21 @@ BucketApplicator::BucketApplicator(Application& app,
     }
 
     // Only apply offers if BucketListDB is enabled
-    if (mApp.getConfig().isUsingBucketListDB() && !bucket->isEmpty())
+    if (mApp.getConfig().isUsingBucketListDB())
     {
-        auto offsetOp = bucket->getOfferRange();
+        std::optional<std::pair<std::streamoff, std::streamoff>> offsetOp;
+        if (!bucket->isEmpty())
+        {
+            offsetOp = bucket->getOfferRange();
+        }
         if (offsetOp)
         {
             auto [lowOffset, highOffset] = *offsetOp;
-            mBucketIter.seek(lowOffset);
-            mUpperBoundOffset = highOffset;
+            mReadAhead = std::make_shared<ReadAhead>(
+                bucket, lowOffset, highOffset, mMaxProtocolVersion,
+                mEntryTypeFilter);
+            mReadAheadPos = lowOffset;
+            mReadAhead->start(mApp);
         }
         else
         {
@@ -61,17 +248,33 @@ BucketApplicator::BucketApplicator(Application& app,
 BucketApplicator::operator bool() const
 {
     // There is more work to do (i.e. (bool) *this == true) iff:
-    // 1. The underlying bucket iterator is not EOF and
-    // 2. Either BucketListDB is not enabled (so we must apply all entry types)
-    //    or BucketListDB is enabled and we have offers still remaining.
-    return static_cast<bool>(mBucketIter) &&
-           (!mApp.getConfig().isUsingBucketListDB() || mOffersRemaining);
+    // 1. BucketListDB is not enabled (so we must apply all entry types) and
+    //    the underlying bucket iterator is not EOF or
+    // 2. BucketListDB is enabled and we have offers still remaining.
+    if (mApp.getConfig().isUsingBucketListDB())
+    {
+        return mOffersRemaining;
+    }
+    return static_cast<bool>(mBucketIter);
+}
+
+bool
+BucketApplicator::ready() const
+{
+    return !mReadAhead || !mReadAhead->mReady.empty();
+}
+
+void
+BucketApplicator::setOnReady(std::function<void()> onReady)
+{
+    releaseAssert(mReadAhead);
+    mReadAhead->mOnReady = onReady;
 }
 
 size_t
 BucketApplicator::pos()
 {
-    return mBucketIter.pos();
+    return mReadAhead ? mReadAheadPos : mBucketIter.pos();
 }
 
 size_t
@@ -80,26 +283,23 @@ BucketApplicator::size() const
     return mBucketIter.size();
 }
 
-static bool
-shouldApplyEntry(std::function<bool(LedgerEntryType)> const& filter,
-                 BucketEntry const& e)
+size_t
+BucketApplicator::advance(BucketApplicator::Counters& counters)
 {
-    if (e.type() == LIVEENTRY || e.type() == INITENTRY)
-    {
-        return filter(e.liveEntry().data.type());
-    }
-
-    if (e.type() != DEADENTRY)
+    std::shared_ptr<Batch> batch;
+    if (mReadAhead)
     {
-        throw std::runtime_error(
-            "Malformed bucket: unexpected non-INIT/LIVE/DEAD entry.");
+        releaseAssert(ready());
+        batch = mReadAhead->mReady.front();
+        mReadAhead->mReady.pop_front();
+        if (batch->mError)
+        {
+            std::rethrow_exception(batch->mError);
+        }
+        // Read the next batch while this one is written
+        mReadAhead->start(mApp);
     }
-    return filter(e.deadEntry().type());
-}
 
-size_t
-BucketApplicator::advance(BucketApplicator::Counters& counters)
-{
     size_t count = 0;
 
     auto& root = mApp.getLedgerTxnRoot();
@@ -121,122 +321,123 @@ BucketApplicator::advance(BucketApplicator::Counters& counters)
         ltx->prepareNewObjects(LEDGER_ENTRY_BATCH_COMMIT_SIZE);
     }
 
-    for (; mBucketIter; ++mBucketIter)
+    if (batch)
+    {
+        count = applyBatch(*batch, *ltx, counters);
+        mReadAheadPos = batch->mPos;
+        mOffersRemaining = !batch->mLast;
+    }
+    else
     {
-        // Note: mUpperBoundOffset is not inclusive. However, mBucketIter.pos()
-        // returns the file offset at the end of the currently loaded entry.
-        // This means we must read until pos is strictly greater than the upper
-        // bound so that we don't skip the last offer in the range.
-        auto isUsingBucketListDB = mApp.getConfig().isUsingBucketListDB();
-        if (isUsingBucketListDB && mBucketIter.pos() > mUpperBoundOffset)
+        for (; mBucketIter; ++mBucketIter)
         {
-            mOffersRemaining = false;
-            break;
-        }
+            BucketEntry const& e = *mBucketIter;
+            Bucket::checkProtocolLegality(e, mMaxProtocolVersion);
 
-        BucketEntry const& e = *mBucketIter;
-        Bucket::checkProtocolLegality(e, mMaxProtocolVersion);
-
-        if (shouldApplyEntry(mEntryTypeFilter, e))
-        {
-            if (isUsingBucketListDB)
+            if (shouldApplyEntry(mEntryTypeFilter, e))
             {
-                if (e.type() == LIVEENTRY || e.type() == INITENTRY)
-                {
-                    auto [_, wasInserted] =
-                        mSeenKeys.emplace(LedgerEntryKey(e.liveEntry()));
+                counters.mark(e);
+                applyEntry(e, *ltx);
 
-                    // Skip seen keys
-                    if (!wasInserted)
-                    {
-                        continue;
-                    }
-                }
-                else
+                if ((++count > LEDGER_ENTRY_BATCH_COMMIT_SIZE))
                 {
-                    // Only apply INIT and LIVE entries
-                    mSeenKeys.emplace(e.deadEntry());
-                    continue;
+                    ++mBucketIter;
+                    break;
                 }
             }
+        }
+    }
+    if (innerLtx)
+    {
+        ltx->commit();
+    }
+
+    mCount += count;
+    return count;
+}
+
+size_t
+BucketApplicator::applyBatch(Batch const& batch, AbstractLedgerTxn& ltx,
+                             Counters& counters)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < batch.mEntries.size(); ++i)
+    {
+        auto const& e = batch.mEntries[i];
 
-            counters.mark(e);
+        // Skip seen keys, and only apply INIT and LIVE entries: DEAD entries
+        // only shadow older versions of their key
+        if (!mSeenKeys.insert(batch.mDigests[i]) || e.type() == DEADENTRY)
+        {
+            continue;
+        }
+
+        counters.mark(e);
+        applyEntry(e, ltx);
+        ++count;
+    }
+    return count;
+}
 
-            if (e.type() == LIVEENTRY || e.type() == INITENTRY)
+void
+BucketApplicator::applyEntry(BucketEntry const& e, AbstractLedgerTxn& ltx)
+{
+    if (e.type() == LIVEENTRY || e.type() == INITENTRY)
+    {
+        // The last level can have live entries, but at that point we
+        // know that they are actually init entries because the earliest
+        // state of all entries is init, so we mark them as such here
+        if (mLevel == BucketList::kNumLevels - 1 && e.type() == LIVEENTRY)
+        {
+            ltx.createWithoutLoading(e.liveEntry());
+        }
+        else if (protocolVersionIsBefore(
+                     mMinProtocolVersionSeen,
+                     Bucket::FIRST_PROTOCOL_SUPPORTING_INITENTRY_AND_METAENTRY))
+        {
+            // Prior to protocol 11, INITENTRY didn't exist, so we need
+            // to check ltx to see if this is an update or a create
+            auto key = InternalLedgerEntry(e.liveEntry()).toKey();
+            if (ltx.getNewestVersion(key))
             {
-                // The last level can have live entries, but at that point we
-                // know that they are actually init entries because the earliest
-                // state of all entries is init, so we mark them as such here
-                if (mLevel == BucketList::kNumLevels - 1 &&
-                    e.type() == LIVEENTRY)
-                {
-                    ltx->createWithoutLoading(e.liveEntry());
-                }
-                else if (
-                    protocolVersionIsBefore(
-                        mMinProtocolVersionSeen,
-                        Bucket::
-                            FIRST_PROTOCOL_SUPPORTING_INITENTRY_AND_METAENTRY))
-                {
-                    // Prior to protocol 11, INITENTRY didn't exist, so we need
-                    // to check ltx to see if this is an update or a create
-                    auto key = InternalLedgerEntry(e.liveEntry()).toKey();
-                    if (ltx->getNewestVersion(key))
-                    {
-                        ltx->updateWithoutLoading(e.liveEntry());
-                    }
-                    else
-                    {
-                        ltx->createWithoutLoading(e.liveEntry());
-                    }
-                }
-                else
-                {
-                    if (e.type() == LIVEENTRY)
-                    {
-                        ltx->updateWithoutLoading(e.liveEntry());
-                    }
-                    else
-                    {
-                        ltx->createWithoutLoading(e.liveEntry());
-                    }
-                }
+                ltx.updateWithoutLoading(e.liveEntry());
             }
             else
             {
-                releaseAssertOrThrow(!isUsingBucketListDB);
-                if (protocolVersionIsBefore(
-                        mMinProtocolVersionSeen,
-                        Bucket::
-                            FIRST_PROTOCOL_SUPPORTING_INITENTRY_AND_METAENTRY))
-                {
-                    // Prior to protocol 11, DEAD entries could exist
-                    // without LIVE entries in between
-                    if (ltx->getNewestVersion(e.deadEntry()))
-                    {
-                        ltx->eraseWithoutLoading(e.deadEntry());
-                    }
-                }
-                else
-                {
-                    ltx->eraseWithoutLoading(e.deadEntry());
-                }
+                ltx.createWithoutLoading(e.liveEntry());
             }
-
-            if ((++count > LEDGER_ENTRY_BATCH_COMMIT_SIZE))
+        }
+        else
+        {
+            if (e.type() == LIVEENTRY)
             {
-                ++mBucketIter;
-                break;
+                ltx.updateWithoutLoading(e.liveEntry());
+            }
+            else
+            {
+                ltx.createWithoutLoading(e.liveEntry());
             }
         }
     }
-    if (innerLtx)
+    else
     {
-        ltx->commit();
+        releaseAssertOrThrow(!mApp.getConfig().isUsingBucketListDB());
+        if (protocolVersionIsBefore(
+                mMinProtocolVersionSeen,
+                Bucket::FIRST_PROTOCOL_SUPPORTING_INITENTRY_AND_METAENTRY))
+        {
+            // Prior to protocol 11, DEAD entries could exist
+            // without LIVE entries in between
+            if (ltx.getNewestVersion(e.deadEntry()))
+            {
+                ltx.eraseWithoutLoading(e.deadEntry());
+            }
+        }
+        else
+        {
+            ltx.eraseWithoutLoading(e.deadEntry());
+        }
     }
-
-    mCount += count;
-    return count;
 }
 
 BucketApplicator::Counters::Counters(VirtualClock::time_point now)
@@ -7,19 +7,91 @@
 #include "bucket/Bucket.h"
 #include "bucket/BucketInputIterator.h"
 #include "util/Timer.h"
+#include <array>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <unordered_set>
 
 namespace stellar
 {
 
 class Application;
 
+// Set of the keys seen while applying offers from the newest to the oldest
+// bucket. Keys are stored as 128-bit prefixes of the SHA-256 of their XDR
+// rather than as LedgerKeys, as offer keys embed a (large) seller public key.
+// Digests are spread over shards by their first byte, so that the set grows
+// shard by shard rather than rehashing millions of entries at once.
+class SeenKeySet
+{
+  public:
+    using Digest = std::array<uint8_t, 16>;
+    static size_t const NUM_SHARDS = 16;
+
+    static Digest digest(LedgerKey const& key);
+
+    void reserve(size_t n);
+    // Returns true if `d` was not in the set yet
+    bool insert(Digest const& d);
+    size_t size() const;
+    void clear();
+
+  private:
+    struct DigestHash
+    {
+        size_t operator()(Digest const& d) const noexcept;
+    };
+    std::array<std::unordered_set<Digest, DigestHash>, NUM_SHARDS> mShards;
+};
+
 // Class that represents a single apply-bucket-to-database operation in
 // progress. Used during history catchup to split up the task of applying
 // bucket into scheduler-friendly, bite-sized pieces.
+//
+// When BucketListDB is enabled, the offers of the bucket are read, checked
+// and digested on a worker thread one batch ahead of their application, so
+// that applicators created ahead of time for the following buckets decode
+// them while the main thread writes the current one to the database.
 
 class BucketApplicator
 {
+    // Offers read ahead of their application, with the digests of their keys
+    struct Batch
+    {
+        std::vector<BucketEntry> mEntries;
+        std::vector<SeenKeySet::Digest> mDigests;
+        std::streamoff mPos{0};
+        bool mLast{false};
+        std::exception_ptr mError;
+    };
+
+    // State shared with the worker thread. The worker only touches the
+    // iterator and the immutable fields while a read is in flight, the main
+    // thread only touches the remaining ones.
+    struct ReadAhead : public std::enable_shared_from_this<ReadAhead>
+    {
+        BucketInputIterator mIter;
+        std::streamoff const mUpperBoundOffset;
+        uint32_t const mMaxProtocolVersion;
+        std::function<bool(LedgerEntryType)> const mEntryTypeFilter;
+
+        bool mReading{false};
+        bool mDone{false};
+        std::deque<std::shared_ptr<Batch>> mReady;
+        std::function<void()> mOnReady;
+
+        ReadAhead(std::shared_ptr<Bucket const> bucket,
+                  std::streamoff lowOffset, std::streamoff highOffset,
+                  uint32_t maxProtocolVersion,
+                  std::function<bool(LedgerEntryType)> filter);
+
+        // Starts reading the next batch on a worker thread, unless enough
+        // batches are already read or being read
+        void start(Application& app);
+        std::shared_ptr<Batch> readBatch();
+    };
+
     Application& mApp;
     uint32_t mMaxProtocolVersion;
     uint32_t mMinProtocolVersionSeen;
@@ -27,9 +99,10 @@ class BucketApplicator
     BucketInputIterator mBucketIter;
     size_t mCount{0};
     std::function<bool(LedgerEntryType)> mEntryTypeFilter;
-    std::unordered_set<LedgerKey>& mSeenKeys;
-    std::streamoff mUpperBoundOffset{0};
+    SeenKeySet& mSeenKeys;
     bool mOffersRemaining{true};
+    std::shared_ptr<ReadAhead> mReadAhead;
+    std::streamoff mReadAheadPos{0};
 
   public:
     class Counters
@@ -74,11 +147,22 @@ class BucketApplicator
                      uint32_t minProtocolVersionSeen, uint32_t level,
                      std::shared_ptr<Bucket const> bucket,
                      std::function<bool(LedgerEntryType)> filter,
-                     std::unordered_set<LedgerKey>& seenKeys);
+                     SeenKeySet& seenKeys);
     operator bool() const;
+
+    // Whether advance can make progress right away. Otherwise, `onReady` is
+    // called on the main thread once the next batch has been read.
+    bool ready() const;
+    void setOnReady(std::function<void()> onReady);
+
     size_t advance(Counters& counters);
 
     size_t pos();
     size_t size() const;
+
+  private:
+    size_t applyBatch(Batch const& batch, AbstractLedgerTxn& ltx,
+                      Counters& counters);
+    void applyEntry(BucketEntry const& e, AbstractLedgerTxn& ltx);
 };
 }
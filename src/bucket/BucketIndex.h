@@ -12,6 +12,7 @@
 #include <memory>
 #include <optional>
 #include <variant>
+#include <vector>
 
 #include <cereal/archives/binary.hpp>
 
@@ -80,7 +81,7 @@ class BucketIndex : public NonMovableOrCopyable
                                   IndividualIndex::const_iterator>;
 
     inline static const std::string DB_BACKEND_STATE = "bl";
-    inline static const uint32_t BUCKET_INDEX_VERSION = 4;
+    inline static const uint32_t BUCKET_INDEX_VERSION = 5;
 
     // Returns true if LedgerEntryType not supported by BucketListDB
     static bool typeNotSupported(LedgerEntryType t);
@@ -113,6 +114,12 @@ class BucketIndex : public NonMovableOrCopyable
     virtual std::pair<std::optional<std::streamoff>, Iterator>
     scan(Iterator start, LedgerKey const& k) const = 0;
 
+    // Returns the file offset from which to read the entries with keys not
+    // less than k, in order, or std::nullopt if the bucket has no such
+    // entries. With a range index, entries before k may be read first.
+    virtual std::optional<std::streamoff>
+    getLowerBoundOffset(LedgerKey const& k) const = 0;
+
     // Returns lower bound and upper bound for poolshare trustline entry
     // positions associated with the given accountID. If no trustlines found,
     // returns nullopt
@@ -129,6 +136,20 @@ class BucketIndex : public NonMovableOrCopyable
     virtual std::optional<std::pair<std::streamoff, std::streamoff>>
     getOfferRange() const = 0;
 
+    // Returns the offset of the last indexed entry starting before offset, or
+    // 0 if there is none. Either way, an entry starts at the offset returned.
+    virtual std::streamoff
+    getEntryOffsetBefore(std::streamoff offset) const = 0;
+
+    // Returns the offsets of the INITENTRY and LIVEENTRY temporary
+    // CONTRACT_DATA entries, in increasing order. These are the only entries
+    // the eviction scan can evict.
+    virtual std::vector<std::streamoff> const&
+    getTemporaryEntryOffsets() const = 0;
+
+    // Returns the approximate memory used by the index, in bytes
+    virtual size_t getMemoryEstimate() const = 0;
+
     // Returns page size for index. InidividualIndex returns 0 for page size
     virtual std::streamoff getPageSize() const = 0;
 
@@ -184,6 +184,13 @@ BucketIndexImpl<IndexT>::BucketIndexImpl(BucketManager& bm,
                 {
                     mData.keysToOffset.emplace_back(key, pos);
                 }
+
+                // Lets the eviction scan read only the entries it can evict
+                if ((be.type() == INITENTRY || be.type() == LIVEENTRY) &&
+                    isTemporaryEntry(be.liveEntry().data))
+                {
+                    mData.temporaryEntryOffsets.emplace_back(pos);
+                }
                 countEntry(be);
             }
 
@@ -478,6 +485,32 @@ BucketIndexImpl<IndexT>::getOffsetBounds(LedgerKey const& lowerBound,
     return std::make_pair(startOff, endOff);
 }
 
+template <class IndexT>
+std::optional<std::streamoff>
+BucketIndexImpl<IndexT>::getLowerBoundOffset(LedgerKey const& k) const
+{
+    auto iter = std::lower_bound(mData.keysToOffset.begin(),
+                                 mData.keysToOffset.end(), k,
+                                 lower_bound_pred<typename IndexT::value_type>);
+    if (iter == mData.keysToOffset.end())
+    {
+        return std::nullopt;
+    }
+
+    return iter->second;
+}
+
+template <class IndexT>
+size_t
+BucketIndexImpl<IndexT>::getMemoryEstimate() const
+{
+    // Only counts the key and temporary entry indexes, which dominate the
+    // size of the filter and of the pool ID map
+    return mData.keysToOffset.capacity() *
+               sizeof(typename IndexT::value_type) +
+           mData.temporaryEntryOffsets.capacity() * sizeof(std::streamoff);
+}
+
 template <class IndexT>
 std::vector<PoolID> const&
 BucketIndexImpl<IndexT>::getPoolIDsByAsset(Asset const& asset) const
@@ -526,6 +559,29 @@ BucketIndexImpl<IndexT>::getOfferRange() const
     return getOffsetBounds(lowerBound, upperBound);
 }
 
+template <class IndexT>
+std::streamoff
+BucketIndexImpl<IndexT>::getEntryOffsetBefore(std::streamoff offset) const
+{
+    // The bucket file is sorted by key, so the index is sorted by offset too
+    auto iter = std::lower_bound(
+        mData.keysToOffset.begin(), mData.keysToOffset.end(), offset,
+        [](typename IndexT::value_type const& indexEntry,
+           std::streamoff off) { return indexEntry.second < off; });
+    if (iter == mData.keysToOffset.begin())
+    {
+        return 0;
+    }
+    return std::prev(iter)->second;
+}
+
+template <class IndexT>
+std::vector<std::streamoff> const&
+BucketIndexImpl<IndexT>::getTemporaryEntryOffsets() const
+{
+    return mData.temporaryEntryOffsets;
+}
+
 #ifdef BUILD_TESTS
 template <class IndexT>
 bool
@@ -572,6 +628,11 @@ BucketIndexImpl<IndexT>::operator==(BucketIndex const& inRaw) const
         return false;
     }
 
+    if (mData.temporaryEntryOffsets != in.mData.temporaryEntryOffsets)
+    {
+        return false;
+    }
+
     return true;
 }
 #endif
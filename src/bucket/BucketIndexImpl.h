@@ -35,6 +35,7 @@ template <class IndexT> class BucketIndexImpl : public BucketIndex
         std::unique_ptr<BinaryFuseFilter16> filter{};
         std::map<Asset, std::vector<PoolID>> assetToPoolID{};
         BucketEntryCounters counters{};
+        std::vector<std::streamoff> temporaryEntryOffsets{};
 
         template <class Archive>
         void
@@ -42,7 +43,7 @@ template <class IndexT> class BucketIndexImpl : public BucketIndex
         {
             auto version = BUCKET_INDEX_VERSION;
             ar(version, pageSize, assetToPoolID, keysToOffset, filter,
-               counters);
+               counters, temporaryEntryOffsets);
         }
 
         // Note: version and pageSize must be loaded before this function is
@@ -53,7 +54,8 @@ template <class IndexT> class BucketIndexImpl : public BucketIndex
         void
         load(Archive& ar)
         {
-            ar(assetToPoolID, keysToOffset, filter, counters);
+            ar(assetToPoolID, keysToOffset, filter, counters,
+               temporaryEntryOffsets);
         }
     } mData;
 
@@ -87,6 +89,9 @@ template <class IndexT> class BucketIndexImpl : public BucketIndex
     virtual std::pair<std::optional<std::streamoff>, Iterator>
     scan(Iterator start, LedgerKey const& k) const override;
 
+    virtual std::optional<std::streamoff>
+    getLowerBoundOffset(LedgerKey const& k) const override;
+
     virtual std::optional<std::pair<std::streamoff, std::streamoff>>
     getPoolshareTrustlineRange(AccountID const& accountID) const override;
 
@@ -96,6 +101,14 @@ template <class IndexT> class BucketIndexImpl : public BucketIndex
     virtual std::optional<std::pair<std::streamoff, std::streamoff>>
     getOfferRange() const override;
 
+    virtual std::streamoff
+    getEntryOffsetBefore(std::streamoff offset) const override;
+
+    virtual std::vector<std::streamoff> const&
+    getTemporaryEntryOffsets() const override;
+
+    virtual size_t getMemoryEstimate() const override;
+
     virtual std::streamoff
     getPageSize() const override
     {
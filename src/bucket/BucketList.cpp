@@ -530,7 +530,8 @@ BucketList::addBatch(Application& app, uint32_t currLedger,
                      uint32_t currLedgerProtocol,
                      std::vector<LedgerEntry> const& initEntries,
                      std::vector<LedgerEntry> const& liveEntries,
-                     std::vector<LedgerKey> const& deadEntries)
+                     std::vector<LedgerKey> const& deadEntries,
+                     MultisetHash* offerHash)
 {
     ZoneScoped;
     releaseAssert(currLedger > 0);
@@ -629,7 +630,8 @@ BucketList::addBatch(Application& app, uint32_t currLedger,
                        Bucket::fresh(app.getBucketManager(), currLedgerProtocol,
                                      initEntries, liveEntries, deadEntries,
                                      countMergeEvents,
-                                     app.getClock().getIOContext(), doFsync),
+                                     app.getClock().getIOContext(), doFsync,
+                                     offerHash),
                        shadows, countMergeEvents);
     mLevels[0].commit();
 
@@ -524,12 +524,14 @@ class BucketList
     // (0th) level, as well as commit or prepare merges for any levels that
     // should have spilled due to passing through `currLedger`. The `currLedger`
     // and `currProtocolVersion` values should be taken from the ledger at which
-    // this batch is being added.
+    // this batch is being added. If `offerHash` is provided, the live offers
+    // of the batch are added to it as they are written to the fresh bucket.
     void addBatch(Application& app, uint32_t currLedger,
                   uint32_t currLedgerProtocol,
                   std::vector<LedgerEntry> const& initEntries,
                   std::vector<LedgerEntry> const& liveEntries,
-                  std::vector<LedgerKey> const& deadEntries);
+                  std::vector<LedgerKey> const& deadEntries,
+                  MultisetHash* offerHash = nullptr);
     BucketEntryCounters sumBucketEntryCounters() const;
 };
 }
@@ -9,6 +9,7 @@
 
 #include "medida/timer.h"
 #include "util/GlobalChecks.h"
+#include "util/types.h"
 
 namespace stellar
 {
@@ -31,6 +32,38 @@ BucketListSnapshot::BucketListSnapshot(BucketListSnapshot const& snapshot)
 {
 }
 
+BucketListSnapshot::BucketListSnapshot(
+    BucketListSnapshot const& snapshot,
+    BucketListSnapshot const& sameThreadSnapshot)
+    : BucketListSnapshot(snapshot)
+{
+    // Buckets move between levels and between curr and snap, but only a few
+    // change from one ledger to the next
+    UnorderedMap<Bucket const*, BucketSnapshot const*> streams;
+    for (auto const& lev : sameThreadSnapshot.mLevels)
+    {
+        for (auto const* b : {&lev.curr, &lev.snap})
+        {
+            if (b->mStream)
+            {
+                streams.emplace(b->mBucket.get(), b);
+            }
+        }
+    }
+
+    for (auto& lev : mLevels)
+    {
+        for (auto* b : {&lev.curr, &lev.snap})
+        {
+            auto iter = streams.find(b->mBucket.get());
+            if (iter != streams.end())
+            {
+                b->shareStream(*iter->second);
+            }
+        }
+    }
+}
+
 std::vector<BucketLevelSnapshot> const&
 BucketListSnapshot::getLevels() const
 {
@@ -131,7 +164,8 @@ LedgerHeader const&
 SearchableBucketListSnapshot::getLedgerHeader()
 {
     releaseAssert(mSnapshot);
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
     return mSnapshot->getLedgerHeader();
 }
 
@@ -189,7 +223,8 @@ std::shared_ptr<LedgerEntry>
 SearchableBucketListSnapshot::load(LedgerKey const& k)
 {
     ZoneScoped;
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
     releaseAssert(mSnapshot);
 
     if (threadIsMain())
@@ -211,7 +246,8 @@ SearchableBucketListSnapshot::loadKeysFromLedger(
     std::set<LedgerKey, LedgerEntryIdCmp> const& inKeys, uint32_t ledgerSeq)
 {
     ZoneScoped;
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
     releaseAssert(mSnapshot);
 
     if (ledgerSeq == mSnapshot->getLedgerSeq())
@@ -237,7 +273,8 @@ SearchableBucketListSnapshot::loadKeysWithLimits(
     LedgerKeyMeter* lkMeter)
 {
     ZoneScoped;
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
     releaseAssert(mSnapshot);
 
     if (threadIsMain())
@@ -253,6 +290,48 @@ SearchableBucketListSnapshot::loadKeysWithLimits(
     }
 }
 
+bool
+SearchableBucketListSnapshot::scanKeyRange(
+    LedgerKey const& lowerBound,
+    std::function<bool(LedgerKey const&)> const& inRange,
+    std::function<bool(LedgerEntry const&)> const& f,
+    std::optional<uint32_t> ledgerSeq)
+{
+    ZoneScoped;
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
+    releaseAssert(mSnapshot);
+
+    BucketListSnapshot const* snapshot = mSnapshot.get();
+    if (ledgerSeq && *ledgerSeq != mSnapshot->getLedgerSeq())
+    {
+        auto iter = mHistoricalSnapshots.find(*ledgerSeq);
+        if (iter == mHistoricalSnapshots.end())
+        {
+            return false;
+        }
+        snapshot = iter->second.get();
+        releaseAssert(snapshot);
+    }
+
+    // Buckets are visited newest first, so the first version of a key seen is
+    // the current one and shadows all the others
+    LedgerKeySet seen;
+    auto scanBucket = [&](BucketSnapshot const& b) {
+        return b.scanKeyRange(lowerBound, inRange, [&](BucketEntry const& be) {
+            if (!seen.emplace(getBucketLedgerKey(be)).second ||
+                be.type() == DEADENTRY)
+            {
+                return false;
+            }
+            return f(be.liveEntry());
+        });
+    };
+
+    loopAllBuckets(scanBucket, *snapshot);
+    return true;
+}
+
 // This query has two steps:
 //  1. For each bucket, determine what PoolIDs contain the target asset via the
 //     assetToPoolID index
@@ -266,7 +345,8 @@ SearchableBucketListSnapshot::loadPoolShareTrustLinesByAccountAndAsset(
 
     // This query should only be called during TX apply
     releaseAssert(threadIsMain());
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
     releaseAssert(mSnapshot);
 
     LedgerKeySet trustlinesToLoad;
@@ -298,7 +378,8 @@ SearchableBucketListSnapshot::loadInflationWinners(size_t maxWinners,
                                                    int64_t minBalance)
 {
     ZoneScoped;
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
     releaseAssert(mSnapshot);
 
     // This is a legacy query, should only be called by main thread during
@@ -396,7 +477,8 @@ SearchableBucketListSnapshot::SearchableBucketListSnapshot(
     : mSnapshotManager(snapshotManager), mHistoricalSnapshots()
 {
     // Initialize snapshot from SnapshotManager
-    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots);
+    mSnapshotManager.maybeUpdateSnapshot(mSnapshot, mHistoricalSnapshots,
+                                         mSnapshotsVersion);
 }
 
 }
\ No newline at end of file
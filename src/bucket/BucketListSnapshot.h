@@ -38,6 +38,11 @@ class BucketListSnapshot : public NonMovable
 
     // Only allow copies via constructor
     BucketListSnapshot(BucketListSnapshot const& snapshot);
+
+    // Copies snapshot for the thread that owns sameThreadSnapshot, reusing the
+    // file streams of the buckets both snapshots contain
+    BucketListSnapshot(BucketListSnapshot const& snapshot,
+                       BucketListSnapshot const& sameThreadSnapshot);
     BucketListSnapshot& operator=(BucketListSnapshot const&) = delete;
 
     std::vector<BucketLevelSnapshot> const& getLevels() const;
@@ -67,6 +72,9 @@ class SearchableBucketListSnapshot : public NonMovableOrCopyable
     std::map<uint32_t, std::unique_ptr<BucketListSnapshot const>>
         mHistoricalSnapshots;
 
+    // Version of the SnapshotManager's snapshots that were last copied
+    uint64_t mSnapshotsVersion{0};
+
     SearchableBucketListSnapshot(BucketSnapshotManager const& snapshotManager);
 
     friend std::shared_ptr<SearchableBucketListSnapshot>
@@ -96,6 +104,18 @@ class SearchableBucketListSnapshot : public NonMovableOrCopyable
     loadKeysFromLedger(std::set<LedgerKey, LedgerEntryIdCmp> const& inKeys,
                        uint32_t ledgerSeq);
 
+    // Calls f on each live entry with a key not less than lowerBound, for
+    // which inRange returns true, in the snapshot for the given ledger (or
+    // the current one). inRange must hold for a contiguous range of keys in
+    // LedgerEntryIdCmp order. Entries are visited as they are found in the
+    // BucketList, which is not in key order. Stops early if f returns true.
+    // Returns false if no snapshot is available for ledgerSeq.
+    // f must not load from this snapshot.
+    bool scanKeyRange(LedgerKey const& lowerBound,
+                      std::function<bool(LedgerKey const&)> const& inRange,
+                      std::function<bool(LedgerEntry const&)> const& f,
+                      std::optional<uint32_t> ledgerSeq = std::nullopt);
+
     EvictionResult scanForEviction(uint32_t ledgerSeq,
                                    EvictionCounters& counters,
                                    EvictionIterator evictionIter,
@@ -5,6 +5,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "bucket/Bucket.h"
+#include "crypto/MultisetHash.h"
 #include "util/NonCopyable.h"
 #include "util/types.h"
 #include <future>
@@ -272,6 +273,17 @@ class BucketManager : NonMovableOrCopyable
                           std::vector<LedgerEntry> const& liveEntries,
                           std::vector<LedgerKey> const& deadEntries) = 0;
 
+    // Starts maintaining a MultisetHash of the live offers in the BucketList on
+    // every addBatch, starting from `initial` which must be the hash of the
+    // offers in the BucketList now, or stops if `initial` is std::nullopt.
+    // Offers are added as the fresh bucket is written. The versions they
+    // replace are looked up in BucketListDB on a background thread, and
+    // removed by the next addBatch or getOfferHash. Tracking stops when a new
+    // BucketList state is assumed, or if the snapshot of the replaced versions
+    // is gone by the time the lookup runs. Only supported with BucketListDB.
+    virtual void trackOfferHash(std::optional<MultisetHash> initial) = 0;
+    virtual std::optional<MultisetHash> getOfferHash() const = 0;
+
     // Update the given LedgerHeader's bucketListHash to reflect the current
     // state of the bucket list.
     virtual void snapshotLedger(LedgerHeader& currentHeader) = 0;
@@ -12,6 +12,7 @@
 #include "bucket/BucketSnapshotManager.h"
 #include "crypto/BLAKE2.h"
 #include "crypto/Hex.h"
+#include "crypto/SHA.h"
 #include "history/HistoryManager.h"
 #include "historywork/VerifyBucketWork.h"
 #include "ledger/LedgerManager.h"
@@ -194,6 +195,8 @@ BucketManagerImpl::BucketManagerImpl(Application& app)
           {"bucketlistDB", "bloom", "lookups"}, "bloom"))
     , mBucketListSizeCounter(
           app.getMetrics().NewCounter({"bucketlist", "size", "bytes"}))
+    , mOfferHashUntracked(app.getMetrics().NewMeter(
+          {"bucketlistDB", "offer-hash", "untracked"}, "event"))
     , mBucketListEvictionCounters(app)
     , mEvictionStatistics(std::make_shared<EvictionStatistics>())
     // Minimal DB is stored in the buckets dir, so delete it only when
@@ -929,8 +932,19 @@ BucketManagerImpl::addBatch(Application& app, LedgerHeader header,
     auto timer = mBucketAddBatch.TimeScope();
     mBucketObjectInsertBatch.Mark(initEntries.size() + liveEntries.size() +
                                   deadEntries.size());
+    if (mOfferHash)
+    {
+        settleOfferHash();
+    }
+    if (mOfferHash)
+    {
+        startReplacedOffersLookup(liveEntries, deadEntries);
+    }
+    // The live offers of the batch are added to the hash as the fresh bucket
+    // is written
     mBucketList->addBatch(app, header.ledgerSeq, header.ledgerVersion,
-                          initEntries, liveEntries, deadEntries);
+                          initEntries, liveEntries, deadEntries,
+                          mOfferHash ? &*mOfferHash : nullptr);
     mBucketListSizeCounter.set_count(mBucketList->getSize());
 
     if (app.getConfig().isUsingBucketListDB())
@@ -939,6 +953,113 @@ BucketManagerImpl::addBatch(Application& app, LedgerHeader header,
     }
 }
 
+void
+BucketManagerImpl::trackOfferHash(std::optional<MultisetHash> initial)
+{
+    releaseAssert(!initial || mConfig.isUsingBucketListDB());
+    mReplacedOfferHashes = {};
+    mOfferHash = std::move(initial);
+}
+
+std::optional<MultisetHash>
+BucketManagerImpl::getOfferHash() const
+{
+    settleOfferHash();
+    return mOfferHash;
+}
+
+void
+BucketManagerImpl::startReplacedOffersLookup(
+    std::vector<LedgerEntry> const& liveEntries,
+    std::vector<LedgerKey> const& deadEntries)
+{
+    ZoneScoped;
+    releaseAssert(mOfferHash);
+    releaseAssert(!mReplacedOfferHashes.valid());
+
+    std::set<LedgerKey, LedgerEntryIdCmp> keys;
+    for (auto const& le : liveEntries)
+    {
+        if (le.data.type() == OFFER)
+        {
+            keys.emplace(LedgerEntryKey(le));
+        }
+    }
+    for (auto const& key : deadEntries)
+    {
+        if (key.type() == OFFER)
+        {
+            keys.emplace(key);
+        }
+    }
+    if (keys.empty())
+    {
+        return;
+    }
+
+    // The snapshot is still at the last closed ledger, which holds the
+    // versions of the offers this batch replaces. The lookup overlaps with the
+    // rest of ledger close, and falls back to the historical snapshot if the
+    // current one has moved on by the time it runs.
+    auto searchableBL = mSnapshotManager->copySearchableBucketListSnapshot();
+    auto ledgerSeq = searchableBL->getLedgerSeq();
+    using task_t = std::packaged_task<std::optional<std::vector<uint256>>()>;
+    auto task = std::make_shared<task_t>(
+        [bl = std::move(searchableBL), keys = std::move(keys), ledgerSeq]()
+            -> std::optional<std::vector<uint256>> {
+            auto [entries, found] = bl->loadKeysFromLedger(keys, ledgerSeq);
+            if (!found)
+            {
+                return std::nullopt;
+            }
+            std::vector<uint256> hashes;
+            hashes.reserve(entries.size());
+            for (auto const& le : entries)
+            {
+                hashes.emplace_back(xdrSha256(le));
+            }
+            return hashes;
+        });
+    mReplacedOfferHashes = task->get_future();
+    mApp.postOnBackgroundThread(bind(&task_t::operator(), task),
+                                "BucketManager: replaced offers lookup");
+}
+
+void
+BucketManagerImpl::settleOfferHash() const
+{
+    if (!mReplacedOfferHashes.valid())
+    {
+        return;
+    }
+    auto hashes = mReplacedOfferHashes.get();
+    if (!mOfferHash)
+    {
+        return;
+    }
+    if (!hashes)
+    {
+        stopTrackingOfferHash("BucketListDB no longer has a snapshot of the "
+                              "ledger the replaced offers were in");
+        return;
+    }
+    for (auto const& h : *hashes)
+    {
+        mOfferHash->remove(h);
+    }
+}
+
+void
+BucketManagerImpl::stopTrackingOfferHash(std::string const& reason) const
+{
+    CLOG_WARNING(Bucket,
+                 "Stopped tracking the BucketList offer hash until the next "
+                 "full consistency check: {}",
+                 reason);
+    mOfferHashUntracked.Mark();
+    mOfferHash.reset();
+}
+
 #ifdef BUILD_TESTS
 void
 BucketManagerImpl::setNextCloseVersionAndHashForTesting(uint32_t protocolVers,
@@ -1177,6 +1298,8 @@ BucketManagerImpl::assumeState(HistoryArchiveState const& has,
 {
     ZoneScoped;
     releaseAssertOrThrow(mConfig.MODE_ENABLES_BUCKETLIST);
+    mReplacedOfferHashes = {};
+    mOfferHash.reset();
 
     for (uint32_t i = 0; i < BucketList::kNumLevels; ++i)
     {
@@ -50,6 +50,14 @@ class BucketManagerImpl : public BucketManager
     std::shared_ptr<SearchableBucketListSnapshot>
         mSearchableBucketListSnapshot{};
 
+    // Hash of the live offers in the BucketList, see trackOfferHash. The
+    // hashes of the offers replaced by the last batch are looked up in
+    // BucketListDB in the background, and removed from it by
+    // settleOfferHash. Mutable as getOfferHash settles it.
+    mutable std::optional<MultisetHash> mOfferHash;
+    mutable std::future<std::optional<std::vector<uint256>>>
+        mReplacedOfferHashes{};
+
     // Lock for managing raw Bucket files or the bucket directory. This lock is
     // only required for file access, but is not required for logical changes to
     // the BucketList (i.e. addBatch).
@@ -62,6 +70,7 @@ class BucketManagerImpl : public BucketManager
     medida::Meter& mBucketListDBBloomMisses;
     medida::Meter& mBucketListDBBloomLookups;
     medida::Counter& mBucketListSizeCounter;
+    medida::Meter& mOfferHashUntracked;
     EvictionCounters mBucketListEvictionCounters;
     MergeCounters mMergeCounters;
     std::shared_ptr<EvictionStatistics> mEvictionStatistics{};
@@ -96,6 +105,10 @@ class BucketManagerImpl : public BucketManager
     void cleanupStaleFiles();
     void deleteTmpDirAndUnlockBucketDir();
     void deleteEntireBucketDir();
+    void startReplacedOffersLookup(std::vector<LedgerEntry> const& liveEntries,
+                                   std::vector<LedgerKey> const& deadEntries);
+    void settleOfferHash() const;
+    void stopTrackingOfferHash(std::string const& reason) const;
 
     medida::Timer& recordBulkLoadMetrics(std::string const& label,
                                          size_t numEntries) const;
@@ -149,6 +162,8 @@ class BucketManagerImpl : public BucketManager
                   std::vector<LedgerEntry> const& initEntries,
                   std::vector<LedgerEntry> const& liveEntries,
                   std::vector<LedgerKey> const& deadEntries) override;
+    void trackOfferHash(std::optional<MultisetHash> initial) override;
+    std::optional<MultisetHash> getOfferHash() const override;
     void snapshotLedger(LedgerHeader& currentHeader) override;
     void maybeSetIndex(std::shared_ptr<Bucket> b,
                        std::unique_ptr<BucketIndex const>&& index) override;
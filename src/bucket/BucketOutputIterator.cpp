@@ -21,7 +21,8 @@ BucketOutputIterator::BucketOutputIterator(std::string const& tmpDir,
                                            bool keepDeadEntries,
                                            BucketMetadata const& meta,
                                            MergeCounters& mc,
-                                           asio::io_context& ctx, bool doFsync)
+                                           asio::io_context& ctx, bool doFsync,
+                                           MultisetHash* offerHash)
     : mFilename(Bucket::randomBucketName(tmpDir))
     , mOut(ctx, doFsync)
     , mCtx(ctx)
@@ -29,6 +30,7 @@ BucketOutputIterator::BucketOutputIterator(std::string const& tmpDir,
     , mKeepDeadEntries(keepDeadEntries)
     , mMeta(meta)
     , mMergeCounters(mc)
+    , mOfferHash(offerHash)
 {
     ZoneScoped;
     CLOG_TRACE(Bucket, "BucketOutputIterator opening file to write: {}",
@@ -48,6 +50,18 @@ BucketOutputIterator::BucketOutputIterator(std::string const& tmpDir,
     }
 }
 
+void
+BucketOutputIterator::write(BucketEntry const& e)
+{
+    mOut.writeOne(e, &mHasher, &mBytesPut);
+    mObjectsPut++;
+    if (mOfferHash && (e.type() == LIVEENTRY || e.type() == INITENTRY) &&
+        e.liveEntry().data.type() == OFFER)
+    {
+        mOfferHash->addXDR(e.liveEntry());
+    }
+}
+
 void
 BucketOutputIterator::put(BucketEntry const& e)
 {
@@ -80,8 +94,7 @@ BucketOutputIterator::put(BucketEntry const& e)
         if (mCmp(*mBuf, e))
         {
             ++mMergeCounters.mOutputIteratorActualWrites;
-            mOut.writeOne(*mBuf, &mHasher, &mBytesPut);
-            mObjectsPut++;
+            write(*mBuf);
         }
     }
     else
@@ -102,8 +115,7 @@ BucketOutputIterator::getBucket(BucketManager& bucketManager,
     ZoneScoped;
     if (mBuf)
     {
-        mOut.writeOne(*mBuf, &mHasher, &mBytesPut);
-        mObjectsPut++;
+        write(*mBuf);
         mBuf.reset();
     }
 
@@ -35,6 +35,9 @@ class BucketOutputIterator
     BucketMetadata mMeta;
     bool mPutMeta{false};
     MergeCounters& mMergeCounters;
+    MultisetHash* mOfferHash;
+
+    void write(BucketEntry const& e);
 
   public:
     // BucketOutputIterators must _always_ be constructed with BucketMetadata,
@@ -44,9 +47,12 @@ class BucketOutputIterator
     // version new enough that it should _write_ the metadata to the stream in
     // the form of a METAENTRY; but that's not a thing the caller gets to decide
     // (or forget to do), it's handled automatically.
+    //
+    // If `offerHash` is provided, the live offers written are added to it.
     BucketOutputIterator(std::string const& tmpDir, bool keepDeadEntries,
                          BucketMetadata const& meta, MergeCounters& mc,
-                         asio::io_context& ctx, bool doFsync);
+                         asio::io_context& ctx, bool doFsync,
+                         MultisetHash* offerHash = nullptr);
 
     void put(BucketEntry const& e);
 
@@ -8,6 +8,9 @@
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTypeUtils.h"
 #include "util/XDRStream.h"
+#include "util/types.h"
+
+#include <algorithm>
 
 namespace stellar
 {
@@ -23,6 +26,15 @@ BucketSnapshot::BucketSnapshot(BucketSnapshot const& b)
     releaseAssert(mBucket);
 }
 
+void
+BucketSnapshot::shareStream(BucketSnapshot const& other)
+{
+    if (!mStream && other.mBucket == mBucket)
+    {
+        mStream = other.mStream;
+    }
+}
+
 bool
 BucketSnapshot::isEmpty() const
 {
@@ -148,6 +160,57 @@ BucketSnapshot::getPoolIDsByAsset(Asset const& asset) const
     return mBucket->getIndex().getPoolIDsByAsset(asset);
 }
 
+bool
+BucketSnapshot::scanKeyRange(
+    LedgerKey const& lowerBound,
+    std::function<bool(LedgerKey const&)> const& inRange,
+    std::function<bool(BucketEntry const&)> const& f) const
+{
+    ZoneScoped;
+    if (isEmpty())
+    {
+        return false;
+    }
+
+    auto pos = mBucket->getIndex().getLowerBoundOffset(lowerBound);
+    if (!pos)
+    {
+        return false;
+    }
+
+    auto& stream = getStream();
+    stream.seek(*pos);
+
+    LedgerEntryIdCmp cmp;
+    BucketEntry be;
+    while (stream.readOne(be))
+    {
+        if (be.type() == METAENTRY)
+        {
+            continue;
+        }
+
+        // Range index pages may start before lowerBound
+        auto key = getBucketLedgerKey(be);
+        if (cmp(key, lowerBound))
+        {
+            continue;
+        }
+
+        if (!inRange(key))
+        {
+            break;
+        }
+
+        if (f(be))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool
 BucketSnapshot::scanForEviction(EvictionIterator& iter, uint32_t& bytesToScan,
                                 uint32_t ledgerSeq,
@@ -196,47 +259,66 @@ BucketSnapshot::scanForEviction(EvictionIterator& iter, uint32_t& bytesToScan,
     // streams
     XDRInputFileStream stream{};
     stream.open(mBucket->getFilename());
-    stream.seek(iter.bucketFileOffset);
     BucketEntry be;
 
-    // First, scan the bucket region and record all temp entry keys in
-    // maybeEvictQueue. After scanning, we will load all the TTL keys for these
-    // entries in a single bulk load to determine
-    //   1. If the entry is expired
-    //   2. If the entry has already been deleted/evicted
+    // The scan region ends with the first entry ending at or past
+    // regionEnd. Find that entry by reading forward from the closest indexed
+    // entry, rather than from the start of the region.
+    auto const& index = mBucket->getIndex();
+    auto const regionStart =
+        static_cast<std::streamoff>(iter.bucketFileOffset);
+    auto const regionEnd =
+        regionStart + static_cast<std::streamoff>(bytesToScan);
+    stream.seek(std::max(regionStart, index.getEntryOffsetBefore(regionEnd)));
+    bool reachedRegionEnd = false;
     while (stream.readOne(be))
     {
-        auto newPos = stream.pos();
-        auto bytesRead = newPos - iter.bucketFileOffset;
-        iter.bucketFileOffset = newPos;
-
-        if (be.type() == INITENTRY || be.type() == LIVEENTRY)
+        if (stream.pos() >= regionEnd)
         {
-            auto const& le = be.liveEntry();
-            if (isTemporaryEntry(le.data))
-            {
-                keysToSearch.emplace(getTTLKey(le));
-
-                // Set lifetime to 0 as default, will be updated after TTL keys
-                // loaded
-                maybeEvictQueue.emplace_back(
-                    EvictionResultEntry(LedgerEntryKey(le), iter, 0));
-            }
+            reachedRegionEnd = true;
+            break;
         }
+    }
+    auto const scanEnd =
+        reachedRegionEnd
+            ? stream.pos()
+            : std::max(regionStart, static_cast<std::streamoff>(stream.size()));
 
-        if (bytesRead >= bytesToScan)
-        {
-            // Reached end of scan region
-            bytesToScan = 0;
-            processQueue();
-            return true;
-        }
+    // Then, read only the temp entries of the region, which the index
+    // records, and record their keys in maybeEvictQueue. After scanning, we
+    // will load all the TTL keys for these entries in a single bulk load to
+    // determine
+    //   1. If the entry is expired
+    //   2. If the entry has already been deleted/evicted
+    auto const& tempOffsets = index.getTemporaryEntryOffsets();
+    for (auto it = std::lower_bound(tempOffsets.begin(), tempOffsets.end(),
+                                    regionStart);
+         it != tempOffsets.end() && *it < scanEnd; ++it)
+    {
+        stream.seek(*it);
+        releaseAssertOrThrow(stream.readOne(be));
+        auto const& le = be.liveEntry();
+        keysToSearch.emplace(getTTLKey(le));
 
-        bytesToScan -= bytesRead;
+        // Each result resumes the scan right after its entry. Set lifetime
+        // to 0 as default, will be updated after TTL keys loaded
+        auto entryIter = iter;
+        entryIter.bucketFileOffset = stream.pos();
+        maybeEvictQueue.emplace_back(
+            EvictionResultEntry(LedgerEntryKey(le), entryIter, 0));
     }
 
-    // Hit eof
+    iter.bucketFileOffset = scanEnd;
     processQueue();
+    if (reachedRegionEnd)
+    {
+        // Reached end of scan region
+        bytesToScan = 0;
+        return true;
+    }
+
+    // Hit eof
+    bytesToScan -= static_cast<uint32_t>(scanEnd - regionStart);
     return false;
 }
 
@@ -246,7 +328,7 @@ BucketSnapshot::getStream() const
     releaseAssertOrThrow(!isEmpty());
     if (!mStream)
     {
-        mStream = std::make_unique<XDRInputFileStream>();
+        mStream = std::make_shared<XDRInputFileStream>();
         mStream->open(mBucket->getFilename().string());
     }
     return *mStream;
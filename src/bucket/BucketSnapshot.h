@@ -6,6 +6,7 @@
 
 #include "bucket/LedgerCmp.h"
 #include "util/NonCopyable.h"
+#include <functional>
 #include <list>
 #include <set>
 
@@ -25,8 +26,10 @@ class BucketSnapshot : public NonMovable
 {
     std::shared_ptr<Bucket const> const mBucket;
 
-    // Lazily-constructed and retained for read path.
-    mutable std::unique_ptr<XDRInputFileStream> mStream{};
+    // Lazily-constructed and retained for read path. Shared with the
+    // snapshots of the same bucket in other BucketListSnapshots owned by the
+    // same thread, see shareStream.
+    mutable std::shared_ptr<XDRInputFileStream> mStream{};
 
     // Returns (lazily-constructed) file stream for bucket file. Note
     // this might be in some random position left over from a previous read --
@@ -43,6 +46,10 @@ class BucketSnapshot : public NonMovable
 
     BucketSnapshot(std::shared_ptr<Bucket const> const b);
 
+    // Reuses the file stream of other if it is a snapshot of the same bucket.
+    // Both snapshots must only be used by the same thread.
+    void shareStream(BucketSnapshot const& other);
+
     // Only allow copy constructor, is threadsafe
     BucketSnapshot(BucketSnapshot const& b);
     BucketSnapshot& operator=(BucketSnapshot const&) = delete;
@@ -68,11 +75,19 @@ class BucketSnapshot : public NonMovable
     // pool
     std::vector<PoolID> const& getPoolIDsByAsset(Asset const& asset) const;
 
+    // Calls f on the entries of this bucket with keys not less than
+    // lowerBound, in key order, until reaching a key for which inRange returns
+    // false. Returns true if f returned true to stop the scan early.
+    bool scanKeyRange(LedgerKey const& lowerBound,
+                      std::function<bool(LedgerKey const&)> const& inRange,
+                      std::function<bool(BucketEntry const&)> const& f) const;
+
     bool scanForEviction(EvictionIterator& iter, uint32_t& bytesToScan,
                          uint32_t ledgerSeq,
                          std::list<EvictionResultEntry>& evictableKeys,
                          SearchableBucketListSnapshot& bl) const;
 
     friend struct BucketLevelSnapshot;
+    friend class BucketListSnapshot;
 };
 }
\ No newline at end of file
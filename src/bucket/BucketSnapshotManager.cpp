@@ -3,13 +3,18 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "bucket/BucketSnapshotManager.h"
+#include "bucket/Bucket.h"
+#include "bucket/BucketIndex.h"
 #include "bucket/BucketListSnapshot.h"
 #include "main/Application.h"
+#include "util/Logging.h"
 #include "util/XDRStream.h" // IWYU pragma: keep
 
+#include "medida/counter.h"
+#include "medida/histogram.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
-#include <shared_mutex>
+#include <unordered_set>
 
 namespace stellar
 {
@@ -18,9 +23,15 @@ BucketSnapshotManager::BucketSnapshotManager(
     Application& app, std::unique_ptr<BucketListSnapshot const>&& snapshot,
     uint32_t numHistoricalSnapshots)
     : mApp(app)
-    , mCurrentSnapshot(std::move(snapshot))
-    , mHistoricalSnapshots()
     , mNumHistoricalSnapshots(numHistoricalSnapshots)
+    , mRetainedLedgers(app.getMetrics().NewCounter(
+          {"bucketlistDB", "snapshot", "retained-ledgers"}))
+    , mRetainedBucketBytes(app.getMetrics().NewCounter(
+          {"bucketlistDB", "snapshot", "retained-bucket-bytes"}))
+    , mRetainedIndexBytes(app.getMetrics().NewCounter(
+          {"bucketlistDB", "snapshot", "retained-index-bytes"}))
+    , mLedgerIndexBytes(app.getMetrics().NewHistogram(
+          {"bucketlistDB", "snapshot", "ledger-index-bytes"}))
     , mBulkLoadMeter(app.getMetrics().NewMeter(
           {"bucketlistDB", "query", "loads"}, "query"))
     , mBloomMisses(app.getMetrics().NewMeter(
@@ -29,6 +40,11 @@ BucketSnapshotManager::BucketSnapshotManager(
           {"bucketlistDB", "bloom", "lookups"}, "bloom"))
 {
     releaseAssert(threadIsMain());
+    auto snapshots = std::make_shared<Snapshots>();
+    snapshots->current = std::move(snapshot);
+    std::atomic_store(&mSnapshots,
+                      std::shared_ptr<Snapshots const>(std::move(snapshots)));
+    mSnapshotsVersion.fetch_add(1, std::memory_order_release);
 }
 
 std::shared_ptr<SearchableBucketListSnapshot>
@@ -67,43 +83,68 @@ void
 BucketSnapshotManager::maybeUpdateSnapshot(
     std::unique_ptr<BucketListSnapshot const>& snapshot,
     std::map<uint32_t, std::unique_ptr<BucketListSnapshot const>>&
-        historicalSnapshots) const
+        historicalSnapshots,
+    uint64_t& version) const
 {
-    // The canonical snapshot held by the BucketSnapshotManager is not being
-    // modified. Rather, a thread is checking it's copy against the canonical
-    // snapshot, so use a shared lock.
-    std::shared_lock<std::shared_mutex> lock(mSnapshotMutex);
-
-    // First update current snapshot
-    if (!snapshot ||
-        snapshot->getLedgerSeq() != mCurrentSnapshot->getLedgerSeq())
+    auto latestVersion = mSnapshotsVersion.load(std::memory_order_acquire);
+    if (snapshot && version == latestVersion)
     {
-        // Should only update with a newer snapshot
-        releaseAssert(!snapshot || snapshot->getLedgerSeq() <
-                                       mCurrentSnapshot->getLedgerSeq());
-        snapshot = std::make_unique<BucketListSnapshot>(*mCurrentSnapshot);
+        return;
     }
 
-    // Then update historical snapshots (if any exist)
-    if (mHistoricalSnapshots.empty())
+    // The published snapshots are at least as recent as latestVersion. If
+    // they are more recent, the next call will find nothing to copy.
+    auto snapshots = std::atomic_load(&mSnapshots);
+    version = latestVersion;
+
+    // Should only update with a newer snapshot
+    std::unique_ptr<BucketListSnapshot const> previous = std::move(snapshot);
+    releaseAssert(!previous || previous->getLedgerSeq() <=
+                                   snapshots->current->getLedgerSeq());
+
+    // Copies share file streams with the newest snapshot we already have
+    BucketListSnapshot const* newest = previous.get();
+
+    // Keep our copy of the previous current snapshot if it is retained as a
+    // historical snapshot, then drop the ledgers that aren't retained anymore
+    if (previous && snapshots->historical.count(previous->getLedgerSeq()) != 0)
     {
-        return;
+        auto ledgerSeq = previous->getLedgerSeq();
+        historicalSnapshots.try_emplace(ledgerSeq, std::move(previous));
+    }
+    for (auto iter = historicalSnapshots.begin();
+         iter != historicalSnapshots.end();)
+    {
+        if (snapshots->historical.count(iter->first) == 0)
+        {
+            iter = historicalSnapshots.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
     }
 
-    // If size of manager's history map is different, or if the oldest snapshot
-    // ledger seq is different, we need to update.
-    if (mHistoricalSnapshots.size() != historicalSnapshots.size() ||
-        mHistoricalSnapshots.begin()->first !=
-            historicalSnapshots.begin()->first)
+    if (!newest && !historicalSnapshots.empty())
     {
-        // Copy current snapshot map into historicalSnapshots
-        historicalSnapshots.clear();
-        for (auto const& [ledgerSeq, snap] : mHistoricalSnapshots)
+        newest = historicalSnapshots.rbegin()->second.get();
+    }
+    auto copy = [newest](BucketListSnapshot const& s) {
+        return newest ? std::make_unique<BucketListSnapshot>(s, *newest)
+                      : std::make_unique<BucketListSnapshot>(s);
+    };
+
+    // Only copy the historical snapshots we don't have, which only happens on
+    // the first update or when we haven't been updated for several ledgers
+    for (auto const& [ledgerSeq, snap] : snapshots->historical)
+    {
+        if (historicalSnapshots.count(ledgerSeq) == 0)
         {
-            historicalSnapshots.emplace(
-                ledgerSeq, std::make_unique<BucketListSnapshot>(*snap));
+            historicalSnapshots.emplace(ledgerSeq, copy(*snap));
         }
     }
+
+    snapshot = copy(*snapshots->current);
 }
 
 void
@@ -113,27 +154,100 @@ BucketSnapshotManager::updateCurrentSnapshot(
     releaseAssert(newSnapshot);
     releaseAssert(threadIsMain());
 
-    // Updating the BucketSnapshotManager canonical snapshot, must lock
-    // exclusively for write access.
-    std::unique_lock<std::shared_mutex> lock(mSnapshotMutex);
-    releaseAssert(!mCurrentSnapshot || newSnapshot->getLedgerSeq() >=
-                                           mCurrentSnapshot->getLedgerSeq());
+    // Only the main thread publishes snapshots, so these are the latest ones
+    auto snapshots = std::atomic_load(&mSnapshots);
+    auto const& current = snapshots->current;
+    releaseAssert(!current ||
+                  newSnapshot->getLedgerSeq() >= current->getLedgerSeq());
+
+    // Build the new snapshots next to the published ones, sharing all
+    // unchanged BucketListSnapshots
+    auto updated = std::make_shared<Snapshots>();
+    updated->historical = snapshots->historical;
 
     // First update historical snapshots
-    if (mNumHistoricalSnapshots != 0)
+    if (mNumHistoricalSnapshots != 0 && current)
     {
         // If historical snapshots are full, delete the oldest one
-        if (mHistoricalSnapshots.size() == mNumHistoricalSnapshots)
+        if (updated->historical.size() == mNumHistoricalSnapshots)
         {
-            mHistoricalSnapshots.erase(mHistoricalSnapshots.begin());
+            forgetRetainedSize(updated->historical.begin()->first);
+            updated->historical.erase(updated->historical.begin());
         }
 
-        mHistoricalSnapshots.emplace(mCurrentSnapshot->getLedgerSeq(),
-                                     std::move(mCurrentSnapshot));
-        mCurrentSnapshot = nullptr;
+        if (updated->historical.emplace(current->getLedgerSeq(), current)
+                .second)
+        {
+            recordRetainedSize(*current, *newSnapshot);
+        }
+    }
+
+    updated->current = std::move(newSnapshot);
+
+    // Threads that loaded the previous snapshots keep them alive until they
+    // are done with them
+    std::atomic_store(&mSnapshots,
+                      std::shared_ptr<Snapshots const>(std::move(updated)));
+    mSnapshotsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void
+BucketSnapshotManager::recordRetainedSize(BucketListSnapshot const& retained,
+                                          BucketListSnapshot const& next)
+{
+    std::unordered_set<Bucket const*> nextBuckets;
+    for (auto const& lev : next.getLevels())
+    {
+        nextBuckets.insert(lev.curr.getRawBucket().get());
+        nextBuckets.insert(lev.snap.getRawBucket().get());
+    }
+
+    // Buckets never come back once replaced, so a Bucket that isn't in the
+    // next snapshot is only kept by this one and older ones
+    RetainedSize size;
+    std::unordered_set<Bucket const*> counted;
+    for (auto const& lev : retained.getLevels())
+    {
+        for (auto const* b : {&lev.curr, &lev.snap})
+        {
+            auto bucket = b->getRawBucket();
+            if (b->isEmpty() || nextBuckets.count(bucket.get()) != 0 ||
+                !counted.insert(bucket.get()).second)
+            {
+                continue;
+            }
+            size.bucketBytes += bucket->getSize();
+            if (bucket->isIndexed())
+            {
+                size.indexBytes += bucket->getIndex().getMemoryEstimate();
+            }
+        }
+    }
+
+    mRetainedSizes[retained.getLedgerSeq()] = size;
+    mRetainedLedgers.inc();
+    mRetainedBucketBytes.inc(size.bucketBytes);
+    mRetainedIndexBytes.inc(size.indexBytes);
+    mLedgerIndexBytes.Update(size.indexBytes);
+    CLOG_DEBUG(Bucket,
+               "Retaining snapshot of ledger {}: {} bucket bytes, {} index "
+               "bytes",
+               retained.getLedgerSeq(), size.bucketBytes, size.indexBytes);
+}
+
+void
+BucketSnapshotManager::forgetRetainedSize(uint32_t ledgerSeq)
+{
+    auto iter = mRetainedSizes.find(ledgerSeq);
+    if (iter == mRetainedSizes.end())
+    {
+        return;
     }
 
-    mCurrentSnapshot.swap(newSnapshot);
+    mRetainedLedgers.dec();
+    mRetainedBucketBytes.dec(iter->second.bucketBytes);
+    mRetainedIndexBytes.dec(iter->second.indexBytes);
+    mRetainedSizes.erase(iter);
 }
 
 void
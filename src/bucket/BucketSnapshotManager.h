@@ -8,12 +8,14 @@
 #include "util/NonCopyable.h"
 #include "util/UnorderedMap.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
-#include <shared_mutex>
 
 namespace medida
 {
+class Counter;
+class Histogram;
 class Meter;
 class MetricsRegistry;
 class Timer;
@@ -34,20 +36,47 @@ class BucketSnapshotManager : NonMovableOrCopyable
   private:
     Application& mApp;
 
-    // Snapshot that is maintained and periodically updated by BucketManager on
-    // the main thread. When background threads need to generate or refresh a
-    // snapshot, they will copy this snapshot.
-    std::unique_ptr<BucketListSnapshot const> mCurrentSnapshot{};
+    // Snapshots that are maintained and periodically updated by BucketManager
+    // on the main thread. When background threads need to generate or refresh
+    // a snapshot, they will copy these snapshots. Historical snapshots share
+    // the Buckets that didn't change between ledgers.
+    struct Snapshots
+    {
+        std::shared_ptr<BucketListSnapshot const> current;
 
-    // ledgerSeq that the snapshot is based on -> snapshot
-    std::map<uint32_t, std::unique_ptr<BucketListSnapshot const>>
-        mHistoricalSnapshots;
+        // ledgerSeq that the snapshot is based on -> snapshot
+        std::map<uint32_t, std::shared_ptr<BucketListSnapshot const>>
+            historical;
+    };
+
+    // Never modified once published, the main thread replaces it on every
+    // update. Only accessed with std::atomic_load and std::atomic_store, so
+    // that threads refreshing their snapshots never block the main thread.
+    std::shared_ptr<Snapshots const> mSnapshots;
+
+    // Incremented after each update of mSnapshots, so that threads can check
+    // that their snapshots are up to date with a single atomic load
+    std::atomic<uint64_t> mSnapshotsVersion{0};
 
     uint32_t const mNumHistoricalSnapshots;
 
-    // Lock must be held when accessing mCurrentSnapshot and
-    // mHistoricalSnapshots
-    mutable std::shared_mutex mSnapshotMutex;
+    // Size of the Buckets that are only referenced by each historical
+    // snapshot, and no longer by the next one. Main thread only.
+    struct RetainedSize
+    {
+        size_t bucketBytes{0};
+        size_t indexBytes{0};
+    };
+    std::map<uint32_t, RetainedSize> mRetainedSizes;
+
+    medida::Counter& mRetainedLedgers;
+    medida::Counter& mRetainedBucketBytes;
+    medida::Counter& mRetainedIndexBytes;
+    medida::Histogram& mLedgerIndexBytes;
+
+    void recordRetainedSize(BucketListSnapshot const& retained,
+                            BucketListSnapshot const& next);
+    void forgetRetainedSize(uint32_t ledgerSeq);
 
     mutable UnorderedMap<LedgerEntryType, medida::Timer&> mPointTimers{};
     mutable UnorderedMap<std::string, medida::Timer&> mBulkTimers{};
@@ -73,12 +102,16 @@ class BucketSnapshotManager : NonMovableOrCopyable
     std::shared_ptr<SearchableBucketListSnapshot>
     copySearchableBucketListSnapshot() const;
 
-    // Checks if snapshot is out of date with mCurrentSnapshot and updates
-    // it accordingly
+    // Checks if snapshot is out of date with the current snapshot and updates
+    // it accordingly. version is the version of the snapshots the caller
+    // copied last. Lock-free, and only copies the snapshots of ledgers the
+    // caller doesn't have yet: the caller's current snapshot is kept as a
+    // historical snapshot when it is retained.
     void maybeUpdateSnapshot(
         std::unique_ptr<BucketListSnapshot const>& snapshot,
         std::map<uint32_t, std::unique_ptr<BucketListSnapshot const>>&
-            historicalSnapshots) const;
+            historicalSnapshots,
+        uint64_t& version) const;
 
     // All metric recording functions must only be called by the main thread
     void startPointLoadTimer() const;
@@ -10,11 +10,16 @@
 #include "bucket/BucketManager.h"
 #include "bucket/BucketSnapshotManager.h"
 #include "bucket/test/BucketTestUtils.h"
+#include "ledger/LedgerTypeUtils.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "test/test.h"
+#include "util/XDRStream.h"
+
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
 
 using namespace stellar;
 using namespace BucketTestUtils;
@@ -107,14 +112,26 @@ class BucketIndexTest
         buildBucketList(f);
     }
 
+    // If refreshEachLedger is set, the snapshot is created first and
+    // refreshed after every ledger, so that it keeps its own copies of the
+    // historical snapshots rather than copying them all at once
     void
-    runHistoricalSnapshotTest()
+    runHistoricalSnapshotTest(bool refreshEachLedger = false)
     {
         uint32_t ledger = 0;
         auto canonicalEntry =
             LedgerTestUtils::generateValidLedgerEntryWithExclusions(
                 {LedgerEntryType::CONFIG_SETTING});
         canonicalEntry.lastModifiedLedgerSeq = 0;
+        auto lk = LedgerEntryKey(canonicalEntry);
+
+        std::shared_ptr<SearchableBucketListSnapshot> searchableBL;
+        if (refreshEachLedger)
+        {
+            searchableBL = getBM()
+                               .getBucketSnapshotManager()
+                               .copySearchableBucketListSnapshot();
+        }
 
         do
         {
@@ -124,13 +141,24 @@ class BucketIndexTest
             mApp->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
                 {}, {entryCopy}, {});
             closeLedger(*mApp);
+            if (searchableBL)
+            {
+                REQUIRE(searchableBL->load(lk)->lastModifiedLedgerSeq ==
+                        ledger);
+            }
         } while (ledger < mApp->getConfig().QUERY_SNAPSHOT_LEDGERS + 2);
         ++ledger;
 
-        auto searchableBL = getBM()
-                                .getBucketSnapshotManager()
-                                .copySearchableBucketListSnapshot();
-        auto lk = LedgerEntryKey(canonicalEntry);
+        if (!searchableBL)
+        {
+            searchableBL = getBM()
+                               .getBucketSnapshotManager()
+                               .copySearchableBucketListSnapshot();
+        }
+        REQUIRE(mApp->getMetrics()
+                    .NewCounter({"bucketlistDB", "snapshot",
+                                 "retained-ledgers"})
+                    .count() == mApp->getConfig().QUERY_SNAPSHOT_LEDGERS);
 
         auto currentLoadedEntry = searchableBL->load(lk);
         REQUIRE(currentLoadedEntry);
@@ -502,6 +530,156 @@ class BucketIndexPoolShareTest : public BucketIndexTest
     }
 };
 
+class BucketIndexRangeScanTest : public BucketIndexTest
+{
+    AccountID mAccountToSearch;
+    SCAddress mContractToSearch;
+
+    // Entries in the ranges to scan that BucketList should return
+    UnorderedMap<LedgerKey, LedgerEntry> mTrustlines;
+    UnorderedMap<LedgerKey, LedgerEntry> mContractData;
+
+    void
+    updateOrDelete(UnorderedMap<LedgerKey, LedgerEntry>& entries,
+                   std::vector<LedgerEntry>& live,
+                   std::vector<LedgerKey>& dead)
+    {
+        if (entries.empty() || mDist(gRandomEngine) >= 20)
+        {
+            return;
+        }
+
+        // Arbitrarily pick first entry of map
+        auto iter = entries.begin();
+        if (rand_flip())
+        {
+            dead.emplace_back(iter->first);
+            entries.erase(iter);
+        }
+        else
+        {
+            ++iter->second.lastModifiedLedgerSeq;
+            live.emplace_back(iter->second);
+        }
+    }
+
+    void
+    buildTest(bool shouldMultiVersion)
+    {
+        auto f = [&](std::vector<LedgerEntry>& entries) {
+            // Update existing entries before adding new ones, so that no key
+            // is both created and deleted in the same batch
+            std::vector<LedgerKey> dead;
+            if (shouldMultiVersion)
+            {
+                updateOrDelete(mTrustlines, entries, dead);
+                updateOrDelete(mContractData, entries, dead);
+            }
+
+            for (int i = 0; i < 4; ++i)
+            {
+                LedgerEntry trustline;
+                trustline.data.type(TRUSTLINE);
+                trustline.data.trustLine() =
+                    LedgerTestUtils::generateValidTrustLineEntry();
+
+                LedgerEntry contractData;
+                contractData.data.type(CONTRACT_DATA);
+                contractData.data.contractData() =
+                    LedgerTestUtils::generateValidContractDataEntry();
+
+                // Half of the entries are in the ranges to scan, the other
+                // half are neighbours that must not be returned
+                if (rand_flip())
+                {
+                    trustline.data.trustLine().accountID = mAccountToSearch;
+                    mTrustlines.emplace(LedgerEntryKey(trustline), trustline);
+                    contractData.data.contractData().contract =
+                        mContractToSearch;
+                    mContractData.emplace(LedgerEntryKey(contractData),
+                                          contractData);
+                }
+                entries.emplace_back(trustline);
+                entries.emplace_back(contractData);
+            }
+
+            mApp->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
+                {}, entries, dead);
+        };
+
+        BucketIndexTest::buildBucketList(f);
+    }
+
+  public:
+    BucketIndexRangeScanTest(Config& cfg, uint32_t levels = 6)
+        : BucketIndexTest(cfg, levels)
+    {
+        mAccountToSearch =
+            LedgerTestUtils::generateValidAccountEntry().accountID;
+        mContractToSearch =
+            LedgerTestUtils::generateValidContractDataEntry().contract;
+    }
+
+    virtual void
+    buildGeneralTest() override
+    {
+        buildTest(false);
+    }
+
+    virtual void
+    buildMultiVersionTest() override
+    {
+        buildTest(true);
+    }
+
+    virtual void
+    run() override
+    {
+        auto searchableBL = getBM()
+                                .getBucketSnapshotManager()
+                                .copySearchableBucketListSnapshot();
+        auto scan = [&](LedgerKey const& lowerBound,
+                        std::function<bool(LedgerKey const&)> inRange) {
+            std::vector<LedgerEntry> result;
+            REQUIRE(searchableBL->scanKeyRange(
+                lowerBound, inRange, [&](LedgerEntry const& le) {
+                    result.emplace_back(le);
+                    return false;
+                }));
+            return result;
+        };
+
+        LedgerKey trustlineBound(TRUSTLINE);
+        trustlineBound.trustLine().accountID = mAccountToSearch;
+        validateResults(mTrustlines,
+                        scan(trustlineBound, [&](LedgerKey const& k) {
+                            return k.type() == TRUSTLINE &&
+                                   k.trustLine().accountID == mAccountToSearch;
+                        }));
+
+        LedgerKey contractDataBound(CONTRACT_DATA);
+        contractDataBound.contractData().contract = mContractToSearch;
+        contractDataBound.contractData().durability = TEMPORARY;
+        validateResults(mContractData,
+                        scan(contractDataBound, [&](LedgerKey const& k) {
+                            return k.type() == CONTRACT_DATA &&
+                                   k.contractData().contract ==
+                                       mContractToSearch;
+                        }));
+
+        // Scans stop as soon as the callback asks to
+        if (!mTrustlines.empty())
+        {
+            size_t count = 0;
+            searchableBL->scanKeyRange(
+                trustlineBound,
+                [&](LedgerKey const& k) { return k.type() == TRUSTLINE; },
+                [&](LedgerEntry const& le) { return ++count == 1; });
+            REQUIRE(count == 1);
+        }
+    }
+};
+
 static void
 testAllIndexTypes(std::function<void(Config&)> f)
 {
@@ -566,6 +744,18 @@ TEST_CASE("load from historical snapshots", "[bucket][bucketindex]")
     testAllIndexTypes(f);
 }
 
+TEST_CASE("load from historical snapshots refreshed each ledger",
+          "[bucket][bucketindex]")
+{
+    auto f = [&](Config& cfg) {
+        cfg.QUERY_SNAPSHOT_LEDGERS = 50;
+        auto test = BucketIndexTest(cfg);
+        test.runHistoricalSnapshotTest(/*refreshEachLedger=*/true);
+    };
+
+    testAllIndexTypes(f);
+}
+
 TEST_CASE("loadPoolShareTrustLinesByAccountAndAsset", "[bucket][bucketindex]")
 {
     auto f = [&](Config& cfg) {
@@ -590,6 +780,29 @@ TEST_CASE(
     testAllIndexTypes(f);
 }
 
+TEST_CASE("scan key range", "[bucket][bucketindex]")
+{
+    auto f = [&](Config& cfg) {
+        auto test = BucketIndexRangeScanTest(cfg);
+        test.buildGeneralTest();
+        test.run();
+    };
+
+    testAllIndexTypes(f);
+}
+
+TEST_CASE("scan key range does not load outdated versions",
+          "[bucket][bucketindex]")
+{
+    auto f = [&](Config& cfg) {
+        auto test = BucketIndexRangeScanTest(cfg);
+        test.buildMultiVersionTest();
+        test.run();
+    };
+
+    testAllIndexTypes(f);
+}
+
 TEST_CASE("ContractData key with same ScVal", "[bucket][bucketindex]")
 {
     auto f = [&](Config& cfg) {
@@ -602,6 +815,53 @@ TEST_CASE("ContractData key with same ScVal", "[bucket][bucketindex]")
     testAllIndexTypes(f);
 }
 
+TEST_CASE("temporary entry offsets", "[bucket][bucketindex]")
+{
+    auto f = [&](Config& cfg) {
+        auto test = BucketIndexTest(cfg);
+        test.buildGeneralTest();
+
+        for (auto const& bucketHash :
+             test.getBM().getBucketListReferencedBuckets())
+        {
+            if (isZero(bucketHash))
+            {
+                continue;
+            }
+
+            // The index must record exactly the evictable entries a linear
+            // scan of the bucket finds
+            auto b = test.getBM().getBucketByHash(bucketHash);
+            std::vector<std::streamoff> expectedOffsets;
+            XDRInputFileStream in;
+            in.open(b->getFilename().string());
+            std::streamoff pos = 0;
+            BucketEntry be;
+            while (in.readOne(be))
+            {
+                if ((be.type() == INITENTRY || be.type() == LIVEENTRY) &&
+                    isTemporaryEntry(be.liveEntry().data))
+                {
+                    expectedOffsets.emplace_back(pos);
+                }
+                pos = in.pos();
+            }
+
+            auto const& index = b->getIndexForTesting();
+            REQUIRE(index.getTemporaryEntryOffsets() == expectedOffsets);
+            for (auto off : expectedOffsets)
+            {
+                // Every temporary entry starts at or after the indexed entry
+                // preceding it
+                REQUIRE(index.getEntryOffsetBefore(off) < off);
+                REQUIRE(index.getEntryOffsetBefore(off + 1) <= off);
+            }
+        }
+    };
+
+    testAllIndexTypes(f);
+}
+
 TEST_CASE("serialize bucket indexes", "[bucket][bucketindex]")
 {
     Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT));
@@ -12,6 +12,7 @@
 // else.
 #include "util/asio.h"
 #include "bucket/Bucket.h"
+#include "bucket/BucketApplicator.h"
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketManager.h"
 #include "bucket/BucketOutputIterator.h"
@@ -956,6 +957,82 @@ TEST_CASE_VERSIONS("legacy bucket apply", "[bucket]")
     });
 }
 
+TEST_CASE("bucket apply only applies newest offers with BucketListDB",
+          "[bucket]")
+{
+    VirtualClock clock;
+    Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_VOLATILE));
+    Application::pointer app = createTestApplication(clock, cfg);
+    REQUIRE(app->getConfig().isUsingBucketListDB());
+
+    std::vector<LedgerEntry> older(30), newer;
+    std::vector<LedgerKey> dead, noDead;
+    for (size_t i = 0; i < older.size(); ++i)
+    {
+        auto& e = older[i];
+        e.data.type(OFFER);
+        e.data.offer() = LedgerTestUtils::generateValidOfferEntry(5);
+        e.data.offer().offerID = i + 1;
+        e.data.offer().amount = 1;
+        if (i % 3 == 0)
+        {
+            auto updated = e;
+            updated.data.offer().amount = 2;
+            newer.emplace_back(updated);
+        }
+        else if (i % 3 == 1)
+        {
+            dead.emplace_back(LedgerEntryKey(e));
+        }
+    }
+
+    auto newerBucket = Bucket::fresh(
+        app->getBucketManager(), getAppLedgerVersion(app), {}, newer, dead,
+        /*countMergeEvents=*/true, clock.getIOContext(), /*doFsync=*/true);
+    auto olderBucket = Bucket::fresh(
+        app->getBucketManager(), getAppLedgerVersion(app), older, {}, noDead,
+        /*countMergeEvents=*/true, clock.getIOContext(), /*doFsync=*/true);
+
+    SeenKeySet seenKeys;
+    BucketApplicator::Counters counters(clock.now());
+    auto onlyOffers = [](LedgerEntryType t) { return t == OFFER; };
+    for (auto const& bucket : {newerBucket, olderBucket})
+    {
+        BucketApplicator applicator(*app, getAppLedgerVersion(app),
+                                    getAppLedgerVersion(app), 0, bucket,
+                                    onlyOffers, seenKeys);
+        while (applicator)
+        {
+            if (!applicator.ready())
+            {
+                clock.crank(true);
+                continue;
+            }
+            applicator.advance(counters);
+        }
+    }
+
+    REQUIRE(seenKeys.size() == older.size());
+    REQUIRE(app->getLedgerTxnRoot().countObjects(OFFER) ==
+            older.size() - dead.size());
+
+    LedgerTxn ltx(app->getLedgerTxnRoot());
+    for (size_t i = 0; i < older.size(); ++i)
+    {
+        auto entry = ltx.load(LedgerEntryKey(older[i]));
+        if (i % 3 == 1)
+        {
+            REQUIRE(!entry);
+        }
+        else
+        {
+            REQUIRE(entry);
+            REQUIRE(entry.current().data.offer().amount ==
+                    (i % 3 == 0 ? 2 : 1));
+        }
+    }
+}
+
 TEST_CASE("bucket apply bench", "[bucketbench][!hide]")
 {
     auto runtest = [](Config::TestDbMode mode) {
@@ -58,6 +58,14 @@ ApplyBucketsWork::startingLevel()
                                                   : BucketList::kNumLevels - 1;
 }
 
+uint32_t
+ApplyBucketsWork::bucketLevel(size_t bucketIndex)
+{
+    auto level = static_cast<uint32_t>(bucketIndex / 2);
+    return mApp.getConfig().isUsingBucketListDB() ? level
+                                                  : startingLevel() - level;
+}
+
 ApplyBucketsWork::ApplyBucketsWork(
     Application& app,
     std::map<std::string, std::shared_ptr<Bucket>> const& buckets,
@@ -112,6 +120,8 @@ ApplyBucketsWork::doReset()
     mSeenKeys.clear();
     mBucketsToApply.clear();
     mBucketApplicator.reset();
+    mNextApplicators.clear();
+    mNextApplicatorIndex = 0;
 
     if (!isAborting())
     {
@@ -119,7 +129,8 @@ ApplyBucketsWork::doReset()
         {
             // The current size of this set is 1.6 million during BucketApply
             // (as of 12/20/23). There's not a great way to estimate this, so
-            // reserving with some extra wiggle room
+            // reserving with some extra wiggle room. Keys are only stored as
+            // 16-byte digests.
             mSeenKeys.reserve(2'000'000);
         }
 
@@ -192,17 +203,44 @@ ApplyBucketsWork::appliedAllBuckets() const
     return mBucketToApplyIndex == mBucketsToApply.size();
 }
 
+void
+ApplyBucketsWork::createApplicators(size_t count)
+{
+    ZoneScoped;
+    while (mNextApplicators.size() < count &&
+           mNextApplicatorIndex < mBucketsToApply.size())
+    {
+        auto bucket = mBucketsToApply.at(mNextApplicatorIndex);
+        mMinProtocolVersionSeen =
+            std::min(mMinProtocolVersionSeen, Bucket::getBucketVersion(bucket));
+        mNextApplicators.emplace_back(std::make_unique<BucketApplicator>(
+            mApp, mMaxProtocolVersion, mMinProtocolVersionSeen,
+            bucketLevel(mNextApplicatorIndex), bucket, mEntryTypeFilter,
+            mSeenKeys));
+        ++mNextApplicatorIndex;
+    }
+}
+
 void
 ApplyBucketsWork::startBucket()
 {
     ZoneScoped;
-    auto bucket = mBucketsToApply.at(mBucketToApplyIndex);
-    mMinProtocolVersionSeen =
-        std::min(mMinProtocolVersionSeen, Bucket::getBucketVersion(bucket));
-    // Create a new applicator for the bucket.
-    mBucketApplicator = std::make_unique<BucketApplicator>(
-        mApp, mMaxProtocolVersion, mMinProtocolVersionSeen, mLevel, bucket,
-        mEntryTypeFilter, mSeenKeys);
+    createApplicators(1);
+    releaseAssert(mNextApplicatorIndex - mNextApplicators.size() ==
+                  mBucketToApplyIndex);
+    mBucketApplicator = std::move(mNextApplicators.front());
+    mNextApplicators.pop_front();
+
+    // With BucketListDB, applicators read their offers on worker threads as
+    // soon as they are created, so create those of the next buckets now to
+    // decode them while this one is applied. Offers of a bucket can only be
+    // applied once all the newer ones are, as they are checked against the
+    // keys seen so far.
+    if (mApp.getConfig().isUsingBucketListDB())
+    {
+        createApplicators(
+            static_cast<size_t>(std::max(1, mApp.getConfig().WORKER_THREADS)));
+    }
 }
 
 void
@@ -284,6 +322,22 @@ ApplyBucketsWork::doWork()
                                           : mBucketToApplyIndex % 2 == 1;
         if (mBucketApplicator)
         {
+            if (*mBucketApplicator && !mBucketApplicator->ready())
+            {
+                // Wait for the next batch of offers to be read
+                std::weak_ptr<ApplyBucketsWork> weak(
+                    std::static_pointer_cast<ApplyBucketsWork>(
+                        shared_from_this()));
+                mBucketApplicator->setOnReady([weak]() {
+                    auto self = weak.lock();
+                    if (self)
+                    {
+                        self->wakeUp();
+                    }
+                });
+                return State::WORK_WAITING;
+            }
+
             TempLedgerVersionSetter tlvs(mApp, mMaxProtocolVersion);
             // Only advance the applicator if there are entries to apply.
             if (*mBucketApplicator)
@@ -39,9 +39,13 @@ class ApplyBucketsWork : public Work
     uint32_t mLevel{0};
     uint32_t mMaxProtocolVersion{0};
     uint32_t mMinProtocolVersionSeen{UINT32_MAX};
-    std::unordered_set<LedgerKey> mSeenKeys;
+    SeenKeySet mSeenKeys;
     std::vector<std::shared_ptr<Bucket>> mBucketsToApply;
     std::unique_ptr<BucketApplicator> mBucketApplicator;
+    // Applicators of the buckets following the current one, reading their
+    // offers ahead when using BucketListDB
+    std::deque<std::unique_ptr<BucketApplicator>> mNextApplicators;
+    size_t mNextApplicatorIndex{0};
     bool mDelayChecked{false};
 
     BucketApplicator::Counters mCounters;
@@ -50,7 +54,9 @@ class ApplyBucketsWork : public Work
     std::shared_ptr<Bucket> getBucket(std::string const& bucketHash);
 
     uint32_t startingLevel();
+    uint32_t bucketLevel(size_t bucketIndex);
     bool appliedAllBuckets() const;
+    void createApplicators(size_t count);
     void startBucket();
     void prepareForNextBucket();
 
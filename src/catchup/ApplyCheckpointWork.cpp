@@ -7,6 +7,7 @@
 #include "bucket/BucketManager.h"
 #include "catchup/ApplyLedgerWork.h"
 #include "history/FileTransferInfo.h"
+#include "history/HistoryCache.h"
 #include "history/HistoryManager.h"
 #include "historywork/Progress.h"
 #include "invariant/InvariantDoesNotHold.h"
@@ -355,6 +356,14 @@ ApplyCheckpointWork::onAbort()
 void
 ApplyCheckpointWork::onFailureRaise()
 {
+    // The files may have come from the local history cache, don't let them
+    // fail the next attempt too
+    for (auto type : {FileType::HISTORY_FILE_TYPE_LEDGER,
+                      FileType::HISTORY_FILE_TYPE_TRANSACTIONS})
+    {
+        HistoryCache::evict(mApp,
+                            FileTransferInfo(mDownloadDir, type, mCheckpoint));
+    }
     if (mOnFailure)
     {
         mOnFailure();
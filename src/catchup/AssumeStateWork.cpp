@@ -9,6 +9,7 @@
 #include "crypto/Hex.h"
 #include "history/HistoryArchive.h"
 #include "invariant/InvariantManager.h"
+#include "ledger/LedgerTxn.h"
 #include "work/WorkSequence.h"
 #include "work/WorkWithCallback.h"
 
@@ -76,6 +77,7 @@ AssumeStateWork::doWork()
                               &buckets = mBuckets](Application& app) {
             app.getBucketManager().assumeState(has, maxProtocolVersion,
                                                restartMerges);
+            app.getLedgerTxnRoot().clearContractCodeCache();
 
             // Drop bucket references once assume state complete since buckets
             // now referenced by BucketList
@@ -74,6 +74,10 @@ class CatchupManager
     virtual bool catchupWorkIsDone() const = 0;
     virtual bool isCatchupInitialized() const = 0;
 
+    // Return the first ledger of the ledger chain verified by the current
+    // catchup, see CatchupWork::getVerifiedLedgerRangeStart
+    virtual LedgerHeaderHistoryEntry getVerifiedLedgerRangeStart() const = 0;
+
     // Emit a log message and set StatusManager HISTORY_CATCHUP status to
     // describe current catchup state. The `contiguous` argument is passed in
     // to describe whether the ledger-manager's view of current catchup tasks
@@ -295,6 +295,13 @@ CatchupManagerImpl::isCatchupInitialized() const
     return mCatchupWork != nullptr;
 }
 
+LedgerHeaderHistoryEntry
+CatchupManagerImpl::getVerifiedLedgerRangeStart() const
+{
+    releaseAssert(mCatchupWork);
+    return mCatchupWork->getVerifiedLedgerRangeStart();
+}
+
 void
 CatchupManagerImpl::logAndUpdateCatchupStatus(bool contiguous,
                                               std::string const& message)
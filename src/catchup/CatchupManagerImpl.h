@@ -72,6 +72,7 @@ class CatchupManagerImpl : public CatchupManager
     BasicWork::State getCatchupWorkState() const override;
     bool catchupWorkIsDone() const override;
     bool isCatchupInitialized() const override;
+    LedgerHeaderHistoryEntry getVerifiedLedgerRangeStart() const override;
 
     void logAndUpdateCatchupStatus(bool contiguous,
                                    std::string const& message) override;
@@ -26,6 +26,7 @@
 #include "main/PersistentState.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
+#include "work/ParallelWork.h"
 #include "work/WorkWithCallback.h"
 #include <Tracy.hpp>
 #include <fmt/format.h>
@@ -179,9 +180,27 @@ CatchupWork::downloadVerifyLedgerChain(CatchupRange const& catchupRange,
         mApp, *mDownloadDir, verifyRange, mLastClosedLedgerHashPair,
         std::nullopt, mRangeEndFuture, std::move(fatalFailurePromise));
 
+    std::vector<std::shared_ptr<BasicWork>> seq{getLedgers};
+    if (mCatchupConfiguration.mode() ==
+        CatchupConfiguration::Mode::OFFLINE_COMPLETE)
+    {
+        // Transaction results are checked against the downloaded headers, so
+        // they can be downloaded and verified while the chain itself is
+        // verified
+        downloadVerifyTxResults(catchupRange);
+        std::vector<std::shared_ptr<BasicWork>> verify{mVerifyLedgers,
+                                                       mVerifyTxResults};
+        seq.emplace_back(std::make_shared<ParallelWork>(
+            mApp, "verify-ledgers-and-results", verify,
+            BasicWork::RETRY_NEVER));
+    }
+    else
+    {
+        seq.emplace_back(mVerifyLedgers);
+    }
+
     // Never retry the sequence: downloads already have retries, and there's no
     // point retrying verification
-    std::vector<std::shared_ptr<BasicWork>> seq{getLedgers, mVerifyLedgers};
     mDownloadVerifyLedgersSeq = addWork<WorkSequence>(
         "download-verify-ledgers-seq", seq, BasicWork::RETRY_NEVER);
     mCurrentWork = mDownloadVerifyLedgersSeq;
@@ -608,13 +627,6 @@ CatchupWork::runCatchupStep()
                 mApp, "herder-state-consistency-work", cb);
             seq.push_back(consistencyWork);
 
-            if (mCatchupConfiguration.mode() ==
-                CatchupConfiguration::Mode::OFFLINE_COMPLETE)
-            {
-                downloadVerifyTxResults(catchupRange);
-                seq.push_back(mVerifyTxResults);
-            }
-
             if (catchupRange.applyBuckets())
             {
                 // Step 4.2: Download, verify and apply buckets
@@ -636,7 +648,10 @@ CatchupWork::runCatchupStep()
         }
         else if (mDownloadVerifyLedgersSeq->getState() == State::WORK_FAILURE)
         {
-            if (mVerifyLedgers && mVerifyLedgers->isDone())
+            // Verification may have been aborted by a failure to verify
+            // transaction results, which doesn't resolve the future
+            if (mVerifyLedgers && mVerifyLedgers->isDone() &&
+                mVerifyLedgers->getState() != State::WORK_ABORTED)
             {
                 releaseAssert(futureIsReady(mFatalFailureFuture));
             }
@@ -76,6 +76,15 @@ class CatchupWork : public Work
         return mCatchupConfiguration;
     }
 
+    // First ledger of the verified ledger chain: the ledger buckets are
+    // applied at, or the end of the first replayed checkpoint. Only
+    // meaningful once the chain has been verified.
+    LedgerHeaderHistoryEntry const&
+    getVerifiedLedgerRangeStart() const
+    {
+        return mVerifiedLedgerRangeStart;
+    }
+
     bool
     fatalFailure()
     {
@@ -0,0 +1,369 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "catchup/ParallelCatchupWork.h"
+#include "catchup/CatchupManager.h"
+#include "catchup/CatchupRange.h"
+#include "history/HistoryArchive.h"
+#include "history/HistoryArchiveManager.h"
+#include "history/HistoryManager.h"
+#include "ledger/LedgerManager.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/TmpDir.h"
+
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+namespace stellar
+{
+
+namespace
+{
+// Upper bound on the handlers run on each segment per call to onRun, so that
+// a busy segment doesn't starve the others or the application
+size_t const MAX_SEGMENT_CRANKS = 16;
+std::chrono::seconds const STATUS_LOG_INTERVAL(30);
+
+std::string
+describeSegment(CatchupConfiguration const& configuration)
+{
+    return fmt::format(FMT_STRING("ledgers {:d}-{:d}"),
+                       configuration.toLedger() - configuration.count() + 1,
+                       configuration.toLedger());
+}
+
+std::string
+catchupStatus(CatchupManager const& cm)
+{
+    if (!cm.isCatchupInitialized())
+    {
+        return "not started";
+    }
+    if (!cm.catchupWorkIsDone())
+    {
+        return cm.getStatus();
+    }
+    return cm.getCatchupWorkState() == BasicWork::State::WORK_SUCCESS
+               ? "done"
+               : "failed";
+}
+}
+
+std::vector<CatchupConfiguration>
+ParallelCatchupWork::splitRange(uint32_t lastClosedLedger,
+                                CatchupConfiguration const& configuration,
+                                uint32_t segments,
+                                HistoryManager const& historyManager)
+{
+    // Segments start from buckets, so only a fresh application replaying a
+    // known range can be split
+    if (segments <= 1 ||
+        lastClosedLedger != LedgerManager::GENESIS_LEDGER_SEQ ||
+        configuration.toLedger() == CatchupConfiguration::CURRENT ||
+        configuration.localBucketsOnly())
+    {
+        return {configuration};
+    }
+
+    CatchupRange range(lastClosedLedger, configuration, historyManager);
+    if (!range.replayLedgers())
+    {
+        return {configuration};
+    }
+
+    uint32_t const first = range.getReplayFirst();
+    uint32_t const last = range.last();
+    uint64_t const length = last - first + 1;
+
+    // End of each segment but the last one, rounded up to a checkpoint
+    // boundary
+    std::vector<uint32_t> ends;
+    for (uint32_t i = 1; i < segments; ++i)
+    {
+        auto target = static_cast<uint32_t>(first - 1 + length * i / segments);
+        auto end = historyManager.checkpointContainingLedger(target);
+        if (end < first || end >= last || (!ends.empty() && end <= ends.back()))
+        {
+            continue;
+        }
+        ends.emplace_back(end);
+    }
+
+    if (ends.empty())
+    {
+        return {configuration};
+    }
+
+    std::vector<CatchupConfiguration> result;
+    auto mode = configuration.mode();
+    result.emplace_back(ends[0], ends[0] - first + 1, mode);
+    for (size_t i = 1; i < ends.size(); ++i)
+    {
+        result.emplace_back(ends[i], ends[i] - ends[i - 1], mode);
+    }
+    result.emplace_back(
+        LedgerNumHashPair(configuration.toLedger(), configuration.hash()),
+        last - ends.back(), mode);
+    return result;
+}
+
+ParallelCatchupWork::ParallelCatchupWork(
+    Application& app, std::vector<CatchupConfiguration> segments,
+    std::shared_ptr<HistoryArchive> archive)
+    : BasicWork(app, "parallel-catchup", BasicWork::RETRY_NEVER)
+    , mConfigurations(std::move(segments))
+    , mArchive(archive)
+{
+    releaseAssert(!mConfigurations.empty());
+}
+
+ParallelCatchupWork::~ParallelCatchupWork()
+{
+    stopSegments();
+}
+
+std::string
+ParallelCatchupWork::getStatus() const
+{
+    if (mSegments.empty())
+    {
+        return BasicWork::getStatus();
+    }
+
+    auto status = fmt::format(FMT_STRING("Parallel catchup, {:d} segments"),
+                              mSegments.size() + 1);
+    for (size_t i = 0; i < mSegments.size(); ++i)
+    {
+        status += fmt::format(
+            FMT_STRING("; {}: {}"), describeSegment(mConfigurations[i]),
+            catchupStatus(mSegments[i].mApp->getCatchupManager()));
+    }
+    status += fmt::format(FMT_STRING("; last segment: {}"),
+                          catchupStatus(mApp.getCatchupManager()));
+    return status;
+}
+
+void
+ParallelCatchupWork::onReset()
+{
+    stopSegments();
+    mLastLoggedStatus.clear();
+}
+
+bool
+ParallelCatchupWork::onAbort()
+{
+    return true;
+}
+
+void
+ParallelCatchupWork::onSuccess()
+{
+    stopSegments();
+}
+
+BasicWork::State
+ParallelCatchupWork::onRun()
+{
+    ZoneScoped;
+    if (mSegments.empty())
+    {
+        startSegments();
+    }
+
+    auto ran = crankSegments();
+
+    auto done = true;
+    auto checkCatchup = [&](CatchupManager const& cm, std::string const& name) {
+        if (!cm.isCatchupInitialized())
+        {
+            CLOG_ERROR(History, "Catchup of {} did not start", name);
+            return false;
+        }
+        if (!cm.catchupWorkIsDone())
+        {
+            done = false;
+        }
+        else if (cm.getCatchupWorkState() != State::WORK_SUCCESS)
+        {
+            CLOG_ERROR(History, "Catchup of {} failed", name);
+            return false;
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < mSegments.size(); ++i)
+    {
+        if (!checkCatchup(mSegments[i].mApp->getCatchupManager(),
+                          describeSegment(mConfigurations[i])))
+        {
+            return State::WORK_FAILURE;
+        }
+    }
+    if (!checkCatchup(mApp.getCatchupManager(), "last segment"))
+    {
+        return State::WORK_FAILURE;
+    }
+
+    logProgress();
+
+    if (done)
+    {
+        return checkBoundaries() ? State::WORK_SUCCESS : State::WORK_FAILURE;
+    }
+
+    if (ran == 0)
+    {
+        // Segments are waiting for their worker threads, poll them again
+        // shortly without spinning the main thread
+        setupWaitingCallback(std::chrono::milliseconds(1));
+        return State::WORK_WAITING;
+    }
+    return State::WORK_RUNNING;
+}
+
+Config
+ParallelCatchupWork::makeSegmentConfig(size_t index,
+                                       std::string const& dir) const
+{
+    Config cfg = mApp.getConfig();
+    cfg.setNoListen();
+    cfg.setNoPublish();
+    cfg.BUCKET_DIR_PATH = dir + "/buckets";
+    if (cfg.DATABASE.value != "sqlite3://:memory:")
+    {
+        cfg.DATABASE = SecretValue{
+            fmt::format(FMT_STRING("sqlite3://{}/stellar.db"), dir)};
+    }
+    cfg.METADATA_DEBUG_LEDGERS = 0;
+    if (!cfg.METADATA_OUTPUT_STREAM.empty())
+    {
+        // Segments close their ledgers out of order with respect to each
+        // other, so each of them gets its own stream. Descriptors can't be
+        // shared, runCatchup rejects them.
+        releaseAssert(cfg.METADATA_OUTPUT_STREAM.find("fd:") != 0);
+        cfg.METADATA_OUTPUT_STREAM =
+            fmt::format(FMT_STRING("{}.segment-{:d}"),
+                        cfg.METADATA_OUTPUT_STREAM, index + 1);
+    }
+    return cfg;
+}
+
+void
+ParallelCatchupWork::startSegments()
+{
+    ZoneScoped;
+    releaseAssert(mSegments.empty());
+    for (size_t i = 0; i < mConfigurations.size(); ++i)
+    {
+        auto const& configuration = mConfigurations[i];
+        CLOG_INFO(History, "Starting catchup segment {}/{}: {}", i + 1,
+                  mConfigurations.size() + 1, describeSegment(configuration));
+
+        Segment segment;
+        segment.mDir = std::make_unique<TmpDir>(mApp.getTmpDirManager().tmpDir(
+            fmt::format(FMT_STRING("catchup-segment-{:d}"), i + 1)));
+        segment.mClock =
+            std::make_unique<VirtualClock>(mApp.getClock().getMode());
+        segment.mApp = Application::create(
+            *segment.mClock, makeSegmentConfig(i, segment.mDir->getName()));
+        segment.mApp->start();
+
+        // Segments use their own instance of the archive picked for the
+        // application, or pick one themselves
+        std::shared_ptr<HistoryArchive> archive;
+        if (mArchive)
+        {
+            archive =
+                segment.mApp->getHistoryArchiveManager().getHistoryArchive(
+                    mArchive->getName());
+        }
+        segment.mApp->getLedgerManager().startCatchup(configuration, archive,
+                                                      {});
+        mSegments.emplace_back(std::move(segment));
+    }
+}
+
+void
+ParallelCatchupWork::stopSegments()
+{
+    for (auto& segment : mSegments)
+    {
+        segment.mApp->gracefulStop();
+        while (segment.mClock->crank(false) > 0)
+            ;
+    }
+    mSegments.clear();
+}
+
+size_t
+ParallelCatchupWork::crankSegments()
+{
+    size_t ran = 0;
+    for (auto& segment : mSegments)
+    {
+        if (segment.mApp->getCatchupManager().catchupWorkIsDone())
+        {
+            continue;
+        }
+        for (size_t i = 0; i < MAX_SEGMENT_CRANKS; ++i)
+        {
+            auto n = segment.mClock->crank(false);
+            if (n == 0)
+            {
+                break;
+            }
+            ran += n;
+        }
+    }
+    return ran;
+}
+
+bool
+ParallelCatchupWork::checkBoundaries() const
+{
+    for (size_t i = 0; i < mSegments.size(); ++i)
+    {
+        auto const& closed = mSegments[i]
+                                 .mApp->getLedgerManager()
+                                 .getLastClosedLedgerHeader();
+        auto& nextCatchup = i + 1 < mSegments.size()
+                                ? mSegments[i + 1].mApp->getCatchupManager()
+                                : mApp.getCatchupManager();
+        auto next = nextCatchup.getVerifiedLedgerRangeStart();
+        if (closed.header.ledgerSeq != next.header.ledgerSeq ||
+            closed.hash != next.hash)
+        {
+            CLOG_ERROR(History,
+                       "Catchup segment {} closed {}, but the next segment "
+                       "verified {}",
+                       describeSegment(mConfigurations[i]),
+                       LedgerManager::ledgerAbbrev(closed),
+                       LedgerManager::ledgerAbbrev(next));
+            return false;
+        }
+    }
+    CLOG_INFO(History, "Verified the boundaries of {} catchup segments",
+              mSegments.size() + 1);
+    return true;
+}
+
+void
+ParallelCatchupWork::logProgress()
+{
+    auto now = mApp.getClock().now();
+    if (now < mNextStatusLog)
+    {
+        return;
+    }
+    auto status = getStatus();
+    if (status != mLastLoggedStatus)
+    {
+        CLOG_INFO(History, "{}", status);
+        mLastLoggedStatus = status;
+    }
+    mNextStatusLog = now + STATUS_LOG_INTERVAL;
+}
+}
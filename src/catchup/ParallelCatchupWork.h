@@ -0,0 +1,86 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#include "catchup/CatchupConfiguration.h"
+#include "main/Application.h"
+#include "util/Timer.h"
+#include "work/BasicWork.h"
+
+namespace stellar
+{
+
+class CatchupManager;
+class HistoryArchive;
+class HistoryManager;
+class TmpDir;
+
+// ParallelCatchupWork replays the leading segments of a catchup range, as
+// computed by splitRange, while the application itself catches up to the last
+// segment.
+//
+// Every segment runs in its own application, with its own database and bucket
+// directory under the application's tmp dir: it applies the buckets at the
+// start of the segment and replays the ledgers up to its end. Those
+// applications are cranked from the main thread along with this work, so their
+// downloads, decompression, hashing and merges proceed concurrently on their
+// worker threads.
+//
+// Once everything is done, the ledger closed by each segment is checked
+// against the start of the ledger chain verified by the following one, so the
+// whole range is chained to the (possibly trusted) hash of the last segment.
+// The application is left in the state produced by the last segment; the
+// other segments' state is discarded.
+class ParallelCatchupWork : public BasicWork
+{
+  public:
+    // Splits the catchup described by `configuration` into at most `segments`
+    // configurations ending on checkpoint boundaries, each starting from the
+    // buckets at the end of the previous one. The last one targets the
+    // destination of `configuration`. Ranges that can't be split are returned
+    // unchanged.
+    static std::vector<CatchupConfiguration>
+    splitRange(uint32_t lastClosedLedger,
+               CatchupConfiguration const& configuration, uint32_t segments,
+               HistoryManager const& historyManager);
+
+    // `segments` are all the configurations returned by splitRange except
+    // the last one, which must have been started on the application.
+    ParallelCatchupWork(Application& app,
+                        std::vector<CatchupConfiguration> segments,
+                        std::shared_ptr<HistoryArchive> archive);
+    ~ParallelCatchupWork();
+
+    std::string getStatus() const override;
+
+  protected:
+    void onReset() override;
+    BasicWork::State onRun() override;
+    bool onAbort() override;
+    void onSuccess() override;
+
+  private:
+    struct Segment
+    {
+        std::unique_ptr<TmpDir> mDir;
+        std::unique_ptr<VirtualClock> mClock;
+        Application::pointer mApp;
+    };
+
+    std::vector<CatchupConfiguration> const mConfigurations;
+    std::shared_ptr<HistoryArchive> const mArchive;
+    std::vector<Segment> mSegments;
+
+    std::string mLastLoggedStatus;
+    VirtualClock::time_point mNextStatusLog;
+
+    Config makeSegmentConfig(size_t index, std::string const& dir) const;
+    void startSegments();
+    void stopSegments();
+    size_t crankSegments();
+    bool checkBoundaries() const;
+    void logProgress();
+};
+}
@@ -5,16 +5,13 @@
 #include "catchup/ReplayDebugMetaWork.h"
 #include "catchup/CatchupWork.h"
 #include "work/WorkScheduler.h"
-#include "work/WorkWithCallback.h"
 
 #include "catchup/ApplyLedgerWork.h"
 #include "herder/LedgerCloseData.h"
-#include "historywork/GunzipFileWork.h"
 #include "ledger/LedgerManager.h"
 #include "util/DebugMetaUtils.h"
 #include "util/GlobalChecks.h"
 #include "util/XDRStream.h"
-#include <regex>
 
 namespace stellar
 {
@@ -30,11 +27,11 @@ class ApplyLedgersFromMetaWork : public Work
 
   public:
     ApplyLedgersFromMetaWork(Application& app,
-                             std::filesystem::path const& unzippedMetaFile,
+                             std::filesystem::path const& metaFile,
                              uint32_t targetLedger)
-        : Work(app, fmt::format("apply-ledgers-from-{}", unzippedMetaFile),
+        : Work(app, fmt::format("apply-ledgers-from-{}", metaFile),
                BasicWork::RETRY_NEVER)
-        , mFilename(unzippedMetaFile)
+        , mFilename(metaFile)
         , mTargetLedger(targetLedger)
     {
     }
@@ -211,35 +208,14 @@ ReplayDebugMetaWork::doWork()
 
     auto filename = *mNextToApply;
     CLOG_INFO(Work, "Process next debug meta file: {}", filename.string());
-    auto isZipped = std::regex_match(filename.string(),
-                                     metautils::META_DEBUG_ZIP_FILE_REGEX);
 
-    auto zipped = metautils::getMetaDebugDirPath(mMetaDir) / filename;
+    // Zipped meta files are decompressed as they are read, no need to unzip
+    // them first
+    auto path = metautils::getMetaDebugDirPath(mMetaDir) / filename;
+    std::vector<std::shared_ptr<BasicWork>> seq{
+        std::make_shared<ApplyLedgersFromMetaWork>(mApp, path, mTargetLedger)};
 
-    std::filesystem::path unzipped = zipped;
-    std::vector<std::shared_ptr<BasicWork>> seq;
-
-    if (isZipped)
-    {
-        seq.emplace_back(std::make_shared<GunzipFileWork>(
-            mApp, zipped.string(), /* keepExisting */ true));
-        // If zipped, remove `gz` extension
-        unzipped.replace_extension();
-    }
-
-    seq.emplace_back(std::make_shared<ApplyLedgersFromMetaWork>(mApp, unzipped,
-                                                                mTargetLedger));
-    auto removeUnzipped = [isZipped, unzipped](Application& app) {
-        if (isZipped)
-        {
-            std::filesystem::remove(unzipped);
-        }
-        return true;
-    };
-    seq.emplace_back(std::make_shared<WorkWithCallback>(mApp, "remove-unzipped",
-                                                        removeUnzipped));
-
-    mCurrentWorkSequence = addWork<WorkSequence>("unzip-and-apply-from-meta",
+    mCurrentWorkSequence = addWork<WorkSequence>("apply-from-meta",
                                                  seq, BasicWork::RETRY_NEVER);
     return BasicWork::State::WORK_RUNNING;
 }
@@ -4,6 +4,7 @@
 
 #include "catchup/VerifyLedgerChainWork.h"
 #include "history/FileTransferInfo.h"
+#include "history/HistoryCache.h"
 #include "historywork/Progress.h"
 #include "ledger/LedgerManager.h"
 #include "main/Application.h"
@@ -14,17 +15,19 @@
 #include "util/XDRStream.h"
 #include "util/types.h"
 #include <Tracy.hpp>
+#include <algorithm>
 #include <fmt/format.h>
 #include <fstream>
 
 namespace stellar
 {
 
+// `calculated` is the hash of `hhe.header`
 static HistoryManager::LedgerVerificationStatus
-verifyLedgerHistoryEntry(LedgerHeaderHistoryEntry const& hhe)
+verifyLedgerHistoryEntry(LedgerHeaderHistoryEntry const& hhe,
+                         Hash const& calculated)
 {
     ZoneScoped;
-    Hash calculated = sha256(xdr::xdr_to_opaque(hhe.header));
     if (calculated != hhe.hash)
     {
         CLOG_ERROR(
@@ -38,9 +41,10 @@ verifyLedgerHistoryEntry(LedgerHeaderHistoryEntry const& hhe)
 }
 
 static HistoryManager::LedgerVerificationStatus
-verifyLedgerHistoryLink(Hash const& prev, LedgerHeaderHistoryEntry const& curr)
+verifyLedgerHistoryLink(Hash const& prev, LedgerHeaderHistoryEntry const& curr,
+                        Hash const& calculated)
 {
-    auto entryResult = verifyLedgerHistoryEntry(curr);
+    auto entryResult = verifyLedgerHistoryEntry(curr, calculated);
     if (entryResult != HistoryManager::VERIFY_STATUS_OK)
     {
         return entryResult;
@@ -124,6 +128,7 @@ VerifyLedgerChainWork::VerifyLedgerChainWork(
     , mTrustedMaxLedger(trustedMaxLedger)
     , mVerifiedMinLedgerPrevFuture(mVerifiedMinLedgerPrev.get_future().share())
     , mOutputStream(outputStream)
+    , mNextCheckpointToLoad(mCurrCheckpoint)
 {
     // LCL should be at-or-after genesis and we should have a hash.
     releaseAssert(lastClosedLedger.first >= LedgerManager::GENESIS_LEDGER_SEQ);
@@ -156,10 +161,107 @@ VerifyLedgerChainWork::onReset()
                                 mRange.last());
     mChainDisagreesWithLocalState.reset();
     mHasTrustedHash = false;
+    mLoadedCheckpoints.clear();
+    mNextCheckpointToLoad = mCurrCheckpoint;
+    mLoadsInFlight = 0;
+    ++mGeneration;
+}
+
+std::shared_ptr<VerifyLedgerChainWork::CheckpointHeaders>
+VerifyLedgerChainWork::loadCheckpointHeaders(std::string const& path,
+                                             uint32_t lastLedger)
+{
+    ZoneScoped;
+    auto headers = std::make_shared<CheckpointHeaders>();
+    try
+    {
+        XDRInputFileStream hdrIn;
+        hdrIn.open(path);
+        LedgerHeaderHistoryEntry curr;
+        while (hdrIn)
+        {
+            try
+            {
+                if (!hdrIn.readOne(curr))
+                {
+                    break;
+                }
+            }
+            catch (xdr::xdr_bad_message_size&)
+            {
+                headers->mBadMessageSize = true;
+                break;
+            }
+            headers->mHashes.emplace_back(
+                sha256(xdr::xdr_to_opaque(curr.header)));
+            headers->mEntries.emplace_back(curr);
+
+            // Nothing past the range is verified
+            if (curr.header.ledgerSeq == lastLedger)
+            {
+                break;
+            }
+        }
+    }
+    catch (...)
+    {
+        headers->mReadError = std::current_exception();
+    }
+    return headers;
+}
+
+void
+VerifyLedgerChainWork::loadCheckpoints()
+{
+    ZoneScoped;
+    auto const& hm = mApp.getHistoryManager();
+    auto minCheckpoint = hm.checkpointContainingLedger(mRange.mFirst);
+    // Keep every worker thread busy, without reading far ahead of the
+    // verification
+    auto maxPending =
+        2 * static_cast<size_t>(std::max(1, mApp.getConfig().WORKER_THREADS));
+
+    Application& app = mApp;
+    std::weak_ptr<VerifyLedgerChainWork> weak(
+        std::static_pointer_cast<VerifyLedgerChainWork>(shared_from_this()));
+    while (mNextCheckpointToLoad >= minCheckpoint &&
+           mLoadsInFlight + mLoadedCheckpoints.size() < maxPending)
+    {
+        auto checkpoint = mNextCheckpointToLoad;
+        auto generation = mGeneration;
+        FileTransferInfo ft(mDownloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
+                            checkpoint);
+        app.postOnBackgroundThread(
+            [&app, weak, generation, checkpoint, path = ft.localPath_nogz(),
+             lastLedger = mRange.last()]() {
+                auto headers = loadCheckpointHeaders(path, lastLedger);
+                app.postOnMainThread(
+                    [weak, generation, checkpoint, headers]() {
+                        auto self = weak.lock();
+                        if (!self || self->mGeneration != generation)
+                        {
+                            return;
+                        }
+                        --self->mLoadsInFlight;
+                        self->mLoadedCheckpoints.emplace(checkpoint, headers);
+                        self->wakeUp();
+                    },
+                    "VerifyLedgerChain: checkpoint loaded");
+            },
+            "VerifyLedgerChain: load checkpoint");
+        ++mLoadsInFlight;
+
+        // Checkpoints are loaded from the highest one down, stop after the
+        // lowest one
+        mNextCheckpointToLoad = checkpoint == minCheckpoint
+                                    ? 0
+                                    : checkpoint - hm.getCheckpointFrequency();
+    }
 }
 
 HistoryManager::LedgerVerificationStatus
-VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
+VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint(
+    CheckpointHeaders const& headers)
 {
     ZoneScoped;
     // When verifying a checkpoint, we rely on the fact that the next checkpoint
@@ -168,11 +270,6 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
     // trusted hash passed in. If LCL is reached, verify that it agrees with
     // the chain.
 
-    FileTransferInfo ft(mDownloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
-                        mCurrCheckpoint);
-    XDRInputFileStream hdrIn;
-    hdrIn.open(ft.localPath_nogz());
-
     bool beginCheckpoint = true;
 
     // The `curr`, `first` and `prev` variables are named for their positions in
@@ -184,24 +281,30 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
     LedgerHeaderHistoryEntry first;
     LedgerHeaderHistoryEntry prev;
 
-    CLOG_DEBUG(History, "Verifying ledger headers from {} for checkpoint {}",
-               ft.localPath_nogz(), mCurrCheckpoint);
+    CLOG_DEBUG(History, "Verifying ledger headers for checkpoint {}",
+               mCurrCheckpoint);
 
     auto const& hm = mApp.getHistoryManager();
 
-    while (hdrIn)
+    size_t next = 0;
+    while (true)
     {
-        try
+        // Surface read failures where the sequential read would have hit them
+        if (next == headers.mEntries.size())
         {
-            if (!hdrIn.readOne(curr))
+            if (headers.mReadError)
             {
-                break;
+                std::rethrow_exception(headers.mReadError);
             }
+            if (headers.mBadMessageSize)
+            {
+                return HistoryManager::VERIFY_STATUS_ERR_BAD_LEDGER_VERSION;
+            }
+            break;
         }
-        catch (xdr::xdr_bad_message_size&)
-        {
-            return HistoryManager::VERIFY_STATUS_ERR_BAD_LEDGER_VERSION;
-        }
+        curr = headers.mEntries[next];
+        Hash const& currHash = headers.mHashes[next];
+        ++next;
 
         if (curr.header.ledgerVersion >
             mApp.getConfig().LEDGER_PROTOCOL_VERSION)
@@ -217,7 +320,7 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
         // or if the archive is in a bad state (in which case, retry)
         if (curr.header.ledgerSeq == mLastClosed.first)
         {
-            if (sha256(xdr::xdr_to_opaque(curr.header)) != *mLastClosed.second)
+            if (currHash != *mLastClosed.second)
             {
                 CLOG_ERROR(History,
                            "Bad ledger-header history entry: claimed ledger {} "
@@ -232,7 +335,8 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
         // Verify LCL that is just before the first ledger in range
         else if (curr.header.ledgerSeq == mLastClosed.first + 1)
         {
-            auto lclResult = verifyLedgerHistoryLink(*mLastClosed.second, curr);
+            auto lclResult =
+                verifyLedgerHistoryLink(*mLastClosed.second, curr, currHash);
             if (lclResult != HistoryManager::VERIFY_STATUS_OK)
             {
                 CLOG_ERROR(History,
@@ -273,7 +377,7 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
             // At the beginning of checkpoint, we can't verify the link with
             // previous ledger, so at least verify that header content hashes to
             // correct value
-            auto hashResult = verifyLedgerHistoryEntry(curr);
+            auto hashResult = verifyLedgerHistoryEntry(curr, currHash);
             if (hashResult != HistoryManager::VERIFY_STATUS_OK)
             {
                 return hashResult;
@@ -304,7 +408,8 @@ VerifyLedgerChainWork::verifyHistoryOfSingleCheckpoint()
                            expectedSeq, curr.header.ledgerSeq);
                 return HistoryManager::VERIFY_STATUS_ERR_OVERSHOT;
             }
-            auto linkResult = verifyLedgerHistoryLink(prev.hash, curr);
+            auto linkResult =
+                verifyLedgerHistoryLink(prev.hash, curr, currHash);
             if (linkResult != HistoryManager::VERIFY_STATUS_OK)
             {
                 return linkResult;
@@ -471,17 +576,33 @@ VerifyLedgerChainWork::onRun()
             "Verification undershot first ledger in the range.");
     }
 
+    auto it = mLoadedCheckpoints.find(mCurrCheckpoint);
+    if (it == mLoadedCheckpoints.end())
+    {
+        loadCheckpoints();
+        return BasicWork::State::WORK_WAITING;
+    }
+    auto headers = it->second;
+    mLoadedCheckpoints.erase(it);
+    loadCheckpoints();
+
     HistoryManager::LedgerVerificationStatus result;
 
+    // A rejected file may have come from the local history cache, don't let
+    // it fail the next attempt too
+    FileTransferInfo ft(mDownloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
+                        mCurrCheckpoint);
+
     // Catch FS-related errors to gracefully fail Work instead of crashing
     try
     {
-        result = verifyHistoryOfSingleCheckpoint();
+        result = verifyHistoryOfSingleCheckpoint(*headers);
     }
     catch (FileSystemException&)
     {
         CLOG_ERROR(History, "Catchup material failed verification");
         CLOG_ERROR(History, "{}", POSSIBLY_CORRUPTED_LOCAL_FS);
+        HistoryCache::evict(mApp, ft);
         mApp.getCatchupManager().ledgerChainsVerificationFailed();
         return BasicWork::State::WORK_FAILURE;
     }
@@ -500,6 +621,12 @@ VerifyLedgerChainWork::onRun()
         }
     }
 
+    if (result != HistoryManager::VERIFY_STATUS_OK &&
+        result != HistoryManager::VERIFY_STATUS_ERR_BAD_LEDGER_VERSION)
+    {
+        HistoryCache::evict(mApp, ft);
+    }
+
     switch (result)
     {
     case HistoryManager::VERIFY_STATUS_OK:
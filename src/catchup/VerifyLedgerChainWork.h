@@ -7,8 +7,10 @@
 #include "history/HistoryManager.h"
 #include "ledger/LedgerRange.h"
 #include "work/Work.h"
+#include <exception>
 #include <future>
 #include <iosfwd>
+#include <map>
 #include <vector>
 
 namespace stellar
@@ -20,8 +22,29 @@ struct LedgerHeaderHistoryEntry;
 // This class verifies ledger chain of a given range by checking the hashes.
 // Note that verification is done starting with the latest checkpoint in the
 // range, and working its way backwards to the beginning of the range.
+//
+// Reading and hashing the headers of a checkpoint doesn't depend on any other
+// checkpoint, so several checkpoints ahead of the one being verified are
+// loaded and hashed on worker threads. Only the checks of the hashes against
+// each other, the local state and the trusted hash run on the main thread,
+// one checkpoint at a time and in the same order as before.
 class VerifyLedgerChainWork : public BasicWork
 {
+    // Headers of a checkpoint file read on a worker thread, along with the
+    // hash of each of them
+    struct CheckpointHeaders
+    {
+        std::vector<LedgerHeaderHistoryEntry> mEntries;
+        std::vector<Hash> mHashes;
+        // Reading stopped after mEntries because of an oversized entry
+        bool mBadMessageSize{false};
+        // Reading stopped after mEntries because of this exception
+        std::exception_ptr mReadError;
+    };
+
+    static std::shared_ptr<CheckpointHeaders>
+    loadCheckpointHeaders(std::string const& path, uint32_t lastLedger);
+
     TmpDir const& mDownloadDir;
     LedgerRange const mRange;
     uint32_t mCurrCheckpoint;
@@ -76,7 +99,17 @@ class VerifyLedgerChainWork : public BasicWork
     std::vector<LedgerNumHashPair> mVerifiedLedgers;
     std::shared_ptr<std::ofstream> mOutputStream;
 
-    HistoryManager::LedgerVerificationStatus verifyHistoryOfSingleCheckpoint();
+    // Checkpoints loaded on worker threads and not yet verified, the next one
+    // to start loading, and the number of loads in progress.
+    std::map<uint32_t, std::shared_ptr<CheckpointHeaders>> mLoadedCheckpoints;
+    uint32_t mNextCheckpointToLoad;
+    size_t mLoadsInFlight{0};
+    // Bumped on every reset, so that stale loads are ignored
+    uint64_t mGeneration{0};
+
+    void loadCheckpoints();
+    HistoryManager::LedgerVerificationStatus
+    verifyHistoryOfSingleCheckpoint(CheckpointHeaders const& headers);
 
   public:
     VerifyLedgerChainWork(
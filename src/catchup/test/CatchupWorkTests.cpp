@@ -6,6 +6,7 @@
 #include "catchup/CatchupConfiguration.h"
 #include "catchup/CatchupRange.h"
 #include "catchup/CatchupWork.h"
+#include "catchup/ParallelCatchupWork.h"
 #include "ledger/CheckpointRange.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
@@ -235,4 +236,89 @@ TEST_CASE("CatchupRange starting on checkpoint boundary still replays it",
     REQUIRE(crange2.getBucketApplyLedger() == 63);
     REQUIRE(crange2.getReplayFirst() == 64);
     REQUIRE(crange2.getReplayCount() == 3);
-}
\ No newline at end of file
+}
+TEST_CASE("split catchup range into parallel segments", "[catchup]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+    auto& historyManager = app->getHistoryManager();
+    auto mode = CatchupConfiguration::Mode::OFFLINE_BASIC;
+    uint32_t lcl = LedgerManager::GENESIS_LEDGER_SEQ;
+
+    auto checkSegments = [&](CatchupConfiguration const& configuration,
+                             uint32_t segments) {
+        auto configs = ParallelCatchupWork::splitRange(
+            lcl, configuration, segments, historyManager);
+        REQUIRE(!configs.empty());
+        REQUIRE(configs.size() <= segments);
+        REQUIRE(configs.back().toLedger() == configuration.toLedger());
+        REQUIRE(configs.back().hash() == configuration.hash());
+
+        CatchupRange whole{lcl, configuration, historyManager};
+        std::optional<uint32_t> previousEnd;
+        for (auto const& config : configs)
+        {
+            REQUIRE(config.mode() == mode);
+            CatchupRange range{lcl, config, historyManager};
+            REQUIRE(range.replayLedgers());
+            if (!previousEnd)
+            {
+                // The first segment starts like the whole range
+                REQUIRE(range.applyBuckets() == whole.applyBuckets());
+                REQUIRE(range.getReplayFirst() == whole.getReplayFirst());
+            }
+            else
+            {
+                // Others start from the buckets at the end of the previous
+                // one
+                REQUIRE(range.applyBuckets());
+                REQUIRE(range.getBucketApplyLedger() == *previousEnd);
+            }
+            if (&config != &configs.back())
+            {
+                REQUIRE(historyManager.isLastLedgerInCheckpoint(range.last()));
+            }
+            previousEnd = range.last();
+        }
+        return configs;
+    };
+
+    SECTION("full replay")
+    {
+        CatchupConfiguration configuration{1000, maxCount, mode};
+        REQUIRE(checkSegments(configuration, 4).size() == 4);
+        REQUIRE(checkSegments(configuration, 1).size() == 1);
+    }
+
+    SECTION("replay from buckets with trusted hash")
+    {
+        Hash hash;
+        hash[0] = 1;
+        CatchupConfiguration configuration{
+            LedgerNumHashPair(2000, std::make_optional(hash)), 1000, mode};
+        REQUIRE(checkSegments(configuration, 3).size() == 3);
+    }
+
+    SECTION("more segments than checkpoints")
+    {
+        CatchupConfiguration configuration{200, maxCount, mode};
+        auto configs = checkSegments(configuration, 50);
+        REQUIRE(configs.size() == 4);
+    }
+
+    SECTION("ranges that can't be split")
+    {
+        auto unchanged = [&](uint32_t lastClosed,
+                             CatchupConfiguration const& configuration) {
+            auto configs = ParallelCatchupWork::splitRange(
+                lastClosed, configuration, 4, historyManager);
+            REQUIRE(configs.size() == 1);
+            REQUIRE(configs[0].toLedger() == configuration.toLedger());
+            REQUIRE(configs[0].count() == configuration.count());
+        };
+        unchanged(lcl, {50, maxCount, mode});
+        unchanged(lcl, {127, 0, mode});
+        unchanged(lcl, {CatchupConfiguration::CURRENT, maxCount, mode});
+        unchanged(1000, {2000, maxCount, mode});
+    }
+}
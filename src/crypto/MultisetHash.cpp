@@ -0,0 +1,73 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/MultisetHash.h"
+#include "crypto/Hex.h"
+
+namespace stellar
+{
+
+namespace
+{
+std::array<uint64_t, 4>
+toLimbs(uint256 const& h)
+{
+    // Read the digest as a big-endian 256-bit integer
+    std::array<uint64_t, 4> limbs{};
+    for (size_t i = 0; i < limbs.size(); ++i)
+    {
+        uint64_t limb = 0;
+        for (size_t j = 0; j < 8; ++j)
+        {
+            limb = (limb << 8) | h[(limbs.size() - 1 - i) * 8 + j];
+        }
+        limbs[i] = limb;
+    }
+    return limbs;
+}
+}
+
+void
+MultisetHash::add(uint256 const& elementHash)
+{
+    auto limbs = toLimbs(elementHash);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < mSum.size(); ++i)
+    {
+        uint64_t sum = mSum[i] + limbs[i];
+        uint64_t c1 = sum < mSum[i];
+        mSum[i] = sum + carry;
+        carry = c1 | (mSum[i] < sum);
+    }
+}
+
+void
+MultisetHash::remove(uint256 const& elementHash)
+{
+    auto limbs = toLimbs(elementHash);
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < mSum.size(); ++i)
+    {
+        uint64_t diff = mSum[i] - limbs[i];
+        uint64_t b1 = mSum[i] < limbs[i];
+        mSum[i] = diff - borrow;
+        borrow = b1 | (diff < borrow);
+    }
+}
+
+std::string
+MultisetHash::toHex() const
+{
+    uint256 bytes;
+    for (size_t i = 0; i < mSum.size(); ++i)
+    {
+        for (size_t j = 0; j < 8; ++j)
+        {
+            bytes[(mSum.size() - 1 - i) * 8 + j] =
+                static_cast<uint8_t>(mSum[i] >> (56 - 8 * j));
+        }
+    }
+    return binToHex(bytes);
+}
+}
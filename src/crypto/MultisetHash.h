@@ -0,0 +1,60 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace stellar
+{
+
+// Hash of a multiset, computed as the sum modulo 2^256 of the SHA256 of each
+// element (MSet-Add-Hash). It doesn't depend on the order elements are added
+// in and elements can be removed, so a hash maintained incrementally as a set
+// changes can be compared with one computed from scratch over the same set.
+//
+// This detects accidental inconsistencies between two copies of a set, it is
+// not meant to resist adversarially chosen elements.
+class MultisetHash
+{
+    // Little-endian 64-bit limbs
+    std::array<uint64_t, 4> mSum{};
+
+  public:
+    void add(uint256 const& elementHash);
+    void remove(uint256 const& elementHash);
+
+    template <typename T>
+    void
+    addXDR(T const& t)
+    {
+        add(xdrSha256(t));
+    }
+
+    template <typename T>
+    void
+    removeXDR(T const& t)
+    {
+        remove(xdrSha256(t));
+    }
+
+    bool
+    operator==(MultisetHash const& other) const
+    {
+        return mSum == other.mSum;
+    }
+
+    bool
+    operator!=(MultisetHash const& other) const
+    {
+        return !(*this == other);
+    }
+
+    std::string toHex() const;
+};
+}
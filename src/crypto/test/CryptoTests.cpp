@@ -5,6 +5,7 @@
 #include "crypto/BLAKE2.h"
 #include "crypto/Hex.h"
 #include "crypto/KeyUtils.h"
+#include "crypto/MultisetHash.h"
 #include "crypto/Random.h"
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
@@ -242,6 +243,58 @@ TEST_CASE("BLAKE2 XDR bench", "[!hide][blake-xdr-bench]")
     }
 }
 
+TEST_CASE("MultisetHash tests", "[crypto]")
+{
+    auto entries = LedgerTestUtils::generateValidLedgerEntries(100);
+
+    MultisetHash forward;
+    for (auto const& e : entries)
+    {
+        forward.addXDR(e);
+    }
+    MultisetHash backward;
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        backward.addXDR(*it);
+    }
+    REQUIRE(forward == backward);
+    REQUIRE(forward != MultisetHash{});
+
+    SECTION("remove")
+    {
+        MultisetHash partial;
+        for (size_t i = 1; i < entries.size(); ++i)
+        {
+            partial.addXDR(entries[i]);
+        }
+        forward.removeXDR(entries.front());
+        REQUIRE(forward == partial);
+
+        for (auto const& e : entries)
+        {
+            backward.removeXDR(e);
+        }
+        REQUIRE(backward == MultisetHash{});
+    }
+
+    SECTION("carries")
+    {
+        // All ones plus one wraps around to zero
+        uint256 ones;
+        ones.fill(0xff);
+        uint256 one{};
+        one.back() = 1;
+
+        MultisetHash h;
+        h.add(ones);
+        REQUIRE(h.toHex() == binToHex(ones));
+        h.add(one);
+        REQUIRE(h == MultisetHash{});
+        h.remove(one);
+        REQUIRE(h.toHex() == binToHex(ones));
+    }
+}
+
 TEST_CASE("HMAC test vector", "[crypto]")
 {
     HmacSha256Key k;
@@ -6,6 +6,7 @@
 #include "crypto/Hex.h"
 #include "database/DatabaseConnectionString.h"
 #include "database/DatabaseTypeSpecificOperation.h"
+#include "database/WalCheckpointer.h"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "overlay/StellarXDR.h"
@@ -130,9 +131,15 @@ Database::registerDrivers()
 class DatabaseConfigureSessionOp : public DatabaseTypeSpecificOperation<void>
 {
     soci::session& mSession;
+    Config const& mConfig;
+    bool const mBackgroundCheckpoint;
 
   public:
-    DatabaseConfigureSessionOp(soci::session& sess) : mSession(sess)
+    DatabaseConfigureSessionOp(soci::session& sess, Config const& cfg,
+                               bool backgroundCheckpoint)
+        : mSession(sess)
+        , mConfig(cfg)
+        , mBackgroundCheckpoint(backgroundCheckpoint)
     {
     }
     void
@@ -145,22 +152,40 @@ class DatabaseConfigureSessionOp : public DatabaseTypeSpecificOperation<void>
         }
 
         mSession << "PRAGMA journal_mode = WAL";
-        // FULL is needed as to ensure durability
-        // NORMAL is enough for non validating nodes
-        // mSession << "PRAGMA synchronous = NORMAL";
+        // FULL syncs the WAL on each commit, which is needed for committed
+        // ledgers to survive the OS crashing or losing power. NORMAL only
+        // syncs it on checkpoints, so only use it when XDR files aren't
+        // synced either.
+        if (mConfig.DISABLE_XDR_FSYNC)
+        {
+            mSession << "PRAGMA synchronous = NORMAL";
+        }
+        else
+        {
+            mSession << "PRAGMA synchronous = FULL";
+        }
 
-        // number of pages in WAL file
-        mSession << "PRAGMA wal_autocheckpoint=10000";
+        // number of pages in WAL file. With the WalCheckpointer, commits only
+        // checkpoint as a safety net, should it fall far behind
+        if (mBackgroundCheckpoint)
+        {
+            mSession << "PRAGMA wal_autocheckpoint=250000";
+        }
+        else
+        {
+            mSession << "PRAGMA wal_autocheckpoint=10000";
+        }
 
         // busy_timeout gives room for external processes
         // that may lock the database for some time
         mSession << "PRAGMA busy_timeout = 10000";
 
-        // adjust caches
-        // 20000 pages
-        mSession << "PRAGMA cache_size=-20000";
-        // 100 MB map
-        mSession << "PRAGMA mmap_size=104857600";
+        // adjust caches, a negative cache_size is in KiB
+        mSession << fmt::format(FMT_STRING("PRAGMA cache_size=-{:d}"),
+                                uint64_t(mConfig.SQLITE_CACHE_SIZE_MB) * 1024);
+        mSession << fmt::format(FMT_STRING("PRAGMA mmap_size={:d}"),
+                                uint64_t(mConfig.SQLITE_MMAP_SIZE_MB) * 1024 *
+                                    1024);
 
         // Register the sqlite carray() extension we use for bulk operations.
         sqlite3_carray_init(sq->conn_, nullptr, nullptr);
@@ -196,14 +221,51 @@ Database::Database(Application& app)
     open();
 }
 
+Database::~Database()
+{
+}
+
+bool
+Database::usesBackgroundCheckpoint() const
+{
+    return isSqlite() && canUsePool() &&
+           mApp.getConfig().SQLITE_BACKGROUND_CHECKPOINT;
+}
+
 void
 Database::open()
 {
     mSession.open(mApp.getConfig().DATABASE.value);
-    DatabaseConfigureSessionOp op(mSession);
+    DatabaseConfigureSessionOp op(mSession, mApp.getConfig(),
+                                  usesBackgroundCheckpoint());
     doDatabaseTypeSpecificOperation(op);
+    if (usesBackgroundCheckpoint())
+    {
+        mWalCheckpointer = std::make_unique<WalCheckpointer>(
+            mApp.getMetrics(), mApp.getConfig().DATABASE.value);
+    }
+}
+
+void
+Database::requestWalCheckpoint()
+{
+    if (mWalCheckpointer)
+    {
+        mWalCheckpointer->requestCheckpoint();
+    }
 }
 
+#ifdef BUILD_TESTS
+void
+Database::waitForWalCheckpointsForTesting()
+{
+    if (mWalCheckpointer)
+    {
+        mWalCheckpointer->waitForCheckpointsForTesting();
+    }
+}
+#endif
+
 void
 Database::applySchemaUpgrade(unsigned long vers)
 {
@@ -460,6 +522,7 @@ Database::initialize()
         }
         if (!fn.empty() && fs::exists(fn))
         {
+            mWalCheckpointer.reset();
             mSession.close();
             std::remove(fn.c_str());
             open();
@@ -518,7 +581,8 @@ Database::getPool()
             LOG_DEBUG(DEFAULT_LOG, "Opening pool entry {}", i);
             soci::session& sess = mPool->at(i);
             sess.open(c.value);
-            DatabaseConfigureSessionOp op(sess);
+            DatabaseConfigureSessionOp op(sess, mApp.getConfig(),
+                                          usesBackgroundCheckpoint());
             stellar::doDatabaseTypeSpecificOperation(sess, op);
         }
     }
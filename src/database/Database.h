@@ -26,6 +26,7 @@ namespace stellar
 {
 class Application;
 class SQLLogContext;
+class WalCheckpointer;
 
 /**
  * Helper class for borrowing a SOCI prepared statement handle into a local
@@ -96,19 +97,21 @@ class Database : NonMovableOrCopyable
 
     std::set<std::string> mEntityTypes;
 
+    // Only for on-disk SQLite databases with SQLITE_BACKGROUND_CHECKPOINT
+    std::unique_ptr<WalCheckpointer> mWalCheckpointer;
+
     static bool gDriversRegistered;
     static void registerDrivers();
     void applySchemaUpgrade(unsigned long vers);
     void open();
+    bool usesBackgroundCheckpoint() const;
 
   public:
     // Instantiate object and connect to app.getConfig().DATABASE;
     // if there is a connection error, this will throw.
     Database(Application& app);
 
-    virtual ~Database()
-    {
-    }
+    virtual ~Database();
 
     // Return a logging helper that will capture all SQL statements made
     // on the main connection while active, and will log those statements
@@ -125,6 +128,15 @@ class Database : NonMovableOrCopyable
     // database.
     void clearPreparedStatementCache();
 
+    // Called after committing to the database. With SQLite WAL checkpoints
+    // running in the background, requests one, otherwise does nothing.
+    void requestWalCheckpoint();
+
+#ifdef BUILD_TESTS
+    // Blocks until the WAL checkpoints requested so far have run, if any
+    void waitForWalCheckpointsForTesting();
+#endif
+
     // Return metric-gathering timers for various families of SQL operation.
     // These timers automatically count the time they are alive for,
     // so only acquire them immediately before executing an SQL statement.
@@ -0,0 +1,157 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/WalCheckpointer.h"
+#include "util/Logging.h"
+
+#include <Tracy.hpp>
+#include <fmt/format.h>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+#include <optional>
+#include <soci.h>
+
+namespace stellar
+{
+
+WalCheckpointer::WalCheckpointer(medida::MetricsRegistry& registry,
+                                 std::string const& connectionString)
+    : mConnectionString(connectionString)
+    , mCheckpointTime(registry.NewTimer({"database", "checkpoint", "time"}))
+    , mWalBytes(registry.NewCounter({"database", "checkpoint", "wal-bytes"}))
+    , mPendingBytes(
+          registry.NewCounter({"database", "checkpoint", "pending-bytes"}))
+    , mTruncates(registry.NewMeter({"database", "checkpoint", "truncate"},
+                                   "checkpoint"))
+{
+    mThread = std::thread([this]() { run(); });
+}
+
+WalCheckpointer::~WalCheckpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    mThread.join();
+}
+
+void
+WalCheckpointer::requestCheckpoint()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRequested = true;
+    }
+    mCV.notify_all();
+}
+
+#ifdef BUILD_TESTS
+void
+WalCheckpointer::waitForCheckpointsForTesting()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [&]() { return mStopping || (!mRequested && !mRunning); });
+}
+#endif
+
+void
+WalCheckpointer::run()
+{
+    std::optional<soci::session> session;
+    int64_t pageSize = 0;
+    // Checkpoints in a row that left more than TRUNCATE_PENDING_BYTES behind
+    uint32_t behind = 0;
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCV.wait(lock, [&]() { return mStopping || mRequested; });
+        if (mStopping)
+        {
+            return;
+        }
+        mRequested = false;
+        mRunning = true;
+        lock.unlock();
+
+        try
+        {
+            ZoneScoped;
+            if (!session)
+            {
+                session.emplace(mConnectionString);
+                // Same as the connections of the Database
+                *session << "PRAGMA busy_timeout = 10000";
+                *session << "PRAGMA page_size", soci::into(pageSize);
+            }
+
+            // Number of frames in the WAL, and how many of them are in the
+            // database after the checkpoint
+            int busy = 0;
+            int64_t walFrames = 0;
+            int64_t checkpointedFrames = 0;
+            bool truncate = behind >= TRUNCATE_AFTER_CHECKPOINTS;
+            {
+                auto timer = mCheckpointTime.TimeScope();
+                if (truncate)
+                {
+                    // TRUNCATE holds the write lock while it waits for
+                    // readers, so don't wait as long as for a write
+                    *session << fmt::format(
+                        FMT_STRING("PRAGMA busy_timeout = {:d}"),
+                        TRUNCATE_BUSY_TIMEOUT_MS);
+                    *session << "PRAGMA wal_checkpoint(TRUNCATE)",
+                        soci::into(busy), soci::into(walFrames),
+                        soci::into(checkpointedFrames);
+                    *session << "PRAGMA busy_timeout = 10000";
+                    mTruncates.Mark();
+                }
+                else
+                {
+                    *session << "PRAGMA wal_checkpoint(PASSIVE)",
+                        soci::into(busy), soci::into(walFrames),
+                        soci::into(checkpointedFrames);
+                }
+            }
+            mWalBytes.set_count(walFrames * pageSize);
+            auto pendingBytes = (walFrames - checkpointedFrames) * pageSize;
+            mPendingBytes.set_count(pendingBytes);
+            if (busy == 0 && truncate)
+            {
+                behind = 0;
+            }
+            else if (pendingBytes > TRUNCATE_PENDING_BYTES)
+            {
+                ++behind;
+            }
+            else
+            {
+                behind = 0;
+            }
+            if (busy != 0 && truncate)
+            {
+                CLOG_WARNING(Database,
+                             "WAL checkpoint blocked by readers, {} bytes "
+                             "left to checkpoint",
+                             pendingBytes);
+            }
+        }
+        catch (std::exception const& e)
+        {
+            // The next request retries with a new connection
+            CLOG_WARNING(Database, "Failed to checkpoint the WAL: {}",
+                         e.what());
+            session.reset();
+        }
+
+        lock.lock();
+        mRunning = false;
+        lock.unlock();
+        mCV.notify_all();
+    }
+}
+}
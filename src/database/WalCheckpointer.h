@@ -0,0 +1,81 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace medida
+{
+class MetricsRegistry;
+class Counter;
+class Meter;
+class Timer;
+}
+
+namespace stellar
+{
+
+// WalCheckpointer runs the WAL checkpoints of an SQLite database on a
+// background thread, through a connection of its own, so that the
+// connections writing to the database can disable automatic checkpoints and
+// never run one as part of a commit.
+//
+// The main thread requests a checkpoint after each commit. Requests made
+// while a checkpoint runs are coalesced into a single one that runs next.
+// Checkpoints are PASSIVE: they copy as much of the WAL into the database as
+// no reader still needs, without blocking readers or writers. A long-lived
+// reader (e.g. an OfferSnapshot) can keep them from ever reaching the end of
+// the WAL, which then grows with every commit. Once more than
+// TRUNCATE_PENDING_BYTES are left behind by TRUNCATE_AFTER_CHECKPOINTS
+// checkpoints in a row, the next one is a TRUNCATE checkpoint: it waits a
+// short while for readers to move on, then resets the WAL.
+class WalCheckpointer : NonMovableOrCopyable
+{
+  public:
+    static constexpr int64_t TRUNCATE_PENDING_BYTES = 64 * 1024 * 1024;
+    static constexpr uint32_t TRUNCATE_AFTER_CHECKPOINTS = 3;
+    // How long a TRUNCATE checkpoint waits for readers, and so how long it
+    // can delay a commit waiting on it
+    static constexpr int TRUNCATE_BUSY_TIMEOUT_MS = 1000;
+
+  private:
+    std::string const mConnectionString;
+
+    // Guarded by mMutex
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    bool mRequested{false};
+    bool mRunning{false};
+    bool mStopping{false};
+
+    medida::Timer& mCheckpointTime;
+    medida::Counter& mWalBytes;
+    medida::Counter& mPendingBytes;
+    medida::Meter& mTruncates;
+
+    std::thread mThread;
+
+    void run();
+
+  public:
+    WalCheckpointer(medida::MetricsRegistry& registry,
+                    std::string const& connectionString);
+
+    // Waits for the running checkpoint, if any, but drops pending requests
+    ~WalCheckpointer();
+
+    void requestCheckpoint();
+
+#ifdef BUILD_TESTS
+    // Blocks until every checkpoint requested so far has run
+    void waitForCheckpointsForTesting();
+#endif
+};
+}
@@ -20,6 +20,9 @@
 #include "util/Timer.h"
 #include "util/TmpDir.h"
 #include <algorithm>
+#include <medida/counter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 #include <optional>
 #include <random>
 
@@ -199,6 +202,40 @@ checkMVCCIsolation(Application::pointer app)
     sess1 << "DROP TABLE test";
 }
 
+TEST_CASE("sqlite background WAL checkpoints", "[db]")
+{
+    Config cfg = getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE);
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& db = app->getDatabase();
+    auto& session = db.getSession();
+
+    int autoCheckpoint = -1;
+    session << "PRAGMA wal_autocheckpoint", soci::into(autoCheckpoint);
+    REQUIRE(autoCheckpoint == 250000);
+
+    session << "create table checkpointtest (a bigint primary key);";
+    {
+        soci::transaction sqltx(session);
+        for (int64_t i = 0; i < 1000; ++i)
+        {
+            session << "insert into checkpointtest (a) values (:a)",
+                soci::use(i);
+        }
+        sqltx.commit();
+    }
+
+    auto& checkpoints =
+        app->getMetrics().NewTimer({"database", "checkpoint", "time"});
+    auto& walBytes =
+        app->getMetrics().NewCounter({"database", "checkpoint", "wal-bytes"});
+    auto before = checkpoints.count();
+    db.requestWalCheckpoint();
+    db.waitForWalCheckpointsForTesting();
+    REQUIRE(checkpoints.count() == before + 1);
+    REQUIRE(walBytes.count() > 0);
+}
+
 TEST_CASE("sqlite MVCC test", "[db]")
 {
     Config const& cfg = getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE);
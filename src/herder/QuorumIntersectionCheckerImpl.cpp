@@ -8,6 +8,8 @@
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/Math.h"
+#include <limits>
+#include <thread>
 
 namespace
 {
@@ -112,12 +114,15 @@ MinQuorumEnumerator::maxCommit() const
 
 MinQuorumEnumerator::MinQuorumEnumerator(
     BitSet const& committed, BitSet const& remaining, BitSet const& scanSCC,
-    QuorumIntersectionCheckerImpl const& qic)
+    QuorumIntersectionCheckerImpl const& qic, ParallelMinQuorumSearch* search,
+    size_t thread)
     : mCommitted(committed)
     , mRemaining(remaining)
     , mPerimeter(committed | remaining)
     , mScanSCC(scanSCC)
     , mQic(qic)
+    , mSearch(search)
+    , mThread(thread)
 {
 }
 
@@ -129,6 +134,13 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
         throw QuorumIntersectionChecker::InterruptedException();
     }
 
+    // In a parallel search, some other thread may have already found a
+    // disjoint pair that a serial search would have reached before this one.
+    if (mSearch && mSearch->shouldAbandon(mSearch->currentPath(mThread)))
+    {
+        return false;
+    }
+
     mQic.mStats.mCallsStarted++;
 
     // Emit a progress meter every million calls.
@@ -237,16 +249,27 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
     }
 
     // Phase two: recurse into subproblems.
-    size_t split = pickSplitNode(mQic.mRand);
+    stellar_default_random_engine randEngine(
+        mQic.splitNodeSeed(mCommitted, mRemaining));
+    size_t split = pickSplitNode(randEngine);
     if (mQic.mLogTrace)
     {
         CLOG_TRACE(SCP, "recursing into subproblems, split={}", split);
     }
     mRemaining.unset(split);
     MinQuorumEnumerator childExcludingSplit(mCommitted, mRemaining, mScanSCC,
-                                            mQic);
+                                            mQic, mSearch, mThread);
     mQic.mStats.mFirstRecursionsTaken++;
-    if (childExcludingSplit.anyMinQuorumHasDisjointQuorum())
+    if (mSearch)
+    {
+        mSearch->currentPath(mThread).push_back(0);
+    }
+    bool firstFound = childExcludingSplit.anyMinQuorumHasDisjointQuorum();
+    if (mSearch)
+    {
+        mSearch->currentPath(mThread).pop_back();
+    }
+    if (firstFound)
     {
         if (mQic.mLogTrace)
         {
@@ -256,10 +279,245 @@ MinQuorumEnumerator::anyMinQuorumHasDisjointQuorum()
         return true;
     }
     mCommitted.set(split);
+    if (mSearch)
+    {
+        auto& path = mSearch->currentPath(mThread);
+        path.push_back(1);
+        bool shared = mSearch->maybeShareSubproblem(mThread, mCommitted,
+                                                    mRemaining, path);
+        if (shared)
+        {
+            // Another thread will pick it up; anything it finds is
+            // reported directly to the search.
+            path.pop_back();
+            return false;
+        }
+    }
     MinQuorumEnumerator childIncludingSplit(mCommitted, mRemaining, mScanSCC,
-                                            mQic);
+                                            mQic, mSearch, mThread);
     mQic.mStats.mSecondRecursionsTaken++;
-    return childIncludingSplit.anyMinQuorumHasDisjointQuorum();
+    bool secondFound = childIncludingSplit.anyMinQuorumHasDisjointQuorum();
+    if (mSearch)
+    {
+        mSearch->currentPath(mThread).pop_back();
+    }
+    return secondFound;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation of ParallelMinQuorumSearch
+////////////////////////////////////////////////////////////////////////////////
+
+ParallelMinQuorumSearch::ParallelMinQuorumSearch(
+    QuorumIntersectionCheckerImpl const& qic, BitSet const& scanSCC,
+    size_t numThreads)
+    : mQic(qic), mScanSCC(scanSCC)
+{
+    releaseAssert(numThreads > 0);
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        auto thread = std::make_unique<Thread>();
+        thread->mQic.reset(new QuorumIntersectionCheckerImpl(qic));
+        mThreads.emplace_back(std::move(thread));
+    }
+}
+
+ParallelMinQuorumSearch::Path&
+ParallelMinQuorumSearch::currentPath(size_t thread)
+{
+    return mThreads.at(thread)->mPath;
+}
+
+bool
+ParallelMinQuorumSearch::shouldAbandon(Path const& path) const
+{
+    if (mAbort.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+    if (!mFound.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(mBestMutex);
+    return mBestPath < path;
+}
+
+bool
+ParallelMinQuorumSearch::maybeShareSubproblem(size_t thread,
+                                              BitSet const& committed,
+                                              BitSet const& remaining,
+                                              Path const& path)
+{
+    if (mIdleThreads.load(std::memory_order_relaxed) == 0 ||
+        remaining.count() < MIN_SHARED_REMAINING)
+    {
+        return false;
+    }
+    ++mOutstandingTasks;
+    auto& t = *mThreads.at(thread);
+    {
+        std::lock_guard<std::mutex> guard(t.mTasksMutex);
+        t.mTasks.emplace_back(Task{committed, remaining, path});
+    }
+    ++mQueuedTasks;
+    notifyWork(false);
+    return true;
+}
+
+void
+ParallelMinQuorumSearch::notifyWork(bool all)
+{
+    // Taking the mutex orders the update made by the caller with the waiter
+    // checking its predicate, so the wakeup can't be lost.
+    {
+        std::lock_guard<std::mutex> guard(mWorkMutex);
+    }
+    if (all)
+    {
+        mWorkCV.notify_all();
+    }
+    else
+    {
+        mWorkCV.notify_one();
+    }
+}
+
+void
+ParallelMinQuorumSearch::noteFoundDisjointQuorums(BitSet const& nodes,
+                                                  BitSet const& disj,
+                                                  Path const& path)
+{
+    std::lock_guard<std::mutex> guard(mBestMutex);
+    if (!mFound.load(std::memory_order_relaxed) || path < mBestPath)
+    {
+        mBestPath = path;
+        mBestQuorum = nodes;
+        mBestDisjoint = disj;
+        mFound.store(true, std::memory_order_release);
+    }
+}
+
+bool
+ParallelMinQuorumSearch::popTask(size_t thread, Task& task)
+{
+    // Own tasks come off the back, depth-first; stolen ones off the front.
+    for (size_t i = 0; i < mThreads.size(); ++i)
+    {
+        auto& t = *mThreads.at((thread + i) % mThreads.size());
+        std::lock_guard<std::mutex> guard(t.mTasksMutex);
+        if (t.mTasks.empty())
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            task = std::move(t.mTasks.back());
+            t.mTasks.pop_back();
+        }
+        else
+        {
+            task = std::move(t.mTasks.front());
+            t.mTasks.pop_front();
+        }
+        --mQueuedTasks;
+        return true;
+    }
+    return false;
+}
+
+void
+ParallelMinQuorumSearch::runThread(size_t thread)
+{
+    auto& t = *mThreads.at(thread);
+    try
+    {
+        bool idle = false;
+        Task task;
+        while (!mAbort)
+        {
+            if (popTask(thread, task))
+            {
+                if (idle)
+                {
+                    idle = false;
+                    --mIdleThreads;
+                }
+                if (!shouldAbandon(task.mPath))
+                {
+                    t.mPath = task.mPath;
+                    MinQuorumEnumerator mqe(task.mCommitted, task.mRemaining,
+                                            mScanSCC, *t.mQic, this, thread);
+                    mqe.anyMinQuorumHasDisjointQuorum();
+                }
+                if (--mOutstandingTasks == 0)
+                {
+                    notifyWork(true);
+                }
+                continue;
+            }
+            if (mOutstandingTasks == 0)
+            {
+                break;
+            }
+            if (!idle)
+            {
+                idle = true;
+                ++mIdleThreads;
+            }
+            std::unique_lock<std::mutex> lock(mWorkMutex);
+            mWorkCV.wait(lock, [&]() {
+                return mAbort || mQueuedTasks > 0 || mOutstandingTasks == 0;
+            });
+        }
+        if (idle)
+        {
+            --mIdleThreads;
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(mErrorMutex);
+        if (!mError)
+        {
+            mError = std::current_exception();
+        }
+        mAbort = true;
+        notifyWork(true);
+    }
+}
+
+bool
+ParallelMinQuorumSearch::anyMinQuorumHasDisjointQuorum()
+{
+    mOutstandingTasks = 1;
+    mThreads.at(0)->mTasks.emplace_back(Task{BitSet(), mScanSCC, Path{}});
+
+    // The calling thread does its share of the work as thread 0.
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < mThreads.size(); ++i)
+    {
+        threads.emplace_back([this, i]() { runThread(i); });
+    }
+    runThread(0);
+    for (auto& th : threads)
+    {
+        th.join();
+    }
+
+    for (auto const& t : mThreads)
+    {
+        mQic.mStats.add(t->mQic->mStats);
+    }
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+    if (mFound)
+    {
+        mQic.noteFoundDisjointQuorums(mBestQuorum, mBestDisjoint);
+    }
+    return mFound;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -276,7 +534,9 @@ QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
     , mTSC()
     , mInterruptFlag(interruptFlag)
     , mCachedQuorums(MAX_CACHED_QUORUMS_SIZE)
-    , mRand(seed)
+    , mSeed(seed)
+    , mNumThreads(cfg ? cfg->QUORUM_INTERSECTION_CHECKER_THREADS
+                      : std::max(1u, std::thread::hardware_concurrency()))
 {
     buildGraph(qmap);
     // Awkwardly, the graph size is zero when we initialize mTSC. Update it
@@ -284,6 +544,49 @@ QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
     buildSCCs();
 }
 
+QuorumIntersectionCheckerImpl::QuorumIntersectionCheckerImpl(
+    QuorumIntersectionCheckerImpl const& parent)
+    : mCfg(parent.mCfg)
+    , mLogTrace(parent.mLogTrace)
+    , mQuiet(true)
+    , mBitNumPubKeys(parent.mBitNumPubKeys)
+    , mPubKeyBitNums(parent.mPubKeyBitNums)
+    , mGraph(parent.mGraph)
+    , mTSC()
+    , mInterruptFlag(parent.mInterruptFlag)
+    // The default cache evicts using gRandomEngine, which is not safe to share
+    // between the threads of a parallel search.
+    , mCachedQuorums(MAX_CACHED_QUORUMS_SIZE, /*separatePRNG=*/true)
+    , mSeed(parent.mSeed)
+    , mNumThreads(1)
+{
+    mCachedQuorums.maybeSeed(static_cast<unsigned int>(mSeed));
+    mStats.mTotalNodes = parent.mStats.mTotalNodes;
+}
+
+stellar_default_random_engine::result_type
+QuorumIntersectionCheckerImpl::splitNodeSeed(BitSet const& committed,
+                                             BitSet const& remaining) const
+{
+    // Hash set bits rather than words so that equal sets hash equally
+    // regardless of how much capacity each BitSet happens to carry.
+    size_t h = std::hash<size_t>{}(mSeed);
+    auto mix = [&h](size_t v) {
+        h ^= std::hash<size_t>{}(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    };
+    for (size_t i = 0; committed.nextSet(i); ++i)
+    {
+        mix(i);
+    }
+    // Separator, so that moving a node between the sets changes the seed.
+    mix(std::numeric_limits<size_t>::max());
+    for (size_t i = 0; remaining.nextSet(i); ++i)
+    {
+        mix(i);
+    }
+    return static_cast<stellar_default_random_engine::result_type>(h);
+}
+
 std::pair<std::vector<NodeID>, std::vector<NodeID>>
 QuorumIntersectionCheckerImpl::getPotentialSplit() const
 {
@@ -312,6 +615,22 @@ QuorumIntersectionCheckerImpl::Stats::log() const
                mEarlyExit21s, mEarlyExit22s, mEarlyExit31s, mEarlyExit32s);
 }
 
+void
+QuorumIntersectionCheckerImpl::Stats::add(Stats const& other)
+{
+    mCallsStarted += other.mCallsStarted;
+    mFirstRecursionsTaken += other.mFirstRecursionsTaken;
+    mSecondRecursionsTaken += other.mSecondRecursionsTaken;
+    mMaxQuorumsSeen += other.mMaxQuorumsSeen;
+    mMinQuorumsSeen += other.mMinQuorumsSeen;
+    mTerminations += other.mTerminations;
+    mEarlyExit1s += other.mEarlyExit1s;
+    mEarlyExit21s += other.mEarlyExit21s;
+    mEarlyExit22s += other.mEarlyExit22s;
+    mEarlyExit31s += other.mEarlyExit31s;
+    mEarlyExit32s += other.mEarlyExit32s;
+}
+
 // This function is the innermost call in the checker and must be as fast
 // as possible. We spend almost all of our time in here.
 bool
@@ -518,7 +837,15 @@ MinQuorumEnumerator::hasDisjointQuorum(BitSet const& nodes) const
     BitSet disj = mQic.contractToMaximalQuorum(mScanSCC - nodes);
     if (!disj.empty())
     {
-        mQic.noteFoundDisjointQuorums(nodes, disj);
+        if (mSearch)
+        {
+            mSearch->noteFoundDisjointQuorums(nodes, disj,
+                                              mSearch->currentPath(mThread));
+        }
+        else
+        {
+            mQic.noteFoundDisjointQuorums(nodes, disj);
+        }
     }
     else
     {
@@ -724,10 +1051,18 @@ QuorumIntersectionCheckerImpl::networkEnjoysQuorumIntersection() const
     // Second stage: scan the scan-SCC powerset, potentially expensive.
     if (!foundDisjoint)
     {
-        BitSet committed;
-        BitSet remaining = scanSCC;
-        MinQuorumEnumerator mqe(committed, remaining, scanSCC, *this);
-        foundDisjoint = mqe.anyMinQuorumHasDisjointQuorum();
+        if (mNumThreads > 1)
+        {
+            ParallelMinQuorumSearch search(*this, scanSCC, mNumThreads);
+            foundDisjoint = search.anyMinQuorumHasDisjointQuorum();
+        }
+        else
+        {
+            BitSet committed;
+            BitSet remaining = scanSCC;
+            MinQuorumEnumerator mqe(committed, remaining, scanSCC, *this);
+            foundDisjoint = mqe.anyMinQuorumHasDisjointQuorum();
+        }
         mStats.log();
     }
     return !foundDisjoint;
@@ -349,6 +349,33 @@
 //
 // Remaining details of the implementation are noted as we go, but the above
 // explanation ought to give you a good idea what you're looking at.
+//
+//
+// Addendum: parallel search
+// =========================
+//
+// The enumeration in refinement 3 is a binary tree of independent subproblems,
+// so once the tree's shape is fixed it can be explored by several threads at
+// once. Two things make the parallel search return exactly what a serial one
+// would:
+//
+//     1. The "random" choice between equally-good split nodes in refinement 7
+//        is seeded from the checker's seed and the (committed, remaining) pair
+//        of the enumerator making it, so the tree is a pure function of the
+//        network and the seed, no matter which thread expands which node.
+//
+//     2. Every enumerator knows its path from the root (0 for "exclude split
+//        node", 1 for "include split node"). Comparing paths lexicographically
+//        is the order a serial depth-first search visits them, so when several
+//        threads find disjoint quorums we keep the one with the smallest path,
+//        and only stop exploring subtrees that come _after_ it.
+//
+// Threads share subproblems work-stealing style: each thread has a deque of
+// pending subtrees; it pushes and pops its own at the back (staying
+// depth-first) and, when idle, steals from the front of others' (taking the
+// oldest and typically largest subtrees). A busy thread only pushes the
+// "include split node" branch as a task, rather than recursing into it, while
+// some other thread is idle.
 
 #include "QuorumIntersectionChecker.h"
 #include "main/Config.h"
@@ -357,7 +384,11 @@
 #include "util/TarjanSCCCalculator.h"
 #include "xdr/Stellar-SCP.h"
 #include "xdr/Stellar-types.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <mutex>
 #include <optional>
 
 namespace
@@ -366,6 +397,7 @@ namespace
 struct QBitSet;
 using QGraph = std::vector<QBitSet>;
 class QuorumIntersectionCheckerImpl;
+class ParallelMinQuorumSearch;
 
 // A QBitSet is the "fast" representation of a SCPQuorumSet. It includes both a
 // BitSet of its own nodes and a set of innerSets, along with a "successors"
@@ -426,6 +458,11 @@ class MinQuorumEnumerator
     // Checker that owns us, contains state of stats, graph, etc.
     QuorumIntersectionCheckerImpl const& mQic;
 
+    // Thread of the parallel search we're running on, or nullptr when running
+    // a plain serial search.
+    ParallelMinQuorumSearch* const mSearch;
+    size_t const mThread;
+
     // Select the next node in mRemaining to split recursive cases between.
     size_t
     pickSplitNode(stellar::stellar_default_random_engine& randEngine) const;
@@ -436,12 +473,101 @@ class MinQuorumEnumerator
   public:
     MinQuorumEnumerator(BitSet const& committed, BitSet const& remaining,
                         BitSet const& scanSCC,
-                        QuorumIntersectionCheckerImpl const& qic);
+                        QuorumIntersectionCheckerImpl const& qic,
+                        ParallelMinQuorumSearch* search = nullptr,
+                        size_t thread = 0);
 
     bool hasDisjointQuorum(BitSet const& nodes) const;
     bool anyMinQuorumHasDisjointQuorum();
 };
 
+// A ParallelMinQuorumSearch runs a root MinQuorumEnumerator across a pool of
+// threads, as described in the addendum above. Each thread gets its own copy
+// of the checker, so the caches, stats and scratch space of the serial code
+// stay single-threaded; only the task deques and the best result found so far
+// are shared.
+class ParallelMinQuorumSearch
+{
+  public:
+    // Branches taken from the root to reach an enumerator: 0 for the child
+    // excluding the split node, 1 for the child including it.
+    using Path = std::vector<uint8_t>;
+
+  private:
+    struct Task
+    {
+        BitSet mCommitted;
+        BitSet mRemaining;
+        Path mPath;
+    };
+
+    struct Thread
+    {
+        std::unique_ptr<QuorumIntersectionCheckerImpl> mQic;
+        Path mPath;
+        std::mutex mTasksMutex;
+        std::deque<Task> mTasks;
+    };
+
+    // Don't bother handing off subproblems with fewer remaining nodes than
+    // this: they finish faster than another thread can pick them up.
+    static constexpr size_t MIN_SHARED_REMAINING = 6;
+
+    QuorumIntersectionCheckerImpl const& mQic;
+    BitSet const& mScanSCC;
+    std::vector<std::unique_ptr<Thread>> mThreads;
+
+    // Tasks pushed but not yet finished, tasks pushed but not yet popped,
+    // and threads looking for work.
+    std::atomic<size_t> mOutstandingTasks{0};
+    std::atomic<size_t> mQueuedTasks{0};
+    std::atomic<size_t> mIdleThreads{0};
+
+    // Idle threads sleep on mWorkCV until a task is queued, the last
+    // outstanding task finishes or the search aborts.
+    std::mutex mWorkMutex;
+    std::condition_variable mWorkCV;
+
+    // Set when any thread throws; the others unwind as soon as they notice.
+    std::atomic<bool> mAbort{false};
+    std::mutex mErrorMutex;
+    std::exception_ptr mError;
+
+    // Earliest (in serial search order) disjoint pair found so far.
+    std::atomic<bool> mFound{false};
+    mutable std::mutex mBestMutex;
+    Path mBestPath;
+    BitSet mBestQuorum;
+    BitSet mBestDisjoint;
+
+    bool popTask(size_t thread, Task& task);
+    void runThread(size_t thread);
+    void notifyWork(bool all);
+
+  public:
+    ParallelMinQuorumSearch(QuorumIntersectionCheckerImpl const& qic,
+                            BitSet const& scanSCC, size_t numThreads);
+
+    // Runs the whole search, reporting the result through the root checker
+    // just like a serial MinQuorumEnumerator would.
+    bool anyMinQuorumHasDisjointQuorum();
+
+    // The path of the enumerator currently running on `thread`.
+    Path& currentPath(size_t thread);
+
+    // True if the enumerator at `path` can't improve on what was already
+    // found (or the search is being torn down).
+    bool shouldAbandon(Path const& path) const;
+
+    // Hands the subproblem at `path` to the thread's deque if some other
+    // thread is idle. Returns false if the caller should just recurse.
+    bool maybeShareSubproblem(size_t thread, BitSet const& committed,
+                              BitSet const& remaining, Path const& path);
+
+    void noteFoundDisjointQuorums(BitSet const& nodes, BitSet const& disj,
+                                  Path const& path);
+};
+
 // Quorum intersection checking is done by establishing a root
 // QuorumIntersectionChecker on a given QuorumSetMap. The
 // QuorumIntersectionChecker builds a QGraph of the nodes, uses
@@ -469,6 +595,7 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
         size_t mEarlyExit31s = {0};
         size_t mEarlyExit32s = {0};
         void log() const;
+        void add(Stats const& other);
     };
 
     // We use our own stats and a local cached flag to control tracing because
@@ -527,8 +654,24 @@ class QuorumIntersectionCheckerImpl : public stellar::QuorumIntersectionChecker
     std::string nodeName(size_t node) const;
 
     friend class MinQuorumEnumerator;
+    friend class ParallelMinQuorumSearch;
+
+    // Seed of the split-node choices; see splitNodeSeed.
+    stellar::stellar_default_random_engine::result_type const mSeed;
+
+    // Number of threads to run the powerset scan on.
+    size_t const mNumThreads;
+
+    // Seed for the random engine used by pickSplitNode on the enumerator with
+    // the given committed and remaining sets. This depends only on the sets'
+    // contents, so a given network and seed always yield the same search tree.
+    stellar::stellar_default_random_engine::result_type
+    splitNodeSeed(BitSet const& committed, BitSet const& remaining) const;
 
-    mutable stellar::stellar_default_random_engine mRand;
+    // Private copy of `parent` for one thread of a parallel search: shares the
+    // graph and interrupt flag, but nothing mutable.
+    explicit QuorumIntersectionCheckerImpl(
+        QuorumIntersectionCheckerImpl const& parent);
 
   public:
     QuorumIntersectionCheckerImpl(
@@ -9,6 +9,7 @@
 #include "util/types.h"
 #include <Tracy.hpp>
 #include <numeric>
+#include <optional>
 
 namespace stellar
 {
@@ -24,6 +25,61 @@ feeRate3WayCompare(TransactionFrameBase const& l, TransactionFrameBase const& r)
         r.getNumOperations());
 }
 
+// Returns whether `txs` are in the order a highest priority
+// `SurgePricingPriorityQueue` would visit them in. Outside of tests ties are
+// broken randomly by every queue, so any order of equal fee rate transactions
+// is acceptable.
+bool
+isInDescendingFeeRateOrder(std::vector<TransactionFrameBasePtr> const& txs)
+{
+    for (size_t i = 1; i < txs.size(); ++i)
+    {
+        auto cmp3 = feeRate3WayCompare(*txs[i - 1], *txs[i]);
+        if (cmp3 < 0)
+        {
+            return false;
+        }
+#ifdef BUILD_TESTS
+        // Tests break ties by full hash, highest first.
+        if (cmp3 == 0 && txs[i - 1]->getFullHash() < txs[i]->getFullHash())
+        {
+            return false;
+        }
+#endif
+    }
+    return true;
+}
+
+// Appends the transactions of all the `lanes` to `out`, repeatedly taking the
+// head of the lane that comes `before` the others.
+template <typename Iter, typename Before>
+void
+mergeLanes(std::vector<std::pair<Iter, Iter>> lanes, Before const& before,
+           std::vector<TransactionFrameBasePtr>& out)
+{
+    while (true)
+    {
+        std::optional<size_t> best;
+        for (size_t i = 0; i < lanes.size(); ++i)
+        {
+            if (lanes[i].first == lanes[i].second)
+            {
+                continue;
+            }
+            if (!best || before(*lanes[i].first, *lanes[*best].first))
+            {
+                best = i;
+            }
+        }
+        if (!best)
+        {
+            break;
+        }
+        out.emplace_back(*lanes[*best].first);
+        ++lanes[*best].first;
+    }
+}
+
 } // namespace
 
 int
@@ -154,6 +210,39 @@ SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
 {
     ZoneScoped;
 
+    std::vector<TransactionFrameBasePtr> outTxs;
+    if (isInDescendingFeeRateOrder(txs))
+    {
+        // Same greedy selection as `popTopTxs` with gaps allowed, but the
+        // transactions come pre-sorted (typically straight from the
+        // transaction queue), so there is no need to build a queue first.
+        auto const& laneLimits = laneConfig->getLaneLimits();
+        std::vector<Resource> laneLeftUntilLimit = laneLimits;
+        hadTxNotFittingLane.assign(laneLimits.size(), false);
+        for (auto const& tx : txs)
+        {
+            auto res = laneConfig->getTxResources(*tx);
+            auto lane = laneConfig->getLane(*tx);
+            if (anyGreater(res, laneLeftUntilLimit[lane]))
+            {
+                hadTxNotFittingLane[lane] = true;
+                continue;
+            }
+            if (anyGreater(res, laneLeftUntilLimit[GENERIC_LANE]))
+            {
+                hadTxNotFittingLane[GENERIC_LANE] = true;
+                continue;
+            }
+            outTxs.emplace_back(tx);
+            laneLeftUntilLimit[GENERIC_LANE] -= res;
+            if (lane != GENERIC_LANE)
+            {
+                laneLeftUntilLimit[lane] -= res;
+            }
+        }
+        return outTxs;
+    }
+
     SurgePricingPriorityQueue queue(
         /* isHighestPriority */ true, laneConfig,
         stellar::rand_uniform<size_t>(0, std::numeric_limits<size_t>::max()));
@@ -161,7 +250,6 @@ SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
     {
         queue.add(tx);
     }
-    std::vector<TransactionFrameBasePtr> outTxs;
     auto visitor = [&outTxs](TransactionFrameBasePtr const& tx) {
         outTxs.push_back(tx);
         return VisitTxResult::PROCESSED;
@@ -490,6 +578,52 @@ SurgePricingPriorityQueue::getTop() const
     return SurgePricingPriorityQueue::Iterator(*this, iters);
 }
 
+std::vector<TransactionFrameBasePtr>
+SurgePricingPriorityQueue::getTxsInFeeRateOrder() const
+{
+    ZoneScoped;
+
+    size_t totalTxs = 0;
+    for (auto const& txSet : mTxSortedSets)
+    {
+        totalTxs += txSet.size();
+    }
+    std::vector<TransactionFrameBasePtr> res;
+    res.reserve(totalTxs);
+
+    if (mComparator.isGreater())
+    {
+        // Highest fee rate is already at the beginning of every lane.
+        std::vector<std::pair<TxSortedSet::const_iterator,
+                              TxSortedSet::const_iterator>>
+            lanes;
+        for (auto const& txSet : mTxSortedSets)
+        {
+            lanes.emplace_back(txSet.begin(), txSet.end());
+        }
+        mergeLanes(lanes, mComparator, res);
+    }
+    else
+    {
+        // Lowest fee rate is at the beginning, so walk every lane backwards.
+        std::vector<std::pair<TxSortedSet::const_reverse_iterator,
+                              TxSortedSet::const_reverse_iterator>>
+            lanes;
+        for (auto const& txSet : mTxSortedSets)
+        {
+            lanes.emplace_back(txSet.rbegin(), txSet.rend());
+        }
+        mergeLanes(
+            lanes,
+            [this](TransactionFrameBasePtr const& tx1,
+                   TransactionFrameBasePtr const& tx2) {
+                return mComparator(tx2, tx1);
+            },
+            res);
+    }
+    return res;
+}
+
 Resource
 SurgePricingPriorityQueue::totalResources() const
 {
@@ -111,6 +111,9 @@ class SurgePricingPriorityQueue
     // within the limits specified by `laneConfig`.
     // The greedy ordering optimizes for the maximal fee ratio first, then for
     // the output resource count.
+    // When `txs` is already in descending fee rate order (as produced by
+    // `getTxsInFeeRateOrder`) the selection is a single linear pass over
+    // `txs`; otherwise a new queue is built from `txs` first.
     // `hadTxNotFittingLane` is an output parameter that for every lane will
     // identify whether there was a transaction that didn't fit into that lane's
     // limit.
@@ -119,6 +122,11 @@ class SurgePricingPriorityQueue
         std::shared_ptr<SurgePricingLaneConfig> laneConfig,
         std::vector<bool>& hadTxNotFittingLane);
 
+    // Returns all the transactions in this queue, across all the lanes, from
+    // the highest to the lowest fee rate (independently of
+    // `isHighestPriority`). This doesn't modify the queue.
+    std::vector<TransactionFrameBasePtr> getTxsInFeeRateOrder() const;
+
     // Returns total amount of resources in all the transactions in this queue.
     Resource totalResources() const;
 
@@ -947,12 +947,15 @@ TransactionQueue::getTransactions(LedgerHeader const& lcl) const
 
     uint32_t const nextLedgerSeq = lcl.ledgerSeq + 1;
     int64_t const startingSeq = getStartingSequenceNumber(nextLedgerSeq);
-    for (auto const& m : mAccountStates)
+    // The limiter holds exactly the transactions in mAccountStates, kept in
+    // fee rate order as they're added and removed. Returning them in that
+    // order lets surge pricing select the tx set in a single pass instead of
+    // re-sorting the whole queue on every nomination.
+    for (auto const& tx : mTxQueueLimiter->getTxsInFeeRateOrder())
     {
-        if (m.second.mTransaction &&
-            m.second.mTransaction->mTx->getSeqNum() != startingSeq)
+        if (tx->getSeqNum() != startingSeq)
         {
-            txs.emplace_back(m.second.mTransaction->mTx);
+            txs.emplace_back(tx);
         }
     }
 
@@ -56,6 +56,11 @@ class Application;
  *   pendingDepth, all transactions for that source account are banned. It also
  *   unbans any transactions that have been banned for more than banDepth
  *   ledgers.
+ *
+ * Admission is main-thread only. tryAdd checks a transaction against the
+ * ledger snapshot owned by the main thread and against the queue contents, and
+ * both of its callers (Peer::recvTransaction and the "tx" endpoint) already run
+ * on the main thread.
  */
 class TransactionQueue
 {
@@ -77,6 +77,17 @@ TxQueueLimiter::removeTransaction(TransactionFrameBasePtr const& tx)
     mTxs->erase(tx);
 }
 
+std::vector<TransactionFrameBasePtr>
+TxQueueLimiter::getTxsInFeeRateOrder() const
+{
+    // `mTxs` is only initialized with the first transaction.
+    if (mTxs == nullptr)
+    {
+        return {};
+    }
+    return mTxs->getTxsInFeeRateOrder();
+}
+
 #ifdef BUILD_TESTS
 std::pair<bool, int64>
 TxQueueLimiter::canAddTx(
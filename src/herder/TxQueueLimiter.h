@@ -42,6 +42,10 @@ class TxQueueLimiter
 
     void addTransaction(TransactionFrameBasePtr const& tx);
     void removeTransaction(TransactionFrameBasePtr const& tx);
+
+    // Returns all the transactions in the limiter from the highest to the
+    // lowest fee rate.
+    std::vector<TransactionFrameBasePtr> getTxsInFeeRateOrder() const;
 #ifdef BUILD_TESTS
     size_t size() const;
     std::pair<bool, int64>
@@ -8,10 +8,12 @@
 #include "lib/catch.hpp"
 #include "main/Config.h"
 #include "scp/LocalNode.h"
+#include "simulation/Topologies.h"
 #include "test/test.h"
 #include "util/Logging.h"
 #include "util/Math.h"
 #include "xdrpp/marshal.h"
+#include <chrono>
 #include <fmt/format.h>
 #include <lib/json/json.h>
 #include <thread>
@@ -875,6 +877,97 @@ TEST_CASE("quorum intersection scaling test",
     REQUIRE(qic->networkEnjoysQuorumIntersection());
 }
 
+TEST_CASE("quorum intersection parallel search matches serial",
+          "[herder][quorumintersection]")
+{
+    // Same weakened core-and-periphery network as above: it splits, and has
+    // several different disjoint pairs to find.
+    auto orgs = generateOrgs(8, {3, 3, 3, 3, 2, 2, 2, 2});
+    auto qm = interconnectOrgsBidir(orgs, {{0, 1},
+                                           {0, 2},
+                                           {0, 3},
+                                           {1, 2},
+                                           {1, 3},
+                                           {2, 3},
+                                           {0, 4},
+                                           {1, 4},
+                                           {0, 5},
+                                           {1, 5},
+                                           {2, 6},
+                                           {3, 6},
+                                           {2, 7},
+                                           {3, 7}});
+    Config cfg(getTestConfig());
+    cfg = configureShortNames(cfg, orgs);
+    std::atomic<bool> flag{false};
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        auto seed = gRandomEngine();
+        cfg.QUORUM_INTERSECTION_CHECKER_THREADS = 1;
+        auto serial = QuorumIntersectionChecker::create(qm, cfg, flag, seed);
+        REQUIRE(!serial->networkEnjoysQuorumIntersection());
+        auto expected = serial->getPotentialSplit();
+        REQUIRE(!expected.first.empty());
+        REQUIRE(!expected.second.empty());
+
+        for (uint32_t threads : {2, 4, 8})
+        {
+            cfg.QUORUM_INTERSECTION_CHECKER_THREADS = threads;
+            auto parallel =
+                QuorumIntersectionChecker::create(qm, cfg, flag, seed);
+            REQUIRE(!parallel->networkEnjoysQuorumIntersection());
+            REQUIRE(parallel->getPotentialSplit() == expected);
+        }
+    }
+
+    // And a network that doesn't split.
+    auto orgs2 = generateOrgs(6, {3});
+    auto qm2 =
+        interconnectOrgs(orgs2, [](size_t i, size_t j) { return true; });
+    cfg.QUORUM_INTERSECTION_CHECKER_THREADS = 4;
+    auto qic = QuorumIntersectionChecker::create(qm2, cfg, flag,
+                                                 gRandomEngine());
+    REQUIRE(qic->networkEnjoysQuorumIntersection());
+}
+
+TEST_CASE("quorum intersection parallel scaling test",
+          "[herder][quorumintersectionbench][!hide]")
+{
+    // Times the search over Topologies networks of increasing size, with
+    // increasing numbers of threads.
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    for (int coreSize : {4, 8, 12, 16})
+    {
+        auto sim = Topologies::hierarchicalQuorumSimplified(
+            coreSize, 2 * coreSize, Simulation::OVER_LOOPBACK, networkID);
+        QuorumIntersectionChecker::QuorumSetMap qm;
+        for (auto const& node : sim->getNodes())
+        {
+            auto const& nodeCfg = node->getConfig();
+            qm[nodeCfg.NODE_SEED.getPublicKey()] =
+                std::make_shared<SCPQuorumSet>(nodeCfg.QUORUM_SET);
+        }
+
+        Config cfg(getTestConfig());
+        std::atomic<bool> flag{false};
+        auto seed = gRandomEngine();
+        for (uint32_t threads : {1, 2, 4, 8})
+        {
+            cfg.QUORUM_INTERSECTION_CHECKER_THREADS = threads;
+            auto qic = QuorumIntersectionChecker::create(qm, cfg, flag, seed);
+            auto start = std::chrono::steady_clock::now();
+            REQUIRE(qic->networkEnjoysQuorumIntersection());
+            auto elapsed =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+            CLOG_INFO(Herder, "{} nodes, {} threads: {} ms, {} max quorums",
+                      qm.size(), threads, elapsed.count(),
+                      qic->getMaxQuorumsFound());
+        }
+    }
+}
+
 TEST_CASE("quorum intersection interruption", "[herder][quorumintersection]")
 {
     auto orgs = generateOrgs(16);
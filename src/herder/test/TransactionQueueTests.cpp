@@ -1862,6 +1862,79 @@ TEST_CASE("TransactionQueue limits", "[herder][transactionqueue]")
     }
 }
 
+TEST_CASE("TransactionQueue limiter fee rate order",
+          "[herder][transactionqueue]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 20;
+    auto app = createTestApplication(clock, cfg);
+    auto const minBalance2 = app->getLedgerManager().getLastMinBalance(2);
+
+    auto root = TestAccount::createRoot(*app);
+    TxQueueLimiter limiter(1, *app, false);
+    REQUIRE(limiter.getTxsInFeeRateOrder().empty());
+
+    // Fee rates deliberately added out of order, with some ties.
+    std::vector<std::pair<int, int>> opsFees = {
+        {1, 300}, {2, 400}, {1, 100}, {3, 1200}, {1, 200}, {2, 600}, {1, 500}};
+    std::vector<TransactionFrameBasePtr> txs;
+    for (size_t i = 0; i < opsFees.size(); ++i)
+    {
+        auto account = root.create(fmt::format("a{}", i), minBalance2);
+        auto tx = transaction(*app, account, 1, 1, opsFees[i].second,
+                              opsFees[i].first);
+        std::vector<std::pair<TransactionFrameBasePtr, bool>> txsToEvict;
+        REQUIRE(limiter.canAddTx(tx, nullptr, txsToEvict).first);
+        REQUIRE(txsToEvict.empty());
+        limiter.addTransaction(tx);
+        txs.emplace_back(tx);
+    }
+
+    auto ordered = limiter.getTxsInFeeRateOrder();
+    REQUIRE(ordered.size() == txs.size());
+    for (size_t i = 1; i < ordered.size(); ++i)
+    {
+        REQUIRE(feeRate3WayCompare(ordered[i - 1]->getInclusionFee(),
+                                   ordered[i - 1]->getNumOperations(),
+                                   ordered[i]->getInclusionFee(),
+                                   ordered[i]->getNumOperations()) >= 0);
+    }
+
+    // Removal is reflected immediately.
+    limiter.removeTransaction(txs[3]);
+    auto afterRemove = limiter.getTxsInFeeRateOrder();
+    REQUIRE(afterRemove.size() == txs.size() - 1);
+    REQUIRE(std::find(afterRemove.begin(), afterRemove.end(), txs[3]) ==
+            afterRemove.end());
+
+    // Selecting from pre-sorted transactions gives the same result as
+    // selecting from an arbitrary order.
+    std::vector<TransactionFrameBasePtr> unsorted(afterRemove.rbegin(),
+                                                  afterRemove.rend());
+    for (int64_t limit : {1, 3, 5, 100})
+    {
+        auto laneConfig = std::make_shared<DexLimitingLaneConfig>(
+            Resource(limit), std::nullopt);
+        std::vector<bool> hadTxNotFittingSorted;
+        auto fromSorted = SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
+            afterRemove, laneConfig, hadTxNotFittingSorted);
+        std::vector<bool> hadTxNotFittingUnsorted;
+        auto fromUnsorted =
+            SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
+                unsorted, laneConfig, hadTxNotFittingUnsorted);
+        REQUIRE(fromSorted == fromUnsorted);
+        REQUIRE(hadTxNotFittingSorted == hadTxNotFittingUnsorted);
+
+        int64_t totalOps = 0;
+        for (auto const& tx : fromSorted)
+        {
+            totalOps += tx->getNumOperations();
+        }
+        REQUIRE(totalOps <= limit);
+    }
+}
+
 TEST_CASE("TransactionQueue limiter with DEX separation",
           "[herder][transactionqueue]")
 {
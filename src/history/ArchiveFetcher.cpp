@@ -0,0 +1,918 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+// ASIO is somewhat particular about when it gets included -- it wants to be the
+// first to include <windows.h> -- so we try to include it before everything
+// else.
+#include "util/asio.h"
+#include "history/ArchiveFetcher.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+
+#include <Tracy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <deque>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace stellar
+{
+
+std::chrono::seconds const ArchiveFetcher::DEFAULT_TIMEOUT(60);
+
+namespace
+{
+// Requests failing this many times because of their connection are reported
+// as failed; retrying beyond that is up to the caller.
+size_t const MAX_ATTEMPTS = 3;
+size_t const READ_CHUNK_SIZE = 64 * 1024;
+size_t const MAX_HEADER_SIZE = 64 * 1024;
+// Idle connections are closed after this long, rather than waiting for the
+// server to drop them.
+std::chrono::seconds const IDLE_TIMEOUT(30);
+
+struct ParsedURL
+{
+    std::string mScheme;
+    std::string mHost;
+    std::string mPort;
+    std::string mPath;
+};
+
+std::optional<ParsedURL>
+parseURL(std::string const& url)
+{
+    auto schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos)
+    {
+        return std::nullopt;
+    }
+    ParsedURL res;
+    res.mScheme = url.substr(0, schemeEnd);
+    auto rest = url.substr(schemeEnd + 3);
+
+    if (res.mScheme == "file")
+    {
+        // Only local absolute paths, `file:///path/to/archive`
+        if (rest.empty() || rest[0] != '/')
+        {
+            return std::nullopt;
+        }
+        res.mPath = rest;
+        return res;
+    }
+    if (res.mScheme != "http")
+    {
+        return std::nullopt;
+    }
+
+    auto slash = rest.find('/');
+    auto authority = rest.substr(0, slash);
+    res.mPath = slash == std::string::npos ? "/" : rest.substr(slash);
+    auto colon = authority.find(':');
+    res.mHost = authority.substr(0, colon);
+    res.mPort = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+    if (res.mHost.empty() || res.mPort.empty() ||
+        !std::all_of(res.mPort.begin(), res.mPort.end(),
+                     [](char c) { return std::isdigit(c); }))
+    {
+        return std::nullopt;
+    }
+    return res;
+}
+
+std::string
+toLower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+std::string
+trim(std::string const& s)
+{
+    auto begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+    {
+        return "";
+    }
+    auto end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+}
+
+class ArchiveFetcher::Impl
+{
+  public:
+    struct Request
+    {
+        std::string mTarget;
+        std::string mLocal;
+        Callback mCallback;
+        std::shared_ptr<std::atomic<bool>> mCancelled;
+        std::ofstream mOut;
+        // Bytes of the body already written to mLocal, a retry asks for the
+        // rest only
+        size_t mReceived{0};
+        size_t mAttempts{0};
+    };
+
+    class Connection;
+
+    struct Host
+    {
+        std::string mName;
+        std::string mPort;
+        std::string mHostHeader;
+        std::deque<std::shared_ptr<Request>> mQueue;
+        std::vector<std::shared_ptr<Connection>> mIdle;
+        size_t mConnections{0};
+    };
+
+    size_t const mConnectionsPerHost;
+    size_t const mPipelineDepth;
+    std::chrono::seconds const mTimeout;
+    std::atomic<size_t> mConnectionsOpened{0};
+
+    asio::io_context mIOContext;
+    std::unique_ptr<asio::io_context::work> mWork;
+    // Only accessed on the fetcher thread
+    std::map<std::string, std::unique_ptr<Host>> mHosts;
+    std::thread mThread;
+
+    Impl(size_t connectionsPerHost, size_t pipelineDepth,
+         std::chrono::seconds timeout)
+        : mConnectionsPerHost(connectionsPerHost)
+        , mPipelineDepth(pipelineDepth)
+        , mTimeout(timeout)
+        , mWork(std::make_unique<asio::io_context::work>(mIOContext))
+        , mThread([this]() { mIOContext.run(); })
+    {
+    }
+
+    ~Impl()
+    {
+        mWork.reset();
+        mIOContext.stop();
+        mThread.join();
+        for (auto& host : mHosts)
+        {
+            host.second->mIdle.clear();
+        }
+    }
+
+    void start(ParsedURL const& url, std::string const& local,
+               Callback callback, std::shared_ptr<std::atomic<bool>> cancelled);
+    void copyFile(std::string const& path, std::string const& local,
+                  Callback const& callback);
+};
+
+class ArchiveFetcher::Impl::Connection
+    : public std::enable_shared_from_this<Connection>
+{
+    Impl& mFetcher;
+    Host& mHost;
+    asio::ip::tcp::resolver mResolver;
+    asio::ip::tcp::socket mSocket;
+    asio::steady_timer mTimer;
+    uint64_t mTimerGeneration{0};
+    bool mTimedOut{false};
+    bool mIdle{false};
+    // Set when an idle connection is picked up again. The server may have
+    // closed it in the meantime, so failing before the first response
+    // doesn't count against the requests.
+    bool mReused{false};
+
+    std::string mRequestData;
+    // Requests written on the connection, in the order their responses come
+    std::deque<std::shared_ptr<Request>> mInFlight;
+
+    // Bytes received and not consumed yet start at mBufStart
+    std::vector<char> mBuf;
+    size_t mBufStart{0};
+    bool mEOF{false};
+
+    // State of the response being read
+    std::string mResponseError;
+    bool mChunked{false};
+    bool mUntilEOF{false};
+    bool mCloseAfter{false};
+    size_t mRemaining{0};
+
+    char const*
+    bufData() const
+    {
+        return mBuf.data() + mBufStart;
+    }
+
+    size_t
+    bufSize() const
+    {
+        return mBuf.size() - mBufStart;
+    }
+
+    void
+    consume(size_t n)
+    {
+        mBufStart += n;
+        releaseAssert(mBufStart <= mBuf.size());
+    }
+
+    void
+    armTimer(std::chrono::seconds timeout)
+    {
+        auto generation = ++mTimerGeneration;
+        mTimer.expires_after(timeout);
+        std::weak_ptr<Connection> weak(shared_from_this());
+        mTimer.async_wait([weak, generation](asio::error_code const& ec) {
+            auto self = weak.lock();
+            if (!ec && self && self->mTimerGeneration == generation)
+            {
+                self->onTimeout();
+            }
+        });
+    }
+
+    void
+    cancelTimer()
+    {
+        ++mTimerGeneration;
+        mTimer.cancel();
+    }
+
+    void
+    closeSocket()
+    {
+        asio::error_code ignored;
+        mResolver.cancel();
+        mSocket.close(ignored);
+    }
+
+    void
+    onTimeout()
+    {
+        if (mIdle)
+        {
+            auto it = std::find(mHost.mIdle.begin(), mHost.mIdle.end(),
+                                shared_from_this());
+            releaseAssert(it != mHost.mIdle.end());
+            mHost.mIdle.erase(it);
+            mIdle = false;
+            retire();
+        }
+        else
+        {
+            // Pending operations complete with an error and fail the
+            // connection
+            mTimedOut = true;
+            closeSocket();
+        }
+    }
+
+    void
+    retire()
+    {
+        releaseAssert(mHost.mConnections > 0);
+        --mHost.mConnections;
+        cancelTimer();
+        closeSocket();
+    }
+
+    void
+    complete(std::shared_ptr<Request> const& req, std::string const& error)
+    {
+        req->mOut.close();
+        req->mCallback(error);
+    }
+
+    // Puts the requests in flight back at the front of the queue, in order
+    void
+    requeueInFlight(bool countAttempt, std::string const& error)
+    {
+        for (auto it = mInFlight.rbegin(); it != mInFlight.rend(); ++it)
+        {
+            auto const& req = *it;
+            req->mOut.close();
+            if (countAttempt && ++req->mAttempts >= MAX_ATTEMPTS)
+            {
+                complete(req, error);
+            }
+            else
+            {
+                mHost.mQueue.push_front(req);
+            }
+        }
+        mInFlight.clear();
+    }
+
+    void
+    fail(asio::error_code const& ec)
+    {
+        fail(mTimedOut ? std::string("timed out") : ec.message());
+    }
+
+    void
+    fail(std::string const& what)
+    {
+        auto error = fmt::format(FMT_STRING("Error fetching from {}:{}: {}"),
+                                 mHost.mName, mHost.mPort, what);
+        CLOG_DEBUG(History, "{}", error);
+        cancelTimer();
+        closeSocket();
+        requeueInFlight(!mReused, error);
+        mReused = false;
+        run();
+    }
+
+    void
+    connect()
+    {
+        mBuf.clear();
+        mBufStart = 0;
+        mEOF = false;
+        mTimedOut = false;
+        mSocket = asio::ip::tcp::socket(mFetcher.mIOContext);
+        ++mFetcher.mConnectionsOpened;
+
+        armTimer(mFetcher.mTimeout);
+        auto self = shared_from_this();
+        mResolver.async_resolve(
+            mHost.mName, mHost.mPort,
+            [self](asio::error_code const& ec,
+                   asio::ip::tcp::resolver::results_type results) {
+                if (ec)
+                {
+                    self->fail(ec);
+                    return;
+                }
+                asio::async_connect(
+                    self->mSocket, results,
+                    [self](asio::error_code const& ec,
+                           asio::ip::tcp::endpoint const&) {
+                        if (ec)
+                        {
+                            self->fail(ec);
+                            return;
+                        }
+                        asio::error_code ignored;
+                        self->mSocket.set_option(asio::ip::tcp::no_delay(true),
+                                                 ignored);
+                        self->write();
+                    });
+            });
+    }
+
+    // Writes all the requests of the batch at once; the responses are read
+    // back in order.
+    void
+    write()
+    {
+        mRequestData.clear();
+        for (auto const& req : mInFlight)
+        {
+            mRequestData += fmt::format(
+                FMT_STRING("GET {} HTTP/1.1\r\nHost: {}\r\nAccept: "
+                           "*/*\r\nUser-Agent: stellar-core\r\n"),
+                req->mTarget, mHost.mHostHeader);
+            if (req->mReceived > 0)
+            {
+                mRequestData += fmt::format(
+                    FMT_STRING("Range: bytes={:d}-\r\n"), req->mReceived);
+            }
+            mRequestData += "\r\n";
+        }
+
+        armTimer(mFetcher.mTimeout);
+        auto self = shared_from_this();
+        asio::async_write(mSocket, asio::buffer(mRequestData),
+                          [self](asio::error_code const& ec, size_t) {
+                              if (ec)
+                              {
+                                  self->fail(ec);
+                                  return;
+                              }
+                              self->readHeader();
+                          });
+    }
+
+    // Reads more bytes into the buffer, then calls `next`. A clean end of
+    // stream sets mEOF rather than failing, the caller decides whether it
+    // was expected.
+    void
+    readMore(std::function<void()> next)
+    {
+        if (mBufStart > 0)
+        {
+            mBuf.erase(mBuf.begin(), mBuf.begin() + mBufStart);
+            mBufStart = 0;
+        }
+        auto prevSize = mBuf.size();
+        mBuf.resize(prevSize + READ_CHUNK_SIZE);
+
+        armTimer(mFetcher.mTimeout);
+        auto self = shared_from_this();
+        mSocket.async_read_some(
+            asio::buffer(mBuf.data() + prevSize, READ_CHUNK_SIZE),
+            [self, prevSize, next](asio::error_code const& ec, size_t n) {
+                self->mBuf.resize(prevSize + n);
+                if (ec == asio::error::eof)
+                {
+                    self->mEOF = true;
+                }
+                else if (ec)
+                {
+                    self->fail(ec);
+                    return;
+                }
+                next();
+            });
+    }
+
+    // Calls `next` with the length of the buffered data up to and including
+    // `delim`, reading more until it's found.
+    void
+    readUntil(std::string const& delim, std::function<void(size_t)> next)
+    {
+        auto begin = bufData();
+        auto end = begin + bufSize();
+        auto it = std::search(begin, end, delim.begin(), delim.end());
+        if (it != end)
+        {
+            next(static_cast<size_t>(it - begin) + delim.size());
+        }
+        else if (mEOF)
+        {
+            fail(std::string("connection closed"));
+        }
+        else if (bufSize() > MAX_HEADER_SIZE)
+        {
+            fail(std::string("malformed response"));
+        }
+        else
+        {
+            auto self = shared_from_this();
+            readMore([self, delim, next]() { self->readUntil(delim, next); });
+        }
+    }
+
+    void
+    readHeader()
+    {
+        auto self = shared_from_this();
+        readUntil("\r\n\r\n", [self](size_t n) { self->onHeader(n); });
+    }
+
+    void
+    onHeader(size_t n)
+    {
+        // The server answered, this connection is working
+        mReused = false;
+        std::istringstream in(std::string(bufData(), n));
+        consume(n);
+
+        std::string line;
+        std::getline(in, line);
+        std::string version;
+        unsigned status = 0;
+        {
+            std::istringstream statusLine(line);
+            statusLine >> version >> status;
+        }
+        if (version.compare(0, 5, "HTTP/") != 0 || status == 0)
+        {
+            fail(std::string("malformed response"));
+            return;
+        }
+
+        if (status < 200)
+        {
+            // Interim response (e.g. 100 Continue), which has no body: the
+            // final response to the same request follows it
+            readHeader();
+            return;
+        }
+
+        mResponseError.clear();
+        mChunked = false;
+        mUntilEOF = false;
+        mCloseAfter = version == "HTTP/1.0";
+        std::optional<size_t> contentLength;
+        std::optional<size_t> rangeStart;
+        while (std::getline(in, line))
+        {
+            auto colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                continue;
+            }
+            auto name = toLower(trim(line.substr(0, colon)));
+            auto value = toLower(trim(line.substr(colon + 1)));
+            try
+            {
+                if (name == "content-length")
+                {
+                    contentLength = std::stoull(value);
+                }
+                else if (name == "transfer-encoding")
+                {
+                    mChunked = value.find("chunked") != std::string::npos;
+                }
+                else if (name == "connection")
+                {
+                    mCloseAfter = value == "close";
+                }
+                else if (name == "content-range" &&
+                         value.compare(0, 6, "bytes ") == 0)
+                {
+                    rangeStart = std::stoull(value.substr(6));
+                }
+            }
+            catch (std::exception const&)
+            {
+                fail(std::string("malformed response header: ") + line);
+                return;
+            }
+        }
+
+        auto& req = *mInFlight.front();
+        if (req.mCancelled->load())
+        {
+            // The response is still read, to keep the connection in sync
+            mResponseError = "cancelled";
+        }
+        else if (status == 200 ||
+                 (status == 206 && rangeStart == req.mReceived))
+        {
+            if (status == 200)
+            {
+                req.mReceived = 0;
+            }
+            req.mOut.open(req.mLocal, std::ofstream::binary |
+                                          (status == 200 ? std::ofstream::trunc
+                                                         : std::ofstream::app));
+            if (!req.mOut)
+            {
+                mResponseError = fmt::format(
+                    FMT_STRING("Error opening file {}"), req.mLocal);
+            }
+        }
+        else
+        {
+            mResponseError = fmt::format(
+                FMT_STRING("Error fetching http://{}:{}{}: HTTP {:d}"),
+                mHost.mName, mHost.mPort, req.mTarget, status);
+        }
+
+        if (status == 204 || status == 304)
+        {
+            mRemaining = 0;
+            readBody();
+        }
+        else if (mChunked)
+        {
+            readChunkSize();
+        }
+        else if (contentLength)
+        {
+            mRemaining = *contentLength;
+            readBody();
+        }
+        else
+        {
+            mUntilEOF = true;
+            mCloseAfter = true;
+            readBody();
+        }
+    }
+
+    void
+    writeBody(size_t n)
+    {
+        auto& req = *mInFlight.front();
+        if (mResponseError.empty() && req.mCancelled->load())
+        {
+            mResponseError = "cancelled";
+            req.mOut.close();
+        }
+        if (mResponseError.empty())
+        {
+            req.mOut.write(bufData(), n);
+            if (!req.mOut)
+            {
+                mResponseError = fmt::format(
+                    FMT_STRING("Error writing file {}"), req.mLocal);
+            }
+            req.mReceived += n;
+        }
+        consume(n);
+    }
+
+    // Moves mRemaining bytes (or everything up to the end of the stream) from
+    // the connection to the output file
+    void
+    readBody()
+    {
+        auto n = mUntilEOF ? bufSize() : std::min(bufSize(), mRemaining);
+        if (n > 0)
+        {
+            writeBody(n);
+            if (!mUntilEOF)
+            {
+                mRemaining -= n;
+            }
+        }
+
+        if (mUntilEOF ? mEOF : mRemaining == 0)
+        {
+            if (mChunked)
+            {
+                // Each chunk is followed by a CRLF
+                auto self = shared_from_this();
+                readUntil("\r\n", [self](size_t n) {
+                    self->consume(n);
+                    self->readChunkSize();
+                });
+            }
+            else
+            {
+                onResponseDone();
+            }
+        }
+        else if (mEOF)
+        {
+            fail(std::string("connection closed"));
+        }
+        else
+        {
+            auto self = shared_from_this();
+            readMore([self]() { self->readBody(); });
+        }
+    }
+
+    void
+    readChunkSize()
+    {
+        auto self = shared_from_this();
+        readUntil("\r\n", [self](size_t n) {
+            std::string line(self->bufData(), n - 2);
+            self->consume(n);
+            size_t size = 0;
+            try
+            {
+                // Ignore chunk extensions
+                size = std::stoull(line.substr(0, line.find(';')), nullptr, 16);
+            }
+            catch (std::exception const&)
+            {
+                self->fail(std::string("malformed chunk size"));
+                return;
+            }
+            if (size == 0)
+            {
+                self->readTrailer();
+            }
+            else
+            {
+                self->mRemaining = size;
+                self->readBody();
+            }
+        });
+    }
+
+    // Skips trailer fields, up to the empty line ending the response
+    void
+    readTrailer()
+    {
+        auto self = shared_from_this();
+        readUntil("\r\n", [self](size_t n) {
+            self->consume(n);
+            if (n == 2)
+            {
+                self->onResponseDone();
+            }
+            else
+            {
+                self->readTrailer();
+            }
+        });
+    }
+
+    void
+    onResponseDone()
+    {
+        auto req = mInFlight.front();
+        mInFlight.pop_front();
+        auto error = mResponseError;
+        req->mOut.close();
+        if (error.empty() && req->mOut.fail())
+        {
+            error = fmt::format(FMT_STRING("Error writing file {}"),
+                                req->mLocal);
+        }
+        complete(req, error);
+
+        if (mCloseAfter || mEOF)
+        {
+            // The rest of the batch will never be answered on this connection
+            cancelTimer();
+            closeSocket();
+            requeueInFlight(false, "");
+            run();
+        }
+        else if (!mInFlight.empty())
+        {
+            readHeader();
+        }
+        else
+        {
+            run();
+        }
+    }
+
+  public:
+    Connection(Impl& fetcher, Host& host)
+        : mFetcher(fetcher)
+        , mHost(host)
+        , mResolver(fetcher.mIOContext)
+        , mSocket(fetcher.mIOContext)
+        , mTimer(fetcher.mIOContext)
+    {
+    }
+
+    // Takes the next batch of requests off the host queue and sends it,
+    // connecting first if needed. Goes idle if there's nothing to do.
+    void
+    run()
+    {
+        while (mInFlight.size() < mFetcher.mPipelineDepth &&
+               !mHost.mQueue.empty())
+        {
+            auto req = mHost.mQueue.front();
+            mHost.mQueue.pop_front();
+            if (req->mCancelled->load())
+            {
+                complete(req, "cancelled");
+                continue;
+            }
+            mInFlight.emplace_back(req);
+        }
+
+        if (mInFlight.empty())
+        {
+            if (mSocket.is_open())
+            {
+                mIdle = true;
+                mHost.mIdle.emplace_back(shared_from_this());
+                armTimer(IDLE_TIMEOUT);
+            }
+            else
+            {
+                retire();
+            }
+        }
+        else if (mSocket.is_open())
+        {
+            write();
+        }
+        else
+        {
+            connect();
+        }
+    }
+
+    void
+    resume()
+    {
+        releaseAssert(mIdle);
+        mIdle = false;
+        mReused = true;
+        cancelTimer();
+        run();
+    }
+};
+
+void
+ArchiveFetcher::Impl::start(ParsedURL const& url, std::string const& local,
+                            Callback callback,
+                            std::shared_ptr<std::atomic<bool>> cancelled)
+{
+    if (cancelled->load())
+    {
+        callback("cancelled");
+        return;
+    }
+    if (url.mScheme == "file")
+    {
+        copyFile(url.mPath, local, callback);
+        return;
+    }
+
+    auto& host = mHosts[url.mHost + ":" + url.mPort];
+    if (!host)
+    {
+        host = std::make_unique<Host>();
+        host->mName = url.mHost;
+        host->mPort = url.mPort;
+        host->mHostHeader =
+            url.mPort == "80" ? url.mHost : url.mHost + ":" + url.mPort;
+    }
+
+    auto req = std::make_shared<Request>();
+    req->mTarget = url.mPath;
+    req->mLocal = local;
+    req->mCallback = std::move(callback);
+    req->mCancelled = std::move(cancelled);
+    host->mQueue.emplace_back(req);
+
+    if (!host->mIdle.empty())
+    {
+        auto conn = host->mIdle.back();
+        host->mIdle.pop_back();
+        conn->resume();
+    }
+    else if (host->mConnections < mConnectionsPerHost)
+    {
+        ++host->mConnections;
+        std::make_shared<Connection>(*this, *host)->run();
+    }
+    // Otherwise a busy connection picks it up once done with its batch
+}
+
+void
+ArchiveFetcher::Impl::copyFile(std::string const& path,
+                               std::string const& local,
+                               Callback const& callback)
+{
+    ZoneScoped;
+    std::error_code ec;
+    std::filesystem::copy_file(
+        path, local, std::filesystem::copy_options::overwrite_existing, ec);
+    callback(ec ? fmt::format(FMT_STRING("Error copying {}: {}"), path,
+                              ec.message())
+                : std::string());
+}
+
+ArchiveFetcher::ArchiveFetcher(size_t connectionsPerHost,
+                               size_t pipelineDepth,
+                               std::chrono::seconds timeout)
+    : mImpl(std::make_unique<Impl>(connectionsPerHost, pipelineDepth, timeout))
+{
+    releaseAssert(connectionsPerHost > 0);
+    releaseAssert(pipelineDepth > 0);
+}
+
+ArchiveFetcher::~ArchiveFetcher()
+{
+}
+
+ArchiveFetcher::Handle::Handle(std::shared_ptr<std::atomic<bool>> cancelled)
+    : mCancelled(std::move(cancelled))
+{
+}
+
+void
+ArchiveFetcher::Handle::cancel()
+{
+    if (mCancelled)
+    {
+        mCancelled->store(true);
+    }
+}
+
+bool
+ArchiveFetcher::isSupportedURL(std::string const& url)
+{
+    return parseURL(url).has_value();
+}
+
+ArchiveFetcher::Handle
+ArchiveFetcher::fetch(std::string const& url, std::string const& local,
+                      Callback callback)
+{
+    auto parsed = parseURL(url);
+    releaseAssert(parsed);
+    auto impl = mImpl.get();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    asio::post(mImpl->mIOContext,
+               [impl, parsed = *parsed, local, callback, cancelled]() {
+                   impl->start(parsed, local, callback, cancelled);
+               });
+    return Handle(cancelled);
+}
+
+size_t
+ArchiveFetcher::getConnectionsOpened() const
+{
+    return mImpl->mConnectionsOpened.load();
+}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace stellar
+{
+
+/**
+ * Downloads files from history archives without spawning a process per file.
+ *
+ * `http://` URLs are served by a built-in HTTP/1.1 client that keeps up to a
+ * fixed number of persistent connections per host and pipelines several
+ * requests on each of them, so a catchup doesn't pay for a connection
+ * handshake per file. Requests interrupted by a dropped connection are
+ * retried on a new one, resuming with a range request where the transfer
+ * stopped. `file://` URLs are plain file copies.
+ *
+ * All the I/O happens on a dedicated thread, and callbacks are invoked there.
+ *
+ * There's no TLS implementation in the build, so `https://` archives (or any
+ * other scheme) still need a `get` command.
+ */
+class ArchiveFetcher : NonMovableOrCopyable
+{
+  public:
+    // Called on the fetcher thread, with an empty string on success and a
+    // description of the failure otherwise.
+    using Callback = std::function<void(std::string const& error)>;
+
+    static std::chrono::seconds const DEFAULT_TIMEOUT;
+
+    // Returned by fetch. Cancelling a request stops writing to its local file
+    // as soon as the fetcher thread notices; its callback is then called with
+    // an error. Thread-safe.
+    class Handle
+    {
+        std::shared_ptr<std::atomic<bool>> mCancelled;
+
+      public:
+        Handle() = default;
+        explicit Handle(std::shared_ptr<std::atomic<bool>> cancelled);
+        void cancel();
+    };
+
+    ArchiveFetcher(size_t connectionsPerHost, size_t pipelineDepth,
+                   std::chrono::seconds timeout = DEFAULT_TIMEOUT);
+    // Stops the fetcher thread, requests still in flight never complete.
+    ~ArchiveFetcher();
+
+    // Whether `url` (an archive base URL or a file URL) can be fetched
+    static bool isSupportedURL(std::string const& url);
+
+    // Downloads `url` into `local`, overwriting it. `url` must be supported.
+    Handle fetch(std::string const& url, std::string const& local,
+                 Callback callback);
+
+    // Number of connections opened so far, across all hosts.
+    size_t getConnectionsOpened() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+}
@@ -5,6 +5,10 @@
 #include "main/Application.h"
 #include "util/XDRStream.h"
 
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+#include <set>
+
 namespace stellar
 {
 void
@@ -41,6 +45,104 @@ CheckpointBuilder::ensureOpen(uint32_t ledgerSeq)
         mLedgerHeaders->open(ledger.localPath_nogz_dirty());
         mOpen = true;
     }
+    if (!mWriter)
+    {
+        mWriter.emplace([this]() { runWriter(); });
+    }
+}
+
+template <typename T>
+void
+CheckpointBuilder::queueWrite(XDROutputFileStream& stream, T&& entry,
+                              bool durable)
+{
+    // std::function needs a copyable callable, share the entry instead of
+    // copying it
+    auto shared = std::make_shared<std::decay_t<T>>(std::forward<T>(entry));
+    auto* out = &stream;
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        mPendingWrites.emplace_back(PendingWrite{
+            out, [out, shared]() { out->writeOne(*shared); }, durable});
+        ++mQueuedWrites;
+    }
+    mWriteCV.notify_all();
+}
+
+void
+CheckpointBuilder::runWriter()
+{
+    std::unique_lock<std::mutex> lock(mWriteMutex);
+    while (true)
+    {
+        mWriteCV.wait(lock,
+                      [&]() { return mStopWriter || !mPendingWrites.empty(); });
+        if (mPendingWrites.empty())
+        {
+            return;
+        }
+
+        std::deque<PendingWrite> batch;
+        std::swap(batch, mPendingWrites);
+        auto queued = mQueuedWrites;
+        bool failed = static_cast<bool>(mWriteError);
+        lock.unlock();
+
+        std::exception_ptr error;
+        if (!failed)
+        {
+            ZoneScopedN("write checkpoint entries");
+            auto timer = mWriteTimer.TimeScope();
+            try
+            {
+                std::set<XDROutputFileStream*> written;
+                std::set<XDROutputFileStream*> durable;
+                for (auto& write : batch)
+                {
+                    write.mWrite();
+                    written.insert(write.mStream);
+                    if (write.mDurable)
+                    {
+                        durable.insert(write.mStream);
+                    }
+                }
+                for (auto* stream : written)
+                {
+                    stream->flush();
+                    if (durable.find(stream) != durable.end())
+                    {
+                        fs::flushFileChanges(stream->getHandle());
+                    }
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+        batch.clear();
+
+        lock.lock();
+        if (error)
+        {
+            mWriteError = error;
+        }
+        mDurableWrites = queued;
+        mWriteCV.notify_all();
+    }
+}
+
+void
+CheckpointBuilder::waitForWrites()
+{
+    ZoneScoped;
+    auto timer = mWriteWaitTimer.TimeScope();
+    std::unique_lock<std::mutex> lock(mWriteMutex);
+    mWriteCV.wait(lock, [&]() { return mDurableWrites == mQueuedWrites; });
+    if (mWriteError)
+    {
+        std::rethrow_exception(mWriteError);
+    }
 }
 
 void
@@ -52,6 +154,7 @@ CheckpointBuilder::checkpointComplete(uint32_t checkpoint)
         mApp.getHistoryManager().isLastLedgerInCheckpoint(checkpoint));
 
     // This will close and reset the streams
+    waitForWrites();
     mLedgerHeaders.reset();
     mTxs.reset();
     mTxResults.reset();
@@ -86,8 +189,26 @@ CheckpointBuilder::checkpointComplete(uint32_t checkpoint)
     maybeRename(ledger);
 }
 
-CheckpointBuilder::CheckpointBuilder(Application& app) : mApp(app)
+CheckpointBuilder::CheckpointBuilder(Application& app)
+    : mApp(app)
+    , mWriteTimer(app.getMetrics().NewTimer({"history", "checkpoint", "write"}))
+    , mWriteWaitTimer(
+          app.getMetrics().NewTimer({"history", "checkpoint", "write-wait"}))
+{
+}
+
+CheckpointBuilder::~CheckpointBuilder()
 {
+    if (mWriter)
+    {
+        // Pending writes are drained before the writer exits
+        {
+            std::lock_guard<std::mutex> lock(mWriteMutex);
+            mStopWriter = true;
+        }
+        mWriteCV.notify_all();
+        mWriter->join();
+    }
 }
 
 void
@@ -131,8 +252,8 @@ CheckpointBuilder::appendTransactionSet(uint32_t ledgerSeq,
         TransactionHistoryResultEntry results;
         results.ledgerSeq = ledgerSeq;
         results.txResultSet = resultSet;
-        mTxResults->durableWriteOne(results);
-        mTxs->durableWriteOne(txSet);
+        queueWrite(*mTxResults, std::move(results), /* durable */ true);
+        queueWrite(*mTxs, txSet, /* durable */ true);
     }
 }
 
@@ -152,8 +273,8 @@ CheckpointBuilder::appendLedgerHeader(LedgerHeader const& header,
     LedgerHeaderHistoryEntry lhe;
     lhe.header = header;
     lhe.hash = xdrSha256(header);
-    mLedgerHeaders->writeOne(lhe);
-    mLedgerHeaders->flush();
+    // Appended right before commit, fsyncing it would stall ledger close
+    queueWrite(*mLedgerHeaders, std::move(lhe), /* durable */ false);
 }
 
 uint32_t
@@ -182,6 +303,7 @@ CheckpointBuilder::cleanup(uint32_t lcl)
         return;
     }
 
+    waitForWrites();
     mTxResults.reset();
     mTxs.reset();
     mLedgerHeaders.reset();
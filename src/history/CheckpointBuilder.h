@@ -7,6 +7,19 @@
 #include "herder/TxSetFrame.h"
 #include "util/XDRStream.h"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace medida
+{
+class Timer;
+}
+
 namespace stellar
 {
 class Application;
@@ -44,6 +57,15 @@ including the LCL, and truncating the rest (including malformed data). If a
 crash before commit occurrs on a first ledger in a checkpoint, the dirty file is
 simply deleted on startup. This ensures core always starts with a valid publish
 state.
+
+* Appended entries are written by a dedicated writer thread, so that encoding
+and fsyncing them overlaps with the rest of ledger close. The writer drains
+everything queued since its last pass, then flushes each file it wrote once and
+fsyncs the transaction and result files among them (group commit). Ledger
+headers are only flushed, so that the header appended right before commit
+doesn't add an fsync to ledger close. waitForWrites must return before the
+ledger is committed, which keeps the guarantees above; finalizing and
+recovering files wait for it too.
  */
 class CheckpointBuilder
 {
@@ -58,10 +80,36 @@ class CheckpointBuilder
     bool mOpen{false};
     bool mStartupValidationComplete{false};
 
+    struct PendingWrite
+    {
+        XDROutputFileStream* mStream;
+        std::function<void()> mWrite;
+        bool mDurable;
+    };
+
+    // State shared with the writer thread, guarded by mWriteMutex. Streams
+    // are only opened and closed on the main thread while no write is
+    // pending.
+    std::mutex mWriteMutex;
+    std::condition_variable mWriteCV;
+    std::deque<PendingWrite> mPendingWrites;
+    uint64_t mQueuedWrites{0};
+    uint64_t mDurableWrites{0};
+    std::exception_ptr mWriteError;
+    bool mStopWriter{false};
+    std::optional<std::thread> mWriter;
+
+    medida::Timer& mWriteTimer;
+    medida::Timer& mWriteWaitTimer;
+
     void ensureOpen(uint32_t ledgerSeq);
+    template <typename T>
+    void queueWrite(XDROutputFileStream& stream, T&& entry, bool durable);
+    void runWriter();
 
   public:
     CheckpointBuilder(Application& app);
+    ~CheckpointBuilder();
     void appendTransactionSet(uint32_t ledgerSeq,
                               TxSetXDRFrameConstPtr const& txSet,
                               TransactionResultSet const& resultSet,
@@ -73,6 +121,10 @@ class CheckpointBuilder
     void appendLedgerHeader(LedgerHeader const& header,
                             bool skipStartupCheck = false);
 
+    // Block until everything appended so far is durably written to the dirty
+    // checkpoint files. Rethrows any error the writer thread hit.
+    void waitForWrites();
+
     // Cleanup publish files according to the latest LCL.
     // Publish files might contain dirty data if a crash occurred after append
     // but before commit in LedgerManagerImpl::closeLedger
@@ -12,6 +12,7 @@
 #include "bucket/BucketManager.h"
 #include "crypto/Hex.h"
 #include "crypto/SHA.h"
+#include "history/ArchiveFetcher.h"
 #include "history/HistoryManager.h"
 #include "main/Application.h"
 #include "main/StellarCoreVersion.h"
@@ -463,6 +464,19 @@ HistoryArchive::hasGetCmd() const
     return !mConfig.mGetCmd.empty();
 }
 
+bool
+HistoryArchive::hasGetURL() const
+{
+    return !mConfig.mURL.empty() &&
+           ArchiveFetcher::isSupportedURL(mConfig.mURL);
+}
+
+bool
+HistoryArchive::isReadable() const
+{
+    return hasGetURL() || hasGetCmd();
+}
+
 bool
 HistoryArchive::hasPutCmd() const
 {
@@ -490,6 +504,19 @@ HistoryArchive::getFileCmd(std::string const& remote,
     return formatString(mConfig.mGetCmd, remote, local);
 }
 
+std::string
+HistoryArchive::getFileURL(std::string const& remote) const
+{
+    if (!hasGetURL())
+        return "";
+    auto base = mConfig.mURL;
+    while (!base.empty() && base.back() == '/')
+    {
+        base.pop_back();
+    }
+    return base + "/" + remote;
+}
+
 std::string
 HistoryArchive::putFileCmd(std::string const& local,
                            std::string const& remote) const
@@ -156,12 +156,17 @@ class HistoryArchive : public std::enable_shared_from_this<HistoryArchive>
                             HistoryArchiveConfiguration const& config);
     ~HistoryArchive();
     bool hasGetCmd() const;
+    // Whether files are fetched from the archive's `url` by the built-in
+    // ArchiveFetcher rather than with the `get` command
+    bool hasGetURL() const;
+    bool isReadable() const;
     bool hasPutCmd() const;
     bool hasMkdirCmd() const;
     std::string const& getName() const;
 
     std::string getFileCmd(std::string const& remote,
                            std::string const& local) const;
+    std::string getFileURL(std::string const& remote) const;
     std::string putFileCmd(std::string const& local,
                            std::string const& remote) const;
     std::string mkdirCmd(std::string const& remoteDir) const;
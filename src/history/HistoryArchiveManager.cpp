@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "history/HistoryArchiveManager.h"
+#include "history/ArchiveFetcher.h"
 #include "history/HistoryArchive.h"
 #include "history/HistoryArchiveReportWork.h"
 #include "historywork/CheckSingleLedgerHeaderWork.h"
@@ -28,6 +29,10 @@ HistoryArchiveManager::HistoryArchiveManager(Application& app) : mApp{app}
             std::make_shared<HistoryArchive>(app, archiveConfiguration.second));
 }
 
+HistoryArchiveManager::~HistoryArchiveManager()
+{
+}
+
 bool
 HistoryArchiveManager::checkSensibleConfig() const
 {
@@ -39,7 +44,7 @@ HistoryArchiveManager::checkSensibleConfig() const
 
     for (auto const& archive : mArchives)
     {
-        if (archive->hasGetCmd())
+        if (archive->isReadable())
         {
             if (archive->hasPutCmd())
             {
@@ -65,6 +70,29 @@ HistoryArchiveManager::checkSensibleConfig() const
 
     bool badArchives = false;
 
+    for (auto const& item : mApp.getConfig().HISTORY)
+    {
+        auto const& conf = item.second;
+        if (!conf.mURL.empty() && !ArchiveFetcher::isSupportedURL(conf.mURL))
+        {
+            if (conf.mGetCmd.empty())
+            {
+                CLOG_FATAL(History,
+                           "Archive '{}' has url '{}' which can only be "
+                           "fetched with a 'get' command",
+                           conf.mName, conf.mURL);
+                badArchives = true;
+            }
+            else
+            {
+                CLOG_INFO(History,
+                          "Archive '{}' has url '{}' which can't be fetched "
+                          "natively, will use its 'get' command",
+                          conf.mName, conf.mURL);
+            }
+        }
+    }
+
     for (auto const& a : inertArchives)
     {
         CLOG_FATAL(
@@ -136,7 +164,7 @@ HistoryArchiveManager::selectRandomReadableHistoryArchive() const
     std::copy_if(std::begin(mArchives), std::end(mArchives),
                  std::back_inserter(archives),
                  [](std::shared_ptr<HistoryArchive> const& x) {
-                     return x->hasGetCmd() && !x->hasPutCmd();
+                     return x->isReadable() && !x->hasPutCmd();
                  });
 
     // If we have none of those, accept those with get+put
@@ -145,7 +173,7 @@ HistoryArchiveManager::selectRandomReadableHistoryArchive() const
         std::copy_if(std::begin(mArchives), std::end(mArchives),
                      std::back_inserter(archives),
                      [](std::shared_ptr<HistoryArchive> const& x) {
-                         return x->hasGetCmd();
+                         return x->isReadable();
                      });
     }
 
@@ -243,7 +271,7 @@ HistoryArchiveManager::publishEnabled() const
 {
     return std::any_of(std::begin(mArchives), std::end(mArchives),
                        [](std::shared_ptr<HistoryArchive> const& x) {
-                           return x->hasGetCmd() && x->hasPutCmd();
+                           return x->isReadable() && x->hasPutCmd();
                        });
 }
 
@@ -257,6 +285,24 @@ HistoryArchiveManager::getHistoryArchive(std::string const& name) const
     return it == std::end(mArchives) ? nullptr : *it;
 }
 
+ArchiveFetcher&
+HistoryArchiveManager::getArchiveFetcher()
+{
+    if (!mArchiveFetcher)
+    {
+        auto const& cfg = mApp.getConfig();
+        mArchiveFetcher = std::make_unique<ArchiveFetcher>(
+            cfg.HISTORY_FETCH_CONNECTIONS, cfg.HISTORY_FETCH_PIPELINE_DEPTH);
+    }
+    return *mArchiveFetcher;
+}
+
+void
+HistoryArchiveManager::shutdown()
+{
+    mArchiveFetcher.reset();
+}
+
 std::vector<std::shared_ptr<HistoryArchive>>
 HistoryArchiveManager::getWritableHistoryArchives() const
 {
@@ -264,7 +310,7 @@ HistoryArchiveManager::getWritableHistoryArchives() const
     std::copy_if(std::begin(mArchives), std::end(mArchives),
                  std::back_inserter(result),
                  [](std::shared_ptr<HistoryArchive> const& x) {
-                     return x->hasGetCmd() && x->hasPutCmd();
+                     return x->isReadable() && x->hasPutCmd();
                  });
     return result;
 }
@@ -11,6 +11,7 @@
 namespace stellar
 {
 class Application;
+class ArchiveFetcher;
 class Config;
 class HistoryArchive;
 
@@ -21,6 +22,7 @@ class HistoryArchiveManager
 {
   public:
     explicit HistoryArchiveManager(Application& app);
+    ~HistoryArchiveManager();
 
     // Check that config settings are at least somewhat reasonable.
     bool checkSensibleConfig() const;
@@ -54,8 +56,18 @@ class HistoryArchiveManager
     std::vector<std::shared_ptr<HistoryArchive>>
     getWritableHistoryArchives() const;
 
+    // Returns the fetcher used for archives configured with a `url`, started
+    // on first use. Main thread only.
+    ArchiveFetcher& getArchiveFetcher();
+
+    // Stops and joins the fetcher thread, if started. Requests in flight never
+    // complete. Called before the application is destroyed, as the fetch
+    // callbacks post to its main thread.
+    void shutdown();
+
   private:
     Application& mApp;
     std::vector<std::shared_ptr<HistoryArchive>> mArchives;
+    std::unique_ptr<ArchiveFetcher> mArchiveFetcher;
 };
 }
@@ -0,0 +1,139 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "history/HistoryCache.h"
+#include "crypto/Hex.h"
+#include "crypto/Random.h"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "util/Fs.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+
+#include <Tracy.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+namespace stellar
+{
+
+namespace
+{
+bool
+linkOrCopy(std::string const& from, std::string const& to)
+{
+    std::error_code ec;
+    std::filesystem::remove(to, ec);
+    std::filesystem::create_hard_link(from, to, ec);
+    if (ec)
+    {
+        // Different filesystems, or no hard links there
+        ec.clear();
+        std::filesystem::copy_file(from, to, ec);
+    }
+    return !ec;
+}
+}
+
+HistoryCache::HistoryCache(std::string const& dir, Hash const& networkID)
+    : mDir(dir + "/" + binToHex(networkID))
+{
+    releaseAssert(!dir.empty());
+}
+
+std::optional<HistoryCache>
+HistoryCache::forApp(Application& app)
+{
+    auto const& dir = app.getConfig().LOCAL_HISTORY_CACHE_PATH;
+    if (dir.empty())
+    {
+        return std::nullopt;
+    }
+    return std::make_optional<HistoryCache>(dir, app.getNetworkID());
+}
+
+bool
+HistoryCache::isCacheable(FileType type)
+{
+    return type != FileType::HISTORY_FILE_TYPE_BUCKET;
+}
+
+std::string
+HistoryCache::localPath(FileTransferInfo const& ft) const
+{
+    return mDir + "/" + ft.remoteDir() + "/" + ft.baseName_nogz();
+}
+
+bool
+HistoryCache::contains(FileTransferInfo const& ft) const
+{
+    return isCacheable(ft.getType()) && fs::exists(localPath(ft));
+}
+
+bool
+HistoryCache::retrieve(FileTransferInfo const& ft) const
+{
+    ZoneScoped;
+    if (!contains(ft))
+    {
+        return false;
+    }
+    return linkOrCopy(localPath(ft), ft.localPath_nogz());
+}
+
+void
+HistoryCache::store(FileTransferInfo const& ft) const
+{
+    ZoneScoped;
+    releaseAssert(isCacheable(ft.getType()));
+    auto path = localPath(ft);
+    fs::mkpath(mDir + "/" + ft.remoteDir());
+
+    // Add the file under a temporary name first so that the cache never
+    // holds a partial file. The name is unique as several nodes may store
+    // the same file at once.
+    auto tmp = path + "." + binToHex(randomBytes(8)) + ".tmp";
+    if (!linkOrCopy(ft.localPath_nogz(), tmp))
+    {
+        std::remove(tmp.c_str());
+        CLOG_WARNING(History, "Failed to add {} to the history cache",
+                     ft.localPath_nogz());
+        return;
+    }
+    if (!fs::durableRename(tmp, path, mDir + "/" + ft.remoteDir()))
+    {
+        std::remove(tmp.c_str());
+        CLOG_WARNING(History, "Failed to add {} to the history cache",
+                     ft.localPath_nogz());
+    }
+}
+
+void
+HistoryCache::remove(FileTransferInfo const& ft) const
+{
+    if (!isCacheable(ft.getType()))
+    {
+        return;
+    }
+    std::error_code ec;
+    if (std::filesystem::remove(localPath(ft), ec))
+    {
+        CLOG_INFO(History, "Removed {} from the history cache",
+                  ft.baseName_nogz());
+    }
+}
+
+void
+HistoryCache::evict(Application& app, FileTransferInfo const& ft)
+{
+    auto cache = forApp(app);
+    if (!cache || !isCacheable(ft.getType()))
+    {
+        return;
+    }
+    app.postOnBackgroundThread([cache = *cache, ft]() { cache.remove(ft); },
+                               "HistoryCache: evict");
+}
+}
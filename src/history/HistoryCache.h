@@ -0,0 +1,61 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "history/FileTransferInfo.h"
+#include "xdr/Stellar-types.h"
+
+#include <optional>
+#include <string>
+
+namespace stellar
+{
+
+class Application;
+
+// Local directory keeping history checkpoint files decompressed, laid out as
+// in archives (e.g. ledger/00/00/3f/ledger-0000003f.xdr) under a directory per
+// network, so that catchup reuses them instead of downloading and
+// decompressing them again. Buckets are not cached here, the bucket directory
+// already keeps them.
+//
+// Cached files are not verified when retrieved: like downloaded files, they
+// are verified by VerifyLedgerChainWork, VerifyTxResultsWork and
+// ApplyCheckpointWork, which remove the files they reject from the cache.
+// Single ledgers of a cached file can be read through IndexedCheckpointFile,
+// as `dump-xdr --ledger` does.
+//
+// All of the operations below touch the filesystem and may copy whole files,
+// so they should not run on the main thread.
+class HistoryCache
+{
+    std::string const mDir;
+
+  public:
+    HistoryCache(std::string const& dir, Hash const& networkID);
+
+    // The cache configured with LOCAL_HISTORY_CACHE_PATH, if any
+    static std::optional<HistoryCache> forApp(Application& app);
+
+    static bool isCacheable(FileType type);
+
+    std::string localPath(FileTransferInfo const& ft) const;
+    bool contains(FileTransferInfo const& ft) const;
+
+    // Makes the cached file available at ft.localPath_nogz(), as a hard link
+    // or a copy. Returns false if it isn't cached.
+    bool retrieve(FileTransferInfo const& ft) const;
+
+    // Adds the file at ft.localPath_nogz() to the cache
+    void store(FileTransferInfo const& ft) const;
+
+    // Removes the cached file if there is one, so that it is downloaded again
+    void remove(FileTransferInfo const& ft) const;
+
+    // Removes `ft` from the cache of `app`, if it has one, on a background
+    // thread. Called when the file fails verification.
+    static void evict(Application& app, FileTransferInfo const& ft);
+};
+}
@@ -370,6 +370,11 @@ class HistoryManager
                          TransactionResultSet const& resultSet) = 0;
     virtual void appendLedgerHeader(LedgerHeader const& header) = 0;
 
+    // Checkpoint files are appended to in the background; block until
+    // everything appended so far is durable. Must be called before the
+    // appended ledger is committed.
+    virtual void waitForCheckpointWrites() = 0;
+
     // On startup, restore checkpoint files based on the last committed LCL
     virtual void restoreCheckpoint(uint32_t lcl) = 0;
 
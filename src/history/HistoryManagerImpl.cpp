@@ -25,6 +25,7 @@
 #include "ledger/LedgerManager.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/counter.h"
 #include "medida/meter.h"
 #include "medida/metrics_registry.h"
 #include "overlay/StellarXDR.h"
@@ -218,6 +219,8 @@ HistoryManagerImpl::HistoryManagerImpl(Application& app)
           app.getMetrics().NewMeter({"history", "publish", "failure"}, "event"))
     , mEnqueueToPublishTimer(
           app.getMetrics().NewTimer({"history", "publish", "time"}))
+    , mPublishQueueAge(
+          app.getMetrics().NewCounter({"history", "publish", "queue-age"}))
     , mCheckpointBuilder(app)
 {
 }
@@ -242,6 +245,18 @@ HistoryManagerImpl::getCheckpointFrequency() const
 void
 HistoryManagerImpl::logAndUpdatePublishStatus()
 {
+    int64_t age = 0;
+    if (!mEnqueueTimes.empty())
+    {
+        auto oldest = std::min_element(
+            mEnqueueTimes.begin(), mEnqueueTimes.end(),
+            [](auto const& a, auto const& b) { return a.second < b.second; });
+        age = std::chrono::duration_cast<std::chrono::seconds>(
+                  std::chrono::steady_clock::now() - oldest->second)
+                  .count();
+    }
+    mPublishQueueAge.set_count(age);
+
     std::stringstream stateStr;
     if (mPublishWork)
     {
@@ -415,34 +430,41 @@ HistoryManagerImpl::queueCurrentHistory()
 }
 
 void
-HistoryManagerImpl::takeSnapshotAndPublish(HistoryArchiveState const& has)
+HistoryManagerImpl::takeSnapshotsAndPublish(
+    std::vector<HistoryArchiveState> const& states)
 {
     ZoneScoped;
     if (mPublishWork)
     {
         return;
     }
-    // Ensure no merges are in-progress, and capture the bucket list hashes
-    // *before* doing the actual publish. This ensures that the HAS is in
-    // pristine state as returned by the database.
-    for (auto const& bucket : has.currentBuckets)
-    {
-        releaseAssert(!bucket.next.isLive());
-    }
-    auto allBucketsFromHAS = has.allBuckets();
-    auto ledgerSeq = has.currentLedger;
-    CLOG_DEBUG(History, "Activating publish for ledger {}", ledgerSeq);
-    auto snap = std::make_shared<StateSnapshot>(mApp, has);
+    releaseAssert(!states.empty());
 
-    // Phase 1: resolve futures in snapshot
-    auto resolveFutures = std::make_shared<ResolveSnapshotWork>(mApp, snap);
-    // Phase 2: write snapshot files
-    auto writeSnap = std::make_shared<WriteSnapshotWork>(mApp, snap);
-    // Phase 3: update archives
-    auto putSnap = std::make_shared<PutSnapshotFilesWork>(mApp, snap);
+    std::vector<std::shared_ptr<StateSnapshot>> snaps;
+    std::vector<std::vector<std::string>> allBucketsFromHAS;
+    std::vector<std::shared_ptr<BasicWork>> seq;
+    for (auto const& has : states)
+    {
+        // Ensure no merges are in-progress, and capture the bucket list
+        // hashes *before* doing the actual publish. This ensures that the HAS
+        // is in pristine state as returned by the database.
+        for (auto const& bucket : has.currentBuckets)
+        {
+            releaseAssert(!bucket.next.isLive());
+        }
+        allBucketsFromHAS.emplace_back(has.allBuckets());
+        CLOG_DEBUG(History, "Activating publish for ledger {}",
+                   has.currentLedger);
+        auto snap = std::make_shared<StateSnapshot>(mApp, has);
+        snaps.emplace_back(snap);
 
-    std::vector<std::shared_ptr<BasicWork>> seq{resolveFutures, writeSnap,
-                                                putSnap};
+        // Phase 1: resolve futures in snapshot
+        seq.emplace_back(std::make_shared<ResolveSnapshotWork>(mApp, snap));
+        // Phase 2: write snapshot files
+        seq.emplace_back(std::make_shared<WriteSnapshotWork>(mApp, snap));
+    }
+    // Phase 3: update archives, with the files of all snapshots at once
+    seq.emplace_back(std::make_shared<PutSnapshotFilesWork>(mApp, snaps));
 
     auto start = mApp.getClock().now();
     ConditionFn delayTimeout = [start](Application& app) {
@@ -461,7 +483,7 @@ HistoryManagerImpl::takeSnapshotAndPublish(HistoryArchiveState const& has)
     // NB: if WorkScheduler is aborting this returns nullptr, but that
     // which means we don't "really" start publishing.
     auto publishWork =
-        std::make_shared<PublishWork>(mApp, snap, seq, allBucketsFromHAS);
+        std::make_shared<PublishWork>(mApp, snaps, seq, allBucketsFromHAS);
 
     mPublishWork = mApp.getWorkScheduler().scheduleWork<ConditionalWork>(
         "delay-publishing-to-archive", delayTimeout, publishWork);
@@ -485,18 +507,29 @@ HistoryManagerImpl::publishQueuedHistory()
 #endif
 
     ZoneScoped;
-    HistoryArchiveState has;
-    auto seq = getMinLedgerQueuedToPublish();
-
-    if (seq == std::numeric_limits<uint32_t>::max())
+    // Publish the oldest queued checkpoints, which are consecutive as older
+    // ones are always published first
+    std::vector<uint32_t> queued;
+    forEveryQueuedCheckpoint(
+        publishQueuePath(mApp.getConfig()).string(),
+        [&](uint32_t seq, std::string const& f) { queued.emplace_back(seq); });
+    if (queued.empty())
     {
         return 0;
     }
+    std::sort(queued.begin(), queued.end());
+    queued.resize(std::min<size_t>(
+        queued.size(), mApp.getConfig().MAX_CHECKPOINTS_PER_PUBLISH));
 
-    auto file = publishQueuePath(mApp.getConfig()) / publishQueueFileName(seq);
-    has.load(file.string());
-    takeSnapshotAndPublish(has);
-    return 1;
+    std::vector<HistoryArchiveState> states(queued.size());
+    for (size_t i = 0; i < queued.size(); ++i)
+    {
+        auto file = publishQueuePath(mApp.getConfig()) /
+                    publishQueueFileName(queued[i]);
+        states[i].load(file.string());
+    }
+    takeSnapshotsAndPublish(states);
+    return states.size();
 }
 
 void
@@ -679,6 +712,15 @@ HistoryManagerImpl::appendLedgerHeader(LedgerHeader const& header)
     }
 }
 
+void
+HistoryManagerImpl::waitForCheckpointWrites()
+{
+    if (mApp.getHistoryArchiveManager().publishEnabled())
+    {
+        mCheckpointBuilder.waitForWrites();
+    }
+}
+
 void
 HistoryManagerImpl::restoreCheckpoint(uint32_t lcl)
 {
@@ -13,6 +13,7 @@
 
 namespace medida
 {
+class Counter;
 class Meter;
 class Timer;
 }
@@ -38,6 +39,9 @@ class HistoryManagerImpl : public HistoryManager
 
     medida::Timer& mEnqueueToPublishTimer;
     UnorderedMap<uint32_t, std::chrono::steady_clock::time_point> mEnqueueTimes;
+    // Seconds since the oldest checkpoint queued by this process and not
+    // published yet was queued
+    medida::Counter& mPublishQueueAge;
     CheckpointBuilder mCheckpointBuilder;
 
     PublishQueueBuckets::BucketCount loadBucketsReferencedByPublishQueue();
@@ -59,7 +63,10 @@ class HistoryManagerImpl : public HistoryManager
 
     void queueCurrentHistory() override;
 
-    void takeSnapshotAndPublish(HistoryArchiveState const& has);
+    // Publishes the consecutive queued checkpoints described by `states`
+    // together
+    void
+    takeSnapshotsAndPublish(std::vector<HistoryArchiveState> const& states);
 
     uint32_t getMinLedgerQueuedToPublish() override;
 
@@ -84,6 +91,7 @@ class HistoryManagerImpl : public HistoryManager
                               TxSetXDRFrameConstPtr const& txSet,
                               TransactionResultSet const& resultSet) override;
     void appendLedgerHeader(LedgerHeader const& header) override;
+    void waitForCheckpointWrites() override;
     void restoreCheckpoint(uint32_t lcl) override;
     void deletePublishedFiles(uint32_t ledgerSeq, Config const& cfg) override;
 
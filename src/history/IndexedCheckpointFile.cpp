@@ -0,0 +1,98 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "history/IndexedCheckpointFile.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <Tracy.hpp>
+#include <fmt/format.h>
+
+namespace stellar
+{
+
+namespace
+{
+uint32_t
+readUint32(uint8_t const* buf)
+{
+    return (static_cast<uint32_t>(buf[0]) << 24) |
+           (static_cast<uint32_t>(buf[1]) << 16) |
+           (static_cast<uint32_t>(buf[2]) << 8) | static_cast<uint32_t>(buf[3]);
+}
+
+uint32_t
+readXDRSize(uint8_t const* buf)
+{
+    // 4 bytes of size, big-endian, with XDR 'continuation' bit cleared (high
+    // bit of high byte)
+    return readUint32(buf) & 0x7fffffff;
+}
+
+uint32_t
+entryLedgerSeq(FileType type, uint8_t const* start, uint8_t const* end)
+{
+    switch (type)
+    {
+    case FileType::HISTORY_FILE_TYPE_LEDGER:
+    {
+        LedgerHeaderHistoryEntry entry;
+        xdr::xdr_get g(start, end);
+        xdr::xdr_argpack_archive(g, entry);
+        return entry.header.ledgerSeq;
+    }
+    case FileType::HISTORY_FILE_TYPE_TRANSACTIONS:
+    case FileType::HISTORY_FILE_TYPE_RESULTS:
+    {
+        // Both TransactionHistoryEntry and TransactionHistoryResultEntry start
+        // with the ledger sequence, no need to decode the rest
+        if (end - start < 4)
+        {
+            throw xdr::xdr_runtime_error("truncated history entry");
+        }
+        return readUint32(start);
+    }
+    case FileType::HISTORY_FILE_TYPE_SCP:
+    {
+        SCPHistoryEntry entry;
+        xdr::xdr_get g(start, end);
+        xdr::xdr_argpack_archive(g, entry);
+        return entry.v0().ledgerMessages.ledgerSeq;
+    }
+    default:
+        throw std::runtime_error("not a checkpoint file type");
+    }
+}
+}
+
+IndexedCheckpointFile::IndexedCheckpointFile(std::string const& path,
+                                             FileType type)
+    : mFile(path)
+{
+    ZoneScoped;
+    size_t pos = 0;
+    while (pos < mFile.size())
+    {
+        if (mFile.size() - pos < 4)
+        {
+            throw xdr::xdr_runtime_error(
+                fmt::format("truncated record in {}", path));
+        }
+        size_t sz = readXDRSize(mFile.data() + pos);
+        pos += 4;
+        if (mFile.size() - pos < sz)
+        {
+            throw xdr::xdr_runtime_error(
+                fmt::format("truncated record in {}", path));
+        }
+        auto const* start = mFile.data() + pos;
+        auto seq = entryLedgerSeq(type, start, start + sz);
+        if (!mIndex.emplace(seq, std::make_pair(pos, sz)).second)
+        {
+            throw std::runtime_error(
+                fmt::format("duplicate entry for ledger {} in {}", seq, path));
+        }
+        pos += sz;
+    }
+}
+}
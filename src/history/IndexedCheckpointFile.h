@@ -0,0 +1,61 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "history/FileTransferInfo.h"
+#include "util/MappedFile.h"
+#include "util/NonCopyable.h"
+#include "util/UnorderedMap.h"
+#include "xdrpp/marshal.h"
+
+#include <string>
+
+namespace stellar
+{
+
+// Random access to the per-ledger entries of a decompressed checkpoint file
+// (ledger headers, transactions, results or SCP messages), such as the files
+// kept by the local history cache. The file is mapped in memory and indexed
+// by ledger sequence once, on construction; loading an entry then only
+// decodes that entry. Throws if the file is malformed.
+class IndexedCheckpointFile : NonMovableOrCopyable
+{
+    MappedFile mFile;
+    // Offset and size of each entry, by ledger sequence
+    UnorderedMap<uint32_t, std::pair<size_t, size_t>> mIndex;
+
+  public:
+    IndexedCheckpointFile(std::string const& path, FileType type);
+
+    bool
+    contains(uint32_t ledgerSeq) const
+    {
+        return mIndex.find(ledgerSeq) != mIndex.end();
+    }
+
+    size_t
+    size() const
+    {
+        return mIndex.size();
+    }
+
+    // Loads the entry of `ledgerSeq`, returns false if there is none (like
+    // the transactions of an empty ledger)
+    template <typename T>
+    bool
+    load(uint32_t ledgerSeq, T& out) const
+    {
+        auto it = mIndex.find(ledgerSeq);
+        if (it == mIndex.end())
+        {
+            return false;
+        }
+        auto const* start = mFile.data() + it->second.first;
+        xdr::xdr_get g(start, start + it->second.second);
+        xdr::xdr_argpack_archive(g, out);
+        return true;
+    }
+};
+}
@@ -0,0 +1,453 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+// ASIO is somewhat particular about when it gets included -- it wants to be the
+// first to include <windows.h> -- so we try to include it before everything
+// else.
+#include "util/asio.h"
+#include "history/ArchiveFetcher.h"
+#include "history/HistoryArchive.h"
+#include "history/HistoryArchiveManager.h"
+#include "historywork/GetRemoteFileWork.h"
+#include "lib/catch.hpp"
+#include "main/Application.h"
+#include "test/TestUtils.h"
+#include "test/test.h"
+#include "util/Fs.h"
+#include "util/TmpDir.h"
+#include "work/WorkScheduler.h"
+
+#include <atomic>
+#include <fmt/format.h>
+#include <fstream>
+#include <future>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+using namespace stellar;
+
+namespace
+{
+
+// Minimal HTTP/1.1 server standing in for an archive host. It serves files
+// from a directory, keeps connections alive, answers pipelined requests in
+// order and honours `Range: bytes=N-`.
+class StandInServer
+{
+    class Session : public std::enable_shared_from_this<Session>
+    {
+        StandInServer& mServer;
+        asio::ip::tcp::socket mSocket;
+        asio::streambuf mBuf;
+        std::string mOut;
+        size_t mServed{0};
+
+      public:
+        Session(StandInServer& server, asio::ip::tcp::socket socket)
+            : mServer(server), mSocket(std::move(socket))
+        {
+        }
+
+        void
+        readRequest()
+        {
+            auto self = shared_from_this();
+            asio::async_read_until(
+                mSocket, mBuf, "\r\n\r\n",
+                [self](asio::error_code const& ec, size_t) {
+                    if (!ec)
+                    {
+                        self->respond();
+                    }
+                });
+        }
+
+        void
+        respond()
+        {
+            std::istream in(&mBuf);
+            std::string line, method, target;
+            std::getline(in, line);
+            std::istringstream(line) >> method >> target;
+            std::optional<size_t> rangeStart;
+            while (std::getline(in, line) && line != "\r")
+            {
+                if (line.rfind("Range: bytes=", 0) == 0)
+                {
+                    rangeStart = std::stoull(line.substr(13));
+                    ++mServer.mRangeRequests;
+                }
+            }
+
+            bool close = mServer.mCloseAfter != 0 &&
+                         ++mServed >= mServer.mCloseAfter;
+            std::string connection = close ? "Connection: close\r\n" : "";
+
+            std::ifstream file(mServer.mRoot + target, std::ios::binary);
+            if (!file)
+            {
+                mOut = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n" +
+                       connection + "\r\n";
+            }
+            else
+            {
+                std::string body((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+                std::string status = "200 OK";
+                std::string range;
+                if (rangeStart && *rangeStart < body.size())
+                {
+                    status = "206 Partial Content";
+                    range = fmt::format("Content-Range: bytes {}-{}/{}\r\n",
+                                        *rangeStart, body.size() - 1,
+                                        body.size());
+                    body = body.substr(*rangeStart);
+                }
+
+                if (mServer.mTruncateNext.exchange(false))
+                {
+                    // Announce the whole body but drop the connection
+                    // halfway through it
+                    mOut = fmt::format("HTTP/1.1 {}\r\n{}Content-Length: "
+                                       "{}\r\n\r\n",
+                                       status, range, body.size()) +
+                           body.substr(0, body.size() / 2);
+                    close = true;
+                }
+                else if (mServer.mChunked)
+                {
+                    mOut = fmt::format("HTTP/1.1 {}\r\n{}{}Transfer-Encoding: "
+                                       "chunked\r\n\r\n",
+                                       status, range, connection);
+                    for (size_t i = 0; i < body.size(); i += 1000)
+                    {
+                        auto chunk = body.substr(i, 1000);
+                        mOut += fmt::format("{:x};ext=1\r\n", chunk.size()) +
+                                chunk + "\r\n";
+                    }
+                    mOut += "0\r\nX-Trailer: 1\r\n\r\n";
+                }
+                else
+                {
+                    mOut = fmt::format("HTTP/1.1 {}\r\n{}{}Content-Length: "
+                                       "{}\r\n\r\n",
+                                       status, range, connection,
+                                       body.size()) +
+                           body;
+                }
+            }
+
+            if (mServer.mInterim)
+            {
+                mOut = "HTTP/1.1 100 Continue\r\n\r\n" + mOut;
+            }
+
+            auto self = shared_from_this();
+            asio::async_write(
+                mSocket, asio::buffer(mOut),
+                [self, close](asio::error_code const& ec, size_t) {
+                    if (ec)
+                    {
+                        return;
+                    }
+                    if (close)
+                    {
+                        asio::error_code ignored;
+                        self->mSocket.shutdown(
+                            asio::ip::tcp::socket::shutdown_both, ignored);
+                        self->mSocket.close(ignored);
+                        return;
+                    }
+                    self->readRequest();
+                });
+        }
+    };
+
+    asio::io_context mIOContext;
+    asio::ip::tcp::acceptor mAcceptor;
+    std::thread mThread;
+
+    void
+    accept()
+    {
+        mAcceptor.async_accept(
+            [this](asio::error_code const& ec, asio::ip::tcp::socket socket) {
+                if (ec)
+                {
+                    return;
+                }
+                ++mConnections;
+                std::make_shared<Session>(*this, std::move(socket))
+                    ->readRequest();
+                accept();
+            });
+    }
+
+  public:
+    std::string const mRoot;
+    // Close connections after this many responses, 0 to keep them open
+    size_t mCloseAfter{0};
+    bool mChunked{false};
+    // Precede each response with a 100 Continue
+    bool mInterim{false};
+    std::atomic<bool> mTruncateNext{false};
+    std::atomic<size_t> mConnections{0};
+    std::atomic<size_t> mRangeRequests{0};
+
+    explicit StandInServer(std::string const& root)
+        : mAcceptor(mIOContext, asio::ip::tcp::endpoint(
+                                    asio::ip::address_v4::loopback(), 0))
+        , mRoot(root)
+    {
+    }
+
+    ~StandInServer()
+    {
+        mIOContext.stop();
+        if (mThread.joinable())
+        {
+            mThread.join();
+        }
+    }
+
+    void
+    start()
+    {
+        accept();
+        mThread = std::thread([this]() { mIOContext.run(); });
+    }
+
+    std::string
+    getURL() const
+    {
+        return fmt::format("http://127.0.0.1:{}",
+                           mAcceptor.local_endpoint().port());
+    }
+};
+
+std::string
+makeContents(size_t i)
+{
+    std::string s;
+    for (size_t j = 0; j < 1000 + 997 * i; ++j)
+    {
+        s.push_back(static_cast<char>('a' + (i + j) % 26));
+    }
+    return s;
+}
+
+std::string
+readFile(std::string const& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)),
+                       std::istreambuf_iterator<char>());
+}
+
+// Fetches `count` files from `baseURL`, and checks their contents
+void
+fetchAll(ArchiveFetcher& fetcher, std::string const& baseURL,
+         std::string const& localDir, size_t count)
+{
+    std::vector<std::promise<std::string>> results(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        fetcher.fetch(fmt::format("{}/file-{}", baseURL, i),
+                      fmt::format("{}/file-{}", localDir, i),
+                      [&results, i](std::string const& error) {
+                          results[i].set_value(error);
+                      });
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        REQUIRE(results[i].get_future().get() == "");
+        REQUIRE(readFile(fmt::format("{}/file-{}", localDir, i)) ==
+                makeContents(i));
+    }
+}
+}
+
+TEST_CASE("archive fetcher URLs", "[history][fetcher]")
+{
+    REQUIRE(ArchiveFetcher::isSupportedURL("http://history.example.org"));
+    REQUIRE(ArchiveFetcher::isSupportedURL("http://127.0.0.1:8000/a/b"));
+    REQUIRE(ArchiveFetcher::isSupportedURL("file:///var/lib/history"));
+    REQUIRE(!ArchiveFetcher::isSupportedURL("https://history.example.org"));
+    REQUIRE(!ArchiveFetcher::isSupportedURL("http://:80/"));
+    REQUIRE(!ArchiveFetcher::isSupportedURL("http://host:port/"));
+    REQUIRE(!ArchiveFetcher::isSupportedURL("file://relative/path"));
+    REQUIRE(!ArchiveFetcher::isSupportedURL("/var/lib/history"));
+}
+
+TEST_CASE("archive fetcher over http", "[history][fetcher]")
+{
+    TmpDir remote("fetcher-remote");
+    TmpDir local("fetcher-local");
+    size_t const numFiles = 40;
+    for (size_t i = 0; i < numFiles; ++i)
+    {
+        std::ofstream out(fmt::format("{}/file-{}", remote.getName(), i),
+                          std::ios::binary);
+        out << makeContents(i);
+    }
+
+    StandInServer server(remote.getName());
+    size_t const connections = 4;
+    ArchiveFetcher fetcher(connections, /* pipelineDepth */ 3,
+                           std::chrono::seconds(10));
+
+    SECTION("connections are reused")
+    {
+        server.start();
+        fetchAll(fetcher, server.getURL(), local.getName(), numFiles);
+        // A second round reuses the idle connections
+        fetchAll(fetcher, server.getURL(), local.getName(), numFiles);
+        REQUIRE(server.mConnections <= connections);
+        REQUIRE(fetcher.getConnectionsOpened() == server.mConnections);
+    }
+
+    SECTION("chunked responses")
+    {
+        server.mChunked = true;
+        server.start();
+        fetchAll(fetcher, server.getURL(), local.getName(), numFiles);
+    }
+
+    SECTION("interim responses")
+    {
+        server.mInterim = true;
+        server.start();
+        fetchAll(fetcher, server.getURL(), local.getName(), numFiles);
+    }
+
+    SECTION("server closing connections")
+    {
+        server.mCloseAfter = 2;
+        server.start();
+        fetchAll(fetcher, server.getURL(), local.getName(), numFiles);
+        REQUIRE(server.mConnections >= numFiles / 2);
+    }
+
+    SECTION("interrupted transfer resumes")
+    {
+        server.mTruncateNext = true;
+        server.start();
+        fetchAll(fetcher, server.getURL(), local.getName(), 1);
+        REQUIRE(server.mRangeRequests == 1);
+    }
+
+    SECTION("missing file")
+    {
+        server.start();
+        std::promise<std::string> result;
+        fetcher.fetch(server.getURL() + "/missing",
+                      local.getName() + "/missing",
+                      [&result](std::string const& error) {
+                          result.set_value(error);
+                      });
+        auto error = result.get_future().get();
+        REQUIRE(error.find("HTTP 404") != std::string::npos);
+
+        // The connection is still usable
+        fetchAll(fetcher, server.getURL(), local.getName(), 1);
+        REQUIRE(server.mConnections == 1);
+    }
+
+    SECTION("cancelled request")
+    {
+        // Whether the fetcher sees the cancellation before sending the
+        // request or once the response comes, nothing is written
+        std::promise<std::string> result;
+        auto handle = fetcher.fetch(server.getURL() + "/file-0",
+                                    local.getName() + "/file-0",
+                                    [&result](std::string const& error) {
+                                        result.set_value(error);
+                                    });
+        handle.cancel();
+        server.start();
+        REQUIRE(result.get_future().get() == "cancelled");
+        REQUIRE(!fs::exists(local.getName() + "/file-0"));
+
+        // The connection is still usable
+        fetchAll(fetcher, server.getURL(), local.getName(), 1);
+    }
+
+    SECTION("unreachable server")
+    {
+        std::string url;
+        {
+            // Nothing accepts connections on the port once it's gone
+            StandInServer gone(remote.getName());
+            url = gone.getURL();
+        }
+        std::promise<std::string> result;
+        fetcher.fetch(url + "/file-0", local.getName() + "/file-0",
+                      [&result](std::string const& error) {
+                          result.set_value(error);
+                      });
+        REQUIRE(result.get_future().get() != "");
+    }
+}
+
+TEST_CASE("archive fetcher from file url", "[history][fetcher]")
+{
+    TmpDir remote("fetcher-remote");
+    TmpDir local("fetcher-local");
+    for (size_t i = 0; i < 3; ++i)
+    {
+        std::ofstream out(fmt::format("{}/file-{}", remote.getName(), i),
+                          std::ios::binary);
+        out << makeContents(i);
+    }
+
+    ArchiveFetcher fetcher(1, 1);
+    fetchAll(fetcher, "file://" + remote.getName(), local.getName(), 3);
+
+    std::promise<std::string> result;
+    fetcher.fetch("file://" + remote.getName() + "/missing",
+                  local.getName() + "/missing",
+                  [&result](std::string const& error) {
+                      result.set_value(error);
+                  });
+    REQUIRE(result.get_future().get() != "");
+}
+
+TEST_CASE("GetRemoteFileWork with archive url", "[history][fetcher]")
+{
+    TmpDir remote("fetcher-remote");
+    TmpDir local("fetcher-local");
+    {
+        std::ofstream out(remote.getName() + "/file-0", std::ios::binary);
+        out << makeContents(0);
+    }
+    StandInServer server(remote.getName());
+    server.start();
+
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.HISTORY.clear();
+    cfg.HISTORY["web"] =
+        HistoryArchiveConfiguration{"web", "", "", "", server.getURL()};
+    auto app = createTestApplication(clock, cfg);
+
+    auto archive = app->getHistoryArchiveManager().getHistoryArchive("web");
+    REQUIRE(archive);
+    REQUIRE(archive->hasGetURL());
+    REQUIRE(archive->isReadable());
+
+    auto& wm = app->getWorkScheduler();
+    auto good = wm.executeWork<GetRemoteFileWork>(
+        "file-0", local.getName() + "/file-0", archive, BasicWork::RETRY_NEVER);
+    REQUIRE(good->getState() == BasicWork::State::WORK_SUCCESS);
+    REQUIRE(readFile(local.getName() + "/file-0") == makeContents(0));
+    // Fetches go through a temporary file, renamed once complete
+    REQUIRE(!fs::exists(local.getName() + "/file-0.0.tmp"));
+
+    auto bad = wm.executeWork<GetRemoteFileWork>(
+        "missing", local.getName() + "/missing", archive,
+        BasicWork::RETRY_NEVER);
+    REQUIRE(bad->getState() == BasicWork::State::WORK_FAILURE);
+    REQUIRE(!fs::exists(local.getName() + "/missing"));
+}
@@ -5,11 +5,15 @@
 #include "bucket/BucketManager.h"
 #include "bucket/test/BucketTestUtils.h"
 #include "catchup/CatchupManagerImpl.h"
+#include "catchup/ParallelCatchupWork.h"
 #include "catchup/test/CatchupWorkTests.h"
+#include "crypto/SHA.h"
 #include "history/CheckpointBuilder.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryArchiveManager.h"
+#include "history/HistoryCache.h"
 #include "history/HistoryManagerImpl.h"
+#include "history/IndexedCheckpointFile.h"
 #include "history/test/HistoryTestsUtils.h"
 #include "historywork/GetHistoryArchiveStateWork.h"
 #include "historywork/GunzipFileWork.h"
@@ -25,13 +29,18 @@
 #include "test/test.h"
 #include "util/Fs.h"
 #include "util/Logging.h"
+#include "util/XDRStream.h"
 #include "work/WorkScheduler.h"
 
 #include "historywork/BatchDownloadWork.h"
 #include "historywork/DownloadBucketsWork.h"
 #include "historywork/DownloadVerifyTxResultsWork.h"
 #include "historywork/VerifyTxResultsWork.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
 #include <fmt/format.h>
+#include <fstream>
+#include <iterator>
 #include <lib/catch.hpp>
 
 using namespace stellar;
@@ -105,6 +114,249 @@ TEST_CASE("HistoryManager compress", "[history]")
     REQUIRE(!fs::exists(compressed));
 }
 
+TEST_CASE("HistoryManager gunzip verifies hash", "[history]")
+{
+    CatchupSimulation catchupSimulation{};
+
+    std::string s = "hello there";
+    HistoryManager& hm = catchupSimulation.getApp().getHistoryManager();
+    std::string fname = hm.localFilename("compressme");
+    {
+        std::ofstream out;
+        out.exceptions(std::ios::failbit | std::ios::badbit);
+        out.open(fname, std::ofstream::binary);
+        out.write(s.data(), s.size());
+    }
+    std::string compressed = fname + ".gz";
+    auto& wm = catchupSimulation.getApp().getWorkScheduler();
+    auto g = wm.executeWork<GzipFileWork>(fname);
+    REQUIRE(g->getState() == BasicWork::State::WORK_SUCCESS);
+
+    SECTION("matching hash")
+    {
+        auto u = wm.executeWork<GunzipFileWork>(
+            compressed, false, BasicWork::RETRY_NEVER, sha256(s));
+        REQUIRE(u->getState() == BasicWork::State::WORK_SUCCESS);
+        REQUIRE(fs::exists(fname));
+        REQUIRE(!fs::exists(compressed));
+    }
+    SECTION("mismatched hash")
+    {
+        auto u = wm.executeWork<GunzipFileWork>(
+            compressed, false, BasicWork::RETRY_NEVER, sha256("hello"));
+        REQUIRE(u->getState() == BasicWork::State::WORK_FAILURE);
+        REQUIRE(!fs::exists(fname));
+        REQUIRE(fs::exists(compressed));
+    }
+    SECTION("truncated file")
+    {
+        auto size = fs::size(compressed);
+        std::filesystem::resize_file(compressed, size - 4);
+        auto u = wm.executeWork<GunzipFileWork>(compressed);
+        REQUIRE(u->getState() == BasicWork::State::WORK_FAILURE);
+        REQUIRE(!fs::exists(fname));
+    }
+}
+
+TEST_CASE("XDRInputFileStream reads gzipped files", "[history]")
+{
+    CatchupSimulation catchupSimulation{};
+    auto& app = catchupSimulation.getApp();
+    std::string fname = app.getHistoryManager().localFilename("entries.xdr");
+
+    std::vector<LedgerHeaderHistoryEntry> entries(10);
+    for (uint32_t i = 0; i < entries.size(); ++i)
+    {
+        entries[i].header.ledgerSeq = i + 1;
+    }
+    {
+        XDROutputFileStream out(app.getClock().getIOContext(),
+                                /*fsyncOnClose=*/false);
+        out.open(fname);
+        for (auto const& e : entries)
+        {
+            out.writeOne(e);
+        }
+    }
+
+    auto g = app.getWorkScheduler().executeWork<GzipFileWork>(
+        fname, /* keepExisting */ true);
+    REQUIRE(g->getState() == BasicWork::State::WORK_SUCCESS);
+    REQUIRE(fs::exists(fname));
+    REQUIRE(fs::exists(fname + ".gz"));
+
+    for (auto const& f : {fname, fname + ".gz"})
+    {
+        XDRInputFileStream in;
+        in.open(f);
+        LedgerHeaderHistoryEntry e;
+        size_t n = 0;
+        while (in.readOne(e))
+        {
+            REQUIRE(n < entries.size());
+            REQUIRE(e == entries[n]);
+            ++n;
+        }
+        REQUIRE(n == entries.size());
+    }
+}
+
+TEST_CASE("local history cache", "[history]")
+{
+    CatchupSimulation catchupSimulation{};
+    auto& app = catchupSimulation.getApp();
+    auto& hm = app.getHistoryManager();
+    auto downloadDir = app.getTmpDirManager().tmpDir("download");
+    auto cacheDir = app.getTmpDirManager().tmpDir("cache");
+    HistoryCache cache(cacheDir.getName(), app.getNetworkID());
+
+    uint32_t const checkpoint = hm.checkpointContainingLedger(100);
+    FileTransferInfo ft(downloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
+                        checkpoint);
+    REQUIRE(!cache.contains(ft));
+    REQUIRE(!cache.retrieve(ft));
+
+    {
+        XDROutputFileStream out(app.getClock().getIOContext(),
+                                /*fsyncOnClose=*/false);
+        out.open(ft.localPath_nogz());
+        for (uint32_t seq = hm.firstLedgerInCheckpointContaining(checkpoint);
+             seq <= checkpoint; ++seq)
+        {
+            LedgerHeaderHistoryEntry header;
+            header.header.ledgerSeq = seq;
+            header.hash = HashUtils::pseudoRandomForTesting();
+            out.writeOne(header);
+        }
+    }
+    auto readFile = [](std::string const& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+    auto contents = readFile(ft.localPath_nogz());
+    cache.store(ft);
+    REQUIRE(cache.contains(ft));
+
+    SECTION("retrieve")
+    {
+        std::remove(ft.localPath_nogz().c_str());
+        REQUIRE(cache.retrieve(ft));
+        REQUIRE(readFile(ft.localPath_nogz()) == contents);
+    }
+
+    SECTION("separate per network")
+    {
+        HistoryCache other(cacheDir.getName(),
+                           sha256(std::string("another network")));
+        REQUIRE(!other.contains(ft));
+        REQUIRE(!other.retrieve(ft));
+    }
+
+    SECTION("remove")
+    {
+        cache.remove(ft);
+        REQUIRE(!cache.contains(ft));
+        REQUIRE(fs::exists(ft.localPath_nogz()));
+    }
+}
+
+TEST_CASE("indexed checkpoint files", "[history]")
+{
+    CatchupSimulation catchupSimulation{};
+    auto& app = catchupSimulation.getApp();
+    auto& hm = app.getHistoryManager();
+    auto downloadDir = app.getTmpDirManager().tmpDir("download");
+    auto cacheDir = app.getTmpDirManager().tmpDir("cache");
+    HistoryCache cache(cacheDir.getName(), app.getNetworkID());
+
+    uint32_t const checkpoint = hm.checkpointContainingLedger(100);
+    uint32_t const first = hm.firstLedgerInCheckpointContaining(checkpoint);
+    FileTransferInfo ledgerFt(downloadDir, FileType::HISTORY_FILE_TYPE_LEDGER,
+                              checkpoint);
+    FileTransferInfo txFt(downloadDir, FileType::HISTORY_FILE_TYPE_TRANSACTIONS,
+                          checkpoint);
+
+    std::vector<LedgerHeaderHistoryEntry> headers;
+    std::vector<TransactionHistoryEntry> txs;
+    {
+        XDROutputFileStream ledgerOut(app.getClock().getIOContext(),
+                                      /*fsyncOnClose=*/false);
+        XDROutputFileStream txOut(app.getClock().getIOContext(),
+                                  /*fsyncOnClose=*/false);
+        ledgerOut.open(ledgerFt.localPath_nogz());
+        txOut.open(txFt.localPath_nogz());
+        for (uint32_t seq = first; seq <= checkpoint; ++seq)
+        {
+            LedgerHeaderHistoryEntry header;
+            header.header.ledgerSeq = seq;
+            header.hash = HashUtils::pseudoRandomForTesting();
+            ledgerOut.writeOne(header);
+            headers.emplace_back(header);
+
+            // Leave some ledgers without transactions
+            if (seq % 3 == 0)
+            {
+                TransactionHistoryEntry tx;
+                tx.ledgerSeq = seq;
+                tx.txSet.previousLedgerHash =
+                    HashUtils::pseudoRandomForTesting();
+                txOut.writeOne(tx);
+                txs.emplace_back(tx);
+            }
+        }
+    }
+    cache.store(ledgerFt);
+    cache.store(txFt);
+
+    SECTION("load entries by ledger")
+    {
+        IndexedCheckpointFile ledgers(cache.localPath(ledgerFt),
+                                      FileType::HISTORY_FILE_TYPE_LEDGER);
+        REQUIRE(ledgers.size() == headers.size());
+        for (auto const& expected : headers)
+        {
+            LedgerHeaderHistoryEntry header;
+            REQUIRE(ledgers.load(expected.header.ledgerSeq, header));
+            REQUIRE(header == expected);
+        }
+        LedgerHeaderHistoryEntry header;
+        REQUIRE(!ledgers.load(checkpoint + 1, header));
+
+        IndexedCheckpointFile transactions(
+            cache.localPath(txFt), FileType::HISTORY_FILE_TYPE_TRANSACTIONS);
+        REQUIRE(transactions.size() == txs.size());
+        for (uint32_t seq = first; seq <= checkpoint; ++seq)
+        {
+            REQUIRE(transactions.contains(seq) == (seq % 3 == 0));
+        }
+        for (auto const& expected : txs)
+        {
+            TransactionHistoryEntry tx;
+            REQUIRE(transactions.load(expected.ledgerSeq, tx));
+            REQUIRE(tx == expected);
+        }
+    }
+
+    SECTION("malformed file")
+    {
+        auto path = ledgerFt.localPath_nogz();
+        std::filesystem::resize_file(path,
+                                     std::filesystem::file_size(path) - 1);
+        REQUIRE_THROWS_AS(
+            IndexedCheckpointFile(path, FileType::HISTORY_FILE_TYPE_LEDGER),
+            xdr::xdr_runtime_error);
+    }
+
+    SECTION("missing file")
+    {
+        cache.remove(ledgerFt);
+        REQUIRE_THROWS_AS(
+            IndexedCheckpointFile(cache.localPath(ledgerFt),
+                                  FileType::HISTORY_FILE_TYPE_LEDGER),
+            FileSystemException);
+    }
+}
+
 TEST_CASE("HistoryArchiveState get_put", "[history]")
 {
     CatchupSimulation catchupSimulation{};
@@ -614,6 +866,34 @@ TEST_CASE("History catchup with extra validation", "[history][publish]")
     REQUIRE(catchupSimulation.catchupOffline(app, checkpointLedger, true));
 }
 
+TEST_CASE("History catchup in parallel segments", "[history][catchup]")
+{
+    CatchupSimulation catchupSimulation{};
+    auto checkpointLedger = catchupSimulation.getLastCheckpointLedger(4);
+    catchupSimulation.ensureOfflineCatchupPossible(checkpointLedger);
+
+    auto app = catchupSimulation.createCatchupApplication(
+        std::numeric_limits<uint32_t>::max(),
+        Config::TESTDB_BUCKET_DB_PERSISTENT, "app");
+
+    CatchupConfiguration configuration{
+        checkpointLedger, std::numeric_limits<uint32_t>::max(),
+        CatchupConfiguration::Mode::OFFLINE_BASIC};
+    auto segments = ParallelCatchupWork::splitRange(
+        app->getLedgerManager().getLastClosedLedgerNum(), configuration, 3,
+        app->getHistoryManager());
+    REQUIRE(segments.size() == 3);
+
+    app->getLedgerManager().startCatchup(segments.back(), nullptr, {});
+    segments.pop_back();
+    auto work = app->getWorkScheduler().executeWork<ParallelCatchupWork>(
+        segments, nullptr);
+    REQUIRE(work->getState() == BasicWork::State::WORK_SUCCESS);
+    REQUIRE(app->getLedgerManager().getLastClosedLedgerNum() ==
+            checkpointLedger);
+    catchupSimulation.validateCatchup(app);
+}
+
 TEST_CASE("Publish works correctly post shadow removal", "[history]")
 {
     // Given a HAS, verify that appropriate levels have "next" cleared, while
@@ -1409,6 +1689,59 @@ TEST_CASE("persist publish queue", "[history][publish][acceptance]")
     }
 }
 
+TEST_CASE("publish queued checkpoints together", "[history][publish]")
+{
+    Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT));
+
+    cfg.MANUAL_CLOSE = false;
+    cfg.MAX_CONCURRENT_SUBPROCESSES = 0;
+    cfg.ARTIFICIALLY_ACCELERATE_TIME_FOR_TESTING = true;
+    TmpDirHistoryConfigurator tcfg;
+    cfg = tcfg.configure(cfg, true);
+
+    {
+        VirtualClock clock;
+        Application::pointer app0 = createTestApplication(clock, cfg);
+        auto& hm0 = app0->getHistoryManager();
+        while (hm0.getPublishQueueCount() < 4)
+        {
+            clock.crank(true);
+        }
+        REQUIRE(hm0.getPublishSuccessCount() == 0);
+    }
+
+    cfg.MAX_CONCURRENT_SUBPROCESSES = 32;
+    cfg.MAX_CHECKPOINTS_PER_PUBLISH = 3;
+
+    VirtualClock clock;
+    Application::pointer app1 = Application::create(clock, cfg, 0);
+    app1->getHistoryArchiveManager().initializeHistoryArchive(
+        tcfg.getArchiveDirName());
+    for (size_t i = 0; i < 100; ++i)
+        clock.crank(false);
+    auto& hm1 = app1->getHistoryManager();
+    REQUIRE(hm1.publishQueueLength() == 4);
+    app1->start();
+    while (hm1.getPublishSuccessCount() == 0)
+    {
+        clock.crank(true);
+    }
+    // The three oldest checkpoints were published together, the next one is
+    // left for the next publish
+    REQUIRE(hm1.getPublishSuccessCount() == 3);
+    REQUIRE(hm1.getMinLedgerQueuedToPublish() == 31);
+
+    auto archiveDir = tcfg.getArchiveDirName();
+    for (uint32_t checkpoint : {7, 15, 23})
+    {
+        REQUIRE(fs::exists(archiveDir + "/" +
+                           HistoryArchiveState::remoteName(checkpoint)));
+    }
+    HistoryArchiveState has;
+    has.load(archiveDir + "/" + HistoryArchiveState::wellKnownRemoteName());
+    REQUIRE(has.currentLedger == 23);
+}
+
 // The idea with this test is that we join a network and somehow get a gap
 // in the SCP voting sequence while we're trying to catchup. This will let
 // system catchup just before the gap.
@@ -1751,6 +2084,7 @@ TEST_CASE("CheckpointBuilder", "[history][publish]")
             }
             cb.appendLedgerHeader(lh.header);
         }
+        cb.waitForWrites();
     };
 
     SECTION("recover")
@@ -1795,4 +2129,23 @@ TEST_CASE("CheckpointBuilder", "[history][publish]")
         cb.checkpointComplete(ledgerSeq);
         validateCheckpointFiles(*app, ledgerSeq, true);
     }
+    SECTION("finalizing waits for background writes")
+    {
+        auto ledgerSeq = hm.checkpointContainingLedger(1);
+        for (uint32_t i = lcl; i <= ledgerSeq; ++i)
+        {
+            LedgerHeaderHistoryEntry lh;
+            lh.header.ledgerSeq = i;
+            cb.appendLedgerHeader(lh.header);
+        }
+        cb.checkpointComplete(ledgerSeq);
+        validateCheckpointFiles(*app, ledgerSeq, true);
+
+        // Writes are batched, the writer never runs more passes than there
+        // were appends
+        auto& writes = app->getMetrics().NewTimer(
+            {"history", "checkpoint", "write"});
+        REQUIRE(writes.count() >= 1);
+        REQUIRE(writes.count() <= ledgerSeq - lcl + 1);
+    }
 }
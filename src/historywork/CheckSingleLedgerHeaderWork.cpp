@@ -75,8 +75,10 @@ CheckSingleLedgerHeaderWork::doWork()
     {
         CLOG_INFO(History, "Downloading ledger checkpoint {} from archive {}",
                   mFt->baseName_gz(), mArchive->getName());
+        // This checks a specific archive, so always download from it
         mGetLedgerFileWork = addWork<GetAndUnzipRemoteFileWork>(
-            *mFt, mArchive, BasicWork::RETRY_NEVER);
+            *mFt, mArchive, BasicWork::RETRY_NEVER, std::nullopt,
+            /* useLocalCache */ false);
         return State::WORK_RUNNING;
     }
     else if (!mGetLedgerFileWork->isDone())
@@ -0,0 +1,114 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "historywork/CompressionWork.h"
+#include "main/Application.h"
+#include "util/Logging.h"
+
+#include <Tracy.hpp>
+#include <filesystem>
+#include <fmt/format.h>
+
+namespace stellar
+{
+
+CompressionWork::CompressionWork(Application& app, std::string const& name,
+                                 std::string const& source,
+                                 std::string const& destination,
+                                 size_t maxRetries)
+    : BasicWork(app, name, maxRetries)
+    , mSource(source)
+    , mDestination(destination)
+{
+}
+
+void
+CompressionWork::onReset()
+{
+    mDone = false;
+    mError.clear();
+    ++mGeneration;
+    std::remove(mDestination.c_str());
+}
+
+BasicWork::State
+CompressionWork::onRun()
+{
+    ZoneScoped;
+    if (mDone)
+    {
+        if (!mError.empty())
+        {
+            CLOG_WARNING(History, "{} failed: {}", getName(), mError);
+            return State::WORK_FAILURE;
+        }
+        onTransformed();
+        return State::WORK_SUCCESS;
+    }
+
+    spawnTransform();
+    return State::WORK_WAITING;
+}
+
+void
+CompressionWork::spawnTransform()
+{
+    auto generation = mGeneration;
+    auto tmp = fmt::format(FMT_STRING("{}.{:d}.tmp"), mDestination, generation);
+    auto transform = getTransform();
+    auto dst = mDestination;
+    Application& app = mApp;
+    std::weak_ptr<CompressionWork> weak(
+        std::static_pointer_cast<CompressionWork>(shared_from_this()));
+
+    app.postOnBackgroundThread(
+        [&app, weak, generation, tmp, dst, transform]() {
+            {
+                auto self = weak.lock();
+                if (!self || self->isAborting())
+                {
+                    return;
+                }
+            }
+
+            std::string error;
+            try
+            {
+                transform(tmp);
+            }
+            catch (std::exception const& e)
+            {
+                error = e.what();
+            }
+
+            app.postOnMainThread(
+                [weak, generation, tmp, dst, error]() mutable {
+                    auto self = weak.lock();
+                    if (!self || self->mGeneration != generation)
+                    {
+                        std::remove(tmp.c_str());
+                        return;
+                    }
+                    if (error.empty())
+                    {
+                        std::error_code ec;
+                        std::filesystem::rename(tmp, dst, ec);
+                        if (ec)
+                        {
+                            error = ec.message();
+                        }
+                    }
+                    if (!error.empty())
+                    {
+                        std::remove(tmp.c_str());
+                    }
+                    self->mError = error;
+                    self->mDone = true;
+                    self->wakeUp();
+                },
+                "CompressionWork: finish");
+        },
+        "CompressionWork: start in background");
+}
+}
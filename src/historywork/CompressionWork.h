@@ -0,0 +1,58 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#include "work/BasicWork.h"
+
+#include <functional>
+
+namespace stellar
+{
+
+/**
+ * Base for works that (de)compress a file in-process. The transformation runs
+ * on a background thread and writes to a temporary file that is moved to the
+ * destination on the main thread once it's complete, so a reset or an abort
+ * never leaves a partial destination behind.
+ */
+class CompressionWork : public BasicWork
+{
+    bool mDone{false};
+    std::string mError;
+    // Bumped on every reset, so that results of stale background jobs are
+    // ignored
+    uint64_t mGeneration{0};
+
+    void spawnTransform();
+
+  protected:
+    std::string const mSource;
+    std::string const mDestination;
+
+    // Returns the function run on the background thread to transform the
+    // source into the given file. It must not access the work itself, and
+    // throws on failure.
+    virtual std::function<void(std::string const&)> getTransform() const = 0;
+    // Called on the main thread once the destination is in place
+    virtual void
+    onTransformed()
+    {
+    }
+
+    void onReset() override;
+    BasicWork::State onRun() override;
+    bool
+    onAbort() override
+    {
+        return true;
+    }
+
+  public:
+    CompressionWork(Application& app, std::string const& name,
+                    std::string const& source, std::string const& destination,
+                    size_t maxRetries);
+    ~CompressionWork() = default;
+};
+}
@@ -5,8 +5,10 @@
 #include "historywork/GetAndUnzipRemoteFileWork.h"
 #include "catchup/CatchupManager.h"
 #include "history/HistoryArchive.h"
+#include "history/HistoryCache.h"
 #include "historywork/GetRemoteFileWork.h"
 #include "historywork/GunzipFileWork.h"
+#include "main/Application.h"
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include <Tracy.hpp>
@@ -17,11 +19,14 @@ namespace stellar
 
 GetAndUnzipRemoteFileWork::GetAndUnzipRemoteFileWork(
     Application& app, FileTransferInfo ft,
-    std::shared_ptr<HistoryArchive> archive, size_t retry)
+    std::shared_ptr<HistoryArchive> archive, size_t retry,
+    std::optional<uint256> expectedHash, bool useLocalCache)
     : Work(app, std::string("get-and-unzip-remote-file ") + ft.remoteName(),
            retry)
     , mFt(std::move(ft))
     , mArchive(archive)
+    , mExpectedHash(expectedHash)
+    , mUseLocalCache(useLocalCache)
 {
 }
 
@@ -47,6 +52,11 @@ GetAndUnzipRemoteFileWork::doReset()
     std::remove(mFt.localPath_gz_tmp().c_str());
     mGetRemoteFileWork.reset();
     mGunzipFileWork.reset();
+    mCacheBusy = false;
+    mCacheLookedUp = false;
+    mRetrievedFromCache = false;
+    mStoredInCache = false;
+    ++mGeneration;
 }
 
 void
@@ -85,6 +95,14 @@ GetAndUnzipRemoteFileWork::doWork()
                        mFt.remoteName());
             return State::WORK_FAILURE;
         }
+        if (state == State::WORK_SUCCESS && cacheEnabled() && !mStoredInCache)
+        {
+            if (!mCacheBusy)
+            {
+                useCacheInBackground(/* store */ true);
+            }
+            return State::WORK_WAITING;
+        }
         return state;
     }
     else if (mGetRemoteFileWork)
@@ -97,14 +115,29 @@ GetAndUnzipRemoteFileWork::doWork()
             {
                 return State::WORK_FAILURE;
             }
-            mGunzipFileWork = addWork<GunzipFileWork>(mFt.localPath_gz(), false,
-                                                      BasicWork::RETRY_NEVER);
+            mGunzipFileWork =
+                addWork<GunzipFileWork>(mFt.localPath_gz(), false,
+                                        BasicWork::RETRY_NEVER, mExpectedHash);
             return State::WORK_RUNNING;
         }
         return state;
     }
     else
     {
+        if (cacheEnabled() && !mCacheLookedUp)
+        {
+            if (!mCacheBusy)
+            {
+                useCacheInBackground(/* store */ false);
+            }
+            return State::WORK_WAITING;
+        }
+        if (mRetrievedFromCache)
+        {
+            CLOG_DEBUG(History, "Using {} from the local history cache",
+                       mFt.remoteName());
+            return State::WORK_SUCCESS;
+        }
         CLOG_DEBUG(History, "Downloading and unzipping {}", mFt.remoteName());
         mGetRemoteFileWork =
             addWork<GetRemoteFileWork>(mFt.remoteName(), mFt.localPath_gz_tmp(),
@@ -113,6 +146,72 @@ GetAndUnzipRemoteFileWork::doWork()
     }
 }
 
+bool
+GetAndUnzipRemoteFileWork::cacheEnabled() const
+{
+    return mUseLocalCache &&
+           !mApp.getConfig().LOCAL_HISTORY_CACHE_PATH.empty() &&
+           HistoryCache::isCacheable(mFt.getType());
+}
+
+void
+GetAndUnzipRemoteFileWork::useCacheInBackground(bool store)
+{
+    auto cache = HistoryCache::forApp(mApp);
+    releaseAssert(cache);
+    mCacheBusy = true;
+
+    Application& app = mApp;
+    std::weak_ptr<GetAndUnzipRemoteFileWork> weak(
+        std::static_pointer_cast<GetAndUnzipRemoteFileWork>(
+            shared_from_this()));
+    app.postOnBackgroundThread(
+        [&app, weak, cache = *cache, ft = mFt, store,
+         generation = mGeneration]() {
+            bool done = false;
+            try
+            {
+                if (store)
+                {
+                    cache.store(ft);
+                    done = true;
+                }
+                else
+                {
+                    done = cache.retrieve(ft);
+                }
+            }
+            catch (std::exception const& e)
+            {
+                // The cache is only an optimization, don't fail the download
+                CLOG_WARNING(History, "History cache failed for {}: {}",
+                             ft.remoteName(), e.what());
+            }
+            app.postOnMainThread(
+                [weak, store, generation, done]() {
+                    auto self = weak.lock();
+                    if (!self || self->mGeneration != generation)
+                    {
+                        return;
+                    }
+                    self->mCacheBusy = false;
+                    if (store)
+                    {
+                        // Don't try again if it failed
+                        self->mStoredInCache = true;
+                    }
+                    else
+                    {
+                        self->mCacheLookedUp = true;
+                        self->mRetrievedFromCache = done;
+                    }
+                    self->wakeUp();
+                },
+                "GetAndUnzipRemoteFile: history cache done");
+        },
+        "GetAndUnzipRemoteFile: use history cache");
+}
+
 bool
 GetAndUnzipRemoteFileWork::validateFile()
 {
@@ -6,6 +6,9 @@
 
 #include "history/FileTransferInfo.h"
 #include "work/Work.h"
+#include "xdr/Stellar-types.h"
+
+#include <optional>
 
 namespace stellar
 {
@@ -20,16 +23,35 @@ class GetAndUnzipRemoteFileWork : public Work
 
     FileTransferInfo mFt;
     std::shared_ptr<HistoryArchive> const mArchive;
+    std::optional<uint256> const mExpectedHash;
+    bool const mUseLocalCache;
+
+    // The local history cache is used on a background thread, see
+    // useCacheInBackground
+    bool mCacheBusy{false};
+    bool mCacheLookedUp{false};
+    bool mRetrievedFromCache{false};
+    bool mStoredInCache{false};
+    // Incremented on reset, to ignore cache operations of a previous attempt
+    uint32_t mGeneration{0};
 
     bool validateFile();
+    bool cacheEnabled() const;
+    void useCacheInBackground(bool store);
 
   public:
     // Passing `nullptr` for the archive argument will cause the work to
     // select a new readable history archive at random each time it runs /
-    // retries.
-    GetAndUnzipRemoteFileWork(Application& app, FileTransferInfo ft,
-                              std::shared_ptr<HistoryArchive> archive = nullptr,
-                              size_t retry = BasicWork::RETRY_A_LOT);
+    // retries. When `expectedHash` is set, the unzipped file is verified
+    // against it while unzipping. Unless `useLocalCache` is false, the file
+    // is taken from the local history cache when it is there, and added to it
+    // once downloaded (see LOCAL_HISTORY_CACHE_PATH).
+    GetAndUnzipRemoteFileWork(
+        Application& app, FileTransferInfo ft,
+        std::shared_ptr<HistoryArchive> archive = nullptr,
+        size_t retry = BasicWork::RETRY_A_LOT,
+        std::optional<uint256> expectedHash = std::nullopt,
+        bool useLocalCache = true);
     ~GetAndUnzipRemoteFileWork() = default;
     std::string getStatus() const override;
     std::shared_ptr<HistoryArchive> getArchive() const;
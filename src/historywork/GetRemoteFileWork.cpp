@@ -4,6 +4,7 @@
 
 #include "historywork/GetRemoteFileWork.h"
 #include "fmt/format.h"
+#include "history/ArchiveFetcher.h"
 #include "history/HistoryArchive.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/HistoryManager.h"
@@ -12,6 +13,8 @@
 #include "util/GlobalChecks.h"
 #include "util/Logging.h"
 
+#include <memory>
+
 namespace stellar
 {
 GetRemoteFileWork::GetRemoteFileWork(Application& app,
@@ -30,8 +33,8 @@ GetRemoteFileWork::GetRemoteFileWork(Application& app,
 {
 }
 
-CommandInfo
-GetRemoteFileWork::getCommand()
+void
+GetRemoteFileWork::selectArchive()
 {
     mCurrentArchive = mArchive;
     if (!mCurrentArchive)
@@ -39,6 +42,13 @@ GetRemoteFileWork::getCommand()
         mCurrentArchive = mApp.getHistoryArchiveManager()
                               .selectRandomReadableHistoryArchive();
     }
+    releaseAssert(mCurrentArchive);
+    mArchiveSelected = true;
+}
+
+CommandInfo
+GetRemoteFileWork::getCommand()
+{
     releaseAssert(mCurrentArchive);
     releaseAssert(mCurrentArchive->hasGetCmd());
     auto cmdLine = mCurrentArchive->getFileCmd(mRemote, mLocal);
@@ -46,10 +56,101 @@ GetRemoteFileWork::getCommand()
     return CommandInfo{cmdLine, std::string()};
 }
 
+BasicWork::State
+GetRemoteFileWork::onRun()
+{
+    if (!mArchiveSelected)
+    {
+        selectArchive();
+    }
+    if (!mCurrentArchive->hasGetURL())
+    {
+        return RunCommandWork::onRun();
+    }
+
+    if (mFetchDone)
+    {
+        if (!mFetchError.empty())
+        {
+            CLOG_DEBUG(History, "{}", mFetchError);
+            return State::WORK_FAILURE;
+        }
+        return State::WORK_SUCCESS;
+    }
+    if (!mFetchStarted)
+    {
+        startFetch();
+    }
+    return State::WORK_WAITING;
+}
+
+void
+GetRemoteFileWork::startFetch()
+{
+    mFetchStarted = true;
+    auto generation = mFetchGeneration;
+    auto tmp = fmt::format(FMT_STRING("{}.{:d}.tmp"), mLocal, generation);
+    auto local = mLocal;
+    std::weak_ptr<GetRemoteFileWork> weak(
+        std::static_pointer_cast<GetRemoteFileWork>(shared_from_this()));
+    // The fetcher is stopped before the application is destroyed, so the
+    // callback never outlives it
+    Application& app = mApp;
+    mFetch = mApp.getHistoryArchiveManager().getArchiveFetcher().fetch(
+        mCurrentArchive->getFileURL(mRemote), tmp,
+        [&app, weak, generation, tmp, local](std::string const& error) {
+            app.postOnMainThread(
+                [weak, generation, tmp, local, error]() {
+                    auto self = weak.lock();
+                    if (!self || self->mFetchGeneration != generation ||
+                        self->isDone())
+                    {
+                        std::remove(tmp.c_str());
+                        return;
+                    }
+                    self->mFetchError = error;
+                    if (error.empty() &&
+                        std::rename(tmp.c_str(), local.c_str()) != 0)
+                    {
+                        self->mFetchError = fmt::format(
+                            FMT_STRING("Failed to rename {} to {}"), tmp,
+                            local);
+                    }
+                    if (!self->mFetchError.empty())
+                    {
+                        std::remove(tmp.c_str());
+                    }
+                    self->mFetchDone = true;
+                    self->wakeUp();
+                },
+                "GetRemoteFileWork: fetch done");
+        });
+}
+
+bool
+GetRemoteFileWork::onAbort()
+{
+    if (mCurrentArchive && mCurrentArchive->hasGetURL())
+    {
+        // The fetch only writes its own temporary file, which is removed once
+        // the cancelled request completes
+        mFetch.cancel();
+        return true;
+    }
+    return RunCommandWork::onAbort();
+}
+
 void
 GetRemoteFileWork::onReset()
 {
+    mFetch.cancel();
+    mFetch = ArchiveFetcher::Handle();
     std::remove(mLocal.c_str());
+    mArchiveSelected = false;
+    mFetchStarted = false;
+    mFetchDone = false;
+    mFetchError.clear();
+    ++mFetchGeneration;
     RunCommandWork::onReset();
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "history/ArchiveFetcher.h"
 #include "historywork/RunCommandWork.h"
 #include "medida/medida.h"
 
@@ -18,10 +19,24 @@ class GetRemoteFileWork : public RunCommandWork
     std::string const mLocal;
     std::shared_ptr<HistoryArchive> const mArchive;
     std::shared_ptr<HistoryArchive> mCurrentArchive;
+    bool mArchiveSelected{false};
     CommandInfo getCommand() override;
     medida::Meter& mFailuresPerSecond;
     medida::Meter& mBytesPerSecond;
 
+    // State of a download through the archive fetcher, for archives with a
+    // `url`. Each fetch writes its own temporary file, renamed to mLocal once
+    // it succeeds, and is cancelled by a reset or an abort; the results of
+    // fetches started before the last reset are ignored.
+    ArchiveFetcher::Handle mFetch;
+    bool mFetchStarted{false};
+    bool mFetchDone{false};
+    std::string mFetchError;
+    uint64_t mFetchGeneration{0};
+
+    void selectArchive();
+    void startFetch();
+
   public:
     // Passing `nullptr` for the archive argument will cause the work to
     // select a new readable history archive at random each time it runs /
@@ -34,6 +49,8 @@ class GetRemoteFileWork : public RunCommandWork
     std::shared_ptr<HistoryArchive> getCurrentArchive() const;
 
   protected:
+    BasicWork::State onRun() override;
+    bool onAbort() override;
     void onReset() override;
     void onSuccess() override;
     void onFailureRaise() override;
@@ -3,38 +3,63 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "historywork/GunzipFileWork.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
+#include "main/ErrorMessages.h"
 #include "util/Fs.h"
+#include "util/Gzip.h"
+#include "util/Logging.h"
+#include <fmt/format.h>
 
 namespace stellar
 {
 
 GunzipFileWork::GunzipFileWork(Application& app, std::string const& filenameGz,
-                               bool keepExisting, size_t maxRetries)
-    : RunCommandWork(app, std::string("gunzip-file ") + filenameGz, maxRetries)
-    , mFilenameGz(filenameGz)
+                               bool keepExisting, size_t maxRetries,
+                               std::optional<uint256> expectedHash)
+    : CompressionWork(app, std::string("gunzip-file ") + filenameGz,
+                      filenameGz, filenameGz.substr(0, filenameGz.size() - 3),
+                      maxRetries)
     , mKeepExisting(keepExisting)
+    , mExpectedHash(expectedHash)
 {
-    fs::checkGzipSuffix(mFilenameGz);
+    fs::checkGzipSuffix(mSource);
 }
 
-CommandInfo
-GunzipFileWork::getCommand()
+std::function<void(std::string const&)>
+GunzipFileWork::getTransform() const
 {
-    std::string cmdLine, outFile;
-    cmdLine = "gzip -d ";
-    if (mKeepExisting)
-    {
-        cmdLine += "-c ";
-        outFile = mFilenameGz.substr(0, mFilenameGz.size() - 3);
-    }
-    cmdLine += mFilenameGz;
-    return CommandInfo{cmdLine, outFile};
+    return [src = mSource, expected = mExpectedHash](std::string const& dst) {
+        if (!expected)
+        {
+            gzip::decompressFile(src, dst);
+            return;
+        }
+
+        SHA256 hasher;
+        gzip::decompressFile(src, dst, &hasher);
+        auto actual = hasher.finish();
+        if (actual != *expected)
+        {
+            CLOG_WARNING(History, "FAILED verifying hash for {}", src);
+            CLOG_WARNING(History, "expected hash: {}", binToHex(*expected));
+            CLOG_WARNING(History, "computed hash: {}", binToHex(actual));
+            CLOG_WARNING(History, "{}", POSSIBLY_CORRUPTED_HISTORY);
+            throw std::runtime_error(
+                fmt::format(FMT_STRING("hash mismatch for {}"), src));
+        }
+        CLOG_DEBUG(History, "Verified hash ({}) for {}", hexAbbrev(actual),
+                   src);
+    };
 }
 
 void
-GunzipFileWork::onReset()
+GunzipFileWork::onTransformed()
 {
-    std::string filenameNoGz = mFilenameGz.substr(0, mFilenameGz.size() - 3);
-    std::remove(filenameNoGz.c_str());
+    // Like `gzip -d` without `-c`, replace the original
+    if (!mKeepExisting)
+    {
+        std::remove(mSource.c_str());
+    }
 }
 }
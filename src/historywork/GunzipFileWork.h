@@ -4,24 +4,31 @@
 
 #pragma once
 
-#include "historywork/RunCommandWork.h"
+#include "historywork/CompressionWork.h"
+#include "xdr/Stellar-types.h"
+
+#include <optional>
 
 namespace stellar
 {
 
-class GunzipFileWork : public RunCommandWork
+class GunzipFileWork : public CompressionWork
 {
-    std::string const mFilenameGz;
     bool const mKeepExisting;
-    CommandInfo getCommand() override;
+    std::optional<uint256> const mExpectedHash;
 
   public:
+    // When `expectedHash` is set, the work fails unless the SHA256 of the
+    // decompressed file matches it. The hash is computed while decompressing,
+    // so no separate pass over the file is needed to verify it.
     GunzipFileWork(Application& app, std::string const& filenameGz,
                    bool keepExisting = false,
-                   size_t maxRetries = Work::RETRY_NEVER);
+                   size_t maxRetries = BasicWork::RETRY_NEVER,
+                   std::optional<uint256> expectedHash = std::nullopt);
     ~GunzipFileWork() = default;
 
   protected:
-    void onReset() override;
+    std::function<void(std::string const&)> getTransform() const override;
+    void onTransformed() override;
 };
 }
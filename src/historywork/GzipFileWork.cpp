@@ -4,39 +4,36 @@
 
 #include "historywork/GzipFileWork.h"
 #include "util/Fs.h"
+#include "util/Gzip.h"
 
 namespace stellar
 {
 
 GzipFileWork::GzipFileWork(Application& app, std::string const& filenameNoGz,
                            bool keepExisting)
-    : RunCommandWork(app, std::string("gzip-file ") + filenameNoGz,
-                     BasicWork::RETRY_A_LOT)
-    , mFilenameNoGz(filenameNoGz)
+    : CompressionWork(app, std::string("gzip-file ") + filenameNoGz,
+                      filenameNoGz, filenameNoGz + ".gz",
+                      BasicWork::RETRY_A_LOT)
     , mKeepExisting(keepExisting)
 {
-    fs::checkNoGzipSuffix(mFilenameNoGz);
+    fs::checkNoGzipSuffix(mSource);
 }
 
-void
-GzipFileWork::onReset()
+std::function<void(std::string const&)>
+GzipFileWork::getTransform() const
 {
-    std::string filenameGz = mFilenameNoGz + ".gz";
-    std::remove(filenameGz.c_str());
+    return [src = mSource](std::string const& dst) {
+        gzip::compressFile(src, dst);
+    };
 }
 
-CommandInfo
-GzipFileWork::getCommand()
+void
+GzipFileWork::onTransformed()
 {
-    std::string cmdLine = "gzip ";
-    std::string outFile;
-    if (mKeepExisting)
+    // Like `gzip` without `-c`, replace the original
+    if (!mKeepExisting)
     {
-        cmdLine += "-c ";
-        outFile = mFilenameNoGz + ".gz";
+        std::remove(mSource.c_str());
     }
-    cmdLine += mFilenameNoGz;
-
-    return CommandInfo{cmdLine, outFile};
 }
 }
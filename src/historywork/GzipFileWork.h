@@ -4,16 +4,14 @@
 
 #pragma once
 
-#include "historywork/RunCommandWork.h"
+#include "historywork/CompressionWork.h"
 
 namespace stellar
 {
 
-class GzipFileWork : public RunCommandWork
+class GzipFileWork : public CompressionWork
 {
-    std::string const mFilenameNoGz;
     bool const mKeepExisting;
-    CommandInfo getCommand() override;
 
   public:
     GzipFileWork(Application& app, std::string const& filenameNoGz,
@@ -21,6 +19,7 @@ class GzipFileWork : public RunCommandWork
     ~GzipFileWork() = default;
 
   protected:
-    void onReset() override;
+    std::function<void(std::string const&)> getTransform() const override;
+    void onTransformed() override;
 };
 }
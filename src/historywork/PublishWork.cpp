@@ -7,6 +7,7 @@
 #include "history/HistoryManager.h"
 #include "history/StateSnapshot.h"
 #include "main/Application.h"
+#include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include <Tracy.hpp>
 #include <fmt/format.h>
@@ -14,36 +15,58 @@
 namespace stellar
 {
 
-PublishWork::PublishWork(Application& app,
-                         std::shared_ptr<StateSnapshot> snapshot,
-                         std::vector<std::shared_ptr<BasicWork>> seq,
-                         std::vector<std::string> const& bucketHashes)
-    : WorkSequence(app,
-                   fmt::format(FMT_STRING("publish-{:08x}"),
-                               snapshot->mLocalState.currentLedger),
-                   seq, BasicWork::RETRY_NEVER)
-    , mSnapshot(snapshot)
+namespace
+{
+std::string
+publishWorkName(std::vector<std::shared_ptr<StateSnapshot>> const& snapshots)
+{
+    releaseAssert(!snapshots.empty());
+    auto first = snapshots.front()->mLocalState.currentLedger;
+    auto last = snapshots.back()->mLocalState.currentLedger;
+    if (first == last)
+    {
+        return fmt::format(FMT_STRING("publish-{:08x}"), first);
+    }
+    return fmt::format(FMT_STRING("publish-{:08x}-{:08x}"), first, last);
+}
+}
+
+PublishWork::PublishWork(
+    Application& app, std::vector<std::shared_ptr<StateSnapshot>> snapshots,
+    std::vector<std::shared_ptr<BasicWork>> seq,
+    std::vector<std::vector<std::string>> const& bucketHashes)
+    : WorkSequence(app, publishWorkName(snapshots), seq,
+                   BasicWork::RETRY_NEVER)
+    , mSnapshots(snapshots)
     , mOriginalBuckets(bucketHashes)
 {
+    releaseAssert(mSnapshots.size() == mOriginalBuckets.size());
+}
+
+void
+PublishWork::historyPublished(bool success)
+{
+    // use mOriginalBuckets as mLocalState.allBuckets() could change in
+    // meantime
+    for (size_t i = 0; i < mSnapshots.size(); ++i)
+    {
+        mApp.getHistoryManager().historyPublished(
+            mSnapshots[i]->mLocalState.currentLedger, mOriginalBuckets[i],
+            success);
+    }
 }
 
 void
 PublishWork::onFailureRaise()
 {
     ZoneScoped;
-    // use mOriginalBuckets as mSnapshot->mLocalState.allBuckets() could change
-    // in meantime
-    mApp.getHistoryManager().historyPublished(
-        mSnapshot->mLocalState.currentLedger, mOriginalBuckets, false);
+    historyPublished(false);
 }
 
 void
 PublishWork::onSuccess()
 {
     ZoneScoped;
-    // use mOriginalBuckets as mSnapshot->mLocalState.allBuckets() could change
-    // in meantime
-    mApp.getHistoryManager().historyPublished(
-        mSnapshot->mLocalState.currentLedger, mOriginalBuckets, true);
+    historyPublished(true);
 }
 }
@@ -12,15 +12,20 @@ namespace stellar
 
 struct StateSnapshot;
 
+// Publishes one or more consecutive queued checkpoints, in ledger order, and
+// reports each of them to the HistoryManager once done.
 class PublishWork : public WorkSequence
 {
-    std::shared_ptr<StateSnapshot> mSnapshot;
-    std::vector<std::string> mOriginalBuckets;
+    std::vector<std::shared_ptr<StateSnapshot>> mSnapshots;
+    std::vector<std::vector<std::string>> mOriginalBuckets;
+
+    void historyPublished(bool success);
 
   public:
-    PublishWork(Application& app, std::shared_ptr<StateSnapshot> snapshot,
+    PublishWork(Application& app,
+                std::vector<std::shared_ptr<StateSnapshot>> snapshots,
                 std::vector<std::shared_ptr<BasicWork>> seq,
-                std::vector<std::string> const& bucketHashes);
+                std::vector<std::vector<std::string>> const& bucketHashes);
     ~PublishWork() = default;
 
   protected:
@@ -7,21 +7,22 @@
 #include "historywork/GzipFileWork.h"
 #include "historywork/MakeRemoteDirWork.h"
 #include "historywork/PutRemoteFileWork.h"
+#include "util/UnorderedSet.h"
 #include "work/WorkSequence.h"
 #include <Tracy.hpp>
 
 namespace stellar
 {
 
-PutFilesWork::PutFilesWork(Application& app,
-                           std::shared_ptr<HistoryArchive> archive,
-                           std::shared_ptr<StateSnapshot> snapshot,
-                           HistoryArchiveState const& remoteState)
+PutFilesWork::PutFilesWork(
+    Application& app, std::shared_ptr<HistoryArchive> archive,
+    std::vector<std::shared_ptr<StateSnapshot>> snapshots,
+    HistoryArchiveState const& remoteState)
     // Each mkdir-and-put-file sequence will retry correctly
     : Work(app, "helper-put-files-" + archive->getName(),
            BasicWork::RETRY_NEVER)
     , mArchive(archive)
-    , mSnapshot(snapshot)
+    , mSnapshots(snapshots)
     , mRemoteState(remoteState)
 {
 }
@@ -32,18 +33,27 @@ PutFilesWork::doWork()
     ZoneScoped;
     if (!mChildrenSpawned)
     {
-        for (auto const& f : mSnapshot->differingHASFiles(mRemoteState))
+        UnorderedSet<std::string> remoteNames;
+        for (auto const& snapshot : mSnapshots)
         {
-            auto mkdir = std::make_shared<MakeRemoteDirWork>(
-                mApp, f->remoteDir(), mArchive);
-            auto putFile = std::make_shared<PutRemoteFileWork>(
-                mApp, f->localPath_gz(), f->remoteName(), mArchive);
+            for (auto const& f : snapshot->differingHASFiles(mRemoteState))
+            {
+                if (!remoteNames.emplace(f->remoteName()).second)
+                {
+                    continue;
+                }
+                auto mkdir = std::make_shared<MakeRemoteDirWork>(
+                    mApp, f->remoteDir(), mArchive);
+                auto putFile = std::make_shared<PutRemoteFileWork>(
+                    mApp, f->localPath_gz(), f->remoteName(), mArchive);
 
-            std::vector<std::shared_ptr<BasicWork>> seq{mkdir, putFile};
-            // Each inner step will retry a lot, so retry the sequence once
-            // in case of an unexpected failure
-            addWork<WorkSequence>("mkdir-and-put-file-" + f->localPath_gz(),
-                                  seq, BasicWork::RETRY_ONCE);
+                std::vector<std::shared_ptr<BasicWork>> seq{mkdir, putFile};
+                // Each inner step will retry a lot, so retry the sequence
+                // once in case of an unexpected failure
+                addWork<WorkSequence>("mkdir-and-put-file-" +
+                                          f->localPath_gz(),
+                                      seq, BasicWork::RETRY_ONCE);
+            }
         }
         mChildrenSpawned = true;
         return State::WORK_RUNNING;
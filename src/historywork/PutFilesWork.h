@@ -14,14 +14,16 @@ namespace stellar
 class PutFilesWork : public Work
 {
     std::shared_ptr<HistoryArchive> mArchive;
-    std::shared_ptr<StateSnapshot> mSnapshot;
+    std::vector<std::shared_ptr<StateSnapshot>> mSnapshots;
     HistoryArchiveState const& mRemoteState;
 
     bool mChildrenSpawned{false};
 
   public:
+    // Uploads the files of all `snapshots` missing from `remoteState`. Files
+    // shared by several snapshots (buckets) are only uploaded once.
     PutFilesWork(Application& app, std::shared_ptr<HistoryArchive> archive,
-                 std::shared_ptr<StateSnapshot> snapshot,
+                 std::vector<std::shared_ptr<StateSnapshot>> snapshots,
                  HistoryArchiveState const& remoteState);
     ~PutFilesWork() = default;
 
@@ -11,6 +11,9 @@
 #include "historywork/PutFilesWork.h"
 #include "historywork/PutHistoryArchiveStateWork.h"
 #include "main/Application.h"
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
+#include "util/Fs.h"
 #include "work/WorkSequence.h"
 #include <Tracy.hpp>
 #include <fmt/format.h>
@@ -18,6 +21,16 @@
 namespace stellar
 {
 
+namespace
+{
+medida::Counter&
+bytesInFlightCounter(Application& app)
+{
+    return app.getMetrics().NewCounter(
+        {"history", "publish", "bytes-in-flight"});
+}
+}
+
 void
 PutSnapshotFilesWork::cleanup()
 {
@@ -26,16 +39,18 @@ PutSnapshotFilesWork::cleanup()
     {
         std::remove(f.second.localPath_gz().c_str());
     }
+    bytesInFlightCounter(mApp).dec(mBytesInFlight);
+    mBytesInFlight = 0;
 }
 
 PutSnapshotFilesWork::PutSnapshotFilesWork(
-    Application& app, std::shared_ptr<StateSnapshot> snapshot)
+    Application& app, std::vector<std::shared_ptr<StateSnapshot>> snapshots)
     : Work(app,
            fmt::format(FMT_STRING("update-archives-{:08x}"),
-                       snapshot->mLocalState.currentLedger),
+                       snapshots.back()->mLocalState.currentLedger),
            // Each put-snapshot-sequence will retry correctly
            BasicWork::RETRY_NEVER)
-    , mSnapshot(snapshot)
+    , mSnapshots(snapshots)
 {
 }
 
@@ -53,17 +68,28 @@ PutSnapshotFilesWork::doWork()
         if (WorkUtils::getWorkStatus(mGzipFilesWorks) == State::WORK_SUCCESS)
         {
             // Step 3: ready to upload files to archives
+            for (auto const& f : mFilesToUpload)
+            {
+                mBytesInFlight += fs::size(f.second.localPath_gz());
+            }
+            bytesInFlightCounter(mApp).inc(mBytesInFlight);
+
             for (auto const& getState : mGetStateWorks)
             {
                 auto putSnapshotFiles = std::make_shared<PutFilesWork>(
-                    mApp, getState->getArchive(), mSnapshot,
+                    mApp, getState->getArchive(), mSnapshots,
                     getState->getHistoryArchiveState());
-                auto putArchiveState =
-                    std::make_shared<PutHistoryArchiveStateWork>(
-                        mApp, mSnapshot->mLocalState, getState->getArchive());
-
-                std::vector<std::shared_ptr<BasicWork>> seq{putSnapshotFiles,
-                                                            putArchiveState};
+                std::vector<std::shared_ptr<BasicWork>> seq{putSnapshotFiles};
+
+                // Archive states go last, in ledger order, once all the
+                // files they refer to are uploaded
+                for (auto const& snapshot : mSnapshots)
+                {
+                    seq.emplace_back(
+                        std::make_shared<PutHistoryArchiveStateWork>(
+                            mApp, snapshot->mLocalState,
+                            getState->getArchive()));
+                }
                 mUploadSeqs.emplace_back(addWork<WorkSequence>(
                     "upload-files-seq", seq, BasicWork::RETRY_NEVER));
             }
@@ -124,15 +150,21 @@ PutSnapshotFilesWork::createGzipWorks()
         throw std::runtime_error("Corrupted GetHistoryArchiveStateWork");
     }
 
+    // Buckets are named after their hash, so those already in an archive
+    // (according to its state) or shared by several snapshots are only
+    // compressed once, and not at all if every archive has them
     for (auto const& getState : mGetStateWorks)
     {
-        for (auto const& f :
-             mSnapshot->differingHASFiles(getState->getHistoryArchiveState()))
+        for (auto const& snapshot : mSnapshots)
         {
-            if (mFilesToUpload.emplace(f->localPath_nogz(), *f).second)
+            for (auto const& f : snapshot->differingHASFiles(
+                     getState->getHistoryArchiveState()))
             {
-                mGzipFilesWorks.emplace_back(
-                    addWork<GzipFileWork>(f->localPath_nogz(), true));
+                if (mFilesToUpload.emplace(f->localPath_nogz(), *f).second)
+                {
+                    mGzipFilesWorks.emplace_back(
+                        addWork<GzipFileWork>(f->localPath_nogz(), true));
+                }
             }
         }
     }
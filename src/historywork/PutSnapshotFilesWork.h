@@ -15,9 +15,12 @@ namespace stellar
 struct StateSnapshot;
 class GetHistoryArchiveStateWork;
 
+// Uploads the files of one or more consecutive snapshots to all writable
+// archives, then puts their history archive states in ledger order, so an
+// archive never refers to a checkpoint or bucket it doesn't hold yet.
 class PutSnapshotFilesWork : public Work
 {
-    std::shared_ptr<StateSnapshot> mSnapshot;
+    std::vector<std::shared_ptr<StateSnapshot>> mSnapshots;
 
     // Keep track of each step
     std::list<std::shared_ptr<GetHistoryArchiveStateWork>> mGetStateWorks;
@@ -25,12 +28,16 @@ class PutSnapshotFilesWork : public Work
     std::list<std::shared_ptr<BasicWork>> mUploadSeqs;
     UnorderedMap<std::string, FileTransferInfo> mFilesToUpload;
 
+    // Size of the compressed files being uploaded, accounted for in the
+    // history.publish.bytes-in-flight counter
+    uint64_t mBytesInFlight{0};
+
     void createGzipWorks();
     void cleanup();
 
   public:
     PutSnapshotFilesWork(Application& app,
-                         std::shared_ptr<StateSnapshot> snapshot);
+                         std::vector<std::shared_ptr<StateSnapshot>> snapshots);
     ~PutSnapshotFilesWork() = default;
 
     std::string getStatus() const override;
@@ -4,6 +4,7 @@
 
 #include "historywork/VerifyTxResultsWork.h"
 #include "history/FileTransferInfo.h"
+#include "history/HistoryCache.h"
 #include "ledger/LedgerManager.h"
 #include "main/ErrorMessages.h"
 #include "util/FileSystemException.h"
@@ -41,7 +42,17 @@ VerifyTxResultsWork::onRun()
 {
     if (mDone)
     {
-        return mEc ? State::WORK_FAILURE : State::WORK_SUCCESS;
+        if (mEc)
+        {
+            // The ledger headers are verified against the ledger chain, so
+            // the results file is the one to download again
+            HistoryCache::evict(
+                mApp, FileTransferInfo(mDownloadDir,
+                                       FileType::HISTORY_FILE_TYPE_RESULTS,
+                                       mCheckpoint));
+            return State::WORK_FAILURE;
+        }
+        return State::WORK_SUCCESS;
     }
 
     std::weak_ptr<VerifyTxResultsWork> weak(
@@ -259,6 +259,50 @@ BucketListIsConsistentWithDatabase::checkEntireBucketlist()
     }
 }
 
+MultisetHash
+BucketListIsConsistentWithDatabase::hashBucketListOffers()
+{
+    MultisetHash hash;
+    LedgerKeySet seenKeys;
+    auto& bl = mApp.getBucketManager().getBucketList();
+    for (uint32_t i = 0; i < BucketList::kNumLevels; ++i)
+    {
+        auto const& level = bl.getLevel(i);
+        for (auto const& bucket : {level.getCurr(), level.getSnap()})
+        {
+            for (BucketInputIterator iter(bucket); iter; ++iter)
+            {
+                auto const& e = *iter;
+                if (e.type() == LIVEENTRY || e.type() == INITENTRY)
+                {
+                    // Only the newest version of each key is live
+                    if (e.liveEntry().data.type() == OFFER &&
+                        seenKeys.emplace(LedgerEntryKey(e.liveEntry())).second)
+                    {
+                        hash.addXDR(e.liveEntry());
+                    }
+                }
+                else if (e.type() == DEADENTRY && e.deadEntry().type() == OFFER)
+                {
+                    seenKeys.emplace(e.deadEntry());
+                }
+            }
+        }
+    }
+    return hash;
+}
+
+MultisetHash
+BucketListIsConsistentWithDatabase::hashDatabaseOffers()
+{
+    MultisetHash hash;
+    for (auto const& [_, le] : mApp.getLedgerTxnRoot().getAllOffers())
+    {
+        hash.addXDR(le);
+    }
+    return hash;
+}
+
 std::string
 BucketListIsConsistentWithDatabase::checkAfterAssumeState(uint32_t newestLedger)
 {
@@ -269,6 +313,64 @@ BucketListIsConsistentWithDatabase::checkAfterAssumeState(uint32_t newestLedger)
         return {};
     }
 
+    // Comparing hashes reads the offers table in a single query instead of
+    // loading each offer of the BucketList from it. If they match, both sides
+    // maintain their hash from now on so that checkOnLedgerCommit is O(1).
+    auto& ltxRoot = mApp.getLedgerTxnRoot();
+    auto& bm = mApp.getBucketManager();
+    auto bucketListHash = hashBucketListOffers();
+    auto databaseHash = hashDatabaseOffers();
+    if (bucketListHash == databaseHash)
+    {
+        ltxRoot.trackOfferHash(databaseHash);
+        bm.trackOfferHash(bucketListHash);
+        return {};
+    }
+
+    ltxRoot.trackOfferHash(std::nullopt);
+    bm.trackOfferHash(std::nullopt);
+
+    // Find the inconsistent entry to report
+    auto s = checkOffersEntryByEntry(newestLedger);
+    if (s.empty())
+    {
+        s = fmt::format(
+            FMT_STRING("Inconsistent offer hash: Bucket = {} Database = {}"),
+            bucketListHash.toHex(), databaseHash.toHex());
+    }
+    return s;
+}
+
+std::string
+BucketListIsConsistentWithDatabase::checkOnLedgerCommit(uint32_t ledgerSeq)
+{
+    if (!mApp.getConfig().isUsingBucketListDB())
+    {
+        return {};
+    }
+
+    auto databaseHash = mApp.getLedgerTxnRoot().getOfferHash();
+    auto bucketListHash = mApp.getBucketManager().getOfferHash();
+    if (!databaseHash || !bucketListHash)
+    {
+        // Tracking only starts once checkAfterAssumeState found both sides
+        // consistent, and stops if either is rebuilt
+        return {};
+    }
+
+    if (*databaseHash != *bucketListHash)
+    {
+        return fmt::format(
+            FMT_STRING("Inconsistent offer hash: Bucket = {} Database = {}"),
+            bucketListHash->toHex(), databaseHash->toHex());
+    }
+    return {};
+}
+
+std::string
+BucketListIsConsistentWithDatabase::checkOffersEntryByEntry(
+    uint32_t newestLedger)
+{
     EntryCounts counts;
     LedgerKeySet seenKeys;
 
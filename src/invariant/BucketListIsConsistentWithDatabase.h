@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "crypto/MultisetHash.h"
 #include "invariant/Invariant.h"
 
 namespace stellar
@@ -24,6 +25,13 @@ class Application;
 // database, while the third condition shows that the database does not
 // contain any entry in the appropriate ledger range other than those in
 // the bucket.
+//
+// With BucketListDB, only offers are stored in the database. It overrides
+// Invariant::checkAfterAssumeState to compare a MultisetHash of the live
+// offers in the BucketList with one of the offers in the database, and only
+// compares individual entries to find which one is inconsistent. Once the
+// hashes match, the BucketManager and LedgerTxnRoot update theirs as offers
+// change, and Invariant::checkOnLedgerCommit compares them after each ledger.
 class BucketListIsConsistentWithDatabase : public Invariant
 {
   public:
@@ -40,11 +48,17 @@ class BucketListIsConsistentWithDatabase : public Invariant
 
     virtual std::string checkAfterAssumeState(uint32_t newestLedger) override;
 
+    virtual std::string checkOnLedgerCommit(uint32_t ledgerSeq) override;
+
     // Secondary entrypoint to database-vs-bucket consistency checking, designed
     // to be run offline via self-check. Throws an exception on any error.
     void checkEntireBucketlist();
 
   private:
     Application& mApp;
+
+    MultisetHash hashBucketListOffers();
+    MultisetHash hashDatabaseOffers();
+    std::string checkOffersEntryByEntry(uint32_t newestLedger);
 };
 }
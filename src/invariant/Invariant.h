@@ -56,6 +56,14 @@ class Invariant
         return std::string{};
     }
 
+    // Called once the changes of ledger `ledgerSeq` are committed to both the
+    // database and the BucketList
+    virtual std::string
+    checkOnLedgerCommit(uint32_t ledgerSeq)
+    {
+        return std::string{};
+    }
+
     virtual std::string
     checkOnOperationApply(Operation const& operation,
                           OperationResult const& result,
@@ -64,6 +72,15 @@ class Invariant
         return std::string{};
     }
 
+    // Invariants that keep state across checkOnOperationApply calls must see
+    // operations in apply order, so they are never checked concurrently. All
+    // the others must only depend on their arguments.
+    virtual bool
+    checksOperationsInOrder() const
+    {
+        return false;
+    }
+
 #ifdef BUILD_TESTS
     virtual void
     snapshotForFuzzer()
@@ -42,10 +42,20 @@ class InvariantManager
 
     virtual void checkAfterAssumeState(uint32_t newestLedger) = 0;
 
+    virtual void checkOnLedgerCommit(uint32_t ledgerSeq) = 0;
+
+    // With INVARIANT_CHECK_THREADS, most invariants are checked in the
+    // background and their failures are only reported by
+    // waitForOperationChecks
     virtual void checkOnOperationApply(Operation const& operation,
                                        OperationResult const& opres,
                                        LedgerTxnDelta const& ltxDelta) = 0;
 
+    // Blocks until every operation passed to checkOnOperationApply so far is
+    // checked, then reports the failures as checkOnOperationApply would have.
+    // Must be called before the ledger these operations belong to is closed.
+    virtual void waitForOperationChecks() = 0;
+
     virtual void registerInvariant(std::shared_ptr<Invariant> invariant) = 0;
 
     virtual void enableInvariant(std::string const& name) = 0;
@@ -8,9 +8,10 @@
 #include "crypto/Hex.h"
 #include "invariant/Invariant.h"
 #include "invariant/InvariantDoesNotHold.h"
-#include "invariant/InvariantManagerImpl.h"
+#include "invariant/ParallelInvariantChecker.h"
 #include "ledger/LedgerTxn.h"
 #include "main/Application.h"
+#include "main/Config.h"
 #include "main/ErrorMessages.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
@@ -27,15 +28,33 @@
 namespace stellar
 {
 
+namespace
+{
+// Operations waiting for a worker when INVARIANT_CHECK_THREADS is set, beyond
+// which operation apply blocks
+size_t const MAX_QUEUED_OPERATION_CHECKS = 1024;
+}
+
 std::unique_ptr<InvariantManager>
 InvariantManager::create(Application& app)
 {
-    return std::make_unique<InvariantManagerImpl>(app.getMetrics());
+    return std::make_unique<InvariantManagerImpl>(
+        app.getMetrics(), app.getConfig().INVARIANT_CHECK_THREADS);
 }
 
-InvariantManagerImpl::InvariantManagerImpl(medida::MetricsRegistry& registry)
+InvariantManagerImpl::InvariantManagerImpl(medida::MetricsRegistry& registry,
+                                           uint32_t operationCheckThreads)
     : mInvariantFailureCount(
           registry.NewCounter({"ledger", "invariant", "failure"}))
+    , mOperationChecker(operationCheckThreads == 0
+                            ? nullptr
+                            : std::make_unique<ParallelInvariantChecker>(
+                                  registry, operationCheckThreads,
+                                  MAX_QUEUED_OPERATION_CHECKS))
+{
+}
+
+InvariantManagerImpl::~InvariantManagerImpl()
 {
 }
 
@@ -117,6 +136,24 @@ InvariantManagerImpl::checkAfterAssumeState(uint32_t newestLedger)
     }
 }
 
+void
+InvariantManagerImpl::checkOnLedgerCommit(uint32_t ledgerSeq)
+{
+    for (auto invariant : mEnabled)
+    {
+        auto result = invariant->checkOnLedgerCommit(ledgerSeq);
+        if (result.empty())
+        {
+            continue;
+        }
+
+        auto message = fmt::format(
+            FMT_STRING(R"(invariant "{}" does not hold on ledger {}: {})"),
+            invariant->getName(), ledgerSeq, result);
+        onInvariantFailure(invariant, message, ledgerSeq);
+    }
+}
+
 void
 InvariantManagerImpl::checkOnOperationApply(Operation const& operation,
                                             OperationResult const& opres,
@@ -128,21 +165,45 @@ InvariantManagerImpl::checkOnOperationApply(Operation const& operation,
         return;
     }
 
+    // Invariants that must see operations in order are always checked here
+    std::vector<std::shared_ptr<Invariant>> background;
     for (auto invariant : mEnabled)
     {
+        if (mOperationChecker && !invariant->checksOperationsInOrder())
+        {
+            background.emplace_back(invariant);
+            continue;
+        }
+
         auto result =
             invariant->checkOnOperationApply(operation, opres, ltxDelta);
         if (result.empty())
         {
             continue;
         }
+        onOperationInvariantFailure(invariant, result, operation,
+                                    ltxDelta.header.current.ledgerSeq);
+    }
 
-        auto message = fmt::format(
-            FMT_STRING(R"(Invariant "{}" does not hold on operation: {}{}{})"),
-            invariant->getName(), result, "\n",
-            xdrToCerealString(operation, "Operation"));
-        onInvariantFailure(invariant, message,
-                           ltxDelta.header.current.ledgerSeq);
+    if (!background.empty())
+    {
+        mOperationChecker->check(std::move(background), operation, opres,
+                                 ltxDelta);
+    }
+}
+
+void
+InvariantManagerImpl::waitForOperationChecks()
+{
+    if (!mOperationChecker)
+    {
+        return;
+    }
+
+    for (auto const& failure : mOperationChecker->wait())
+    {
+        onOperationInvariantFailure(failure.mInvariant, failure.mResult,
+                                    failure.mOperation, failure.mLedgerSeq);
     }
 }
 
@@ -226,6 +287,18 @@ InvariantManagerImpl::enableInvariant(std::string const& invPattern)
     }
 }
 
+void
+InvariantManagerImpl::onOperationInvariantFailure(
+    std::shared_ptr<Invariant> invariant, std::string const& result,
+    Operation const& operation, uint32_t ledger)
+{
+    auto message = fmt::format(
+        FMT_STRING(R"(Invariant "{}" does not hold on operation: {}{}{})"),
+        invariant->getName(), result, "\n",
+        xdrToCerealString(operation, "Operation"));
+    onInvariantFailure(invariant, message, ledger);
+}
+
 void
 InvariantManagerImpl::onInvariantFailure(std::shared_ptr<Invariant> invariant,
                                          std::string const& message,
@@ -17,6 +17,8 @@ class Counter;
 namespace stellar
 {
 
+class ParallelInvariantChecker;
+
 class InvariantManagerImpl : public InvariantManager
 {
     std::map<std::string, std::shared_ptr<Invariant>> mInvariants;
@@ -30,8 +32,15 @@ class InvariantManagerImpl : public InvariantManager
     };
     std::map<std::string, InvariantFailureInformation> mFailureInformation;
 
+    // Set when operations are checked in the background
+    std::unique_ptr<ParallelInvariantChecker> mOperationChecker;
+
   public:
-    InvariantManagerImpl(medida::MetricsRegistry& registry);
+    // operationCheckThreads is INVARIANT_CHECK_THREADS, 0 checks operations
+    // synchronously
+    InvariantManagerImpl(medida::MetricsRegistry& registry,
+                         uint32_t operationCheckThreads = 0);
+    ~InvariantManagerImpl();
 
     virtual Json::Value getJsonInfo() override;
 
@@ -41,6 +50,8 @@ class InvariantManagerImpl : public InvariantManager
                                        OperationResult const& opres,
                                        LedgerTxnDelta const& ltxDelta) override;
 
+    virtual void waitForOperationChecks() override;
+
     virtual void checkOnBucketApply(
         std::shared_ptr<Bucket const> bucket, uint32_t ledger, uint32_t level,
         bool isCurr,
@@ -48,6 +59,8 @@ class InvariantManagerImpl : public InvariantManager
 
     virtual void checkAfterAssumeState(uint32_t newestLedger) override;
 
+    virtual void checkOnLedgerCommit(uint32_t ledgerSeq) override;
+
     virtual void
     registerInvariant(std::shared_ptr<Invariant> invariant) override;
 
@@ -59,6 +72,11 @@ class InvariantManagerImpl : public InvariantManager
 #endif // BUILD_TESTS
 
   private:
+    void onOperationInvariantFailure(std::shared_ptr<Invariant> invariant,
+                                     std::string const& result,
+                                     Operation const& operation,
+                                     uint32_t ledger);
+
     void onInvariantFailure(std::shared_ptr<Invariant> invariant,
                             std::string const& message, uint32_t ledger);
 
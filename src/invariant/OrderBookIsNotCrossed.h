@@ -55,6 +55,12 @@ class OrderBookIsNotCrossed : public Invariant
                           OperationResult const& result,
                           LedgerTxnDelta const& ltxDelta) override;
 
+    virtual bool
+    checksOperationsInOrder() const override
+    {
+        return true;
+    }
+
     OrderBook const&
     getOrderBook() const
     {
@@ -0,0 +1,157 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "invariant/ParallelInvariantChecker.h"
+#include "invariant/Invariant.h"
+#include "util/GlobalChecks.h"
+
+#include <Tracy.hpp>
+#include <fmt/format.h>
+#include <iterator>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+
+namespace stellar
+{
+
+namespace
+{
+std::shared_ptr<InternalLedgerEntry const>
+copyEntry(std::shared_ptr<InternalLedgerEntry const> const& entry)
+{
+    return entry ? std::make_shared<InternalLedgerEntry const>(*entry)
+                 : nullptr;
+}
+}
+
+ParallelInvariantChecker::ParallelInvariantChecker(
+    medida::MetricsRegistry& registry, size_t numThreads, size_t maxQueued)
+    : mMaxQueued(maxQueued)
+    , mLag(registry.NewTimer({"ledger", "invariant", "check-lag"}))
+    , mBlockedTime(registry.NewTimer({"ledger", "invariant", "check-blocked"}))
+    , mWaitTime(registry.NewTimer({"ledger", "invariant", "check-wait"}))
+{
+    releaseAssert(numThreads > 0);
+    releaseAssert(mMaxQueued > 0);
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        mThreads.emplace_back([this]() { run(); });
+    }
+}
+
+ParallelInvariantChecker::~ParallelInvariantChecker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    for (auto& t : mThreads)
+    {
+        t.join();
+    }
+}
+
+void
+ParallelInvariantChecker::check(
+    std::vector<std::shared_ptr<Invariant>> invariants,
+    Operation const& operation, OperationResult const& result,
+    LedgerTxnDelta const& delta)
+{
+    ZoneScoped;
+    auto job = std::make_unique<Job>();
+    job->mInvariants = std::move(invariants);
+    job->mOperation = operation;
+    job->mResult = result;
+    job->mDelta.header = delta.header;
+    job->mDelta.entry.reserve(delta.entry.size());
+    for (auto const& [key, entryDelta] : delta.entry)
+    {
+        job->mDelta.entry.emplace(
+            key, LedgerTxnDelta::EntryDelta{copyEntry(entryDelta.current),
+                                            copyEntry(entryDelta.previous)});
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mQueue.size() >= mMaxQueued)
+    {
+        auto blocked = mBlockedTime.TimeScope();
+        mCV.wait(lock, [&]() { return mQueue.size() < mMaxQueued; });
+    }
+    job->mIndex = mNextIndex++;
+    job->mQueuedAt = std::chrono::steady_clock::now();
+    mQueue.emplace_back(std::move(job));
+    lock.unlock();
+    mCV.notify_all();
+}
+
+std::vector<ParallelInvariantChecker::Failure>
+ParallelInvariantChecker::wait()
+{
+    ZoneScoped;
+    auto waitTime = mWaitTime.TimeScope();
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [&]() { return mQueue.empty() && mRunning == 0; });
+
+    std::vector<Failure> failures;
+    for (auto& kv : mFailures)
+    {
+        std::move(kv.second.begin(), kv.second.end(),
+                  std::back_inserter(failures));
+    }
+    mFailures.clear();
+    return failures;
+}
+
+void
+ParallelInvariantChecker::run()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCV.wait(lock, [&]() { return mStopping || !mQueue.empty(); });
+        if (mStopping)
+        {
+            return;
+        }
+        auto job = std::move(mQueue.front());
+        mQueue.pop_front();
+        ++mRunning;
+        lock.unlock();
+        // Wake up the main thread if it is blocked on a full queue
+        mCV.notify_all();
+
+        mLag.Update(std::chrono::steady_clock::now() - job->mQueuedAt);
+        std::vector<Failure> failures;
+        for (auto const& invariant : job->mInvariants)
+        {
+            std::string result;
+            try
+            {
+                result = invariant->checkOnOperationApply(
+                    job->mOperation, job->mResult, job->mDelta);
+            }
+            catch (std::exception const& e)
+            {
+                result = fmt::format("exception while checking: {}", e.what());
+            }
+            if (!result.empty())
+            {
+                failures.emplace_back(Failure{
+                    invariant, std::move(result), job->mOperation,
+                    job->mDelta.header.current.ledgerSeq});
+            }
+        }
+
+        lock.lock();
+        if (!failures.empty())
+        {
+            mFailures.emplace(job->mIndex, std::move(failures));
+        }
+        --mRunning;
+        lock.unlock();
+        mCV.notify_all();
+    }
+}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerTxn.h"
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-transaction.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace medida
+{
+class MetricsRegistry;
+class Timer;
+}
+
+namespace stellar
+{
+
+class Invariant;
+
+// ParallelInvariantChecker runs Invariant::checkOnOperationApply on a pool of
+// worker threads, so that the main thread can apply the next operations in the
+// meantime. Each operation is checked against all its invariants by a single
+// worker, but different operations are checked concurrently, so the
+// invariants must not keep state across operations.
+//
+// The checker keeps a deep copy of each operation's LedgerTxnDelta, as the
+// entries of a committed LedgerTxn may be modified by its parent. At most
+// `maxQueued` operations wait for a worker, beyond that check blocks.
+//
+// Failures are collected rather than reported, and returned by wait() in the
+// order the operations were checked. An exception thrown by an invariant is
+// reported as a failure of that invariant.
+class ParallelInvariantChecker : NonMovableOrCopyable
+{
+  public:
+    struct Failure
+    {
+        std::shared_ptr<Invariant> mInvariant;
+        std::string mResult;
+        Operation mOperation;
+        uint32_t mLedgerSeq;
+    };
+
+  private:
+    struct Job
+    {
+        uint64_t mIndex;
+        std::vector<std::shared_ptr<Invariant>> mInvariants;
+        Operation mOperation;
+        OperationResult mResult;
+        LedgerTxnDelta mDelta;
+        std::chrono::steady_clock::time_point mQueuedAt;
+    };
+
+    size_t const mMaxQueued;
+
+    // Guarded by mMutex
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<std::unique_ptr<Job>> mQueue;
+    size_t mRunning{0};
+    uint64_t mNextIndex{0};
+    // Index of the job -> failures of its operation
+    std::map<uint64_t, std::vector<Failure>> mFailures;
+    bool mStopping{false};
+
+    medida::Timer& mLag;
+    medida::Timer& mBlockedTime;
+    medida::Timer& mWaitTime;
+
+    std::vector<std::thread> mThreads;
+
+    void run();
+
+  public:
+    ParallelInvariantChecker(medida::MetricsRegistry& registry,
+                             size_t numThreads, size_t maxQueued);
+
+    // Drops the operations that weren't checked yet
+    ~ParallelInvariantChecker();
+
+    void check(std::vector<std::shared_ptr<Invariant>> invariants,
+               Operation const& operation, OperationResult const& result,
+               LedgerTxnDelta const& delta);
+
+    // Blocks until every operation passed to check so far is checked, and
+    // returns their failures
+    std::vector<Failure> wait();
+};
+}
@@ -7,6 +7,7 @@
 #include "bucket/BucketOutputIterator.h"
 #include "bucket/test/BucketTestUtils.h"
 #include "catchup/ApplyBucketsWork.h"
+#include "invariant/BucketListIsConsistentWithDatabase.h"
 #include "ledger/LedgerHashUtils.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
@@ -15,7 +16,9 @@
 #include "lib/catch.hpp"
 #include "lib/util/stdrandom.h"
 #include "main/Application.h"
+#include "test/TestAccount.h"
 #include "test/TestUtils.h"
+#include "test/TxTests.h"
 #include "test/test.h"
 #include "transactions/TransactionUtils.h"
 #include "util/Decoder.h"
@@ -630,6 +633,90 @@ TEST_CASE("BucketListIsConsistentWithDatabase succeed",
     REQUIRE_NOTHROW(blg.applyBuckets());
 }
 
+TEST_CASE("BucketListIsConsistentWithDatabase offer hash",
+          "[invariant][bucketlistconsistent]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(
+        clock, getTestConfig(0, Config::TESTDB_BUCKET_DB_VOLATILE));
+    auto& bm = app->getBucketManager();
+    auto& ltxRoot = app->getLedgerTxnRoot();
+    auto& lm = app->getLedgerManager();
+    BucketListIsConsistentWithDatabase blc(*app);
+
+    auto root = TestAccount::createRoot(*app);
+    auto const minBalance = lm.getLastMinBalance(3);
+    auto issuer = root.create("issuer", minBalance);
+    auto a1 = root.create("A1", minBalance);
+    auto usd = txtest::makeAsset(issuer, "USD");
+    auto native = txtest::makeNativeAsset();
+    a1.changeTrust(usd, INT64_MAX);
+    auto offerID = a1.manageOffer(0, native, usd, Price{1, 1}, 100);
+
+    // Nothing is tracked until the state is checked once
+    REQUIRE(!bm.getOfferHash());
+    REQUIRE(!ltxRoot.getOfferHash());
+    REQUIRE(blc.checkOnLedgerCommit(lm.getLastClosedLedgerNum()).empty());
+
+    REQUIRE(blc.checkAfterAssumeState(lm.getLastClosedLedgerNum()).empty());
+    REQUIRE(bm.getOfferHash());
+    REQUIRE(ltxRoot.getOfferHash() == bm.getOfferHash());
+
+    SECTION("maintained as offers change")
+    {
+        // Every ledger closed here also runs checkOnLedgerCommit
+        a1.manageOffer(offerID, native, usd, Price{1, 2}, 50,
+                       MANAGE_OFFER_UPDATED);
+        a1.manageOffer(0, native, usd, Price{1, 1}, 10);
+        a1.manageOffer(offerID, native, usd, Price{1, 2}, 0,
+                       MANAGE_OFFER_DELETED);
+        REQUIRE(ltxRoot.getOfferHash() == bm.getOfferHash());
+
+        // And matches the hash computed from scratch
+        auto tracked = bm.getOfferHash();
+        REQUIRE(
+            blc.checkAfterAssumeState(lm.getLastClosedLedgerNum()).empty());
+        REQUIRE(bm.getOfferHash() == tracked);
+    }
+
+    SECTION("detects offers modified in the database only")
+    {
+        {
+            LedgerTxn ltx(ltxRoot);
+            auto offer = ltx.load(offerKey(a1.getPublicKey(), offerID));
+            offer.current().data.offer().amount = 1;
+            ltx.commit();
+        }
+        REQUIRE(ltxRoot.getOfferHash() != bm.getOfferHash());
+        REQUIRE(!blc.checkOnLedgerCommit(lm.getLastClosedLedgerNum()).empty());
+
+        // The full check reports the inconsistent offer and stops tracking
+        auto s = blc.checkAfterAssumeState(lm.getLastClosedLedgerNum());
+        REQUIRE(s.find("Inconsistent state between objects") !=
+                std::string::npos);
+        REQUIRE(!bm.getOfferHash());
+        REQUIRE(!ltxRoot.getOfferHash());
+    }
+
+    SECTION("detects offers written without loading in the database only")
+    {
+        // getAllOffers does not hand out offers to a child, so the root reads
+        // the version the write replaces back from the database
+        auto offers = ltxRoot.getAllOffers();
+        auto le = offers.at(offerKey(a1.getPublicKey(), offerID));
+        {
+            LedgerTxn ltx(ltxRoot);
+            le.data.offer().amount = 1;
+            ltx.updateWithoutLoading(le);
+            ltx.commit();
+        }
+        REQUIRE(ltxRoot.getOfferHash());
+        REQUIRE(bm.getOfferHash());
+        REQUIRE(*ltxRoot.getOfferHash() != *bm.getOfferHash());
+        REQUIRE(!blc.checkOnLedgerCommit(lm.getLastClosedLedgerNum()).empty());
+    }
+}
+
 TEST_CASE("BucketListIsConsistentWithDatabase empty ledgers",
           "[invariant][bucketlistconsistent]")
 {
@@ -14,6 +14,7 @@
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
+#include "test/TestAccount.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
 
@@ -222,3 +223,49 @@ TEST_CASE("onOperationApply fail succeed", "[invariant]")
             {}, res, ltx.getDelta()));
     }
 }
+
+TEST_CASE("onOperationApply checked in parallel", "[invariant]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    cfg.INVARIANT_CHECK_THREADS = 2;
+
+    SECTION("Fail")
+    {
+        Application::pointer app = createTestApplication(clock, cfg);
+        auto& im = app->getInvariantManager();
+        im.registerInvariant<TestInvariant>(0, false);
+        im.registerInvariant<TestInvariant>(1, true);
+        im.enableInvariant(TestInvariant::toString(-1, false) + ".*");
+        im.enableInvariant(TestInvariant::toString(1, true));
+
+        // Failures are only reported once all checks are done
+        OperationResult res;
+        for (int i = 0; i < 10; ++i)
+        {
+            LedgerTxn ltx(app->getLedgerTxnRoot());
+            REQUIRE_NOTHROW(im.checkOnOperationApply({}, res, ltx.getDelta()));
+        }
+        REQUIRE_THROWS_AS(im.waitForOperationChecks(), InvariantDoesNotHold);
+        REQUIRE_NOTHROW(im.waitForOperationChecks());
+    }
+    SECTION("Succeed with all invariants")
+    {
+        cfg.INVARIANT_CHECKS = {".*"};
+        Application::pointer app = createTestApplication(clock, cfg);
+
+        auto root = TestAccount::createRoot(*app);
+        auto minBalance = app->getLedgerManager().getLastMinBalance(2);
+        std::vector<TestAccount> accounts;
+        for (int i = 0; i < 5; ++i)
+        {
+            accounts.emplace_back(
+                root.create(fmt::format("A{}", i), minBalance * 10));
+        }
+        for (auto& account : accounts)
+        {
+            account.pay(root, minBalance);
+        }
+        REQUIRE_NOTHROW(app->getInvariantManager().waitForOperationChecks());
+    }
+}
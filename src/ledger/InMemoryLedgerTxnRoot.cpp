@@ -130,6 +130,17 @@ InMemoryLedgerTxnRoot::dropOffers(bool)
 {
 }
 
+void
+InMemoryLedgerTxnRoot::trackOfferHash(std::optional<MultisetHash>)
+{
+}
+
+std::optional<MultisetHash>
+InMemoryLedgerTxnRoot::getOfferHash() const
+{
+    return std::nullopt;
+}
+
 void
 InMemoryLedgerTxnRoot::dropTrustLines(bool)
 {
@@ -155,6 +166,11 @@ InMemoryLedgerTxnRoot::dropContractCode(bool)
 {
 }
 
+void
+InMemoryLedgerTxnRoot::clearContractCodeCache()
+{
+}
+
 void
 InMemoryLedgerTxnRoot::dropConfigSettings(bool)
 {
@@ -73,11 +73,14 @@ class InMemoryLedgerTxnRoot : public AbstractLedgerTxnParent
     void dropAccounts(bool rebuild) override;
     void dropData(bool rebuild) override;
     void dropOffers(bool rebuild) override;
+    void trackOfferHash(std::optional<MultisetHash> initial) override;
+    std::optional<MultisetHash> getOfferHash() const override;
     void dropTrustLines(bool rebuild) override;
     void dropClaimableBalances(bool rebuild) override;
     void dropLiquidityPools(bool rebuild) override;
     void dropContractData(bool rebuild) override;
     void dropContractCode(bool rebuild) override;
+    void clearContractCodeCache() override;
     void dropConfigSettings(bool rebuild) override;
     void dropTTL(bool rebuild) override;
     double getPrefetchHitRate() const override;
@@ -5,13 +5,16 @@
 #include "ledger/LedgerCloseMetaFrame.h"
 #include "crypto/SHA.h"
 #include "ledger/LedgerTypeUtils.h"
+#include "ledger/MetaFilter.h"
 #include "transactions/TransactionMetaFrame.h"
 #include "util/GlobalChecks.h"
 #include "util/ProtocolVersion.h"
 
 namespace stellar
 {
-LedgerCloseMetaFrame::LedgerCloseMetaFrame(uint32_t protocolVersion)
+LedgerCloseMetaFrame::LedgerCloseMetaFrame(uint32_t protocolVersion,
+                                           MetaFilter* filter)
+    : mFilter(filter)
 {
     // The LedgerCloseMeta v() switch can be in 2 positions, 0 and 1. We
     // currently support all of these cases, depending on both compile time
@@ -25,6 +28,12 @@ LedgerCloseMetaFrame::LedgerCloseMetaFrame(uint32_t protocolVersion)
     mLedgerCloseMeta.v(mVersion);
 }
 
+bool
+LedgerCloseMetaFrame::recordsEntryChanges() const
+{
+    return !mFilter || mFilter->includes(MetaFilter::Section::ENTRY_CHANGES);
+}
+
 LedgerHeaderHistoryEntry&
 LedgerCloseMetaFrame::ledgerHeader()
 {
@@ -73,15 +82,21 @@ LedgerCloseMetaFrame::pushTxProcessingEntry()
 
 void
 LedgerCloseMetaFrame::setLastTxProcessingFeeProcessingChanges(
-    LedgerEntryChanges const& changes)
+    LedgerEntryChanges&& changes)
 {
+    if (mFilter)
+    {
+        mFilter->filterChanges(changes);
+    }
     switch (mVersion)
     {
     case 0:
-        mLedgerCloseMeta.v0().txProcessing.back().feeProcessing = changes;
+        mLedgerCloseMeta.v0().txProcessing.back().feeProcessing =
+            std::move(changes);
         break;
     case 1:
-        mLedgerCloseMeta.v1().txProcessing.back().feeProcessing = changes;
+        mLedgerCloseMeta.v1().txProcessing.back().feeProcessing =
+            std::move(changes);
         break;
     default:
         releaseAssert(false);
@@ -130,6 +145,10 @@ LedgerCloseMetaFrame::upgradesProcessing()
 void
 LedgerCloseMetaFrame::populateTxSet(TxSetXDRFrame const& txSet)
 {
+    if (mFilter && !mFilter->includes(MetaFilter::Section::TX_SET))
+    {
+        return;
+    }
     switch (mVersion)
     {
     case 0:
@@ -148,6 +167,10 @@ LedgerCloseMetaFrame::populateEvictedEntries(
     LedgerEntryChanges const& evictionChanges)
 {
     releaseAssert(mVersion == 1);
+    if (mFilter && !mFilter->includes(MetaFilter::Section::EVICTED_ENTRIES))
+    {
+        return;
+    }
     for (auto const& change : evictionChanges)
     {
         switch (change.type())
@@ -175,6 +198,10 @@ LedgerCloseMetaFrame::setNetworkConfiguration(
     SorobanNetworkConfig const& networkConfig, bool emitExtV1)
 {
     releaseAssert(mVersion == 1);
+    if (mFilter && !mFilter->includes(MetaFilter::Section::NETWORK_CONFIG))
+    {
+        return;
+    }
     mLedgerCloseMeta.v1().totalByteSizeOfBucketList =
         networkConfig.getAverageBucketListSize();
 
@@ -10,18 +10,25 @@
 namespace stellar
 {
 
+class MetaFilter;
+
 // Wrapper around LedgerCloseMeta XDR that provides mutable access to fields
-// in the proper version of meta.
+// in the proper version of meta. When given a MetaFilter, the parts it
+// excludes are not populated.
 class LedgerCloseMetaFrame
 {
   public:
-    LedgerCloseMetaFrame(uint32_t protocolVersion);
+    LedgerCloseMetaFrame(uint32_t protocolVersion,
+                         MetaFilter* filter = nullptr);
+
+    // False if entry changes are excluded altogether, in which case callers
+    // can skip computing them
+    bool recordsEntryChanges() const;
 
     LedgerHeaderHistoryEntry& ledgerHeader();
     void reserveTxProcessing(size_t n);
     void pushTxProcessingEntry();
-    void
-    setLastTxProcessingFeeProcessingChanges(LedgerEntryChanges const& changes);
+    void setLastTxProcessingFeeProcessingChanges(LedgerEntryChanges&& changes);
     void setTxProcessingMetaAndResultPair(TransactionMeta const& tm,
                                           TransactionResultPair&& rp,
                                           int index);
@@ -40,6 +47,7 @@ class LedgerCloseMetaFrame
   private:
     LedgerCloseMeta mLedgerCloseMeta;
     int mVersion;
+    MetaFilter* mFilter;
 };
 
 }
@@ -191,6 +191,12 @@ class LedgerManager
 
     virtual SorobanMetrics& getSorobanMetrics() = 0;
 
+    // Blocks until the meta of every ledger closed so far is written to
+    // METADATA_OUTPUT_STREAM. Meta is written by a background thread when
+    // METADATA_OUTPUT_STREAM_QUEUE_SIZE is set, and as ledgers close
+    // otherwise. Rethrows the error if writing the stream failed.
+    virtual void flushMetaStream() = 0;
+
     virtual ~LedgerManager()
     {
     }
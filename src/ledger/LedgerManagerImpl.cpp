@@ -17,6 +17,8 @@
 #include "herder/TxSetFrame.h"
 #include "herder/Upgrades.h"
 #include "history/HistoryManager.h"
+#include "invariant/InvariantDoesNotHold.h"
+#include "invariant/InvariantManager.h"
 #include "ledger/FlushAndRotateMetaDebugWork.h"
 #include "ledger/LedgerHeaderUtils.h"
 #include "ledger/LedgerRange.h"
@@ -256,6 +258,7 @@ LedgerManagerImpl::startNewLedger(LedgerHeader const& genesisLedger)
     CLOG_INFO(Ledger, "Root account: {}", skey.getStrKeyPublic());
     CLOG_INFO(Ledger, "Root account seed: {}", skey.getStrKeySeed().value);
     ledgerClosed(ltx, /*ledgerCloseMeta*/ nullptr, /*initialLedgerVers*/ 0);
+    mApp.getHistoryManager().waitForCheckpointWrites();
     ltx.commit();
 }
 
@@ -769,18 +772,23 @@ LedgerManagerImpl::emitNextMeta()
     ZoneScoped;
 
     releaseAssert(mNextMetaToEmit);
-    releaseAssert(mMetaStream || mMetaDebugStream);
+    releaseAssert(isStreamingMeta());
     auto timer = LogSlowExecution("MetaStream write",
                                   LogSlowExecution::Mode::AUTOMATIC_RAII,
                                   "took", std::chrono::milliseconds(100));
-    auto streamWrite = mMetaStreamWriteTime.TimeScope();
     if (mMetaStream)
     {
+        auto streamWrite = mMetaStreamWriteTime.TimeScope();
         size_t written = 0;
         mMetaStream->writeOne(mNextMetaToEmit->getXDR(), nullptr, &written);
         mMetaStream->flush();
         mMetaStreamBytes.Mark(written);
     }
+    if (mMetaRing)
+    {
+        auto streamWrite = mMetaStreamWriteTime.TimeScope();
+        mMetaStreamBytes.Mark(mMetaRing->publish(mNextMetaToEmit->getXDR()));
+    }
     if (mMetaDebugStream)
     {
         mMetaDebugStream->writeOne(mNextMetaToEmit->getXDR());
@@ -789,6 +797,11 @@ LedgerManagerImpl::emitNextMeta()
         // the meta for problematic ledgers that is vital for diagnostics.
         mMetaDebugStream->flush();
     }
+    if (mMetaStreamWriter)
+    {
+        // Hands the meta off, so this comes last
+        mMetaStreamWriter->emit(std::move(mNextMetaToEmit));
+    }
     mNextMetaToEmit.reset();
 }
 
@@ -887,7 +900,7 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     // the ledger entries modified by each tx during tx processing in a
     // LedgerCloseMeta, for streaming to attached clients (typically: horizon).
     std::unique_ptr<LedgerCloseMetaFrame> ledgerCloseMeta;
-    if (mMetaStream || mMetaDebugStream)
+    if (isStreamingMeta())
     {
         if (mNextMetaToEmit)
         {
@@ -900,7 +913,7 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
         // enables us to discard incomplete meta and retry, should anything in
         // this method throw.
         ledgerCloseMeta = std::make_unique<LedgerCloseMetaFrame>(
-            header.current().ledgerVersion);
+            header.current().ledgerVersion, mMetaFilter.get());
         ledgerCloseMeta->reserveTxProcessing(applicableTxSet->sizeTxTotal());
         ledgerCloseMeta->populateTxSet(*txSet);
     }
@@ -921,6 +934,20 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     // Subtle: after this call, `header` is invalidated, and is not safe to use
     applyTransactions(*applicableTxSet, txs, mutableTxResults, ltx, txResultSet,
                       ledgerCloseMeta);
+
+    // Invariants may still be checked on the last operations in the
+    // background. As when they are checked synchronously, nothing about this
+    // ledger may be recorded before they hold.
+    try
+    {
+        mApp.getInvariantManager().waitForOperationChecks();
+    }
+    catch (InvariantDoesNotHold& e)
+    {
+        printErrorAndAbort("Invariant failure while applying operations: ",
+                           e.what());
+    }
+
     if (mApp.getConfig().MODE_STORES_HISTORY_MISC)
     {
         auto ledgerSeq = ltx.loadHeader().current().ledgerSeq;
@@ -996,7 +1023,7 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
         throw std::runtime_error("Local node's ledger corrupted during close");
     }
 
-    if (mMetaStream || mMetaDebugStream)
+    if (isStreamingMeta())
     {
         releaseAssert(ledgerCloseMeta);
         ledgerCloseMeta->ledgerHeader() = mLastClosedLedger;
@@ -1023,7 +1050,9 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     //    transaction. This way if there's a crash after commit and before
     //    we've published successfully, we'll re-publish on restart.
     //
-    // 2. Commit the current transaction.
+    // 2. Wait for the checkpoint files appended to in the background to be
+    //    durable, then commit the current transaction. Dirty checkpoint files
+    //    must never end before the committed ledger.
     //
     // 3. Finalize any new checkpoint files _after_ the commit. If a crash
     // occurs
@@ -1046,8 +1075,19 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     hm.maybeQueueHistoryCheckpoint();
 
     // step 2
+    hm.waitForCheckpointWrites();
     ltx.commit();
 
+    try
+    {
+        mApp.getInvariantManager().checkOnLedgerCommit(ledgerSeq);
+    }
+    catch (InvariantDoesNotHold& e)
+    {
+        printErrorAndAbort("Invariant failure after committing ledger: ",
+                           e.what());
+    }
+
 #ifdef BUILD_TESTS
     mLatestTxResultSet = txResultSet;
 #endif
@@ -1148,17 +1188,44 @@ LedgerManagerImpl::manuallyAdvanceLedgerHeader(LedgerHeader const& header)
     advanceLedgerPointers(header, false);
 }
 
+void
+LedgerManagerImpl::flushMetaStream()
+{
+    ZoneScoped;
+    if (mMetaStreamWriter)
+    {
+        mMetaStreamWriter->drain();
+    }
+}
+
 void
 LedgerManagerImpl::setupLedgerCloseMetaStream()
 {
     ZoneScoped;
 
-    if (mMetaStream)
+    if (mMetaStream || mMetaStreamWriter || mMetaRing)
     {
         throw std::runtime_error("LedgerManagerImpl already streaming");
     }
     auto& cfg = mApp.getConfig();
-    if (cfg.METADATA_OUTPUT_STREAM != "")
+    if (!cfg.METADATA_OUTPUT_EXCLUDE.empty() ||
+        !cfg.METADATA_OUTPUT_ENTRY_FILTER.empty())
+    {
+        mMetaFilter = std::make_unique<MetaFilter>(
+            cfg.METADATA_OUTPUT_EXCLUDE, cfg.METADATA_OUTPUT_ENTRY_FILTER);
+    }
+    std::regex shmrx("^shm:(.+)$");
+    std::smatch shm;
+    if (std::regex_match(cfg.METADATA_OUTPUT_STREAM, shm, shmrx))
+    {
+        // The ring buffer already lets ledger close run ahead of the reader,
+        // METADATA_OUTPUT_STREAM_QUEUE_SIZE doesn't apply
+        mMetaRing = std::make_unique<MetaRingWriter>(
+            shm[1].str(),
+            static_cast<size_t>(cfg.METADATA_OUTPUT_RING_BUFFER_SIZE_MB)
+                << 20);
+    }
+    else if (cfg.METADATA_OUTPUT_STREAM != "")
     {
         // We can't be sure we're writing to a stream that supports fsync;
         // pipes typically error when you try. So we don't do it.
@@ -1179,6 +1246,13 @@ LedgerManagerImpl::setupLedgerCloseMetaStream()
                       cfg.METADATA_OUTPUT_STREAM);
             mMetaStream->open(cfg.METADATA_OUTPUT_STREAM);
         }
+        if (cfg.METADATA_OUTPUT_STREAM_QUEUE_SIZE > 0)
+        {
+            mMetaStreamWriter = std::make_unique<MetaStreamWriter>(
+                mApp, std::move(mMetaStream),
+                cfg.METADATA_OUTPUT_STREAM_QUEUE_SIZE,
+                cfg.METADATA_OUTPUT_STREAM_SPILL);
+        }
     }
 }
 void
@@ -1386,12 +1460,14 @@ LedgerManagerImpl::processFeesSeqNums(
                 }
             }
 
-            LedgerEntryChanges changes = ltxTx.getChanges();
             if (ledgerCloseMeta)
             {
                 ledgerCloseMeta->pushTxProcessingEntry();
-                ledgerCloseMeta->setLastTxProcessingFeeProcessingChanges(
-                    changes);
+                if (ledgerCloseMeta->recordsEntryChanges())
+                {
+                    ledgerCloseMeta->setLastTxProcessingFeeProcessingChanges(
+                        ltxTx.getChanges());
+                }
             }
             ++index;
             ltxTx.commit();
@@ -1533,7 +1609,8 @@ LedgerManagerImpl::applyTransactions(
         auto mutableTxResult = mutableTxResults.at(i);
 
         auto txTime = mTransactionApply.TimeScope();
-        TransactionMetaFrame tm(ltx.loadHeader().current().ledgerVersion);
+        TransactionMetaFrame tm(ltx.loadHeader().current().ledgerVersion,
+                                mMetaFilter.get());
         CLOG_DEBUG(Tx, " tx#{} = {} ops={} txseq={} (@ {})", index,
                    hexAbbrev(tx->getContentsHash()), tx->getNumOperations(),
                    tx->getSeqNum(),
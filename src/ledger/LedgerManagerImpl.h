@@ -8,6 +8,9 @@
 #include "history/HistoryManager.h"
 #include "ledger/LedgerCloseMetaFrame.h"
 #include "ledger/LedgerManager.h"
+#include "ledger/MetaFilter.h"
+#include "ledger/MetaRingWriter.h"
+#include "ledger/MetaStreamWriter.h"
 #include "ledger/NetworkConfig.h"
 #include "ledger/SorobanMetrics.h"
 #include "main/PersistentState.h"
@@ -44,7 +47,15 @@ class LedgerManagerImpl : public LedgerManager
   protected:
     Application& mApp;
     std::unique_ptr<XDROutputFileStream> mMetaStream;
+    // Set instead of mMetaStream when METADATA_OUTPUT_STREAM_QUEUE_SIZE is
+    // non-zero
+    std::unique_ptr<MetaStreamWriter> mMetaStreamWriter;
+    // Set instead of mMetaStream when METADATA_OUTPUT_STREAM is "shm:<path>"
+    std::unique_ptr<MetaRingWriter> mMetaRing;
     std::unique_ptr<XDROutputFileStream> mMetaDebugStream;
+    // Parts of the meta to build, set when METADATA_OUTPUT_EXCLUDE or
+    // METADATA_OUTPUT_ENTRY_FILTER is
+    std::unique_ptr<MetaFilter> mMetaFilter;
     std::weak_ptr<BasicWork> mFlushAndRotateMetaDebugWork;
     std::filesystem::path mMetaDebugPath;
 
@@ -110,6 +121,12 @@ class LedgerManagerImpl : public LedgerManager
     void setState(State s);
 
     void emitNextMeta();
+    bool
+    isStreamingMeta() const
+    {
+        return mMetaStream || mMetaStreamWriter || mMetaRing ||
+               mMetaDebugStream;
+    }
 
     SorobanNetworkConfig& getSorobanNetworkConfigInternal();
 
@@ -169,6 +186,7 @@ class LedgerManagerImpl : public LedgerManager
 
     uint64_t secondsSinceLastLedgerClose() const override;
     void syncMetrics() override;
+    void flushMetaStream() override;
 
     void startNewLedger(LedgerHeader const& genesisLedger);
     void startNewLedger() override;
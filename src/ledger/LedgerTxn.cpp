@@ -10,12 +10,14 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
 #include "database/Database.h"
+#include "ledger/LedgerManager.h"
 #include "ledger/LedgerRange.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "ledger/LedgerTxnHeader.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/LedgerTypeUtils.h"
 #include "ledger/NonSociRelatedException.h"
+#include "ledger/SorobanMetrics.h"
 #include "main/Application.h"
 #include "transactions/TransactionUtils.h"
 #include "util/GlobalChecks.h"
@@ -25,10 +27,14 @@
 #include "xdr/Stellar-ledger-entries.h"
 #include "xdrpp/marshal.h"
 #include <Tracy.hpp>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
 #include <soci.h>
 
 #include <algorithm>
 #include <numeric>
+#include <thread>
 
 namespace stellar
 {
@@ -2045,6 +2051,18 @@ LedgerTxn::dropOffers(bool rebuild)
     throw std::runtime_error("called dropOffers on non-root LedgerTxn");
 }
 
+void
+LedgerTxn::trackOfferHash(std::optional<MultisetHash> initial)
+{
+    throw std::runtime_error("called trackOfferHash on non-root LedgerTxn");
+}
+
+std::optional<MultisetHash>
+LedgerTxn::getOfferHash() const
+{
+    throw std::runtime_error("called getOfferHash on non-root LedgerTxn");
+}
+
 void
 LedgerTxn::dropTrustLines(bool rebuild)
 {
@@ -2076,6 +2094,13 @@ LedgerTxn::dropContractCode(bool rebuild)
     throw std::runtime_error("called dropContractCode on non-root LedgerTxn");
 }
 
+void
+LedgerTxn::clearContractCodeCache()
+{
+    throw std::runtime_error(
+        "called clearContractCodeCache on non-root LedgerTxn");
+}
+
 void
 LedgerTxn::dropConfigSettings(bool rebuild)
 {
@@ -2497,13 +2522,15 @@ LedgerTxn::Impl::EntryIteratorImpl::clone() const
 size_t const LedgerTxnRoot::Impl::MIN_BEST_OFFERS_BATCH_SIZE = 5;
 
 LedgerTxnRoot::LedgerTxnRoot(Application& app, size_t entryCacheSize,
-                             size_t prefetchBatchSize
+                             size_t prefetchBatchSize,
+                             size_t contractCodeCacheSize
 #ifdef BEST_OFFER_DEBUGGING
                              ,
                              bool bestOfferDebuggingEnabled
 #endif
                              )
-    : mImpl(std::make_unique<Impl>(app, entryCacheSize, prefetchBatchSize
+    : mImpl(std::make_unique<Impl>(app, entryCacheSize, prefetchBatchSize,
+                                   contractCodeCacheSize
 #ifdef BEST_OFFER_DEBUGGING
                                    ,
                                    bestOfferDebuggingEnabled
@@ -2513,7 +2540,8 @@ LedgerTxnRoot::LedgerTxnRoot(Application& app, size_t entryCacheSize,
 }
 
 LedgerTxnRoot::Impl::Impl(Application& app, size_t entryCacheSize,
-                          size_t prefetchBatchSize
+                          size_t prefetchBatchSize,
+                          size_t contractCodeCacheSize
 #ifdef BEST_OFFER_DEBUGGING
                           ,
                           bool bestOfferDebuggingEnabled
@@ -2525,6 +2553,11 @@ LedgerTxnRoot::Impl::Impl(Application& app, size_t entryCacheSize,
     , mApp(app)
     , mHeader(std::make_unique<LedgerHeader>())
     , mEntryCache(entryCacheSize)
+    , mContractCodeCache(contractCodeCacheSize)
+    , mContractCodeCacheHit(app.getMetrics().NewMeter(
+          {"ledger", "contract-code-cache", "hit"}, "entry"))
+    , mContractCodeCacheMiss(app.getMetrics().NewMeter(
+          {"ledger", "contract-code-cache", "miss"}, "entry"))
     , mBulkLoadBatchSize(prefetchBatchSize)
     , mChild(nullptr)
 #ifdef BEST_OFFER_DEBUGGING
@@ -2551,6 +2584,9 @@ LedgerTxnRoot::Impl::resetForFuzzer()
 {
     mBestOffers.clear();
     mEntryCache.clear();
+    mContractCodeCache.clear();
+    mOfferHash.reset();
+    mOfferPreImages.clear();
 }
 
 void
@@ -2710,12 +2746,14 @@ LedgerTxnRoot::Impl::bulkApply(BulkLedgerEntryChangeAccumulator& bleca,
     auto& upsertOffers = bleca.getOffersToUpsert();
     if (upsertOffers.size() > bufferThreshold)
     {
+        updateOfferHash(upsertOffers);
         bulkUpsertOffers(upsertOffers);
         upsertOffers.clear();
     }
     auto& deleteOffers = bleca.getOffersToDelete();
     if (deleteOffers.size() > bufferThreshold)
     {
+        updateOfferHash(deleteOffers);
         bulkDeleteOffers(deleteOffers, cons);
         deleteOffers.clear();
     }
@@ -2824,10 +2862,20 @@ LedgerTxnRoot::Impl::commitChild(EntryIterator iter,
     auto bucketListDBEnabled = mApp.getConfig().isUsingBucketListDB();
     auto bleca = BulkLedgerEntryChangeAccumulator();
     [[maybe_unused]] int64_t counter{0};
+    auto& metrics = mApp.getMetrics();
+    UnorderedSet<LedgerKey> modifiedCode;
     try
     {
+        auto writeTimer =
+            metrics.NewTimer({"ledger", "root", "write"}).TimeScope();
         while ((bool)iter)
         {
+            auto const& key = iter.key();
+            if (key.type() == InternalLedgerEntryType::LEDGER_ENTRY &&
+                key.ledgerKey().type() == CONTRACT_CODE)
+            {
+                modifiedCode.emplace(key.ledgerKey());
+            }
             if (bleca.accumulate(iter, bucketListDBEnabled))
             {
                 ++counter;
@@ -2847,8 +2895,16 @@ LedgerTxnRoot::Impl::commitChild(EntryIterator iter,
         // WAL-auto-checkpointing-at-commit behaviour will starve if there are
         // still prepared statements open at commit time.
         mApp.getDatabase().clearPreparedStatementCache();
+        writeTimer.Stop();
+
         ZoneNamedN(commitZone, "SOCI commit", true);
+        auto commitTimer =
+            metrics.NewTimer({"ledger", "root", "sql-commit"}).TimeScope();
         mTransaction->commit();
+        commitTimer.Stop();
+
+        // Checkpoint the WAL between commits rather than during one
+        mApp.getDatabase().requestWalCheckpoint();
     }
     catch (std::exception& e)
     {
@@ -2864,6 +2920,22 @@ LedgerTxnRoot::Impl::commitChild(EntryIterator iter,
     // Clearing the cache does not throw
     mBestOffers.clear();
     mEntryCache.clear();
+    mOfferPreImages.clear();
+    try
+    {
+        if (!modifiedCode.empty())
+        {
+            mContractCodeCache.erase_if(
+                [&](std::shared_ptr<LedgerEntry const> const& entry) {
+                    return modifiedCode.find(LedgerEntryKey(*entry)) !=
+                           modifiedCode.end();
+                });
+        }
+    }
+    catch (...)
+    {
+        mContractCodeCache.clear();
+    }
 
     // std::unique_ptr<...>::reset does not throw
     mTransaction.reset();
@@ -2962,7 +3034,10 @@ LedgerTxnRoot::Impl::deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const
     using namespace soci;
     throwIfChild();
     mEntryCache.clear();
+    mContractCodeCache.clear();
     mBestOffers.clear();
+    mOfferHash.reset();
+    mOfferPreImages.clear();
 
     for (auto let : xdr::xdr_traits<LedgerEntryType>::enum_values())
     {
@@ -2991,6 +3066,79 @@ LedgerTxnRoot::dropOffers(bool rebuild)
     mImpl->dropOffers(rebuild);
 }
 
+void
+LedgerTxnRoot::trackOfferHash(std::optional<MultisetHash> initial)
+{
+    mImpl->trackOfferHash(std::move(initial));
+}
+
+void
+LedgerTxnRoot::Impl::trackOfferHash(std::optional<MultisetHash> initial)
+{
+    throwIfChild();
+    mOfferHash = std::move(initial);
+
+    // Offers cached before tracking started would be handed out without
+    // recording their pre-image
+    mEntryCache.clear();
+    mBestOffers.clear();
+    mOfferPreImages.clear();
+}
+
+std::optional<MultisetHash>
+LedgerTxnRoot::getOfferHash() const
+{
+    return mImpl->getOfferHash();
+}
+
+std::optional<MultisetHash>
+LedgerTxnRoot::Impl::getOfferHash() const
+{
+    return mOfferHash;
+}
+
+void
+LedgerTxnRoot::Impl::updateOfferHash(std::vector<EntryIterator> const& entries)
+{
+    if (!mOfferHash || entries.empty())
+    {
+        return;
+    }
+
+    // Offers a child loaded were handed out by this root, which recorded the
+    // version in the database. Offers written without loading are read within
+    // the same SQL transaction, before the new versions are written.
+    ZoneScoped;
+    UnorderedSet<LedgerKey> unknown;
+    for (auto const& e : entries)
+    {
+        auto const& key = e.key().ledgerKey();
+        auto iter = mOfferPreImages.find(key);
+        if (iter == mOfferPreImages.end())
+        {
+            unknown.emplace(key);
+        }
+        else if (iter->second)
+        {
+            mOfferHash->removeXDR(*iter->second);
+        }
+        if (e.entryExists())
+        {
+            mOfferHash->addXDR(e.entry().ledgerEntry());
+        }
+    }
+    if (!unknown.empty())
+    {
+        for (auto const& [key, previous] : bulkLoadOffers(unknown))
+        {
+            if (previous)
+            {
+                mOfferHash->removeXDR(*previous);
+            }
+        }
+    }
+}
+
 void
 LedgerTxnRoot::dropTrustLines(bool rebuild)
 {
@@ -3021,6 +3169,19 @@ LedgerTxnRoot::dropContractCode(bool rebuild)
     mImpl->dropContractCode(rebuild);
 }
 
+void
+LedgerTxnRoot::clearContractCodeCache()
+{
+    mImpl->clearContractCodeCache();
+}
+
+void
+LedgerTxnRoot::Impl::clearContractCodeCache()
+{
+    throwIfChild();
+    mContractCodeCache.clear();
+}
+
 void
 LedgerTxnRoot::dropConfigSettings(bool rebuild)
 {
@@ -3079,6 +3240,18 @@ LedgerTxnRoot::Impl::prefetchInternal(UnorderedSet<LedgerKey> const& keys,
         };
 
     auto insertIfNotLoaded = [&](auto& keys, LedgerKey const& key) {
+        if (key.type() == CONTRACT_CODE)
+        {
+            if (auto cached = mContractCodeCache.maybeGet(key))
+            {
+                if (lkMeter)
+                {
+                    lkMeter->updateReadQuotasForKey(key,
+                                                    xdr::xdr_size(**cached));
+                }
+                return;
+            }
+        }
         if (!mEntryCache.exists(key, false))
         {
             keys.insert(key);
@@ -3103,8 +3276,10 @@ LedgerTxnRoot::Impl::prefetchInternal(UnorderedSet<LedgerKey> const& keys,
         {
             insertIfNotLoaded(keysToSearch, key);
         }
-        auto blLoad = getSearchableBucketListSnapshot().loadKeysWithLimits(
-            keysToSearch, lkMeter);
+        auto blLoad =
+            lkMeter ? loadSorobanKeys(keysToSearch, *lkMeter)
+                    : getSearchableBucketListSnapshot().loadKeysWithLimits(
+                          keysToSearch, nullptr);
         cacheResult(populateLoadedEntries(keysToSearch, blLoad, lkMeter));
     }
     else
@@ -3222,6 +3397,94 @@ LedgerTxnRoot::Impl::prefetchInternal(UnorderedSet<LedgerKey> const& keys,
     return total;
 }
 
+std::vector<LedgerEntry>
+LedgerTxnRoot::Impl::loadSorobanKeys(LedgerKeySet const& keys,
+                                     LedgerKeyMeter& lkMeter)
+{
+    ZoneScoped;
+    // Below this many keys per thread, starting the threads costs more than
+    // searching the keys on fewer of them
+    size_t const minKeysPerThread = 64;
+    size_t numThreads =
+        std::min<size_t>(mApp.getConfig().SOROBAN_PREFETCH_THREADS,
+                         keys.size() / minKeysPerThread);
+    if (numThreads <= 1)
+    {
+        return getSearchableBucketListSnapshot().loadKeysWithLimits(keys,
+                                                                    &lkMeter);
+    }
+
+    auto& snapshotManager = mApp.getBucketManager().getBucketSnapshotManager();
+    auto timer =
+        snapshotManager.recordBulkLoadMetrics("prefetch", keys.size())
+            .TimeScope();
+    while (mSorobanPrefetchSnapshots.size() < numThreads)
+    {
+        mSorobanPrefetchSnapshots.emplace_back(
+            snapshotManager.copySearchableBucketListSnapshot());
+    }
+
+    // Each thread searches a contiguous range of the keys, so that it scans
+    // as little of the Bucket indexes as a single thread would
+    std::vector<LedgerKeySet> shards(numThreads);
+    size_t i = 0;
+    for (auto const& key : keys)
+    {
+        shards[i++ * numThreads / keys.size()].emplace(key);
+    }
+
+    std::vector<std::vector<LedgerEntry>> shardEntries(numThreads);
+    std::vector<std::exception_ptr> errors(numThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            try
+            {
+                // The meter isn't thread-safe, entries are metered below
+                shardEntries[t] =
+                    mSorobanPrefetchSnapshots[t]->loadKeysWithLimits(
+                        shards[t], nullptr);
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (auto const& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Same as BucketSnapshot::loadKeysWithLimits, which meters entries as it
+    // finds them
+    std::vector<LedgerEntry> entries;
+    for (auto& shard : shardEntries)
+    {
+        for (auto& le : shard)
+        {
+            auto key = LedgerEntryKey(le);
+            auto entrySize = xdr::xdr_size(le);
+            bool canLoad = lkMeter.canLoad(key, entrySize);
+            lkMeter.updateReadQuotasForKey(key, entrySize);
+            if (canLoad)
+            {
+                entries.emplace_back(std::move(le));
+            }
+        }
+    }
+    return entries;
+}
+
 double
 LedgerTxnRoot::getPrefetchHitRate() const
 {
@@ -3736,6 +3999,16 @@ LedgerTxnRoot::Impl::getNewestVersion(InternalLedgerKey const& gkey) const
     }
     auto const& key = gkey.ledgerKey();
 
+    if (key.type() == CONTRACT_CODE && mContractCodeCache.maxSize() > 0)
+    {
+        if (auto cached = mContractCodeCache.maybeGet(key))
+        {
+            mContractCodeCacheHit.Mark();
+            return std::make_shared<InternalLedgerEntry const>(**cached);
+        }
+        mContractCodeCacheMiss.Mark();
+    }
+
     if (mEntryCache.exists(key))
     {
         std::string zoneTxt("hit");
@@ -3747,6 +4020,10 @@ LedgerTxnRoot::Impl::getNewestVersion(InternalLedgerKey const& gkey) const
         std::string zoneTxt("miss");
         ZoneText(zoneTxt.c_str(), zoneTxt.size());
         ++mPrefetchMisses;
+        if (isSorobanEntry(key) || key.type() == TTL)
+        {
+            mApp.getLedgerManager().getSorobanMetrics().mPrefetchMiss.Mark();
+        }
     }
 
     std::shared_ptr<LedgerEntry const> entry;
@@ -3814,6 +4091,10 @@ LedgerTxnRoot::Impl::getNewestVersion(InternalLedgerKey const& gkey) const
     putInEntryCache(key, entry, LoadType::IMMEDIATE);
     if (entry)
     {
+        if (key.type() == CONTRACT_CODE && mContractCodeCache.maxSize() > 0)
+        {
+            putInContractCodeCache(key, entry);
+        }
         return std::make_shared<InternalLedgerEntry const>(*entry);
     }
     else
@@ -3883,6 +4164,21 @@ LedgerTxnRoot::Impl::getFromEntryCache(LedgerKey const& key) const
     }
 }
 
+void
+LedgerTxnRoot::Impl::putInContractCodeCache(
+    LedgerKey const& key, std::shared_ptr<LedgerEntry const> const& entry) const
+{
+    try
+    {
+        mContractCodeCache.put(key, entry);
+    }
+    catch (...)
+    {
+        mContractCodeCache.clear();
+        throw;
+    }
+}
+
 void
 LedgerTxnRoot::Impl::putInEntryCache(
     LedgerKey const& key, std::shared_ptr<LedgerEntry const> const& entry,
@@ -3891,6 +4187,11 @@ LedgerTxnRoot::Impl::putInEntryCache(
     try
     {
         mEntryCache.put(key, {entry, type});
+        if (mOfferHash && key.type() == OFFER)
+        {
+            // The first version handed out is the one in the database
+            mOfferPreImages.emplace(key, entry);
+        }
     }
     catch (...)
     {
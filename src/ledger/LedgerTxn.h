@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "crypto/MultisetHash.h"
 #include "ledger/InternalLedgerEntry.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "ledger/LedgerTxnHeader.h"
@@ -492,6 +493,17 @@ class AbstractLedgerTxnParent
     // than a (real or stub) root LedgerTxn.
     virtual void dropOffers(bool rebuild) = 0;
 
+    // Starts maintaining a MultisetHash of the offers in the database on every
+    // commit, starting from `initial` which must be the hash of the offers in
+    // the database now, or stops if `initial` is std::nullopt. Tracking stops
+    // when offers are dropped or deleted other than by a commit. Will throw
+    // when called on anything other than a (real or stub) root LedgerTxn.
+    virtual void trackOfferHash(std::optional<MultisetHash> initial) = 0;
+
+    // The hash maintained since trackOfferHash, if any. Will throw when called
+    // on anything other than a (real or stub) root LedgerTxn.
+    virtual std::optional<MultisetHash> getOfferHash() const = 0;
+
     // Delete all trustline ledger entries. Will throw when called on anything
     // other than a (real or stub) root LedgerTxn.
     virtual void dropTrustLines(bool rebuild) = 0;
@@ -512,6 +524,12 @@ class AbstractLedgerTxnParent
     // anything other than a (real or stub) root LedgerTxn.
     virtual void dropContractCode(bool rebuild) = 0;
 
+    // Forget the contract code kept in memory across commits, for when the
+    // ledger state is replaced other than by a commit, e.g. by assuming the
+    // state of a BucketList. Will throw when called on anything other than a
+    // (real or stub) root LedgerTxn.
+    virtual void clearContractCodeCache() = 0;
+
     // Delete all config setting ledger entries. Will throw when called on
     // anything other than a (real or stub) root LedgerTxn.
     virtual void dropConfigSettings(bool rebuild) = 0;
@@ -824,11 +842,14 @@ class LedgerTxn : public AbstractLedgerTxn
     void dropAccounts(bool rebuild) override;
     void dropData(bool rebuild) override;
     void dropOffers(bool rebuild) override;
+    void trackOfferHash(std::optional<MultisetHash> initial) override;
+    std::optional<MultisetHash> getOfferHash() const override;
     void dropTrustLines(bool rebuild) override;
     void dropClaimableBalances(bool rebuild) override;
     void dropLiquidityPools(bool rebuild) override;
     void dropContractData(bool rebuild) override;
     void dropContractCode(bool rebuild) override;
+    void clearContractCodeCache() override;
     void dropConfigSettings(bool rebuild) override;
     void dropTTL(bool rebuild) override;
 
@@ -867,7 +888,8 @@ class LedgerTxnRoot : public AbstractLedgerTxnParent
 
   public:
     explicit LedgerTxnRoot(Application& app, size_t entryCacheSize,
-                           size_t prefetchBatchSize
+                           size_t prefetchBatchSize,
+                           size_t contractCodeCacheSize
 #ifdef BEST_OFFER_DEBUGGING
                            ,
                            bool bestOfferDebuggingEnabled
@@ -890,11 +912,14 @@ class LedgerTxnRoot : public AbstractLedgerTxnParent
     void dropAccounts(bool rebuild) override;
     void dropData(bool rebuild) override;
     void dropOffers(bool rebuild) override;
+    void trackOfferHash(std::optional<MultisetHash> initial) override;
+    std::optional<MultisetHash> getOfferHash() const override;
     void dropTrustLines(bool rebuild) override;
     void dropClaimableBalances(bool rebuild) override;
     void dropLiquidityPools(bool rebuild) override;
     void dropContractData(bool rebuild) override;
     void dropContractCode(bool rebuild) override;
+    void clearContractCodeCache() override;
     void dropConfigSettings(bool rebuild) override;
     void dropTTL(bool rebuild) override;
 
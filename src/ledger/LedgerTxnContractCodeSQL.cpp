@@ -361,6 +361,7 @@ LedgerTxnRoot::Impl::dropContractCode(bool rebuild)
 {
     throwIfChild();
     mEntryCache.clear();
+    mContractCodeCache.clear();
     mBestOffers.clear();
 
     std::string coll = mApp.getDatabase().getSimpleCollationClause();
@@ -17,6 +17,11 @@
 #include <sstream>
 #endif
 
+namespace medida
+{
+class Meter;
+}
+
 namespace stellar
 {
 
@@ -716,6 +721,9 @@ class LedgerTxnRoot::Impl
 
     typedef RandomEvictionCache<LedgerKey, CacheEntry> EntryCache;
 
+    typedef RandomEvictionCache<LedgerKey, std::shared_ptr<LedgerEntry const>>
+        ContractCodeCache;
+
     typedef AssetPair BestOffersKey;
 
     struct BestOffersEntry
@@ -734,11 +742,31 @@ class LedgerTxnRoot::Impl
     Application& mApp;
     std::unique_ptr<LedgerHeader> mHeader;
     mutable EntryCache mEntryCache;
+    // Existing CONTRACT_CODE entries. Unlike mEntryCache, this is kept across
+    // commits, which only drop the entries they modify, so contracts invoked
+    // every ledger are loaded once rather than once per ledger.
+    mutable ContractCodeCache mContractCodeCache;
+    medida::Meter& mContractCodeCacheHit;
+    medida::Meter& mContractCodeCacheMiss;
     mutable BestOffers mBestOffers;
     mutable uint64_t mPrefetchHits{0};
     mutable uint64_t mPrefetchMisses{0};
     mutable std::shared_ptr<SearchableBucketListSnapshot>
         mSearchableBucketListSnapshot{};
+    // One per thread of loadSorobanKeys, as a snapshot can only be searched
+    // by one thread at a time
+    std::vector<std::shared_ptr<SearchableBucketListSnapshot>>
+        mSorobanPrefetchSnapshots{};
+
+    // Hash of the offers in the database, see trackOfferHash. Mutable as
+    // deleteObjectsModifiedOnOrAfterLedger stops tracking.
+    mutable std::optional<MultisetHash> mOfferHash;
+    // While mOfferHash is tracked, the database version of every offer handed
+    // out since the last commit (nullptr if it did not exist). The commit
+    // replaces these versions, so updateOfferHash only reads the offers
+    // written without loading.
+    mutable UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+        mOfferPreImages;
 
     size_t mBulkLoadBatchSize;
     std::unique_ptr<soci::transaction> mTransaction;
@@ -794,6 +822,7 @@ class LedgerTxnRoot::Impl
     void bulkUpsertTrustLines(std::vector<EntryIterator> const& entries);
     void bulkDeleteTrustLines(std::vector<EntryIterator> const& entries,
                               LedgerTxnConsistency cons);
+    void updateOfferHash(std::vector<EntryIterator> const& entries);
     void bulkUpsertOffers(std::vector<EntryIterator> const& entries);
     void bulkDeleteOffers(std::vector<EntryIterator> const& entries,
                           LedgerTxnConsistency cons);
@@ -837,6 +866,9 @@ class LedgerTxnRoot::Impl
     void putInEntryCache(LedgerKey const& key,
                          std::shared_ptr<LedgerEntry const> const& entry,
                          LoadType type) const;
+    void putInContractCodeCache(
+        LedgerKey const& key,
+        std::shared_ptr<LedgerEntry const> const& entry) const;
 
     BestOffersEntryPtr getFromBestOffers(Asset const& buying,
                                          Asset const& selling) const;
@@ -876,9 +908,16 @@ class LedgerTxnRoot::Impl
     uint32_t prefetchInternal(UnorderedSet<LedgerKey> const& keys,
                               LedgerKeyMeter* lkMeter = nullptr);
 
+    // Searches the BucketList for keys on up to SOROBAN_PREFETCH_THREADS
+    // threads, then meters the entries found against the read quotas of
+    // lkMeter, leaving out those no transaction has the quota to read.
+    std::vector<LedgerEntry> loadSorobanKeys(LedgerKeySet const& keys,
+                                             LedgerKeyMeter& lkMeter);
+
   public:
     // Constructor has the strong exception safety guarantee
-    Impl(Application& app, size_t entryCacheSize, size_t prefetchBatchSize
+    Impl(Application& app, size_t entryCacheSize, size_t prefetchBatchSize,
+         size_t contractCodeCacheSize
 #ifdef BEST_OFFER_DEBUGGING
          ,
          bool bestOfferDebuggingEnabled
@@ -905,11 +944,14 @@ class LedgerTxnRoot::Impl
     void dropAccounts(bool rebuild);
     void dropData(bool rebuild);
     void dropOffers(bool rebuild);
+    void trackOfferHash(std::optional<MultisetHash> initial);
+    std::optional<MultisetHash> getOfferHash() const;
     void dropTrustLines(bool rebuild);
     void dropClaimableBalances(bool rebuild);
     void dropLiquidityPools(bool rebuild);
     void dropContractData(bool rebuild);
     void dropContractCode(bool rebuild);
+    void clearContractCodeCache();
     void dropConfigSettings(bool rebuild);
     void dropTTL(bool rebuild);
 
@@ -8,6 +8,7 @@
 #include "database/DatabaseTypeSpecificOperation.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/LedgerTypeUtils.h"
+#include "ledger/OfferSnapshot.h"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "transactions/TransactionUtils.h"
@@ -58,17 +59,11 @@ std::vector<LedgerEntry>
 LedgerTxnRoot::Impl::loadAllOffers() const
 {
     ZoneScoped;
-    std::string sql = "SELECT sellerid, offerid, sellingasset, buyingasset, "
-                      "amount, pricen, priced, flags, lastmodified, extension, "
-                      "ledgerext FROM offers";
-    auto prep = mApp.getDatabase().getPreparedStatement(sql);
-
-    std::vector<LedgerEntry> offers;
-    {
-        auto timer = mApp.getDatabase().getSelectTimer("offer");
-        offers = loadOffers(prep);
-    }
-    return offers;
+    auto timer = mApp.getDatabase().getSelectTimer("offer");
+    return selectAllOffers(
+        [&](std::string const& sql) {
+            return mApp.getDatabase().getPreparedStatement(sql);
+        });
 }
 
 std::deque<LedgerEntry>::const_iterator
@@ -77,28 +72,12 @@ LedgerTxnRoot::Impl::loadBestOffers(std::deque<LedgerEntry>& offers,
                                     size_t numOffers) const
 {
     ZoneScoped;
-    // price is an approximation of the actual n/d (truncated math, 15 digits)
-    // ordering by offerid gives precedence to older offers for fairness
-    std::string sql = "SELECT sellerid, offerid, sellingasset, buyingasset, "
-                      "amount, pricen, priced, flags, lastmodified, extension, "
-                      "ledgerext FROM offers "
-                      "WHERE sellingasset = :v1 AND buyingasset = :v2 "
-                      "ORDER BY price, offerid LIMIT :n";
-
-    std::string buyingAsset, sellingAsset;
-    buyingAsset = decoder::encode_b64(xdr::xdr_to_opaque(buying));
-    sellingAsset = decoder::encode_b64(xdr::xdr_to_opaque(selling));
-
-    auto prep = mApp.getDatabase().getPreparedStatement(sql);
-    auto& st = prep.statement();
-    st.exchange(soci::use(sellingAsset));
-    st.exchange(soci::use(buyingAsset));
-    st.exchange(soci::use(numOffers));
-
-    {
-        auto timer = mApp.getDatabase().getSelectTimer("offer");
-        return loadOffers(prep, offers);
-    }
+    auto timer = mApp.getDatabase().getSelectTimer("offer");
+    return selectBestOffers(
+        [&](std::string const& sql) {
+            return mApp.getDatabase().getPreparedStatement(sql);
+        },
+        offers, buying, selling, numOffers);
 }
 
 std::deque<LedgerEntry>::const_iterator
@@ -108,60 +87,12 @@ LedgerTxnRoot::Impl::loadBestOffers(std::deque<LedgerEntry>& offers,
                                     size_t numOffers) const
 {
     ZoneScoped;
-    // ManageOffer and related operations won't work correctly with an offerID
-    // equal to or exceeding INT64_MAX, so there is no reason to support it
-    // here. We are far from this limit anyway.
-    if (worseThan.offerID == INT64_MAX)
-    {
-        throw std::runtime_error("maximum offerID encountered");
-    }
-
-    // price is an approximation of the actual n/d (truncated math, 15 digits)
-    // ordering by offerid gives precedence to older offers for fairness
-    std::string sql =
-        "WITH r1 AS "
-        "(SELECT sellerid, offerid, sellingasset, buyingasset, amount, price, "
-        "pricen, priced, flags, lastmodified, extension, "
-        "ledgerext FROM offers "
-        "WHERE sellingasset = :v1 AND buyingasset = :v2 AND price > :v3 "
-        "ORDER BY price, offerid LIMIT :v4), "
-        "r2 AS "
-        "(SELECT sellerid, offerid, sellingasset, buyingasset, amount, price, "
-        "pricen, priced, flags, lastmodified, extension, "
-        "ledgerext FROM offers "
-        "WHERE sellingasset = :v5 AND buyingasset = :v6 AND price = :v7 "
-        "AND offerid >= :v8 ORDER BY price, offerid LIMIT :v9) "
-        "SELECT sellerid, offerid, sellingasset, buyingasset, "
-        "amount, pricen, priced, flags, lastmodified, extension, "
-        "ledgerext "
-        "FROM (SELECT * FROM r1 UNION ALL SELECT * FROM r2) AS res "
-        "ORDER BY price, offerid LIMIT :v10";
-
-    std::string buyingAsset, sellingAsset;
-    buyingAsset = decoder::encode_b64(xdr::xdr_to_opaque(buying));
-    sellingAsset = decoder::encode_b64(xdr::xdr_to_opaque(selling));
-
-    double worseThanPrice =
-        (double)worseThan.price.n / (double)worseThan.price.d;
-    int64_t worseThanOfferID = worseThan.offerID + 1;
-
-    auto prep = mApp.getDatabase().getPreparedStatement(sql);
-    auto& st = prep.statement();
-    st.exchange(soci::use(sellingAsset));
-    st.exchange(soci::use(buyingAsset));
-    st.exchange(soci::use(worseThanPrice));
-    st.exchange(soci::use(numOffers));
-    st.exchange(soci::use(sellingAsset));
-    st.exchange(soci::use(buyingAsset));
-    st.exchange(soci::use(worseThanPrice));
-    st.exchange(soci::use(worseThanOfferID));
-    st.exchange(soci::use(numOffers));
-    st.exchange(soci::use(numOffers));
-
-    {
-        auto timer = mApp.getDatabase().getSelectTimer("offer");
-        return loadOffers(prep, offers);
-    }
+    auto timer = mApp.getDatabase().getSelectTimer("offer");
+    return selectBestOffers(
+        [&](std::string const& sql) {
+            return mApp.getDatabase().getPreparedStatement(sql);
+        },
+        offers, buying, selling, worseThan, numOffers);
 }
 
 bool
@@ -191,7 +122,7 @@ isBetterOffer(OfferDescriptor const& lhs, LedgerEntry const& rhsEntry)
 }
 
 // Note: The order induced by this function must match the order used in the
-// SQL query for loadBestOffers above.
+// SQL query of selectBestOffers below.
 bool
 isBetterOffer(LedgerEntry const& lhsEntry, LedgerEntry const& rhsEntry)
 {
@@ -212,33 +143,12 @@ LedgerTxnRoot::Impl::loadOffersByAccountAndAsset(AccountID const& accountID,
                                                  Asset const& asset) const
 {
     ZoneScoped;
-    std::string sql = "SELECT sellerid, offerid, sellingasset, buyingasset, "
-                      "amount, pricen, priced, flags, lastmodified, extension, "
-                      "ledgerext "
-                      "FROM offers WHERE sellerid = :v1 AND "
-                      "(sellingasset = :v2 OR buyingasset = :v3)";
-    // Note: v2 == v3 but positional parameters are faster
-
-    std::string accountStr = KeyUtils::toStrKey(accountID);
-
-    if (asset.type() == ASSET_TYPE_NATIVE)
-    {
-        throw std::runtime_error("Invalid asset type");
-    }
-    std::string assetStr = decoder::encode_b64(xdr::xdr_to_opaque(asset));
-
-    auto prep = mApp.getDatabase().getPreparedStatement(sql);
-    auto& st = prep.statement();
-    st.exchange(soci::use(accountStr));
-    st.exchange(soci::use(assetStr));
-    st.exchange(soci::use(assetStr));
-
-    std::vector<LedgerEntry> offers;
-    {
-        auto timer = mApp.getDatabase().getSelectTimer("offer");
-        offers = loadOffers(prep);
-    }
-    return offers;
+    auto timer = mApp.getDatabase().getSelectTimer("offer");
+    return selectOffersByAccountAndAsset(
+        [&](std::string const& sql) {
+            return mApp.getDatabase().getPreparedStatement(sql);
+        },
+        accountID, asset);
 }
 
 static Asset
@@ -324,6 +234,138 @@ LedgerTxnRoot::Impl::loadOffers(StatementContext& prep) const
     return offers;
 }
 
+std::vector<LedgerEntry>
+selectAllOffers(PrepareStatement const& prepare)
+{
+    ZoneScoped;
+    std::string sql = "SELECT sellerid, offerid, sellingasset, buyingasset, "
+                      "amount, pricen, priced, flags, lastmodified, extension, "
+                      "ledgerext FROM offers";
+    auto prep = prepare(sql);
+
+    std::vector<LedgerEntry> offers;
+    loadOffersHelper(prep, offers);
+    return offers;
+}
+
+std::deque<LedgerEntry>::const_iterator
+selectBestOffers(PrepareStatement const& prepare,
+                 std::deque<LedgerEntry>& offers, Asset const& buying,
+                 Asset const& selling, size_t numOffers)
+{
+    ZoneScoped;
+    // price is an approximation of the actual n/d (truncated math, 15 digits)
+    // ordering by offerid gives precedence to older offers for fairness
+    std::string sql = "SELECT sellerid, offerid, sellingasset, buyingasset, "
+                      "amount, pricen, priced, flags, lastmodified, extension, "
+                      "ledgerext FROM offers "
+                      "WHERE sellingasset = :v1 AND buyingasset = :v2 "
+                      "ORDER BY price, offerid LIMIT :n";
+
+    std::string buyingAsset, sellingAsset;
+    buyingAsset = decoder::encode_b64(xdr::xdr_to_opaque(buying));
+    sellingAsset = decoder::encode_b64(xdr::xdr_to_opaque(selling));
+
+    auto prep = prepare(sql);
+    auto& st = prep.statement();
+    st.exchange(soci::use(sellingAsset));
+    st.exchange(soci::use(buyingAsset));
+    st.exchange(soci::use(numOffers));
+
+    return loadOffersHelper(prep, offers);
+}
+
+std::deque<LedgerEntry>::const_iterator
+selectBestOffers(PrepareStatement const& prepare,
+                 std::deque<LedgerEntry>& offers, Asset const& buying,
+                 Asset const& selling, OfferDescriptor const& worseThan,
+                 size_t numOffers)
+{
+    ZoneScoped;
+    // ManageOffer and related operations won't work correctly with an offerID
+    // equal to or exceeding INT64_MAX, so there is no reason to support it
+    // here. We are far from this limit anyway.
+    if (worseThan.offerID == INT64_MAX)
+    {
+        throw std::runtime_error("maximum offerID encountered");
+    }
+
+    // price is an approximation of the actual n/d (truncated math, 15 digits)
+    // ordering by offerid gives precedence to older offers for fairness
+    std::string sql =
+        "WITH r1 AS "
+        "(SELECT sellerid, offerid, sellingasset, buyingasset, amount, price, "
+        "pricen, priced, flags, lastmodified, extension, "
+        "ledgerext FROM offers "
+        "WHERE sellingasset = :v1 AND buyingasset = :v2 AND price > :v3 "
+        "ORDER BY price, offerid LIMIT :v4), "
+        "r2 AS "
+        "(SELECT sellerid, offerid, sellingasset, buyingasset, amount, price, "
+        "pricen, priced, flags, lastmodified, extension, "
+        "ledgerext FROM offers "
+        "WHERE sellingasset = :v5 AND buyingasset = :v6 AND price = :v7 "
+        "AND offerid >= :v8 ORDER BY price, offerid LIMIT :v9) "
+        "SELECT sellerid, offerid, sellingasset, buyingasset, "
+        "amount, pricen, priced, flags, lastmodified, extension, "
+        "ledgerext "
+        "FROM (SELECT * FROM r1 UNION ALL SELECT * FROM r2) AS res "
+        "ORDER BY price, offerid LIMIT :v10";
+
+    std::string buyingAsset, sellingAsset;
+    buyingAsset = decoder::encode_b64(xdr::xdr_to_opaque(buying));
+    sellingAsset = decoder::encode_b64(xdr::xdr_to_opaque(selling));
+
+    double worseThanPrice =
+        (double)worseThan.price.n / (double)worseThan.price.d;
+    int64_t worseThanOfferID = worseThan.offerID + 1;
+
+    auto prep = prepare(sql);
+    auto& st = prep.statement();
+    st.exchange(soci::use(sellingAsset));
+    st.exchange(soci::use(buyingAsset));
+    st.exchange(soci::use(worseThanPrice));
+    st.exchange(soci::use(numOffers));
+    st.exchange(soci::use(sellingAsset));
+    st.exchange(soci::use(buyingAsset));
+    st.exchange(soci::use(worseThanPrice));
+    st.exchange(soci::use(worseThanOfferID));
+    st.exchange(soci::use(numOffers));
+    st.exchange(soci::use(numOffers));
+
+    return loadOffersHelper(prep, offers);
+}
+
+std::vector<LedgerEntry>
+selectOffersByAccountAndAsset(PrepareStatement const& prepare,
+                              AccountID const& accountID, Asset const& asset)
+{
+    ZoneScoped;
+    std::string sql = "SELECT sellerid, offerid, sellingasset, buyingasset, "
+                      "amount, pricen, priced, flags, lastmodified, extension, "
+                      "ledgerext "
+                      "FROM offers WHERE sellerid = :v1 AND "
+                      "(sellingasset = :v2 OR buyingasset = :v3)";
+    // Note: v2 == v3 but positional parameters are faster
+
+    std::string accountStr = KeyUtils::toStrKey(accountID);
+
+    if (asset.type() == ASSET_TYPE_NATIVE)
+    {
+        throw std::runtime_error("Invalid asset type");
+    }
+    std::string assetStr = decoder::encode_b64(xdr::xdr_to_opaque(asset));
+
+    auto prep = prepare(sql);
+    auto& st = prep.statement();
+    st.exchange(soci::use(accountStr));
+    st.exchange(soci::use(assetStr));
+    st.exchange(soci::use(assetStr));
+
+    std::vector<LedgerEntry> offers;
+    loadOffersHelper(prep, offers);
+    return offers;
+}
+
 class BulkUpsertOffersOperation : public DatabaseTypeSpecificOperation<void>
 {
     Database& mDB;
@@ -419,48 +461,74 @@ class BulkUpsertOffersOperation : public DatabaseTypeSpecificOperation<void>
         }
     }
 
+    // Upserts `n` offers starting at `begin` with a single multi-row INSERT
     void
-    doSociGenericOperation()
+    sqliteUpsertRows(soci::sqlite3_session_backend* sq, size_t begin, size_t n)
     {
-        std::string sql =
-            "INSERT INTO offers ( "
-            "sellerid, offerid, sellingasset, buyingasset, "
-            "amount, pricen, priced, price, flags, lastmodified, extension, "
-            "ledgerext "
-            ") VALUES ( "
-            ":v1, :v2, :v3, :v4, :v5, :v6, :v7, :v8, :v9, :v10, :v11, :v12 "
-            ") ON CONFLICT (offerid) DO UPDATE SET "
-            "sellerid = excluded.sellerid, "
-            "sellingasset = excluded.sellingasset, "
-            "buyingasset = excluded.buyingasset, "
-            "amount = excluded.amount, "
-            "pricen = excluded.pricen, "
-            "priced = excluded.priced, "
-            "price = excluded.price, "
-            "flags = excluded.flags, "
-            "lastmodified = excluded.lastmodified, "
-            "extension = excluded.extension, "
-            "ledgerext = excluded.ledgerext";
+        std::string sql = "INSERT INTO offers ( "
+                          "sellerid, offerid, sellingasset, buyingasset, "
+                          "amount, pricen, priced, price, flags, lastmodified, "
+                          "extension, ledgerext "
+                          ") VALUES ";
+        for (size_t i = 0; i < n; ++i)
+        {
+            sql += i == 0 ? "" : ", ";
+            sql += "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        }
+        sql += " ON CONFLICT (offerid) DO UPDATE SET "
+               "sellerid = excluded.sellerid, "
+               "sellingasset = excluded.sellingasset, "
+               "buyingasset = excluded.buyingasset, "
+               "amount = excluded.amount, "
+               "pricen = excluded.pricen, "
+               "priced = excluded.priced, "
+               "price = excluded.price, "
+               "flags = excluded.flags, "
+               "lastmodified = excluded.lastmodified, "
+               "extension = excluded.extension, "
+               "ledgerext = excluded.ledgerext";
+
         auto prep = mDB.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mSellerIDs));
-        st.exchange(soci::use(mOfferIDs));
-        st.exchange(soci::use(mSellingAssets));
-        st.exchange(soci::use(mBuyingAssets));
-        st.exchange(soci::use(mAmounts));
-        st.exchange(soci::use(mPriceNs));
-        st.exchange(soci::use(mPriceDs));
-        st.exchange(soci::use(mPrices));
-        st.exchange(soci::use(mFlags));
-        st.exchange(soci::use(mLastModifieds));
-        st.exchange(soci::use(mExtensions));
-        st.exchange(soci::use(mLedgerExtensions));
-        st.define_and_bind();
+        auto be = prep.statement().get_backend();
+        if (be == nullptr)
         {
-            auto timer = mDB.getUpsertTimer("offer");
-            st.execute(true);
+            throw std::runtime_error("no sql backend");
         }
-        if (static_cast<size_t>(st.get_affected_rows()) != mOfferIDs.size())
+        auto sqliteStatement =
+            dynamic_cast<soci::sqlite3_statement_backend*>(be);
+        releaseAssertOrThrow(sqliteStatement);
+        auto st = sqliteStatement->stmt_;
+
+        sqlite3_reset(st);
+        int param = 1;
+        auto bindText = [&](std::string const& str) {
+            sqlite3_bind_text(st, param++, str.data(),
+                              static_cast<int>(str.size()), SQLITE_STATIC);
+        };
+        for (size_t i = begin; i < begin + n; ++i)
+        {
+            bindText(mSellerIDs[i]);
+            sqlite3_bind_int64(st, param++, mOfferIDs[i]);
+            bindText(mSellingAssets[i]);
+            bindText(mBuyingAssets[i]);
+            sqlite3_bind_int64(st, param++, mAmounts[i]);
+            sqlite3_bind_int(st, param++, mPriceNs[i]);
+            sqlite3_bind_int(st, param++, mPriceDs[i]);
+            sqlite3_bind_double(st, param++, mPrices[i]);
+            sqlite3_bind_int(st, param++, mFlags[i]);
+            sqlite3_bind_int(st, param++, mLastModifieds[i]);
+            bindText(mExtensions[i]);
+            bindText(mLedgerExtensions[i]);
+        }
+
+        auto res = sqlite3_step(st);
+        auto changes = sqlite3_changes(sq->conn_);
+        sqlite3_reset(st);
+        if (res != SQLITE_DONE)
+        {
+            throw std::runtime_error(sqlite3_errmsg(sq->conn_));
+        }
+        if (static_cast<size_t>(changes) != n)
         {
             throw std::runtime_error("Could not update data in SQL");
         }
@@ -469,7 +537,18 @@ class BulkUpsertOffersOperation : public DatabaseTypeSpecificOperation<void>
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        // Stepping a single-row statement once per offer dominates the cost
+        // of large upserts, so bind as many offers per statement as SQLite's
+        // default limit of 999 parameters allows
+        size_t const rowsPerStatement = 999 / 12;
+        auto timer = mDB.getUpsertTimer("offer");
+        for (size_t begin = 0; begin < mOfferIDs.size();
+             begin += rowsPerStatement)
+        {
+            sqliteUpsertRows(sq, begin,
+                             std::min(rowsPerStatement,
+                                      mOfferIDs.size() - begin));
+        }
     }
 
 #ifdef USE_POSTGRES
@@ -579,30 +658,43 @@ class BulkDeleteOffersOperation : public DatabaseTypeSpecificOperation<void>
     }
 
     void
-    doSociGenericOperation()
+    doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        std::string sql = "DELETE FROM offers WHERE offerid = :id";
+        // Delete all the offers with one statement, as on Postgres
+        std::string sql =
+            "DELETE FROM offers WHERE offerid IN carray(?, ?, 'int64')";
         auto prep = mDB.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mOfferIDs));
-        st.define_and_bind();
+        auto be = prep.statement().get_backend();
+        if (be == nullptr)
+        {
+            throw std::runtime_error("no sql backend");
+        }
+        auto sqliteStatement =
+            dynamic_cast<soci::sqlite3_statement_backend*>(be);
+        releaseAssertOrThrow(sqliteStatement);
+        auto st = sqliteStatement->stmt_;
+
+        sqlite3_reset(st);
+        sqlite3_bind_pointer(st, 1, (void*)mOfferIDs.data(), "carray", 0);
+        sqlite3_bind_int(st, 2, static_cast<int>(mOfferIDs.size()));
+        int res;
         {
             auto timer = mDB.getDeleteTimer("offer");
-            st.execute(true);
+            res = sqlite3_step(st);
         }
-        if (static_cast<size_t>(st.get_affected_rows()) != mOfferIDs.size() &&
+        auto changes = sqlite3_changes(sq->conn_);
+        sqlite3_reset(st);
+        if (res != SQLITE_DONE)
+        {
+            throw std::runtime_error(sqlite3_errmsg(sq->conn_));
+        }
+        if (static_cast<size_t>(changes) != mOfferIDs.size() &&
             mCons == LedgerTxnConsistency::EXACT)
         {
             throw std::runtime_error("Could not update data in SQL");
         }
     }
 
-    void
-    doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
-    {
-        doSociGenericOperation();
-    }
-
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
@@ -657,6 +749,8 @@ LedgerTxnRoot::Impl::dropOffers(bool rebuild)
     throwIfChild();
     mEntryCache.clear();
     mBestOffers.clear();
+    mOfferHash.reset();
+    mOfferPreImages.clear();
 
     mApp.getDatabase().getSession() << "DROP TABLE IF EXISTS offers;";
 
@@ -0,0 +1,132 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/MetaFilter.h"
+#include "util/types.h"
+#include "util/xdrquery/XDRQuery.h"
+
+#include <Tracy.hpp>
+#include <fmt/format.h>
+#include <map>
+#include <stdexcept>
+
+namespace stellar
+{
+
+namespace
+{
+std::map<std::string, MetaFilter::Section> const SECTION_NAMES = {
+    {"TX_SET", MetaFilter::Section::TX_SET},
+    {"ENTRY_CHANGES", MetaFilter::Section::ENTRY_CHANGES},
+    {"CONTRACT_EVENTS", MetaFilter::Section::CONTRACT_EVENTS},
+    {"DIAGNOSTIC_EVENTS", MetaFilter::Section::DIAGNOSTIC_EVENTS},
+    {"EVICTED_ENTRIES", MetaFilter::Section::EVICTED_ENTRIES},
+    {"NETWORK_CONFIG", MetaFilter::Section::NETWORK_CONFIG}};
+
+LedgerEntry const*
+changedEntry(LedgerEntryChange const& change)
+{
+    switch (change.type())
+    {
+    case LEDGER_ENTRY_CREATED:
+        return &change.created();
+    case LEDGER_ENTRY_UPDATED:
+        return &change.updated();
+    case LEDGER_ENTRY_STATE:
+        return &change.state();
+    default:
+        return nullptr;
+    }
+}
+}
+
+MetaFilter::MetaFilter(std::vector<std::string> const& excludedSections,
+                       std::string const& entryQuery)
+{
+    for (auto const& name : excludedSections)
+    {
+        auto it = SECTION_NAMES.find(name);
+        if (it == SECTION_NAMES.end())
+        {
+            throw std::invalid_argument(
+                fmt::format("Unknown meta section '{}'", name));
+        }
+        mExcluded.set(static_cast<size_t>(it->second));
+    }
+
+    if (!entryQuery.empty())
+    {
+        mEntryMatcher = std::make_unique<xdrquery::XDRMatcher>(entryQuery);
+        try
+        {
+            // Parse and validate the query now rather than on first use
+            LedgerEntry entry;
+            mEntryMatcher->matchXDR(entry);
+        }
+        catch (xdrquery::XDRQueryError& e)
+        {
+            throw std::invalid_argument(
+                fmt::format("Invalid meta entry filter '{}': {}", entryQuery,
+                            e.what()));
+        }
+    }
+}
+
+MetaFilter::~MetaFilter()
+{
+}
+
+void
+MetaFilter::filterChanges(LedgerEntryChanges& changes)
+{
+    ZoneScoped;
+    if (!includes(Section::ENTRY_CHANGES))
+    {
+        changes.clear();
+        return;
+    }
+    if (!mEntryMatcher)
+    {
+        return;
+    }
+
+    auto matches = [&](LedgerEntryChange const& change) {
+        auto const* entry = changedEntry(change);
+        return entry && mEntryMatcher->matchXDR(*entry);
+    };
+
+    size_t kept = 0;
+    for (size_t i = 0; i < changes.size(); ++i)
+    {
+        bool keep = matches(changes[i]);
+        size_t n = 1;
+        if (changes[i].type() == LEDGER_ENTRY_STATE && i + 1 < changes.size())
+        {
+            auto const& next = changes[i + 1];
+            auto stateKey = LedgerEntryKey(changes[i].state());
+            if ((next.type() == LEDGER_ENTRY_UPDATED &&
+                 LedgerEntryKey(next.updated()) == stateKey) ||
+                (next.type() == LEDGER_ENTRY_REMOVED &&
+                 next.removed() == stateKey))
+            {
+                keep = keep || matches(next);
+                n = 2;
+            }
+        }
+        for (size_t j = i; j < i + n; ++j)
+        {
+            if (keep)
+            {
+                if (kept != j)
+                {
+                    changes[kept] = std::move(changes[j]);
+                }
+                ++kept;
+            }
+        }
+        i += n - 1;
+    }
+    changes.resize(kept);
+}
+}
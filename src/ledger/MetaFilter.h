@@ -0,0 +1,64 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <bitset>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xdrquery
+{
+class XDRMatcher;
+}
+
+namespace stellar
+{
+
+// MetaFilter describes the parts of LedgerCloseMeta a node's consumers are
+// interested in (METADATA_OUTPUT_EXCLUDE and METADATA_OUTPUT_ENTRY_FILTER).
+// It is consulted while meta is built during ledger close, so that excluded
+// parts are neither computed nor kept in memory, rather than stripped from
+// the full meta before it is written out.
+class MetaFilter : NonMovableOrCopyable
+{
+  public:
+    enum class Section
+    {
+        TX_SET,
+        ENTRY_CHANGES,
+        CONTRACT_EVENTS,
+        DIAGNOSTIC_EVENTS,
+        EVICTED_ENTRIES,
+        NETWORK_CONFIG,
+        SECTION_COUNT
+    };
+
+    // Throws std::invalid_argument for unknown section names or invalid
+    // entry queries. An empty `entryQuery` keeps changes to all entries.
+    MetaFilter(std::vector<std::string> const& excludedSections,
+               std::string const& entryQuery);
+    ~MetaFilter();
+
+    bool
+    includes(Section section) const
+    {
+        return !mExcluded.test(static_cast<size_t>(section));
+    }
+
+    // Removes the changes to entries that don't match the entry query, or
+    // all of them if entry changes are excluded. A LEDGER_ENTRY_STATE change
+    // and the change to the same entry following it are kept together when
+    // either entry matches.
+    void filterChanges(LedgerEntryChanges& changes);
+
+  private:
+    std::bitset<static_cast<size_t>(Section::SECTION_COUNT)> mExcluded;
+    std::unique_ptr<xdrquery::XDRMatcher> mEntryMatcher;
+};
+}
@@ -0,0 +1,126 @@
+#ifndef STELLAR_META_RING_BUFFER_H
+#define STELLAR_META_RING_BUFFER_H
+
+/*
+ * Copyright 2024 Stellar Development Foundation and contributors. Licensed
+ * under the Apache License, Version 2.0. See the COPYING file at the root
+ * of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/*
+ * Layout of the shared-memory ring buffer stellar-core writes LedgerCloseMeta
+ * to when METADATA_OUTPUT_STREAM is "shm:<path>". This header is plain C so
+ * that consumers can include it on its own; it needs GCC or clang for the
+ * __atomic builtins.
+ *
+ * The file at <path> starts with a stellar_meta_ring_header, followed by
+ * `capacity` bytes of data used as a ring. There is one writer (stellar-core)
+ * and one reader. Positions are byte offsets that only grow; a position maps
+ * to offset (position % capacity) in the data.
+ *
+ * Every ledger is one record: a stellar_meta_ring_record followed by `size`
+ * bytes of XDR-encoded LedgerCloseMeta (no record mark), padded to a multiple
+ * of 8 bytes. Records never wrap: when one doesn't fit before the end of the
+ * data, the writer fills the rest with a record of size
+ * STELLAR_META_RING_PAD, which readers skip.
+ *
+ * The writer publishes records by advancing write_pos (release), then bumps
+ * write_futex and wakes it. The reader decodes records in place between
+ * read_pos and write_pos (acquire), and hands the space back by advancing
+ * read_pos (release), then bumping read_futex and waking it. The writer
+ * never overwrites data the reader hasn't released: it waits on read_futex
+ * while the ring is full. On Linux both futex words can be waited on with
+ * FUTEX_WAIT (not FUTEX_PRIVATE, the mapping is shared).
+ */
+
+#include <stdint.h>
+
+#define STELLAR_META_RING_MAGIC 0x31474e5241544d53ULL /* "SMTARNG1" */
+#define STELLAR_META_RING_VERSION 1
+#define STELLAR_META_RING_PAD 0xffffffffu
+
+struct stellar_meta_ring_header
+{
+    uint64_t magic;
+    uint32_t version;
+    /* Offset of the data from the start of the file */
+    uint32_t header_size;
+    /* Size of the data, a multiple of 8 */
+    uint64_t capacity;
+    uint8_t reserved0[40];
+
+    /* Written by the writer */
+    uint64_t write_pos;
+    uint32_t write_futex;
+    /* Set to 1 once the writer has exited */
+    uint32_t writer_closed;
+    uint8_t reserved1[48];
+
+    /* Written by the reader */
+    uint64_t read_pos;
+    uint32_t read_futex;
+    uint32_t reserved2;
+    uint8_t reserved3[48];
+};
+
+struct stellar_meta_ring_record
+{
+    /* Size of the XDR following this header, or STELLAR_META_RING_PAD */
+    uint32_t size;
+    uint32_t ledger_seq;
+};
+
+static inline uint8_t*
+stellar_meta_ring_data(struct stellar_meta_ring_header* h)
+{
+    return (uint8_t*)h + h->header_size;
+}
+
+static inline uint64_t
+stellar_meta_ring_record_space(uint32_t size)
+{
+    return (sizeof(struct stellar_meta_ring_record) + (uint64_t)size + 7) &
+           ~(uint64_t)7;
+}
+
+/*
+ * Returns the next record, or 0 if the writer hasn't published one yet. The
+ * XDR is at (record + 1) and stays valid until stellar_meta_ring_release.
+ */
+static inline struct stellar_meta_ring_record*
+stellar_meta_ring_next(struct stellar_meta_ring_header* h)
+{
+    uint64_t rp = h->read_pos;
+    for (;;)
+    {
+        uint64_t wp = __atomic_load_n(&h->write_pos, __ATOMIC_ACQUIRE);
+        if (rp == wp)
+        {
+            return 0;
+        }
+        struct stellar_meta_ring_record* r =
+            (struct stellar_meta_ring_record*)(stellar_meta_ring_data(h) +
+                                               rp % h->capacity);
+        if (r->size != STELLAR_META_RING_PAD)
+        {
+            return r;
+        }
+        /* Skip padding up to the end of the data */
+        rp += h->capacity - rp % h->capacity;
+        __atomic_store_n(&h->read_pos, rp, __ATOMIC_RELEASE);
+    }
+}
+
+/* Releases the record returned by the last call to stellar_meta_ring_next */
+static inline void
+stellar_meta_ring_release(struct stellar_meta_ring_header* h,
+                          struct stellar_meta_ring_record const* r)
+{
+    __atomic_store_n(&h->read_pos,
+                     h->read_pos + stellar_meta_ring_record_space(r->size),
+                     __ATOMIC_RELEASE);
+    __atomic_fetch_add(&h->read_futex, 1, __ATOMIC_RELEASE);
+    /* Then FUTEX_WAKE read_futex, if the writer may be waiting */
+}
+
+#endif
@@ -0,0 +1,226 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/MetaRingWriter.h"
+#include "util/FileSystemException.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+
+#include <Tracy.hpp>
+#include <chrono>
+#include <cstring>
+#include <fmt/format.h>
+#include <thread>
+#include <xdrpp/marshal.h>
+
+#ifdef _WIN32
+
+namespace stellar
+{
+
+MetaRingWriter::MetaRingWriter(std::string const& path, size_t capacity)
+    : mPath(path)
+{
+    FileSystemException::failWith(
+        "shared-memory meta ring buffers are not supported on Windows");
+}
+
+MetaRingWriter::~MetaRingWriter()
+{
+}
+
+size_t
+MetaRingWriter::publish(LedgerCloseMeta const& meta)
+{
+    releaseAssert(false);
+}
+}
+
+#else
+
+#include "ledger/MetaRingBuffer.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace stellar
+{
+
+namespace
+{
+static_assert(sizeof(stellar_meta_ring_header) == 192,
+              "ring buffer header layout changed");
+static_assert(sizeof(stellar_meta_ring_record) == 8,
+              "ring buffer record layout changed");
+
+// Upper bound on a single wait, so that the writer notices readers that
+// don't wake it up (or systems without futexes)
+std::chrono::milliseconds const MAX_WAIT(100);
+
+void
+futexWait(uint32_t* word, uint32_t expected)
+{
+#ifdef __linux__
+    timespec timeout{};
+    timeout.tv_nsec = std::chrono::nanoseconds(MAX_WAIT).count();
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+}
+
+void
+futexWake(uint32_t* word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+uint32_t
+getLedgerSeq(LedgerCloseMeta const& meta)
+{
+    switch (meta.v())
+    {
+    case 0:
+        return meta.v0().ledgerHeader.header.ledgerSeq;
+    case 1:
+        return meta.v1().ledgerHeader.header.ledgerSeq;
+    default:
+        releaseAssert(false);
+    }
+}
+}
+
+MetaRingWriter::MetaRingWriter(std::string const& path, size_t capacity)
+    : mPath(path)
+{
+    capacity = (capacity + 7) & ~size_t(7);
+    releaseAssert(capacity > 0);
+    size_t const headerSize = sizeof(stellar_meta_ring_header);
+    mMappedSize = headerSize + capacity;
+
+    int fd = ::open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        FileSystemException::failWithErrno(
+            fmt::format("MetaRingWriter failed to open {}: ", path));
+    }
+    if (::ftruncate(fd, mMappedSize) != 0)
+    {
+        auto msg = fmt::format("MetaRingWriter failed to size {}: {}", path,
+                               std::strerror(errno));
+        ::close(fd);
+        FileSystemException::failWith(msg);
+    }
+    void* addr =
+        ::mmap(nullptr, mMappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        auto msg = fmt::format("MetaRingWriter failed to map {}: {}", path,
+                               std::strerror(errno));
+        ::close(fd);
+        FileSystemException::failWith(msg);
+    }
+    ::close(fd);
+
+    mHeader = static_cast<stellar_meta_ring_header*>(addr);
+    std::memset(mHeader, 0, headerSize);
+    mHeader->version = STELLAR_META_RING_VERSION;
+    mHeader->header_size = static_cast<uint32_t>(headerSize);
+    mHeader->capacity = capacity;
+    // Readers may check the magic before anything else
+    __atomic_store_n(&mHeader->magic, STELLAR_META_RING_MAGIC,
+                     __ATOMIC_RELEASE);
+    CLOG_INFO(Ledger, "Streaming metadata to ring buffer '{}' ({} bytes)",
+              path, capacity);
+}
+
+MetaRingWriter::~MetaRingWriter()
+{
+    __atomic_store_n(&mHeader->writer_closed, 1u, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&mHeader->write_futex, 1u, __ATOMIC_RELEASE);
+    futexWake(&mHeader->write_futex);
+    ::munmap(mHeader, mMappedSize);
+}
+
+void
+MetaRingWriter::waitForSpace(uint64_t needed)
+{
+    ZoneScoped;
+    auto writePos = mHeader->write_pos;
+    while (true)
+    {
+        // Read the futex word before the position, so that a release
+        // happening in between makes the wait return immediately
+        auto word = __atomic_load_n(&mHeader->read_futex, __ATOMIC_ACQUIRE);
+        auto readPos = __atomic_load_n(&mHeader->read_pos, __ATOMIC_ACQUIRE);
+        releaseAssert(readPos <= writePos);
+        if (mHeader->capacity - (writePos - readPos) >= needed)
+        {
+            return;
+        }
+        futexWait(&mHeader->read_futex, word);
+    }
+}
+
+void
+MetaRingWriter::advance(uint64_t space)
+{
+    __atomic_store_n(&mHeader->write_pos, mHeader->write_pos + space,
+                     __ATOMIC_RELEASE);
+    __atomic_fetch_add(&mHeader->write_futex, 1u, __ATOMIC_RELEASE);
+    futexWake(&mHeader->write_futex);
+}
+
+size_t
+MetaRingWriter::publish(LedgerCloseMeta const& meta)
+{
+    ZoneScoped;
+    releaseAssert(mHeader);
+    auto const capacity = mHeader->capacity;
+    auto const size = xdr::xdr_size(meta);
+    auto const space = stellar_meta_ring_record_space(size);
+    if (size >= STELLAR_META_RING_PAD || space > capacity)
+    {
+        throw std::runtime_error(fmt::format(
+            "Meta of {} bytes doesn't fit in the {} bytes ring buffer {}", size,
+            capacity, mPath));
+    }
+
+    size_t used = 0;
+    auto* data = stellar_meta_ring_data(mHeader);
+    auto offset = mHeader->write_pos % capacity;
+    if (offset + space > capacity)
+    {
+        // Pad to the end of the data so that the record is contiguous
+        auto pad = capacity - offset;
+        waitForSpace(pad);
+        auto* padding =
+            reinterpret_cast<stellar_meta_ring_record*>(data + offset);
+        padding->size = STELLAR_META_RING_PAD;
+        padding->ledger_seq = 0;
+        advance(pad);
+        used += pad;
+        offset = 0;
+    }
+
+    waitForSpace(space);
+    auto* record = reinterpret_cast<stellar_meta_ring_record*>(data + offset);
+    record->size = static_cast<uint32_t>(size);
+    record->ledger_seq = getLedgerSeq(meta);
+    auto* start = reinterpret_cast<char*>(record + 1);
+    xdr::xdr_put p(start, start + size);
+    xdr::xdr_argpack_archive(p, meta);
+    advance(space);
+    return used + space;
+}
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <cstddef>
+#include <string>
+
+struct stellar_meta_ring_header;
+
+namespace stellar
+{
+
+// Writes LedgerCloseMeta to a shared-memory ring buffer read by a co-located
+// consumer, see MetaRingBuffer.h for the layout and protocol. Each meta is
+// encoded once, directly into the mapping. publish blocks while the reader
+// hasn't released enough space.
+//
+// Only supported on POSIX systems with GCC or clang; the futex wakeups are
+// Linux-only, other systems poll.
+class MetaRingWriter : NonMovableOrCopyable
+{
+    std::string const mPath;
+    stellar_meta_ring_header* mHeader{nullptr};
+    size_t mMappedSize{0};
+
+    void waitForSpace(uint64_t needed);
+    void advance(uint64_t space);
+
+  public:
+    // Creates (or truncates) the ring buffer file at `path` with `capacity`
+    // bytes of data, rounded up to a multiple of 8
+    MetaRingWriter(std::string const& path, size_t capacity);
+    ~MetaRingWriter();
+
+    std::string const&
+    path() const
+    {
+        return mPath;
+    }
+
+    // Returns the number of bytes used in the ring, padding included
+    size_t publish(LedgerCloseMeta const& meta);
+};
+}
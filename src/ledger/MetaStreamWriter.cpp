@@ -0,0 +1,230 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/MetaStreamWriter.h"
+#include "bucket/BucketManager.h"
+#include "ledger/LedgerCloseMetaFrame.h"
+#include "main/Application.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/TmpDir.h"
+
+#include <Tracy.hpp>
+#include <cstdio>
+#include <fmt/format.h>
+#include <fstream>
+#include <medida/counter.h>
+#include <medida/meter.h>
+#include <medida/metrics_registry.h>
+#include <medida/timer.h>
+
+namespace stellar
+{
+
+MetaStreamWriter::MetaStreamWriter(Application& app,
+                                   std::unique_ptr<XDROutputFileStream> stream,
+                                   size_t maxQueued, bool spill)
+    : mApp(app)
+    , mMaxQueued(maxQueued)
+    , mSpill(spill)
+    , mStream(std::move(stream))
+    , mBytesWritten(
+          app.getMetrics().NewMeter({"ledger", "metastream", "bytes"}, "byte"))
+    , mWriteTime(app.getMetrics().NewTimer({"ledger", "metastream", "write"}))
+    , mLag(app.getMetrics().NewTimer({"ledger", "metastream", "lag"}))
+    , mBlockedTime(
+          app.getMetrics().NewTimer({"ledger", "metastream", "blocked"}))
+    , mQueueDepth(
+          app.getMetrics().NewCounter({"ledger", "metastream", "queue-depth"}))
+    , mSpillBytes(
+          app.getMetrics().NewCounter({"ledger", "metastream", "spill-bytes"}))
+{
+    releaseAssert(mMaxQueued > 0);
+    releaseAssert(mStream && mStream->isOpen());
+    mThread = std::thread([this]() { run(); });
+}
+
+MetaStreamWriter::~MetaStreamWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    mThread.join();
+    if (mSpillStream)
+    {
+        mSpillStream.reset();
+        std::remove(mSpillPath.c_str());
+    }
+}
+
+void
+MetaStreamWriter::emit(std::unique_ptr<LedgerCloseMetaFrame> meta)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+    releaseAssert(meta);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mInMemory >= mMaxQueued && !mSpill)
+    {
+        auto blocked = mBlockedTime.TimeScope();
+        mCV.wait(lock, [&]() { return mInMemory < mMaxQueued || mError; });
+    }
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+
+    Item item;
+    item.mQueuedAt = std::chrono::steady_clock::now();
+    if (mInMemory < mMaxQueued)
+    {
+        item.mMeta = std::move(meta);
+        ++mInMemory;
+    }
+    else
+    {
+        // Only the main thread queues spilled meta, so the spill file can be
+        // started over while none is pending
+        bool truncate = mSpilled == 0;
+        lock.unlock();
+        spill(*meta, item, truncate);
+        lock.lock();
+        ++mSpilled;
+    }
+    mQueue.emplace_back(std::move(item));
+    mQueueDepth.set_count(mQueue.size());
+    lock.unlock();
+    mCV.notify_all();
+}
+
+void
+MetaStreamWriter::drain()
+{
+    ZoneScoped;
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [&]() { return mQueue.empty(); });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+}
+
+void
+MetaStreamWriter::spill(LedgerCloseMetaFrame const& meta, Item& item,
+                        bool truncate)
+{
+    ZoneScoped;
+    if (!mSpillDir)
+    {
+        mSpillDir = std::make_unique<TmpDir>(
+            mApp.getBucketManager().getTmpDirManager().tmpDir("meta-spill"));
+        mSpillPath = mSpillDir->getName() + "/meta.xdr";
+    }
+    if (truncate && mSpillEnd > 0)
+    {
+        mSpillStream.reset();
+        std::remove(mSpillPath.c_str());
+        mSpillEnd = 0;
+    }
+    if (!mSpillStream)
+    {
+        mSpillStream = std::make_unique<XDROutputFileStream>(
+            mApp.getClock().getIOContext(), /*fsyncOnClose=*/false);
+        mSpillStream->open(mSpillPath);
+    }
+
+    size_t written = 0;
+    mSpillStream->writeOne(meta.getXDR(), nullptr, &written);
+    mSpillStream->flush();
+    item.mSpillOffset = mSpillEnd;
+    item.mSpillSize = written;
+    mSpillEnd += written;
+    mSpillBytes.inc(written);
+}
+
+void
+MetaStreamWriter::write(Item const& item)
+{
+    ZoneScoped;
+    auto timer = mWriteTime.TimeScope();
+    size_t written = 0;
+    if (item.mMeta)
+    {
+        mStream->writeOne(item.mMeta->getXDR(), nullptr, &written);
+    }
+    else
+    {
+        // mSpillPath is set before any spilled item is queued
+        std::vector<char> buf(item.mSpillSize);
+        std::ifstream in(mSpillPath, std::ios::binary);
+        in.seekg(item.mSpillOffset);
+        if (!in.read(buf.data(), buf.size()))
+        {
+            throw std::runtime_error(
+                fmt::format(FMT_STRING("failed to read spilled meta from {}"),
+                            mSpillPath));
+        }
+        mStream->writeBytes(buf.data(), buf.size());
+        written = buf.size();
+    }
+    mStream->flush();
+    mBytesWritten.Mark(written);
+}
+
+void
+MetaStreamWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCV.wait(lock, [&]() { return mStopping || !mQueue.empty(); });
+        if (mQueue.empty())
+        {
+            return;
+        }
+
+        // The main thread only appends to mQueue, which doesn't move its
+        // elements
+        auto& item = mQueue.front();
+        bool failed = static_cast<bool>(mError);
+        lock.unlock();
+
+        std::exception_ptr error;
+        if (!failed)
+        {
+            try
+            {
+                write(item);
+            }
+            catch (...)
+            {
+                CLOG_ERROR(Ledger, "Failed to write to the meta stream");
+                error = std::current_exception();
+            }
+        }
+
+        lock.lock();
+        if (error)
+        {
+            mError = error;
+        }
+        if (item.mMeta)
+        {
+            --mInMemory;
+        }
+        else
+        {
+            --mSpilled;
+            mSpillBytes.dec(item.mSpillSize);
+        }
+        mLag.Update(std::chrono::steady_clock::now() - item.mQueuedAt);
+        mQueue.pop_front();
+        mQueueDepth.set_count(mQueue.size());
+        mCV.notify_all();
+    }
+}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "util/XDRStream.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace medida
+{
+class Counter;
+class Meter;
+class Timer;
+}
+
+namespace stellar
+{
+
+class Application;
+class LedgerCloseMetaFrame;
+class TmpDir;
+
+// MetaStreamWriter writes the LedgerCloseMeta of closed ledgers to
+// METADATA_OUTPUT_STREAM from a dedicated thread, so that a slow reader of the
+// stream doesn't delay ledger close. Meta is written in the order it is
+// emitted, and serialized on the writer thread.
+//
+// At most `maxQueued` ledgers of meta are kept in memory. Beyond that, emit
+// either blocks until the writer catches up, or, when `spill` is set,
+// serializes the meta to a file in the bucket tmp dir that the writer streams
+// from once it gets there.
+//
+// An error writing the stream is rethrown on the main thread by the next call
+// to emit or drain. The destructor writes out everything still queued.
+class MetaStreamWriter : NonMovableOrCopyable
+{
+    struct Item
+    {
+        // Meta kept in memory, or null if it was spilled
+        std::unique_ptr<LedgerCloseMetaFrame> mMeta;
+        size_t mSpillOffset{0};
+        size_t mSpillSize{0};
+        std::chrono::steady_clock::time_point mQueuedAt;
+    };
+
+    Application& mApp;
+    size_t const mMaxQueued;
+    bool const mSpill;
+
+    // Only used by the writer thread once constructed
+    std::unique_ptr<XDROutputFileStream> mStream;
+
+    // Only used by the main thread
+    std::unique_ptr<TmpDir> mSpillDir;
+    std::string mSpillPath;
+    std::unique_ptr<XDROutputFileStream> mSpillStream;
+    size_t mSpillEnd{0};
+
+    // Guarded by mMutex
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<Item> mQueue;
+    size_t mInMemory{0};
+    size_t mSpilled{0};
+    std::exception_ptr mError;
+    bool mStopping{false};
+
+    medida::Meter& mBytesWritten;
+    medida::Timer& mWriteTime;
+    medida::Timer& mLag;
+    medida::Timer& mBlockedTime;
+    medida::Counter& mQueueDepth;
+    medida::Counter& mSpillBytes;
+
+    std::thread mThread;
+
+    void spill(LedgerCloseMetaFrame const& meta, Item& item, bool truncate);
+    void write(Item const& item);
+    void run();
+
+  public:
+    MetaStreamWriter(Application& app,
+                     std::unique_ptr<XDROutputFileStream> stream,
+                     size_t maxQueued, bool spill);
+    ~MetaStreamWriter();
+
+    void emit(std::unique_ptr<LedgerCloseMetaFrame> meta);
+
+    // Blocks until everything emitted so far is written to the stream
+    void drain();
+};
+}
@@ -0,0 +1,122 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/OfferSnapshot.h"
+#include "history/HistoryArchive.h"
+#include "main/PersistentState.h"
+
+#include <Tracy.hpp>
+#include <memory>
+
+namespace stellar
+{
+
+namespace
+{
+class BeginReadSnapshotOp : public DatabaseTypeSpecificOperation<void>
+{
+    soci::session& mSession;
+
+  public:
+    BeginReadSnapshotOp(soci::session& session) : mSession(session)
+    {
+    }
+
+    void
+    doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
+    {
+        // In WAL mode, the snapshot is taken by the first read of the
+        // transaction
+    }
+
+#ifdef USE_POSTGRES
+    void
+    doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
+    {
+        // Must be the first statement of the transaction
+        mSession << "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ, READ "
+                    "ONLY";
+    }
+#endif
+};
+}
+
+OfferSnapshot::OfferSnapshot(soci::connection_pool& pool)
+    : mSession(pool), mTransaction(mSession)
+{
+    ZoneScoped;
+    BeginReadSnapshotOp op(mSession);
+    doDatabaseTypeSpecificOperation(mSession, op);
+
+    // The HAS is stored in the same transaction as the offers of its ledger
+    auto hasStr = PersistentState::getState(
+        mSession, PersistentState::kHistoryArchiveState);
+    if (hasStr.empty())
+    {
+        throw std::runtime_error("No ledger in the database");
+    }
+    HistoryArchiveState has;
+    has.fromString(hasStr);
+    mLedgerSeq = has.currentLedger;
+}
+
+StatementContext
+OfferSnapshot::prepare(std::string const& sql)
+{
+    // Snapshots are short-lived, so statements aren't cached across them
+    auto p = std::make_shared<soci::statement>(mSession);
+    p->alloc();
+    p->prepare(sql);
+    return StatementContext(p);
+}
+
+uint32_t
+OfferSnapshot::getLedgerSeq() const
+{
+    return mLedgerSeq;
+}
+
+std::vector<LedgerEntry>
+OfferSnapshot::loadAllOffers()
+{
+    ZoneScoped;
+    return selectAllOffers(
+        [&](std::string const& sql) { return prepare(sql); });
+}
+
+std::vector<LedgerEntry>
+OfferSnapshot::loadBestOffers(Asset const& buying, Asset const& selling,
+                              size_t numOffers)
+{
+    ZoneScoped;
+    std::deque<LedgerEntry> offers;
+    selectBestOffers([&](std::string const& sql) { return prepare(sql); },
+                     offers, buying, selling, numOffers);
+    return std::vector<LedgerEntry>(std::make_move_iterator(offers.begin()),
+                                    std::make_move_iterator(offers.end()));
+}
+
+std::vector<LedgerEntry>
+OfferSnapshot::loadBestOffers(Asset const& buying, Asset const& selling,
+                              OfferDescriptor const& worseThan,
+                              size_t numOffers)
+{
+    ZoneScoped;
+    std::deque<LedgerEntry> offers;
+    selectBestOffers([&](std::string const& sql) { return prepare(sql); },
+                     offers, buying, selling, worseThan, numOffers);
+    return std::vector<LedgerEntry>(std::make_move_iterator(offers.begin()),
+                                    std::make_move_iterator(offers.end()));
+}
+
+std::vector<LedgerEntry>
+OfferSnapshot::loadOffersByAccountAndAsset(AccountID const& accountID,
+                                           Asset const& asset)
+{
+    ZoneScoped;
+    return selectOffersByAccountAndAsset(
+        [&](std::string const& sql) { return prepare(sql); }, accountID,
+        asset);
+}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/Database.h"
+#include "ledger/LedgerTxn.h"
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-ledger-entries.h"
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+// Queries of the offers table, run by LedgerTxnRoot on the main session and by
+// OfferSnapshot on a session of the connection pool. prepare returns a
+// statement for the given SQL on the session to query.
+using PrepareStatement = std::function<StatementContext(std::string const&)>;
+
+std::vector<LedgerEntry> selectAllOffers(PrepareStatement const& prepare);
+std::deque<LedgerEntry>::const_iterator
+selectBestOffers(PrepareStatement const& prepare,
+                 std::deque<LedgerEntry>& offers, Asset const& buying,
+                 Asset const& selling, size_t numOffers);
+std::deque<LedgerEntry>::const_iterator
+selectBestOffers(PrepareStatement const& prepare,
+                 std::deque<LedgerEntry>& offers, Asset const& buying,
+                 Asset const& selling, OfferDescriptor const& worseThan,
+                 size_t numOffers);
+std::vector<LedgerEntry>
+selectOffersByAccountAndAsset(PrepareStatement const& prepare,
+                              AccountID const& accountID, Asset const& asset);
+
+// OfferSnapshot is a read-only view of the offers in the database as of the
+// last committed ledger, for threads other than the main thread. It holds a
+// session of the connection pool for its lifetime, within a read transaction,
+// so all its queries see the same ledger however many ledgers close
+// meanwhile: SQLite serves them from the WAL snapshot taken by the first read,
+// PostgreSQL from a REPEATABLE READ transaction.
+//
+// Snapshots are meant to be short-lived. A SQLite snapshot keeps the WAL from
+// being checkpointed past the ledger it reads, and each one holds a session of
+// the pool, so constructing one blocks while all sessions are in use.
+class OfferSnapshot : NonMovableOrCopyable
+{
+    soci::session mSession;
+    // Never committed: rolled back when the snapshot is destroyed
+    soci::transaction mTransaction;
+    uint32_t mLedgerSeq{0};
+
+    StatementContext prepare(std::string const& sql);
+
+  public:
+    // The pool must be obtained from Database::getPool on the main thread, as
+    // creating it isn't thread-safe. Throws if the database has no ledger.
+    explicit OfferSnapshot(soci::connection_pool& pool);
+
+    // Ledger whose offers the snapshot sees
+    uint32_t getLedgerSeq() const;
+
+    // Same as the corresponding methods of AbstractLedgerTxnParent
+    std::vector<LedgerEntry> loadAllOffers();
+    std::vector<LedgerEntry> loadBestOffers(Asset const& buying,
+                                            Asset const& selling,
+                                            size_t numOffers);
+    std::vector<LedgerEntry> loadBestOffers(Asset const& buying,
+                                            Asset const& selling,
+                                            OfferDescriptor const& worseThan,
+                                            size_t numOffers);
+    std::vector<LedgerEntry>
+    loadOffersByAccountAndAsset(AccountID const& accountID,
+                                Asset const& asset);
+};
+}
@@ -47,6 +47,8 @@ SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics)
           metrics.NewMeter({"soroban", "host-fn-op", "emit-event"}, "event"))
     , mHostFnOpEmitEventByte(metrics.NewMeter(
           {"soroban", "host-fn-op", "emit-event-byte"}, "byte"))
+    , mHostFnOpUnchangedWriteEntry(metrics.NewMeter(
+          {"soroban", "host-fn-op", "unchanged-write-entry"}, "entry"))
     , mHostFnOpCpuInsn(
           metrics.NewMeter({"soroban", "host-fn-op", "cpu-insn"}, "insn"))
     , mHostFnOpMemByte(
@@ -87,6 +89,9 @@ SorobanMetrics::SorobanMetrics(medida::MetricsRegistry& metrics)
           {"soroban", "restore-fprint-op", "write-ledger-byte"}, "byte"))
     , mRestoreFpOpExec(
           metrics.NewTimer({"soroban", "restore-fprint-op", "exec"}))
+    /* prefetch metrics */
+    , mPrefetchMiss(
+          metrics.NewMeter({"soroban", "prefetch", "miss"}, "entry"))
     /* network config metrics */
     , mConfigContractDataKeySizeBytes(
           metrics.NewCounter({"soroban", "config", "contract-max-rw-key-byte"}))
@@ -64,6 +64,7 @@ class SorobanMetrics
     medida::Meter& mHostFnOpWriteCodeByte;
     medida::Meter& mHostFnOpEmitEvent;
     medida::Meter& mHostFnOpEmitEventByte;
+    medida::Meter& mHostFnOpUnchangedWriteEntry;
     medida::Meter& mHostFnOpCpuInsn;
     medida::Meter& mHostFnOpMemByte;
     medida::Timer& mHostFnOpInvokeTimeNsecs;
@@ -88,6 +89,9 @@ class SorobanMetrics
     medida::Meter& mRestoreFpOpWriteLedgerByte;
     medida::Timer& mRestoreFpOpExec;
 
+    // Prefetch metrics
+    medida::Meter& mPrefetchMiss;
+
     // `NetworkConfig` metrics
     medida::Counter& mConfigContractDataKeySizeBytes;
     medida::Counter& mConfigMaxContractDataEntrySizeBytes;
@@ -13,6 +13,8 @@
 #include "history/test/HistoryTestsUtils.h"
 #include "ledger/FlushAndRotateMetaDebugWork.h"
 #include "ledger/LedgerTxn.h"
+#include "ledger/MetaRingBuffer.h"
+#include "ledger/MetaRingWriter.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
@@ -34,6 +36,18 @@
 #include <fmt/format.h>
 #include <fstream>
 #include <iterator>
+#include <thread>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
 
 using namespace stellar;
 
@@ -401,6 +415,345 @@ TEST_CASE("EXPERIMENTAL_PRECAUTION_DELAY_META configuration",
     }
 }
 
+TEST_CASE("LedgerCloseMetaStream asynchronous writer",
+          "[ledgerclosemetastreamasync]")
+{
+    TmpDirManager tdm(std::string("streamtmp-") + binToHex(randomBytes(8)));
+    TmpDir td = tdm.tmpDir("streams");
+    std::string metaPath = td.getName() + "/stream.xdr";
+
+    bool const spill = GENERATE(false, true);
+    CAPTURE(spill);
+    bool const flush = GENERATE(false, true);
+    CAPTURE(flush);
+
+    auto checkStream = [&](uint32_t lastClosed) {
+        XDRInputFileStream in;
+        in.open(metaPath);
+        LedgerCloseMeta lcm;
+        uint32_t expected = LedgerManager::GENESIS_LEDGER_SEQ + 1;
+        while (in.readOne(lcm))
+        {
+            auto const& header = lcm.v() == 0 ? lcm.v0().ledgerHeader
+                                              : lcm.v1().ledgerHeader;
+            REQUIRE(header.header.ledgerSeq == expected);
+            ++expected;
+        }
+        REQUIRE(expected == lastClosed + 1);
+    };
+
+    uint32_t lastClosed = 0;
+    {
+        VirtualClock clock;
+        Config cfg = getTestConfig();
+        cfg.METADATA_OUTPUT_STREAM = metaPath;
+        // A single ledger in memory, so that later ones block or spill while
+        // the writer is busy
+        cfg.METADATA_OUTPUT_STREAM_QUEUE_SIZE = 1;
+        cfg.METADATA_OUTPUT_STREAM_SPILL = spill;
+        auto app = createTestApplication(clock, cfg);
+        for (size_t i = 0; i < 20; ++i)
+        {
+            txtest::closeLedger(*app);
+        }
+        lastClosed = app->getLedgerManager().getLastClosedLedgerNum();
+        if (flush)
+        {
+            // Everything closed so far is out while the application runs
+            app->getLedgerManager().flushMetaStream();
+            checkStream(lastClosed);
+        }
+        // Otherwise, queued meta is written out when the application is
+        // destroyed
+    }
+
+    checkStream(lastClosed);
+}
+
+TEST_CASE("LedgerCloseMetaStream filtering", "[ledgerclosemetafilter]")
+{
+    TmpDirManager tdm(std::string("streamtmp-") + binToHex(randomBytes(8)));
+    TmpDir td = tdm.tmpDir("streams");
+    std::string metaPath = td.getName() + "/stream.xdr";
+
+    bool const excludeChanges = GENERATE(false, true);
+    CAPTURE(excludeChanges);
+
+    {
+        VirtualClock clock;
+        Config cfg = getTestConfig();
+        cfg.METADATA_OUTPUT_STREAM = metaPath;
+        if (excludeChanges)
+        {
+            cfg.METADATA_OUTPUT_EXCLUDE = {"TX_SET", "ENTRY_CHANGES"};
+        }
+        else
+        {
+            cfg.METADATA_OUTPUT_ENTRY_FILTER = "data.type == 'TRUSTLINE'";
+        }
+        auto app = createTestApplication(clock, cfg);
+
+        // One ledger creating accounts, then one creating a trustline
+        auto root = TestAccount::createRoot(*app);
+        auto const bal = app->getLedgerManager().getLastMinBalance(2) * 10;
+        auto acc1Key = txtest::getAccount("acc1");
+        auto issuerKey = txtest::getAccount("issuer");
+        auto createTx =
+            root.tx({txtest::createAccount(acc1Key.getPublicKey(), bal),
+                     txtest::createAccount(issuerKey.getPublicKey(), bal)});
+        txtest::closeLedger(*app, {createTx});
+        TestAccount acc1(*app, acc1Key);
+        TestAccount issuer(*app, issuerKey);
+        auto trustTx =
+            acc1.tx({txtest::changeTrust(issuer.asset("CUR1"), 100)});
+        txtest::closeLedger(*app, {trustTx});
+    }
+
+    XDRInputFileStream in;
+    in.open(metaPath);
+    LedgerCloseMeta lcm;
+    size_t opMetas = 0;
+    size_t trustLineChanges = 0;
+    while (in.readOne(lcm))
+    {
+        if (excludeChanges)
+        {
+            if (lcm.v() == 0)
+            {
+                REQUIRE(lcm.v0().txSet == TransactionSet{});
+            }
+            else
+            {
+                REQUIRE(lcm.v1().txSet == GeneralizedTransactionSet{});
+            }
+        }
+
+        auto const& txProcessing =
+            lcm.v() == 0 ? lcm.v0().txProcessing : lcm.v1().txProcessing;
+        for (auto const& trm : txProcessing)
+        {
+            LedgerEntryChanges changes = trm.feeProcessing;
+            auto collect = [&](auto const& tm) {
+                changes.insert(changes.end(), tm.txChangesBefore.begin(),
+                               tm.txChangesBefore.end());
+                for (auto const& op : tm.operations)
+                {
+                    ++opMetas;
+                    changes.insert(changes.end(), op.changes.begin(),
+                                   op.changes.end());
+                }
+                changes.insert(changes.end(), tm.txChangesAfter.begin(),
+                               tm.txChangesAfter.end());
+            };
+            auto const& tm = trm.txApplyProcessing;
+            if (tm.v() == 2)
+            {
+                collect(tm.v2());
+            }
+            else
+            {
+                collect(tm.v3());
+            }
+
+            if (excludeChanges)
+            {
+                REQUIRE(changes.empty());
+            }
+            for (auto const& change : changes)
+            {
+                REQUIRE(change.type() == LEDGER_ENTRY_CREATED);
+                REQUIRE(change.created().data.type() == TRUSTLINE);
+                ++trustLineChanges;
+            }
+        }
+    }
+    // Operations are kept even when all their changes are filtered out
+    REQUIRE(opMetas == 3);
+    REQUIRE(trustLineChanges == (excludeChanges ? 0 : 1));
+}
+
+TEST_CASE("LedgerCloseMetaStream invalid filters", "[ledgerclosemetafilter]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    SECTION("unknown section")
+    {
+        cfg.METADATA_OUTPUT_EXCLUDE = {"TX_SET", "OPERATIONS"};
+    }
+    SECTION("invalid entry query")
+    {
+        cfg.METADATA_OUTPUT_ENTRY_FILTER = "data.type = 'TRUSTLINE'";
+    }
+    SECTION("unknown entry field")
+    {
+        cfg.METADATA_OUTPUT_ENTRY_FILTER = "data.account.foo == 1";
+    }
+    REQUIRE_THROWS_AS(createTestApplication(clock, cfg),
+                      std::invalid_argument);
+}
+
+#ifndef _WIN32
+namespace
+{
+// Maps a ring buffer the way a consumer would
+class MetaRingReader
+{
+    stellar_meta_ring_header* mHeader;
+    size_t mSize;
+
+  public:
+    explicit MetaRingReader(std::string const& path)
+    {
+        int fd = ::open(path.c_str(), O_RDWR);
+        REQUIRE(fd != -1);
+        struct stat st;
+        REQUIRE(::fstat(fd, &st) == 0);
+        mSize = st.st_size;
+        void* addr =
+            ::mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        REQUIRE(addr != MAP_FAILED);
+        mHeader = static_cast<stellar_meta_ring_header*>(addr);
+        REQUIRE(mHeader->magic == STELLAR_META_RING_MAGIC);
+        REQUIRE(mHeader->version == STELLAR_META_RING_VERSION);
+    }
+
+    ~MetaRingReader()
+    {
+        ::munmap(mHeader, mSize);
+    }
+
+    // Ledger sequence stored in the header of the last record read
+    uint32_t mLastRecordSeq{0};
+
+    bool
+    next(LedgerCloseMeta& lcm)
+    {
+        auto* record = stellar_meta_ring_next(mHeader);
+        if (!record)
+        {
+            return false;
+        }
+        auto const* start = reinterpret_cast<uint8_t const*>(record + 1);
+        xdr::xdr_get g(start, start + record->size);
+        xdr::xdr_argpack_archive(g, lcm);
+        mLastRecordSeq = record->ledger_seq;
+        stellar_meta_ring_release(mHeader, record);
+#ifdef __linux__
+        syscall(SYS_futex, &mHeader->read_futex, FUTEX_WAKE, INT_MAX, nullptr,
+                nullptr, 0);
+#endif
+        return true;
+    }
+};
+
+LedgerCloseMeta
+makeRingTestMeta(uint32_t ledgerSeq)
+{
+    LedgerCloseMeta lcm(0);
+    lcm.v0().ledgerHeader.header.ledgerSeq = ledgerSeq;
+    // Vary the size so that records end at different offsets
+    lcm.v0().upgradesProcessing.resize(ledgerSeq % 5);
+    return lcm;
+}
+}
+
+TEST_CASE("LedgerCloseMeta shared-memory ring buffer",
+          "[ledgerclosemetaring]")
+{
+    TmpDirManager tdm(std::string("ringtmp-") + binToHex(randomBytes(8)));
+    TmpDir td = tdm.tmpDir("ring");
+    std::string path = td.getName() + "/ring";
+    uint32_t const count = 200;
+
+    SECTION("reader keeping up")
+    {
+        MetaRingWriter writer(path, 1024);
+        MetaRingReader reader(path);
+        for (uint32_t i = 1; i <= count; ++i)
+        {
+            writer.publish(makeRingTestMeta(i));
+            LedgerCloseMeta lcm;
+            REQUIRE(reader.next(lcm));
+            REQUIRE(lcm == makeRingTestMeta(i));
+            REQUIRE(reader.mLastRecordSeq == i);
+            REQUIRE(!reader.next(lcm));
+        }
+    }
+
+    SECTION("writer waiting for a concurrent reader")
+    {
+        // The ring only holds a few records at a time, so the writer keeps
+        // waiting for the reader to release space
+        MetaRingWriter writer(path, 1024);
+        MetaRingReader reader(path);
+        std::vector<LedgerCloseMeta> read;
+        std::thread readerThread([&]() {
+            LedgerCloseMeta lcm;
+            while (read.size() < count)
+            {
+                if (reader.next(lcm))
+                {
+                    read.emplace_back(lcm);
+                }
+                else
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+        for (uint32_t i = 1; i <= count; ++i)
+        {
+            writer.publish(makeRingTestMeta(i));
+        }
+        readerThread.join();
+        REQUIRE(read.size() == count);
+        for (uint32_t i = 1; i <= count; ++i)
+        {
+            REQUIRE(read[i - 1] == makeRingTestMeta(i));
+        }
+    }
+
+    SECTION("meta larger than the ring is rejected")
+    {
+        MetaRingWriter writer(path, 64);
+        REQUIRE_THROWS_AS(writer.publish(makeRingTestMeta(4)),
+                          std::runtime_error);
+    }
+}
+
+TEST_CASE("LedgerCloseMetaStream to a shared-memory ring buffer",
+          "[ledgerclosemetaring]")
+{
+    TmpDirManager tdm(std::string("ringtmp-") + binToHex(randomBytes(8)));
+    TmpDir td = tdm.tmpDir("ring");
+    std::string path = td.getName() + "/ring";
+
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    cfg.METADATA_OUTPUT_STREAM = "shm:" + path;
+    cfg.METADATA_OUTPUT_RING_BUFFER_SIZE_MB = 1;
+    auto app = createTestApplication(clock, cfg);
+
+    MetaRingReader reader(path);
+    uint32_t expected = LedgerManager::GENESIS_LEDGER_SEQ + 1;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        txtest::closeLedger(*app);
+        LedgerCloseMeta lcm;
+        while (reader.next(lcm))
+        {
+            auto const& header = lcm.v() == 0 ? lcm.v0().ledgerHeader
+                                              : lcm.v1().ledgerHeader;
+            REQUIRE(header.header.ledgerSeq == expected);
+            REQUIRE(reader.mLastRecordSeq == expected);
+            ++expected;
+        }
+    }
+    REQUIRE(expected == app->getLedgerManager().getLastClosedLedgerNum() + 1);
+}
+#endif
+
 TEST_CASE("METADATA_DEBUG_LEDGERS works", "[metadebug]")
 {
     VirtualClock clock;
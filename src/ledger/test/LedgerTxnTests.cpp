@@ -4,16 +4,20 @@
 
 #include "bucket/BucketManager.h"
 #include "bucket/test/BucketTestUtils.h"
+#include "ledger/LedgerManager.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "ledger/LedgerTxnHeader.h"
 #include "ledger/LedgerTypeUtils.h"
 #include "ledger/NonSociRelatedException.h"
+#include "ledger/OfferSnapshot.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "lib/util/stdrandom.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "test/TestAccount.h"
 #include "test/TestUtils.h"
 #include "test/TxTests.h"
@@ -30,6 +34,7 @@
 #include <memory>
 #include <queue>
 #include <set>
+#include <thread>
 #include <xdrpp/autocheck.h>
 
 using namespace stellar;
@@ -3101,6 +3106,80 @@ TEST_CASE("LedgerTxnRoot prefetch soroban entries", "[ledgertxn]")
     }
 }
 
+TEST_CASE("LedgerTxnRoot parallel soroban prefetch", "[ledgertxn]")
+{
+    auto runTest = [](uint32_t threads) {
+        Config cfg = getTestConfig();
+        cfg.DEPRECATED_SQL_LEDGER_STATE = false;
+        cfg.ENTRY_CACHE_SIZE = 1000;
+        cfg.SOROBAN_PREFETCH_THREADS = threads;
+        VirtualClock clock;
+        Application::pointer app = createTestApplication(clock, cfg);
+
+        // Enough keys for each thread to search some of them. The last ones
+        // aren't in the BucketList.
+        auto entries =
+            LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+                {CONTRACT_DATA}, 450);
+        std::vector<LedgerEntry> liveEntries(entries.begin(),
+                                             entries.begin() + 400);
+        LedgerHeader lh;
+        lh.ledgerVersion = app->getLedgerManager()
+                               .getLastClosedLedgerHeader()
+                               .header.ledgerVersion;
+        lh.ledgerSeq = 2;
+        BucketTestUtils::addBatchAndUpdateSnapshot(
+            app->getBucketManager().getBucketList(), *app, lh, {}, liveEntries,
+            {});
+
+        // The first transaction has the quota to read all its entries, the
+        // second one all but one of them
+        LedgerKeyMeter lkMeter;
+        UnorderedSet<LedgerKey> keys;
+        SorobanResources tx1;
+        SorobanResources tx2;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            auto& resources = i < 200 || i >= 400 ? tx1 : tx2;
+            auto key = LedgerEntryKey(entries[i]);
+            resources.footprint.readOnly.emplace_back(key);
+            if (i < 400)
+            {
+                resources.readBytes += xdr::xdr_size(entries[i]);
+            }
+            keys.emplace(key);
+        }
+        tx2.readBytes -= 1;
+        lkMeter.addTxn(tx1);
+        lkMeter.addTxn(tx2);
+
+        auto& root = app->getLedgerTxnRoot();
+        REQUIRE(root.prefetchSoroban(keys, &lkMeter) == keys.size() - 1);
+
+        // Only the entry left out is loaded again
+        auto& missMeter = app->getMetrics().NewMeter(
+            {"soroban", "prefetch", "miss"}, "entry");
+        auto misses = missMeter.count();
+        LedgerTxn ltx(root);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            auto ltxe = ltx.loadWithoutRecord(LedgerEntryKey(entries[i]));
+            REQUIRE(static_cast<bool>(ltxe) == (i < 400));
+        }
+        REQUIRE(missMeter.count() == misses + 1);
+    };
+
+    SECTION("main thread")
+    {
+        runTest(1);
+    }
+
+    SECTION("multiple threads")
+    {
+        runTest(4);
+    }
+}
+
 TEST_CASE("LedgerKeyMeter tests")
 {
     LedgerKeyMeter lkMeter{};
@@ -3997,6 +4076,264 @@ TEST_CASE_VERSIONS("LedgerTxn bulk-load offers", "[ledgertxn]")
 #endif
 }
 
+TEST_CASE("LedgerTxn bulk-write offers", "[ledgertxn]")
+{
+    auto runTest = [&](Config::TestDbMode mode) {
+        VirtualClock clock;
+        auto app = createTestApplication(clock, getTestConfig(0, mode));
+        auto& root = app->getLedgerTxnRoot();
+
+        // More offers than SQLite writes with a single statement
+        std::vector<LedgerEntry> offers;
+        UnorderedSet<int64_t> offerIDs;
+        while (offers.size() < 500)
+        {
+            LedgerEntry le;
+            le.data.type(OFFER);
+            le.data.offer() = LedgerTestUtils::generateValidOfferEntry();
+            if (offerIDs.emplace(le.data.offer().offerID).second)
+            {
+                offers.emplace_back(le);
+            }
+        }
+
+        {
+            LedgerTxn ltx(root);
+            for (auto const& le : offers)
+            {
+                ltx.create(le);
+            }
+            ltx.commit();
+        }
+
+        // Update the first half of the offers and erase the other one
+        {
+            LedgerTxn ltx(root);
+            for (size_t i = 0; i < offers.size(); ++i)
+            {
+                if (i < offers.size() / 2)
+                {
+                    auto entry = ltx.load(LedgerEntryKey(offers[i]));
+                    entry.current().data.offer().amount = i + 1;
+                    offers[i].data.offer().amount = i + 1;
+                }
+                else
+                {
+                    ltx.erase(LedgerEntryKey(offers[i]));
+                }
+            }
+            ltx.commit();
+        }
+        offers.resize(offers.size() / 2);
+
+        auto allOffers = root.getAllOffers();
+        REQUIRE(allOffers.size() == offers.size());
+        for (auto const& le : offers)
+        {
+            auto iter = allOffers.find(LedgerEntryKey(le));
+            REQUIRE(iter != allOffers.end());
+            REQUIRE(iter->second.data == le.data);
+        }
+    };
+
+    SECTION("sqlite")
+    {
+        runTest(Config::TESTDB_ON_DISK_SQLITE);
+    }
+
+#ifdef USE_POSTGRES
+    SECTION("postgresql")
+    {
+        runTest(Config::TESTDB_POSTGRESQL);
+    }
+#endif
+}
+
+TEST_CASE("OfferSnapshot", "[ledgertxn]")
+{
+    auto runTest = [&](Config::TestDbMode mode) {
+        VirtualClock clock;
+        auto app = createTestApplication(clock, getTestConfig(0, mode));
+        auto& root = app->getLedgerTxnRoot();
+        auto& pool = app->getDatabase().getPool();
+
+        auto native = txtest::makeNativeAsset();
+        auto cur1 = txtest::makeAsset(txtest::getAccount("issuer"), "CUR1");
+
+        std::vector<LedgerEntry> offers;
+        UnorderedSet<int64_t> offerIDs;
+        while (offers.size() < 50)
+        {
+            LedgerEntry le;
+            le.data.type(OFFER);
+            le.data.offer() = LedgerTestUtils::generateValidOfferEntry();
+            le.data.offer().selling = native;
+            le.data.offer().buying = cur1;
+            if (offerIDs.emplace(le.data.offer().offerID).second)
+            {
+                offers.emplace_back(le);
+            }
+        }
+        {
+            LedgerTxn ltx(root);
+            for (auto const& le : offers)
+            {
+                ltx.create(le);
+            }
+            ltx.commit();
+        }
+        std::sort(offers.begin(), offers.end(),
+                  [](LedgerEntry const& lhs, LedgerEntry const& rhs) {
+                      return isBetterOffer(lhs, rhs);
+                  });
+
+        auto lcl = app->getLedgerManager().getLastClosedLedgerNum();
+        std::vector<LedgerEntry> best;
+        std::vector<LedgerEntry> worse;
+        std::vector<LedgerEntry> all;
+        uint32_t ledgerSeq = 0;
+        auto load = [&](OfferSnapshot& snapshot) {
+            ledgerSeq = snapshot.getLedgerSeq();
+            best = snapshot.loadBestOffers(cur1, native, 10);
+            auto const& tenth = offers[9].data.offer();
+            worse = snapshot.loadBestOffers(
+                cur1, native, OfferDescriptor{tenth.price, tenth.offerID}, 10);
+            all = snapshot.loadAllOffers();
+        };
+
+        // Queries see the offers as of the snapshot, whatever is committed
+        // meanwhile
+        {
+            OfferSnapshot snapshot(pool);
+            {
+                LedgerTxn ltx(root);
+                for (auto const& le : offers)
+                {
+                    ltx.erase(LedgerEntryKey(le));
+                }
+                ltx.commit();
+            }
+
+            std::thread t([&]() { load(snapshot); });
+            t.join();
+        }
+        REQUIRE(ledgerSeq == lcl);
+        REQUIRE(all.size() == offers.size());
+        REQUIRE(std::vector<LedgerEntry>(offers.begin(), offers.begin() + 10) ==
+                best);
+        REQUIRE(std::vector<LedgerEntry>(offers.begin() + 10,
+                                         offers.begin() + 20) == worse);
+
+        std::thread t([&]() {
+            OfferSnapshot snapshot(pool);
+            load(snapshot);
+        });
+        t.join();
+        REQUIRE(best.empty());
+        REQUIRE(all.empty());
+    };
+
+    SECTION("sqlite")
+    {
+        runTest(Config::TESTDB_ON_DISK_SQLITE);
+    }
+
+#ifdef USE_POSTGRES
+    SECTION("postgresql")
+    {
+        runTest(Config::TESTDB_POSTGRESQL);
+    }
+#endif
+}
+
+TEST_CASE("LedgerTxnRoot contract code cache", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(
+        clock, getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE));
+    auto& root = app->getLedgerTxnRoot();
+    auto& hit = app->getMetrics().NewMeter(
+        {"ledger", "contract-code-cache", "hit"}, "entry");
+    auto& miss = app->getMetrics().NewMeter(
+        {"ledger", "contract-code-cache", "miss"}, "entry");
+
+    auto code = LedgerTestUtils::generateValidLedgerEntryOfType(CONTRACT_CODE);
+    auto key = LedgerEntryKey(code);
+    {
+        LedgerTxn ltx(root);
+        ltx.create(code);
+        ltx.commit();
+    }
+
+    // Loads the code from a new LedgerTxn and returns whether it hit the cache
+    auto load = [&](std::optional<LedgerEntry>& loaded) {
+        auto hits = hit.count();
+        auto misses = miss.count();
+        LedgerTxn ltx(root);
+        auto entry = ltx.loadWithoutRecord(key);
+        if (entry)
+        {
+            loaded = entry.current();
+        }
+        else
+        {
+            loaded.reset();
+        }
+        REQUIRE(hit.count() + miss.count() == hits + misses + 1);
+        return hit.count() == hits + 1;
+    };
+
+    std::optional<LedgerEntry> loaded;
+    REQUIRE(!load(loaded));
+    REQUIRE(loaded == code);
+    REQUIRE(load(loaded));
+    REQUIRE(loaded == code);
+
+    SECTION("kept across commits that don't modify it")
+    {
+        {
+            LedgerTxn ltx(root);
+            ltx.create(LedgerTestUtils::generateValidLedgerEntryOfType(
+                CONTRACT_CODE));
+            ltx.commit();
+        }
+        REQUIRE(load(loaded));
+        REQUIRE(loaded == code);
+    }
+
+    SECTION("dropped by commits that modify it")
+    {
+        {
+            LedgerTxn ltx(root);
+            auto entry = ltx.load(key);
+            entry.current().lastModifiedLedgerSeq += 1;
+            code = entry.current();
+            ltx.commit();
+        }
+        REQUIRE(!load(loaded));
+        REQUIRE(loaded == code);
+        REQUIRE(load(loaded));
+    }
+
+    SECTION("dropped by commits that erase it")
+    {
+        {
+            LedgerTxn ltx(root);
+            ltx.erase(key);
+            ltx.commit();
+        }
+        REQUIRE(!load(loaded));
+        REQUIRE(!loaded);
+    }
+
+    SECTION("cleared")
+    {
+        root.clearContractCodeCache();
+        REQUIRE(!load(loaded));
+        REQUIRE(loaded == code);
+    }
+}
+
 TEST_CASE("Access deactivated entry", "[ledgertxn]")
 {
     auto runTest = [&](Config::TestDbMode mode) {
@@ -347,7 +347,8 @@ ApplicationImpl::initialize(bool createNewDB, bool forceRebuild)
                         mConfig.ENTRY_CACHE_SIZE);
         }
         mLedgerTxnRoot = std::make_unique<LedgerTxnRoot>(
-            *this, mConfig.ENTRY_CACHE_SIZE, mConfig.PREFETCH_BATCH_SIZE
+            *this, mConfig.ENTRY_CACHE_SIZE, mConfig.PREFETCH_BATCH_SIZE,
+            mConfig.CONTRACT_CODE_CACHE_SIZE
 #ifdef BEST_OFFER_DEBUGGING
             ,
             mConfig.BEST_OFFER_DEBUGGING_ENABLED
@@ -672,6 +673,10 @@ ApplicationImpl::~ApplicationImpl()
     try
     {
         shutdownWorkScheduler();
+        if (mHistoryArchiveManager)
+        {
+            mHistoryArchiveManager->shutdown();
+        }
         if (mProcessManager)
         {
             mProcessManager->shutdown();
@@ -973,6 +978,20 @@ ApplicationImpl::gracefulStop()
     }
     mSelfCheckTimer.cancel();
     shutdownWorkScheduler();
+    if (mLedgerManager)
+    {
+        // Consumers of the meta stream expect the meta of every ledger the
+        // node closed to be out by the time it stops
+        try
+        {
+            mLedgerManager->flushMetaStream();
+        }
+        catch (std::exception const& e)
+        {
+            LOG_ERROR(DEFAULT_LOG, "Failed to write ledger close meta: {}",
+                      e.what());
+        }
+    }
     if (mProcessManager)
     {
         mProcessManager->shutdown();
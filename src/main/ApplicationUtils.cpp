@@ -8,6 +8,7 @@
 #include "bucket/BucketManager.h"
 #include "catchup/ApplyBucketsWork.h"
 #include "catchup/CatchupConfiguration.h"
+#include "catchup/ParallelCatchupWork.h"
 #include "crypto/Hex.h"
 #include "database/Database.h"
 #include "herder/Herder.h"
@@ -1047,13 +1048,32 @@ writeCatchupInfo(Json::Value const& catchupInfo, std::string const& outputFile)
 
 int
 catchup(Application::pointer app, CatchupConfiguration cc,
-        Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive)
+        Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive,
+        uint32_t segments)
 {
     app->start();
 
+    std::shared_ptr<ParallelCatchupWork> parallelWork;
     try
     {
-        app->getLedgerManager().startCatchup(cc, archive, {});
+        // The application catches up to the last segment itself, the leading
+        // ones are replayed by ParallelCatchupWork
+        auto configs = ParallelCatchupWork::splitRange(
+            app->getLedgerManager().getLastClosedLedgerNum(), cc, segments,
+            app->getHistoryManager());
+        if (segments > 1 && configs.size() == 1)
+        {
+            LOG_INFO(DEFAULT_LOG, "Catchup range can't be split, replaying "
+                                  "it as a single segment");
+        }
+        app->getLedgerManager().startCatchup(configs.back(), archive, {});
+        configs.pop_back();
+        if (!configs.empty())
+        {
+            parallelWork =
+                app->getWorkScheduler().scheduleWork<ParallelCatchupWork>(
+                    configs, archive);
+        }
     }
     catch (std::invalid_argument const&)
     {
@@ -1078,7 +1098,10 @@ catchup(Application::pointer app, CatchupConfiguration cc,
     auto done = false;
     while (!done && clock.crank(true))
     {
-        switch (app->getCatchupManager().getCatchupWorkState())
+        auto state = parallelWork
+                         ? parallelWork->getState()
+                         : app->getCatchupManager().getCatchupWorkState();
+        switch (state)
         {
         case BasicWork::State::WORK_ABORTED:
         case BasicWork::State::WORK_FAILURE:
@@ -1102,6 +1125,12 @@ catchup(Application::pointer app, CatchupConfiguration cc,
         }
     }
 
+    if (synced)
+    {
+        // Only report success once the meta of the replayed ledgers is out
+        app->getLedgerManager().flushMetaStream();
+    }
+
     LOG_INFO(DEFAULT_LOG, "*");
     if (synced)
     {
@@ -52,8 +52,11 @@ int initializeHistories(Config cfg,
                         std::vector<std::string> const& newHistories);
 void writeCatchupInfo(Json::Value const& catchupInfo,
                       std::string const& outputFile);
+// With `segments` > 1 the range is split into that many segments replayed
+// side by side, see ParallelCatchupWork
 int catchup(Application::pointer app, CatchupConfiguration cc,
-            Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive);
+            Json::Value& catchupInfo, std::shared_ptr<HistoryArchive> archive,
+            uint32_t segments = 1);
 // Reduild ledger state based on the buckets. Ensure ledger state is properly
 // reset before calling this function.
 bool applyBucketsForLCL(Application& app);
@@ -8,6 +8,7 @@
 #include "bucket/BucketSnapshotManager.h"
 #include "crypto/Hex.h"
 #include "crypto/KeyUtils.h"
+#include "database/Database.h"
 #include "herder/Herder.h"
 #include "history/HistoryArchiveManager.h"
 #include "ledger/InternalLedgerEntry.h"
@@ -85,10 +86,13 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
         if (mApp.getConfig().HTTP_QUERY_PORT &&
             mApp.getConfig().isUsingBucketListDB())
         {
+            // The pool is created here as getPool is main thread only
+            auto& db = mApp.getDatabase();
             mQueryServer = std::make_unique<QueryServer>(
                 ipStr, mApp.getConfig().HTTP_QUERY_PORT, httpMaxClient,
                 mApp.getConfig().QUERY_THREAD_POOL_SIZE,
-                mApp.getBucketManager().getBucketSnapshotManager());
+                mApp.getBucketManager().getBucketSnapshotManager(),
+                db.canUsePool() ? &db.getPool() : nullptr);
         }
     }
     else
@@ -27,6 +27,7 @@
 #include "main/SettingsUpgradeUtils.h"
 #include "main/StellarCoreVersion.h"
 #include "main/dumpxdr.h"
+#include "medida/meter.h"
 #include "medida/metrics_registry.h"
 #include "overlay/OverlayManager.h"
 #include "rust/RustBridge.h"
@@ -310,6 +311,15 @@ fromLedgerNumberParser(std::optional<uint32_t>& fromLedgerNum)
         "specify a ledger number to start from");
 }
 
+clara::Opt
+checkpointLedgerParser(std::optional<uint32_t>& ledgerNum)
+{
+    return clara::Opt{
+        [&](std::string const& arg) { ledgerNum = std::stoul(arg); },
+        "LEDGER"}["--ledger"](
+        "only dump the entry of this ledger from a checkpoint file");
+}
+
 clara::Opt
 historyHashParser(std::string& hash)
 {
@@ -818,6 +828,7 @@ runCatchup(CommandLineArgs const& args)
     bool forceUntrusted = false;
     std::string hash;
     std::string stream;
+    uint32_t segments = 1;
 
     auto validateCatchupString = [&] {
         try
@@ -861,6 +872,17 @@ runCatchup(CommandLineArgs const& args)
         return clara::Opt{completeValidation}["--extra-verification"](
             "verify all files from the archive for the catchup range");
     };
+    auto segmentsParser = ParserWithValidation{
+        clara::Opt{segments, "N"}["--parallel-segments"](
+            "split the catchup range into N segments replayed side by side, "
+            "each from the buckets at its start"),
+        [&] {
+            if (segments == 0)
+            {
+                return std::string{"--parallel-segments must be at least 1"};
+            }
+            return std::string{};
+        }};
 
     return runWithHelp(
         args,
@@ -870,7 +892,7 @@ runCatchup(CommandLineArgs const& args)
          outputFileParser(outputFile), disableBucketGCParser(disableBucketGC),
          validationParser(completeValidation), inMemoryParser(inMemory),
          ledgerHashParser(hash), forceUntrustedCatchup(forceUntrusted),
-         metadataOutputStreamParser(stream)},
+         metadataOutputStreamParser(stream), segmentsParser},
         [&] {
             auto config = configOption.getConfig();
             // Don't call config.setNoListen() here as we might want to
@@ -895,6 +917,13 @@ runCatchup(CommandLineArgs const& args)
             maybeEnableInMemoryMode(config, inMemory, 0, "",
                                     /* persistMinimalData */ false);
             maybeSetMetadataOutputStream(config, stream);
+            if (segments > 1 && config.METADATA_OUTPUT_STREAM.find("fd:") == 0)
+            {
+                // Each segment writes its own stream
+                throw std::runtime_error(
+                    "--parallel-segments requires a file metadata output "
+                    "stream, not a file descriptor");
+            }
 
             VirtualClock clock(VirtualClock::REAL_TIME);
             int result;
@@ -953,7 +982,7 @@ runCatchup(CommandLineArgs const& args)
                 }
 
                 Json::Value catchupInfo;
-                result = catchup(app, cc, catchupInfo, archivePtr);
+                result = catchup(app, cc, catchupInfo, archivePtr, segments);
                 if (!catchupInfo.isNull())
                 {
                     writeCatchupInfo(catchupInfo, outputFile);
@@ -1070,10 +1099,13 @@ runDumpXDR(CommandLineArgs const& args)
 {
     std::string xdr;
     bool compact = false;
+    std::optional<uint32_t> ledger;
 
-    return runWithHelp(args, {compactParser(compact), fileNameParser(xdr)},
+    return runWithHelp(args,
+                       {compactParser(compact), checkpointLedgerParser(ledger),
+                        fileNameParser(xdr)},
                        [&] {
-                           dumpXdrStream(xdr, compact);
+                           dumpXdrStream(xdr, compact, ledger);
                            return 0;
                        });
 }
@@ -1925,6 +1957,13 @@ runApplyLoad(CommandLineArgs const& args)
                      "ledger-cpu-insns-ratio-excl-vm"});
                 ledgerCpuInsRatioExclVm.Clear();
 
+                auto& codeCacheHit = app.getMetrics().NewMeter(
+                    {"ledger", "contract-code-cache", "hit"}, "entry");
+                auto& codeCacheMiss = app.getMetrics().NewMeter(
+                    {"ledger", "contract-code-cache", "miss"}, "entry");
+                auto codeCacheHitBefore = codeCacheHit.count();
+                auto codeCacheMissBefore = codeCacheMiss.count();
+
                 for (size_t i = 0; i < 100; ++i)
                 {
                     app.getBucketManager().getBucketList().resolveAllFutures();
@@ -1988,6 +2027,14 @@ runApplyLoad(CommandLineArgs const& args)
 
                 CLOG_INFO(Perf, "Tx Success Rate: {:f}%",
                           al.successRate() * 100);
+
+                // Each hit is a contract code entry that didn't have to be
+                // loaded again from the BucketList
+                CLOG_INFO(Perf,
+                          "Contract code cache per ledger: {} hits, {} misses",
+                          (codeCacheHit.count() - codeCacheHitBefore) / 100.0,
+                          (codeCacheMiss.count() - codeCacheMissBefore) /
+                              100.0);
             }
 
             return 0;
@@ -169,6 +169,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
     BUCKETLIST_DB_PERSIST_INDEX = true;
     BACKGROUND_EVICTION_SCAN = true;
     PUBLISH_TO_ARCHIVE_DELAY = std::chrono::seconds{0};
+    MAX_CHECKPOINTS_PER_PUBLISH = 4;
     // automatic maintenance settings:
     // short and prime with 1 hour which will cause automatic maintenance to
     // rarely conflict with any other scheduled tasks on a machine (that tend to
@@ -207,12 +208,17 @@ Config::Config() : NODE_SEED(SecretKey::random())
                                Herder::EXP_LEDGER_TIMESPAN_SECONDS.count(),
                            CLOSETIME_DRIFT_LIMIT);
     METADATA_OUTPUT_STREAM = "";
+    METADATA_OUTPUT_STREAM_QUEUE_SIZE = 0;
+    METADATA_OUTPUT_STREAM_SPILL = false;
+    METADATA_OUTPUT_RING_BUFFER_SIZE_MB = 256;
+    METADATA_OUTPUT_ENTRY_FILTER = "";
 
     // Store at least 1 checkpoint plus a buffer worth of debug meta
     METADATA_DEBUG_LEDGERS = 100;
 
     LOG_FILE_PATH = "stellar-core-{datetime:%Y-%m-%d_%H-%M-%S}.log";
     BUCKET_DIR_PATH = "buckets";
+    LOCAL_HISTORY_CACHE_PATH = "";
 
     LOG_COLOR = false;
 
@@ -278,12 +284,21 @@ Config::Config() : NODE_SEED(SecretKey::random())
     // Worst case = 10 concurrent merges + 1 quorum intersection calculation.
     WORKER_THREADS = 11;
     MAX_CONCURRENT_SUBPROCESSES = 16;
+    HISTORY_FETCH_CONNECTIONS = 8;
+    HISTORY_FETCH_PIPELINE_DEPTH = 4;
     NODE_IS_VALIDATOR = false;
     QUORUM_INTERSECTION_CHECKER = true;
+    QUORUM_INTERSECTION_CHECKER_THREADS = 1;
+    INVARIANT_CHECK_THREADS = 0;
     DATABASE = SecretValue{"sqlite3://:memory:"};
+    SQLITE_CACHE_SIZE_MB = 20;
+    SQLITE_MMAP_SIZE_MB = 100;
+    SQLITE_BACKGROUND_CHECKPOINT = true;
 
     ENTRY_CACHE_SIZE = 100000;
     PREFETCH_BATCH_SIZE = 1000;
+    CONTRACT_CODE_CACHE_SIZE = 1000;
+    SOROBAN_PREFETCH_THREADS = 4;
 
     HISTOGRAM_WINDOW_SIZE = std::chrono::seconds(30);
 
@@ -554,10 +569,11 @@ Config::loadQset(std::shared_ptr<cpptoml::table> group, SCPQuorumSet& qset,
 
 void
 Config::addHistoryArchive(std::string const& name, std::string const& get,
-                          std::string const& put, std::string const& mkdir)
+                          std::string const& put, std::string const& mkdir,
+                          std::string const& url)
 {
     auto r = HISTORY.insert(std::make_pair(
-        name, HistoryArchiveConfiguration{name, get, put, mkdir}));
+        name, HistoryArchiveConfiguration{name, get, put, mkdir, url}));
     if (!r.second)
     {
         throw std::invalid_argument(
@@ -1060,6 +1076,24 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() { DISABLE_XDR_FSYNC = readBool(item); }},
                 {"METADATA_OUTPUT_STREAM",
                  [&]() { METADATA_OUTPUT_STREAM = readString(item); }},
+                {"METADATA_OUTPUT_STREAM_QUEUE_SIZE",
+                 [&]() {
+                     METADATA_OUTPUT_STREAM_QUEUE_SIZE =
+                         readInt<uint32_t>(item);
+                 }},
+                {"METADATA_OUTPUT_STREAM_SPILL",
+                 [&]() { METADATA_OUTPUT_STREAM_SPILL = readBool(item); }},
+                {"METADATA_OUTPUT_RING_BUFFER_SIZE_MB",
+                 [&]() {
+                     METADATA_OUTPUT_RING_BUFFER_SIZE_MB =
+                         readInt<uint32_t>(item, 1, 1024 * 1024);
+                 }},
+                {"METADATA_OUTPUT_EXCLUDE",
+                 [&]() {
+                     METADATA_OUTPUT_EXCLUDE = readArray<std::string>(item);
+                 }},
+                {"METADATA_OUTPUT_ENTRY_FILTER",
+                 [&]() { METADATA_OUTPUT_ENTRY_FILTER = readString(item); }},
                 {"EXPERIMENTAL_PRECAUTION_DELAY_META",
                  [&]() {
                      EXPERIMENTAL_PRECAUTION_DELAY_META = readBool(item);
@@ -1187,6 +1221,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                      PUBLISH_TO_ARCHIVE_DELAY =
                          std::chrono::seconds(readInt<uint32_t>(item));
                  }},
+                {"MAX_CHECKPOINTS_PER_PUBLISH",
+                 [&]() {
+                     MAX_CHECKPOINTS_PER_PUBLISH = readInt<uint32_t>(item, 1);
+                 }},
                 {"AUTOMATIC_MAINTENANCE_PERIOD",
                  [&]() {
                      AUTOMATIC_MAINTENANCE_PERIOD =
@@ -1206,6 +1244,8 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                 {"LOG_COLOR", [&]() { LOG_COLOR = readBool(item); }},
                 {"BUCKET_DIR_PATH",
                  [&]() { BUCKET_DIR_PATH = readString(item); }},
+                {"LOCAL_HISTORY_CACHE_PATH",
+                 [&]() { LOCAL_HISTORY_CACHE_PATH = readString(item); }},
                 {"NODE_NAMES",
                  [&]() {
                      auto names = readArray<std::string>(item);
@@ -1336,14 +1376,29 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  }},
                 {"QUERY_SNAPSHOT_LEDGERS",
                  [&]() {
-                     QUERY_SNAPSHOT_LEDGERS = readInt<uint32_t>(item, 0, 10);
+                     QUERY_SNAPSHOT_LEDGERS = readInt<uint32_t>(item, 0, 1000);
                  }},
                 {"MAX_CONCURRENT_SUBPROCESSES",
                  [&]() {
                      MAX_CONCURRENT_SUBPROCESSES = readInt<size_t>(item, 1);
                  }},
+                {"HISTORY_FETCH_CONNECTIONS",
+                 [&]() {
+                     HISTORY_FETCH_CONNECTIONS =
+                         readInt<size_t>(item, 1, 256);
+                 }},
+                {"HISTORY_FETCH_PIPELINE_DEPTH",
+                 [&]() {
+                     HISTORY_FETCH_PIPELINE_DEPTH =
+                         readInt<size_t>(item, 1, 64);
+                 }},
                 {"QUORUM_INTERSECTION_CHECKER",
                  [&]() { QUORUM_INTERSECTION_CHECKER = readBool(item); }},
+                {"QUORUM_INTERSECTION_CHECKER_THREADS",
+                 [&]() {
+                     QUORUM_INTERSECTION_CHECKER_THREADS =
+                         readInt<uint32_t>(item, 1, 256);
+                 }},
                 {"HISTORY",
                  [&]() {
                      auto hist = item.second->as_table();
@@ -1359,7 +1414,7 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                                  throw std::invalid_argument(
                                      "malformed HISTORY config block");
                              }
-                             std::string get, put, mkdir;
+                             std::string get, put, mkdir, url;
                              for (auto const& c : *tab)
                              {
                                  if (c.first == "get")
@@ -1374,6 +1429,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                                  {
                                      mkdir = c.second->as<std::string>()->get();
                                  }
+                                 else if (c.first == "url")
+                                 {
+                                     url = c.second->as<std::string>()->get();
+                                 }
                                  else
                                  {
                                      std::string err(
@@ -1384,7 +1443,8 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                                      throw std::invalid_argument(err);
                                  }
                              }
-                             addHistoryArchive(archive.first, get, put, mkdir);
+                             addHistoryArchive(archive.first, get, put, mkdir,
+                                               url);
                          }
                      }
                      else
@@ -1399,10 +1459,30 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
                  [&]() { NETWORK_PASSPHRASE = readString(item); }},
                 {"INVARIANT_CHECKS",
                  [&]() { INVARIANT_CHECKS = readArray<std::string>(item); }},
+                {"INVARIANT_CHECK_THREADS",
+                 [&]() {
+                     INVARIANT_CHECK_THREADS = readInt<uint32_t>(item, 0, 64);
+                 }},
+                {"SQLITE_CACHE_SIZE_MB",
+                 [&]() {
+                     SQLITE_CACHE_SIZE_MB = readInt<uint32_t>(item, 1);
+                 }},
+                {"SQLITE_MMAP_SIZE_MB",
+                 [&]() { SQLITE_MMAP_SIZE_MB = readInt<uint32_t>(item); }},
+                {"SQLITE_BACKGROUND_CHECKPOINT",
+                 [&]() { SQLITE_BACKGROUND_CHECKPOINT = readBool(item); }},
                 {"ENTRY_CACHE_SIZE",
                  [&]() { ENTRY_CACHE_SIZE = readInt<uint32_t>(item); }},
                 {"PREFETCH_BATCH_SIZE",
                  [&]() { PREFETCH_BATCH_SIZE = readInt<uint32_t>(item); }},
+                {"CONTRACT_CODE_CACHE_SIZE",
+                 [&]() {
+                     CONTRACT_CODE_CACHE_SIZE = readInt<uint32_t>(item);
+                 }},
+                {"SOROBAN_PREFETCH_THREADS",
+                 [&]() {
+                     SOROBAN_PREFETCH_THREADS = readInt<uint32_t>(item, 1);
+                 }},
                 {"MAXIMUM_LEDGER_CLOSETIME_DRIFT",
                  [&]() {
                      MAXIMUM_LEDGER_CLOSETIME_DRIFT = readInt<int64_t>(item, 0);
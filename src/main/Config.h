@@ -28,6 +28,8 @@ struct HistoryArchiveConfiguration
     std::string mGetCmd;
     std::string mPutCmd;
     std::string mMkdirCmd;
+    // Base URL fetched from without running `mGetCmd`, see ArchiveFetcher
+    std::string mURL{};
 };
 
 enum class ValidationThresholdLevels : int
@@ -89,7 +91,8 @@ class Config : public std::enable_shared_from_this<Config>
     void addValidatorName(std::string const& pubKeyStr,
                           std::string const& name);
     void addHistoryArchive(std::string const& name, std::string const& get,
-                           std::string const& put, std::string const& mkdir);
+                           std::string const& put, std::string const& mkdir,
+                           std::string const& url = "");
 
     std::string toString(ValidatorQuality q) const;
     ValidatorQuality parseQuality(std::string const& q) const;
@@ -265,6 +268,10 @@ class Config : public std::enable_shared_from_this<Config>
     // Timeout before publishing externalized values to archive
     std::chrono::seconds PUBLISH_TO_ARCHIVE_DELAY;
 
+    // Maximum number of queued checkpoints published together, sharing their
+    // archive state fetches, bucket compression and uploads
+    uint32_t MAX_CHECKPOINTS_PER_PUBLISH;
+
     // Config parameters that force transaction application during ledger
     // close to sleep for a certain amount of time.
     // The probability that it sleeps for
@@ -493,6 +500,29 @@ class Config : public std::enable_shared_from_this<Config>
     // in consensus, only a passive "watcher" node.
     std::string METADATA_OUTPUT_STREAM;
 
+    // Number of ledgers of meta that may be queued for METADATA_OUTPUT_STREAM
+    // while a dedicated thread writes them. 0 (the default) writes meta
+    // synchronously during ledger close. Otherwise ledger close only blocks
+    // once that many ledgers are waiting for the consumer, or never when
+    // METADATA_OUTPUT_STREAM_SPILL is set.
+    uint32_t METADATA_OUTPUT_STREAM_QUEUE_SIZE;
+
+    // When the meta queue is full, spill further ledgers to a file under the
+    // bucket directory instead of blocking ledger close.
+    bool METADATA_OUTPUT_STREAM_SPILL;
+
+    // Size in megabytes of the shared-memory ring buffer created when
+    // METADATA_OUTPUT_STREAM is "shm:<path>".
+    uint32_t METADATA_OUTPUT_RING_BUFFER_SIZE_MB;
+
+    // Parts of LedgerCloseMeta not to build, among TX_SET, ENTRY_CHANGES,
+    // CONTRACT_EVENTS, DIAGNOSTIC_EVENTS, EVICTED_ENTRIES and NETWORK_CONFIG.
+    std::vector<std::string> METADATA_OUTPUT_EXCLUDE;
+
+    // XDR query over LedgerEntry (see util/xdrquery) selecting the entries
+    // whose changes are kept in LedgerCloseMeta. Empty keeps all of them.
+    std::string METADATA_OUTPUT_ENTRY_FILTER;
+
     // Number of ledgers worth of transaction metadata to preserve on disk for
     // debugging purposes. These records are automatically maintained and
     // rotated during processing, and are helpful for recovery in case of a
@@ -540,6 +570,11 @@ class Config : public std::enable_shared_from_this<Config>
     bool LOG_COLOR;
     std::string BUCKET_DIR_PATH;
 
+    // Directory where checkpoint files downloaded from history archives are
+    // kept decompressed, to be reused by later catchups. Empty (the default)
+    // disables the cache.
+    std::string LOCAL_HISTORY_CACHE_PATH;
+
     // Ledger protocol version for testing purposes. Defaulted to
     // LEDGER_PROTOCOL_VERSION. Used in the following scenarios: 1. to specify
     // the genesis ledger version (only when USE_CONFIG_FOR_GENESIS is true) 2.
@@ -607,6 +642,11 @@ class Config : public std::enable_shared_from_this<Config>
     // process-management config
     size_t MAX_CONCURRENT_SUBPROCESSES;
 
+    // Connections kept open to each host serving an archive with a `url`,
+    // and requests pipelined on each of them
+    size_t HISTORY_FETCH_CONNECTIONS;
+    size_t HISTORY_FETCH_PIPELINE_DEPTH;
+
     // SCP config
     SecretKey NODE_SEED;
     bool NODE_IS_VALIDATOR;
@@ -617,9 +657,18 @@ class Config : public std::enable_shared_from_this<Config>
     // Whether to run online quorum intersection checks.
     bool QUORUM_INTERSECTION_CHECKER;
 
+    // Number of threads each quorum intersection check searches on.
+    uint32_t QUORUM_INTERSECTION_CHECKER_THREADS;
+
     // Invariants
     std::vector<std::string> INVARIANT_CHECKS;
 
+    // Number of threads checking invariants on each operation while the
+    // following operations are applied. 0 (the default) checks them
+    // synchronously after each operation. Either way, a ledger that breaks a
+    // strict invariant is never closed.
+    uint32_t INVARIANT_CHECK_THREADS;
+
     std::map<std::string, std::string> VALIDATOR_NAMES;
 
     // Information necessary to compute the weight of a validator for leader
@@ -637,6 +686,16 @@ class Config : public std::enable_shared_from_this<Config>
     // Database config
     SecretValue DATABASE;
 
+    // SQLite configuration, ignored with other databases
+    // - SQLITE_CACHE_SIZE_MB is the size of the page cache of each connection
+    // - SQLITE_MMAP_SIZE_MB is how much of the database file gets mapped in
+    //   memory
+    // - SQLITE_BACKGROUND_CHECKPOINT moves WAL checkpoints out of the commits
+    //   of the main thread into a background thread, run after each commit
+    uint32_t SQLITE_CACHE_SIZE_MB;
+    uint32_t SQLITE_MMAP_SIZE_MB;
+    bool SQLITE_BACKGROUND_CHECKPOINT;
+
     std::vector<std::string> COMMANDS;
     std::vector<std::string> REPORT_METRICS;
 
@@ -651,6 +710,14 @@ class Config : public std::enable_shared_from_this<Config>
     // the entry cache
     size_t PREFETCH_BATCH_SIZE;
 
+    // Maximum number of CONTRACT_CODE entries kept in memory across ledgers,
+    // until they are modified or evicted. 0 disables the cache.
+    size_t CONTRACT_CODE_CACHE_SIZE;
+
+    // Number of threads searching the BucketList for the Soroban entries of a
+    // ledger before it is applied. 1 searches them on the main thread.
+    uint32_t SOROBAN_PREFETCH_THREADS;
+
     // If set to true, the application will halt when an internal error is
     // encountered during applying a transaction. Otherwise, the
     // txINTERNAL_ERROR transaction is created but not applied.
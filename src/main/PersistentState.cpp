@@ -98,6 +98,22 @@ PersistentState::getState(PersistentState::Entry entry)
     return getFromDb(getStoreStateName(entry));
 }
 
+std::string
+PersistentState::getState(soci::session& sess, PersistentState::Entry entry)
+{
+    ZoneScoped;
+    std::string res;
+    auto name = getStoreStateName(entry);
+    soci::indicator ind;
+    sess << "SELECT state FROM storestate WHERE statename = :n;",
+        soci::into(res, ind), soci::use(name);
+    if (!sess.got_data() || ind != soci::i_ok)
+    {
+        res.clear();
+    }
+    return res;
+}
+
 void
 PersistentState::setState(PersistentState::Entry entry,
                           std::string const& value)
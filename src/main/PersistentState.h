@@ -9,6 +9,11 @@
 #include "xdr/Stellar-internal.h"
 #include <string>
 
+namespace soci
+{
+class session;
+}
+
 namespace stellar
 {
 
@@ -35,6 +40,8 @@ class PersistentState
     static void dropAll(Database& db);
 
     std::string getState(Entry stateName);
+    // Same as getState, on a session other than the main one
+    static std::string getState(soci::session& sess, Entry stateName);
     void setState(Entry stateName, std::string const& value);
 
     // Special methods for SCP state (multiple slots)
@@ -59,7 +66,7 @@ class PersistentState
 
     Application& mApp;
 
-    std::string getStoreStateName(Entry n, uint32 subscript = 0);
+    static std::string getStoreStateName(Entry n, uint32 subscript = 0);
     std::string getStoreStateNameForTxSet(Hash const& txSetHash);
 
     void setSCPStateForSlot(uint64 slot, std::string const& value);
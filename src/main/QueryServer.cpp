@@ -6,6 +6,7 @@
 #include "bucket/BucketListSnapshot.h"
 #include "bucket/BucketSnapshotManager.h"
 #include "ledger/LedgerTxnImpl.h"
+#include "ledger/OfferSnapshot.h"
 #include "util/Logging.h"
 #include "util/XDRStream.h" // IWYU pragma: keep
 #include <exception>
@@ -14,9 +15,31 @@
 using std::placeholders::_1;
 using std::placeholders::_2;
 using std::placeholders::_3;
+using std::placeholders::_4;
 
 namespace
 {
+// Scan results are sent to the client in chunks of about this size
+size_t const SCAN_CHUNK_SIZE = 64 * 1024;
+
+// Default and maximum number of offers getorderbook loads for each side
+size_t const ORDER_BOOK_DEFAULT_DEPTH = 20;
+size_t const ORDER_BOOK_MAX_DEPTH = 1000;
+
+// Appends t to out with the same record marking as XDROutputFileStream
+template <typename T>
+void
+appendRecord(std::string& out, T const& t)
+{
+    auto bytes = xdr::xdr_to_opaque(t);
+    uint32_t sz = static_cast<uint32_t>(bytes.size());
+    out.push_back(static_cast<char>(((sz >> 24) & 0xFF) | 0x80));
+    out.push_back(static_cast<char>((sz >> 16) & 0xFF));
+    out.push_back(static_cast<char>((sz >> 8) & 0xFF));
+    out.push_back(static_cast<char>(sz & 0xFF));
+    out.append(bytes.begin(), bytes.end());
+}
+
 template <typename T>
 std::optional<T>
 parseOptionalParam(std::map<std::string, std::vector<std::string>> const& map,
@@ -54,14 +77,23 @@ namespace stellar
 {
 QueryServer::QueryServer(const std::string& address, unsigned short port,
                          int maxClient, size_t threadPoolSize,
-                         BucketSnapshotManager& bucketSnapshotManager)
-    : mServer(address, port, maxClient, threadPoolSize)
+                         BucketSnapshotManager& bucketSnapshotManager,
+                         soci::connection_pool* offerPool)
+    : mServer(address, port, maxClient, threadPoolSize), mOfferPool(offerPool)
 {
     LOG_INFO(DEFAULT_LOG, "Listening on {}:{} for Query requests", address,
              port);
 
     mServer.add404(std::bind(&QueryServer::notFound, this, _1, _2, _3));
     addRoute("getledgerentryraw", &QueryServer::getLedgerEntryRaw);
+    addRoute("getledgerentryrawbatch", &QueryServer::getLedgerEntryRawBatch,
+             "application/octet-stream", /*decodeBody=*/false);
+    addStreamingRoute("scanledgerentries", &QueryServer::scanLedgerEntries,
+                      "application/octet-stream");
+    if (mOfferPool)
+    {
+        addRoute("getorderbook", &QueryServer::getOrderBook);
+    }
 
     auto workerPids = mServer.start();
     for (auto pid : workerPids)
@@ -89,10 +121,23 @@ QueryServer::notFound(std::string const& params, std::string const& body,
 }
 
 void
-QueryServer::addRoute(std::string const& name, HandlerRoute route)
+QueryServer::addRoute(std::string const& name, HandlerRoute route,
+                      std::string const& contentType, bool decodeBody)
 {
     mServer.addRoute(
-        name, std::bind(&QueryServer::safeRouter, this, route, _1, _2, _3));
+        name, std::bind(&QueryServer::safeRouter, this, route, _1, _2, _3),
+        contentType, decodeBody);
+}
+
+void
+QueryServer::addStreamingRoute(std::string const& name,
+                               StreamingHandlerRoute route,
+                               std::string const& contentType)
+{
+    mServer.addStreamingRoute(name,
+                              std::bind(&QueryServer::safeStreamingRouter,
+                                        this, route, _1, _2, _3, _4),
+                              contentType);
 }
 
 bool
@@ -117,6 +162,57 @@ QueryServer::safeRouter(HandlerRoute route, std::string const& params,
     return false;
 }
 
+bool
+QueryServer::safeStreamingRouter(
+    StreamingHandlerRoute route, std::string const& params,
+    std::string const& body,
+    httpThreaded::server::server::chunkWriter const& write,
+    std::string& retStr)
+{
+    try
+    {
+        ZoneNamedN(httpQueryZone, "HTTP streaming query handler", true);
+        return route(this, params, body, write, retStr);
+    }
+    catch (std::exception& e)
+    {
+        retStr = fmt::format("exception: {}", e.what());
+    }
+    catch (...)
+    {
+        retStr = R"({"exception": "generic"})";
+    }
+
+    // Return error
+    return false;
+}
+
+bool
+QueryServer::loadEntries(std::vector<LedgerKey> const& keys,
+                         std::optional<uint32_t> snapshotLedger,
+                         std::vector<LedgerEntry>& entries, uint32_t& ledgerSeq)
+{
+    ZoneScoped;
+    auto& bl = *mBucketListSnapshots.at(std::this_thread::get_id());
+    LedgerKeySet orderedKeys(keys.begin(), keys.end());
+
+    // If a snapshot ledger is specified, use it to get the ledger entry
+    if (snapshotLedger)
+    {
+        ledgerSeq = *snapshotLedger;
+
+        bool snapshotExists;
+        std::tie(entries, snapshotExists) =
+            bl.loadKeysFromLedger(orderedKeys, *snapshotLedger);
+        return snapshotExists;
+    }
+
+    // Otherwise default to current ledger
+    entries = bl.loadKeysWithLimits(orderedKeys, /*lkMeter=*/nullptr);
+    ledgerSeq = bl.getLedgerSeq();
+    return true;
+}
+
 bool
 QueryServer::getLedgerEntryRaw(std::string const& params,
                                std::string const& body, std::string& retStr)
@@ -132,41 +228,22 @@ QueryServer::getLedgerEntryRaw(std::string const& params,
 
     if (!keys.empty())
     {
-        auto& bl = *mBucketListSnapshots.at(std::this_thread::get_id());
-
-        LedgerKeySet orderedKeys;
-        for (auto const& key : keys)
+        std::vector<LedgerKey> ledgerKeys(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
         {
-            LedgerKey k;
-            fromOpaqueBase64(k, key);
-            orderedKeys.emplace(k);
+            fromOpaqueBase64(ledgerKeys[i], keys[i]);
         }
 
         std::vector<LedgerEntry> loadedKeys;
+        uint32_t ledgerSeq;
 
-        // If a snapshot ledger is specified, use it to get the ledger entry
-        if (snapshotLedger)
+        // Return 404 if ledgerSeq not found
+        if (!loadEntries(ledgerKeys, snapshotLedger, loadedKeys, ledgerSeq))
         {
-            root["ledgerSeq"] = *snapshotLedger;
-
-            bool snapshotExists;
-            std::tie(loadedKeys, snapshotExists) =
-                bl.loadKeysFromLedger(orderedKeys, *snapshotLedger);
-
-            // Return 404 if ledgerSeq not found
-            if (!snapshotExists)
-            {
-                retStr = "LedgerSeq not found";
-                return false;
-            }
-        }
-        // Otherwise default to current ledger
-        else
-        {
-            loadedKeys =
-                bl.loadKeysWithLimits(orderedKeys, /*lkMeter=*/nullptr);
-            root["ledgerSeq"] = bl.getLedgerSeq();
+            retStr = "LedgerSeq not found";
+            return false;
         }
+        root["ledgerSeq"] = ledgerSeq;
 
         for (auto const& le : loadedKeys)
         {
@@ -184,4 +261,199 @@ QueryServer::getLedgerEntryRaw(std::string const& params,
     retStr = Json::FastWriter().write(root);
     return true;
 }
-}
\ No newline at end of file
+
+bool
+QueryServer::getLedgerEntryRawBatch(std::string const& params,
+                                    std::string const& body,
+                                    std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(params, paramMap);
+    auto snapshotLedger = parseOptionalParam<uint32_t>(paramMap, "ledgerSeq");
+
+    xdr::xvector<LedgerKey> keys;
+    xdr::xdr_get g(body.data(), body.data() + body.size());
+    xdr::xdr_argpack_archive(g, keys);
+    g.done();
+    if (keys.empty())
+    {
+        throw std::invalid_argument(
+            "Must specify ledger keys in POST body as XDR LedgerKey<>");
+    }
+
+    std::vector<LedgerEntry> loadedKeys;
+    uint32_t ledgerSeq;
+    if (!loadEntries(keys, snapshotLedger, loadedKeys, ledgerSeq))
+    {
+        retStr = "LedgerSeq not found";
+        return false;
+    }
+
+    xdr::xvector<LedgerEntry> entries(
+        std::make_move_iterator(loadedKeys.begin()),
+        std::make_move_iterator(loadedKeys.end()));
+    auto bytes = xdr::xdr_to_opaque(ledgerSeq, entries);
+    retStr.assign(bytes.begin(), bytes.end());
+    return true;
+}
+
+bool
+QueryServer::scanLedgerEntries(
+    std::string const& params, std::string const& body,
+    httpThreaded::server::server::chunkWriter const& write,
+    std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(body, paramMap);
+
+    auto account = parseOptionalParam<std::string>(paramMap, "account");
+    auto contract = parseOptionalParam<std::string>(paramMap, "contract");
+    auto limit = parseOptionalParam<uint64_t>(paramMap, "limit");
+    auto snapshotLedger = parseOptionalParam<uint32_t>(paramMap, "ledgerSeq");
+
+    // Keys of each range share a prefix, the smallest key of the range has
+    // the smallest value for all remaining fields
+    LedgerKey lowerBound;
+    std::function<bool(LedgerKey const&)> inRange;
+    if (account && !contract)
+    {
+        lowerBound.type(TRUSTLINE);
+        fromOpaqueBase64(lowerBound.trustLine().accountID, *account);
+        inRange = [accountID = lowerBound.trustLine().accountID](
+                      LedgerKey const& k) {
+            return k.type() == TRUSTLINE &&
+                   k.trustLine().accountID == accountID;
+        };
+    }
+    else if (contract && !account)
+    {
+        lowerBound.type(CONTRACT_DATA);
+        fromOpaqueBase64(lowerBound.contractData().contract, *contract);
+        lowerBound.contractData().durability = TEMPORARY;
+        inRange = [address = lowerBound.contractData().contract](
+                      LedgerKey const& k) {
+            return k.type() == CONTRACT_DATA &&
+                   k.contractData().contract == address;
+        };
+    }
+    else
+    {
+        throw std::invalid_argument(
+            "Must specify exactly one of account=<AccountID in base64 XDR "
+            "format> or contract=<SCAddress in base64 XDR format>");
+    }
+
+    if (limit && *limit == 0)
+    {
+        throw std::invalid_argument("limit must be positive");
+    }
+
+    auto& bl = *mBucketListSnapshots.at(std::this_thread::get_id());
+
+    // The first record is the ledger of the snapshot, which is only known
+    // once the scan has started
+    std::string out;
+    bool started = false;
+    auto start = [&]() {
+        if (!started)
+        {
+            appendRecord(out, snapshotLedger.value_or(bl.getLedgerSeq()));
+            started = true;
+        }
+    };
+
+    uint64_t count = 0;
+    auto sendEntry = [&](LedgerEntry const& le) {
+        start();
+        appendRecord(out, le);
+        if (out.size() >= SCAN_CHUNK_SIZE)
+        {
+            write(out);
+            out.clear();
+        }
+        return limit && ++count >= *limit;
+    };
+
+    if (!bl.scanKeyRange(lowerBound, inRange, sendEntry, snapshotLedger))
+    {
+        retStr = "LedgerSeq not found";
+        return false;
+    }
+
+    // An empty record marks the end of the results, so that clients can tell
+    // complete results from interrupted ones
+    start();
+    out.append("\x80\0\0\0", 4);
+    write(out);
+    return true;
+}
+
+bool
+QueryServer::getOrderBook(std::string const& params, std::string const& body,
+                          std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::vector<std::string>> paramMap;
+    httpThreaded::server::server::parsePostParams(body, paramMap);
+
+    auto sellingStr = parseOptionalParam<std::string>(paramMap, "selling");
+    auto buyingStr = parseOptionalParam<std::string>(paramMap, "buying");
+    auto depth = parseOptionalParam<size_t>(paramMap, "depth")
+                     .value_or(ORDER_BOOK_DEFAULT_DEPTH);
+    if (!sellingStr || !buyingStr)
+    {
+        throw std::invalid_argument(
+            "Must specify selling=<Asset in base64 XDR format> and "
+            "buying=<Asset in base64 XDR format>");
+    }
+    if (depth == 0 || depth > ORDER_BOOK_MAX_DEPTH)
+    {
+        throw std::invalid_argument(fmt::format(
+            FMT_STRING("depth must be between 1 and {}"), ORDER_BOOK_MAX_DEPTH));
+    }
+
+    Asset selling, buying;
+    fromOpaqueBase64(selling, *sellingStr);
+    fromOpaqueBase64(buying, *buyingStr);
+    if (selling == buying)
+    {
+        throw std::invalid_argument("selling and buying must differ");
+    }
+
+    // Aggregates consecutive offers at the same price, best first
+    auto levels = [](std::vector<LedgerEntry> const& offers) {
+        Json::Value res(Json::arrayValue);
+        Price last{0, 1};
+        for (auto const& le : offers)
+        {
+            auto const& oe = le.data.offer();
+            if (res.empty() ||
+                int64_t(oe.price.n) * last.d != int64_t(last.n) * oe.price.d)
+            {
+                Json::Value level;
+                level["n"] = oe.price.n;
+                level["d"] = oe.price.d;
+                level["amount"] = Json::Int64(0);
+                level["offers"] = 0;
+                res.append(level);
+                last = oe.price;
+            }
+            auto& level = res[res.size() - 1];
+            level["amount"] = Json::Int64(level["amount"].asInt64() + oe.amount);
+            level["offers"] = level["offers"].asInt() + 1;
+        }
+        return res;
+    };
+
+    OfferSnapshot snapshot(*mOfferPool);
+    Json::Value root;
+    root["ledgerSeq"] = snapshot.getLedgerSeq();
+    // Asks sell the selling asset, bids sell the buying asset
+    root["asks"] = levels(snapshot.loadBestOffers(buying, selling, depth));
+    root["bids"] = levels(snapshot.loadBestOffers(selling, buying, depth));
+    retStr = Json::FastWriter().write(root);
+    return true;
+}
+}
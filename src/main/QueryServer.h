@@ -6,11 +6,20 @@
 
 #include "lib/httpthreaded/server.hpp"
 
+#include "xdr/Stellar-ledger-entries.h"
+
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
+
+namespace soci
+{
+class connection_pool;
+}
 
 namespace stellar
 {
@@ -23,28 +32,73 @@ class QueryServer
     using HandlerRoute = std::function<bool(QueryServer*, std::string const&,
                                             std::string const&, std::string&)>;
 
+    using StreamingHandlerRoute = std::function<bool(
+        QueryServer*, std::string const&, std::string const&,
+        httpThreaded::server::server::chunkWriter const&, std::string&)>;
+
     httpThreaded::server::server mServer;
 
     std::unordered_map<std::thread::id,
                        std::shared_ptr<SearchableBucketListSnapshot>>
         mBucketListSnapshots;
 
+    // Pool of the database sessions offer queries run on, if any
+    soci::connection_pool* const mOfferPool;
+
     bool safeRouter(HandlerRoute route, std::string const& params,
                     std::string const& body, std::string& retStr);
 
     bool notFound(std::string const& params, std::string const& body,
                   std::string& retStr);
 
-    void addRoute(std::string const& name, HandlerRoute route);
+    bool safeStreamingRouter(
+        StreamingHandlerRoute route, std::string const& params,
+        std::string const& body,
+        httpThreaded::server::server::chunkWriter const& write,
+        std::string& retStr);
+
+    void addRoute(std::string const& name, HandlerRoute route,
+                  std::string const& contentType = "application/json",
+                  bool decodeBody = true);
+    void addStreamingRoute(std::string const& name,
+                           StreamingHandlerRoute route,
+                           std::string const& contentType);
+
+    // Loads the given keys from the snapshot for snapshotLedger, or the
+    // current one, and sets ledgerSeq to the ledger of the snapshot used.
+    // Returns false if no snapshot is available for snapshotLedger.
+    bool loadEntries(std::vector<LedgerKey> const& keys,
+                     std::optional<uint32_t> snapshotLedger,
+                     std::vector<LedgerEntry>& entries, uint32_t& ledgerSeq);
 
     // Returns raw LedgerKeys for the given keys from the Live BucketList. Does
     // not query other BucketLists or reason about archival.
     bool getLedgerEntryRaw(std::string const& params, std::string const& body,
                            std::string& retStr);
 
+    // Same as getLedgerEntryRaw, but takes and returns binary XDR to avoid
+    // base64 and JSON encoding for large batches of keys.
+    bool getLedgerEntryRawBatch(std::string const& params,
+                                std::string const& body, std::string& retStr);
+
+    // Streams all raw entries in a key range of the Live BucketList, either
+    // the trustlines of an account or the CONTRACT_DATA of a contract.
+    bool scanLedgerEntries(
+        std::string const& params, std::string const& body,
+        httpThreaded::server::server::chunkWriter const& write,
+        std::string& retStr);
+
+    // Returns the best offers on both sides of an order book, aggregated by
+    // price, from an OfferSnapshot of the database.
+    bool getOrderBook(std::string const& params, std::string const& body,
+                      std::string& retStr);
+
   public:
+    // Offer queries are only served if offerPool is set, and it must outlive
+    // the server.
     QueryServer(const std::string& address, unsigned short port, int maxClient,
                 size_t threadPoolSize,
-                BucketSnapshotManager& bucketSnapshotManager);
+                BucketSnapshotManager& bucketSnapshotManager,
+                soci::connection_pool* offerPool = nullptr);
 };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "crypto/Hex.h"
 #include "crypto/SecretKey.h"
 #include "crypto/StrKey.h"
+#include "history/IndexedCheckpointFile.h"
 #include "main/Config.h"
 #include "transactions/SignatureUtils.h"
 #include "transactions/TransactionBridge.h"
@@ -62,14 +63,72 @@ dumpstream(XDRInputFileStream& in, bool compact)
     }
 }
 
+template <typename T>
+void
+dumpentry(IndexedCheckpointFile const& file, uint32_t ledger, bool compact)
+{
+    T tmp;
+    cereal::JSONOutputArchive archive(
+        std::cout, compact ? cereal::JSONOutputArchive::Options::NoIndent()
+                           : cereal::JSONOutputArchive::Options::Default());
+    archive.makeArray();
+    if (file.load(ledger, tmp))
+    {
+        archive(tmp);
+    }
+}
+
+// Dumps the entry of a single ledger from a decompressed checkpoint file,
+// indexing the file instead of decoding every entry before it
 void
-dumpXdrStream(std::string const& filename, bool compact)
+dumpCheckpointEntry(std::string const& filename, std::string const& kind,
+                    uint32_t ledger, bool compact)
+{
+    if (kind == "ledger")
+    {
+        IndexedCheckpointFile file(filename,
+                                   FileType::HISTORY_FILE_TYPE_LEDGER);
+        dumpentry<LedgerHeaderHistoryEntry>(file, ledger, compact);
+    }
+    else if (kind == "transactions")
+    {
+        IndexedCheckpointFile file(filename,
+                                   FileType::HISTORY_FILE_TYPE_TRANSACTIONS);
+        dumpentry<TransactionHistoryEntry>(file, ledger, compact);
+    }
+    else if (kind == "results")
+    {
+        IndexedCheckpointFile file(filename,
+                                   FileType::HISTORY_FILE_TYPE_RESULTS);
+        dumpentry<TransactionHistoryResultEntry>(file, ledger, compact);
+    }
+    else if (kind == "scp")
+    {
+        IndexedCheckpointFile file(filename, FileType::HISTORY_FILE_TYPE_SCP);
+        dumpentry<SCPHistoryEntry>(file, ledger, compact);
+    }
+    else
+    {
+        throw std::runtime_error(
+            "a ledger can only be selected in checkpoint files");
+    }
+}
+
+void
+dumpXdrStream(std::string const& filename, bool compact,
+              std::optional<uint32_t> ledger)
 {
     std::regex rx(
         R"(.*\b(debug-tx-set|(?:(ledger|bucket|transactions|results|meta-debug|scp)-.+))\.xdr$)");
     std::smatch sm;
     if (std::regex_match(filename, sm, rx))
     {
+        if (ledger)
+        {
+            dumpCheckpointEntry(filename, sm[2], *ledger, compact);
+            return;
+        }
+
         XDRInputFileStream in;
         in.open(filename);
 
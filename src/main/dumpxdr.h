@@ -6,11 +6,13 @@
 
 #include "overlay/StellarXDR.h"
 #include <functional>
+#include <optional>
 #include <vector>
 
 namespace stellar
 {
-void dumpXdrStream(std::string const& filename, bool json);
+void dumpXdrStream(std::string const& filename, bool json,
+                   std::optional<uint32_t> ledger = std::nullopt);
 void printXdr(std::string const& filename, std::string const& filetype,
               bool base64, bool compact, bool rawMode);
 void signtxns(std::vector<TransactionEnvelope>& txenvs, std::string netId,
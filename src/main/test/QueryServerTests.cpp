@@ -0,0 +1,462 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "main/QueryServer.h"
+#include "bucket/BucketListSnapshot.h"
+#include "bucket/BucketManager.h"
+#include "bucket/BucketSnapshotManager.h"
+#include "bucket/test/BucketTestUtils.h"
+#include "ledger/LedgerManager.h"
+#include "ledger/LedgerTxnImpl.h"
+#include "ledger/test/LedgerTestUtils.h"
+#include "lib/catch.hpp"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "test/TxTests.h"
+#include "test/test.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "util/UnorderedMap.h"
+#include "util/XDRStream.h" // IWYU pragma: keep
+
+#include <atomic>
+#include <chrono>
+#include <fmt/format.h>
+#include <json/json.h>
+#include <thread>
+
+using namespace stellar;
+using namespace BucketTestUtils;
+
+namespace
+{
+// Sends a POST request to the query server, returns the status and body of
+// the reply, or status 0 if the reply is malformed. Used from client threads,
+// so this doesn't check anything itself.
+std::pair<int, std::string>
+postRequest(unsigned short port, std::string const& path,
+            std::string const& body)
+{
+    asio::io_context ctx;
+    asio::ip::tcp::socket socket(ctx);
+    asio::error_code ec;
+    socket.connect(asio::ip::tcp::endpoint(
+                       asio::ip::address::from_string("127.0.0.1"), port),
+                   ec);
+
+    auto request =
+        fmt::format("POST /{} HTTP/1.0\r\nContent-Length: {}\r\n\r\n",
+                    path, body.size());
+    request += body;
+    if (!ec)
+    {
+        asio::write(socket, asio::buffer(request), ec);
+    }
+    if (ec)
+    {
+        return {0, ""};
+    }
+
+    // The server closes the connection after each reply
+    std::string reply;
+    asio::read(socket, asio::dynamic_buffer(reply), ec);
+
+    auto statusStart = reply.find(' ');
+    auto headersEnd = reply.find("\r\n\r\n");
+    if (ec != asio::error::eof || statusStart == std::string::npos ||
+        headersEnd == std::string::npos)
+    {
+        return {0, ""};
+    }
+    auto status = std::atoi(reply.substr(statusStart + 1, 3).c_str());
+    return {status, reply.substr(headersEnd + 4)};
+}
+
+std::string
+urlEncodedBase64(std::string const& b64)
+{
+    std::string out;
+    for (auto c : b64)
+    {
+        switch (c)
+        {
+        case '+':
+            out += "%2B";
+            break;
+        case '/':
+            out += "%2F";
+            break;
+        case '=':
+            out += "%3D";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out;
+}
+
+// Splits a scanledgerentries reply into its records, checking that it is
+// complete
+std::vector<std::string>
+readRecords(std::string const& body)
+{
+    std::vector<std::string> records;
+    size_t pos = 0;
+    while (true)
+    {
+        REQUIRE(pos + 4 <= body.size());
+        auto byte = [&](size_t i) {
+            return static_cast<uint32_t>(static_cast<uint8_t>(body[pos + i]));
+        };
+        REQUIRE((byte(0) & 0x80) != 0);
+        uint32_t sz = ((byte(0) & 0x7F) << 24) | (byte(1) << 16) |
+                      (byte(2) << 8) | byte(3);
+        pos += 4;
+        if (sz == 0)
+        {
+            REQUIRE(pos == body.size());
+            return records;
+        }
+        REQUIRE(pos + sz <= body.size());
+        records.emplace_back(body.substr(pos, sz));
+        pos += sz;
+    }
+}
+
+template <typename T>
+void
+fromRecord(std::string const& record, T& t)
+{
+    xdr::opaque_vec<> bytes(record.begin(), record.end());
+    xdr::xdr_from_opaque(bytes, t);
+}
+
+void
+validateResults(UnorderedMap<LedgerKey, LedgerEntry> const& expected,
+                std::vector<LedgerEntry> const& loaded)
+{
+    REQUIRE(loaded.size() == expected.size());
+    for (auto const& le : loaded)
+    {
+        auto iter = expected.find(LedgerEntryKey(le));
+        REQUIRE(iter != expected.end());
+        REQUIRE(iter->second == le);
+    }
+}
+}
+
+TEST_CASE("query server batch and scan endpoints", "[queryserver]")
+{
+    VirtualClock clock;
+    Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_VOLATILE));
+    auto app = createTestApplication<BucketTestApplication>(clock, cfg);
+
+    auto account = LedgerTestUtils::generateValidAccountEntry().accountID;
+    auto contract = LedgerTestUtils::generateValidContractDataEntry().contract;
+
+    // Half of the entries are in the ranges to scan
+    std::vector<LedgerEntry> entries;
+    UnorderedMap<LedgerKey, LedgerEntry> allEntries;
+    UnorderedMap<LedgerKey, LedgerEntry> trustlines;
+    UnorderedMap<LedgerKey, LedgerEntry> contractData;
+    for (int i = 0; i < 20; ++i)
+    {
+        LedgerEntry trustline;
+        trustline.data.type(TRUSTLINE);
+        trustline.data.trustLine() =
+            LedgerTestUtils::generateValidTrustLineEntry();
+
+        LedgerEntry data;
+        data.data.type(CONTRACT_DATA);
+        data.data.contractData() =
+            LedgerTestUtils::generateValidContractDataEntry();
+
+        if (i % 2 == 0)
+        {
+            trustline.data.trustLine().accountID = account;
+            trustlines.emplace(LedgerEntryKey(trustline), trustline);
+            data.data.contractData().contract = contract;
+            contractData.emplace(LedgerEntryKey(data), data);
+        }
+        for (auto const& le : {trustline, data})
+        {
+            entries.emplace_back(le);
+            allEntries.emplace(LedgerEntryKey(le), le);
+        }
+    }
+    app->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
+        {}, entries, {});
+    closeLedger(*app);
+
+    auto& snapshotManager = app->getBucketManager().getBucketSnapshotManager();
+    auto ledgerSeq =
+        snapshotManager.copySearchableBucketListSnapshot()->getLedgerSeq();
+
+    // Test apps run standalone, so the peer port is free
+    auto port = cfg.PEER_PORT;
+    QueryServer server("127.0.0.1", port, 16, 2, snapshotManager);
+
+    SECTION("getledgerentryrawbatch")
+    {
+        xdr::xvector<LedgerKey> keys;
+        for (auto const& le : entries)
+        {
+            keys.emplace_back(LedgerEntryKey(le));
+        }
+
+        // Keys that don't exist are omitted from the reply
+        keys.emplace_back(LedgerEntryKey(
+            LedgerTestUtils::generateValidLedgerEntryOfType(TRUSTLINE)));
+
+        auto keysXDR = xdr::xdr_to_opaque(keys);
+        std::string body(keysXDR.begin(), keysXDR.end());
+
+        auto [status, reply] =
+            postRequest(port, "getledgerentryrawbatch", body);
+        REQUIRE(status == 200);
+
+        uint32_t replySeq;
+        xdr::xvector<LedgerEntry> loaded;
+        xdr::opaque_vec<> replyXDR(reply.begin(), reply.end());
+        xdr::xdr_from_opaque(replyXDR, replySeq, loaded);
+        REQUIRE(replySeq == ledgerSeq);
+        validateResults(allEntries, loaded);
+
+        SECTION("missing snapshot")
+        {
+            auto [status, reply] = postRequest(
+                port,
+                fmt::format("getledgerentryrawbatch?ledgerSeq={}",
+                            ledgerSeq + 100),
+                body);
+            REQUIRE(status == 404);
+        }
+
+        SECTION("malformed keys")
+        {
+            auto [status, reply] = postRequest(
+                port, "getledgerentryrawbatch", body.substr(0, 12));
+            REQUIRE(status == 404);
+        }
+    }
+
+    SECTION("scanledgerentries")
+    {
+        auto scan = [&](std::string const& query) {
+            auto [status, reply] =
+                postRequest(port, "scanledgerentries", query);
+            REQUIRE(status == 200);
+
+            auto records = readRecords(reply);
+            REQUIRE(!records.empty());
+            uint32_t replySeq;
+            fromRecord(records.front(), replySeq);
+            REQUIRE(replySeq == ledgerSeq);
+
+            std::vector<LedgerEntry> loaded(records.size() - 1);
+            for (size_t i = 1; i < records.size(); ++i)
+            {
+                fromRecord(records[i], loaded[i - 1]);
+            }
+            return loaded;
+        };
+
+        auto accountQuery =
+            "account=" + urlEncodedBase64(toOpaqueBase64(account));
+        auto contractQuery =
+            "contract=" + urlEncodedBase64(toOpaqueBase64(contract));
+
+        validateResults(trustlines, scan(accountQuery));
+        validateResults(contractData, scan(contractQuery));
+        REQUIRE(scan(accountQuery + "&limit=3").size() == 3);
+
+        SECTION("invalid queries")
+        {
+            for (auto const& query :
+                 {std::string("limit=3"), accountQuery + "&" + contractQuery,
+                  accountQuery + "&limit=0",
+                  accountQuery + fmt::format("&ledgerSeq={}", ledgerSeq + 100)})
+            {
+                auto [status, reply] =
+                    postRequest(port, "scanledgerentries", query);
+                REQUIRE(status == 404);
+            }
+        }
+    }
+}
+
+TEST_CASE("query server order book", "[queryserver]")
+{
+    // Offers are queried from a pool, which needs an on-disk database
+    VirtualClock clock;
+    Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_PERSISTENT));
+    auto app = createTestApplication(clock, cfg);
+
+    auto native = txtest::makeNativeAsset();
+    auto cur1 = txtest::makeAsset(txtest::getAccount("issuer"), "CUR1");
+
+    // Asks at 1/2 and 1/1, bids at 3/1
+    auto addOffer = [&](AbstractLedgerTxn& ltx, Asset const& selling,
+                        Asset const& buying, Price const& price,
+                        int64_t amount) {
+        LedgerEntry le;
+        le.data.type(OFFER);
+        le.data.offer() = LedgerTestUtils::generateValidOfferEntry();
+        le.data.offer().selling = selling;
+        le.data.offer().buying = buying;
+        le.data.offer().price = price;
+        le.data.offer().amount = amount;
+        ltx.createWithoutLoading(le);
+    };
+    {
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        addOffer(ltx, native, cur1, Price{1, 2}, 10);
+        addOffer(ltx, native, cur1, Price{2, 4}, 20);
+        addOffer(ltx, native, cur1, Price{1, 1}, 30);
+        addOffer(ltx, cur1, native, Price{3, 1}, 40);
+        ltx.commit();
+    }
+
+    auto port = cfg.PEER_PORT;
+    QueryServer server("127.0.0.1", port, 16, 2,
+                       app->getBucketManager().getBucketSnapshotManager(),
+                       &app->getDatabase().getPool());
+
+    auto body = fmt::format("selling={}&buying={}",
+                            urlEncodedBase64(toOpaqueBase64(native)),
+                            urlEncodedBase64(toOpaqueBase64(cur1)));
+    auto [status, reply] = postRequest(port, "getorderbook", body);
+    REQUIRE(status == 200);
+
+    Json::Value root;
+    REQUIRE(Json::Reader().parse(reply, root));
+    REQUIRE(root["ledgerSeq"].asUInt() ==
+            app->getLedgerManager().getLastClosedLedgerNum());
+
+    auto const& asks = root["asks"];
+    REQUIRE(asks.size() == 2);
+    REQUIRE(asks[0]["amount"].asInt64() == 30);
+    REQUIRE(asks[0]["offers"].asInt() == 2);
+    REQUIRE(asks[1]["n"].asInt() == 1);
+    REQUIRE(asks[1]["d"].asInt() == 1);
+    REQUIRE(asks[1]["amount"].asInt64() == 30);
+
+    auto const& bids = root["bids"];
+    REQUIRE(bids.size() == 1);
+    REQUIRE(bids[0]["n"].asInt() == 3);
+    REQUIRE(bids[0]["amount"].asInt64() == 40);
+
+    SECTION("depth")
+    {
+        auto [status, reply] =
+            postRequest(port, "getorderbook", body + "&depth=1");
+        REQUIRE(status == 200);
+        REQUIRE(Json::Reader().parse(reply, root));
+        REQUIRE(root["asks"].size() == 1);
+        REQUIRE(root["asks"][0]["offers"].asInt() == 1);
+    }
+
+    SECTION("missing asset")
+    {
+        auto [status, reply] = postRequest(
+            port, "getorderbook",
+            "selling=" + urlEncodedBase64(toOpaqueBase64(native)));
+        REQUIRE(status == 404);
+    }
+}
+
+TEST_CASE("query server load benchmark", "[queryserver][bench][!hide]")
+{
+    size_t const numEntries = 100000;
+    size_t const keysPerRequest = 100;
+    size_t const numClients = 8;
+    auto const duration = std::chrono::seconds(10);
+
+    VirtualClock clock;
+    Config cfg(getTestConfig(0, Config::TESTDB_BUCKET_DB_VOLATILE));
+    auto app = createTestApplication<BucketTestApplication>(clock, cfg);
+
+    std::vector<LedgerKey> keys;
+    for (size_t i = 0; i < numEntries; i += 1000)
+    {
+        auto entries =
+            LedgerTestUtils::generateValidLedgerEntriesWithExclusions(
+                {CONFIG_SETTING}, 1000);
+        for (auto const& le : entries)
+        {
+            keys.emplace_back(LedgerEntryKey(le));
+        }
+        app->getLedgerManager().setNextLedgerEntryBatchForBucketTesting(
+            {}, entries, {});
+        closeLedger(*app);
+    }
+
+    auto port = cfg.PEER_PORT;
+    QueryServer server("127.0.0.1", port, 128,
+                       cfg.QUERY_THREAD_POOL_SIZE,
+                       app->getBucketManager().getBucketSnapshotManager());
+
+    // Each client sends requests for random batches of keys back to back
+    auto run = [&](std::string const& name,
+                   std::function<std::pair<std::string, std::string>(
+                       std::vector<LedgerKey> const&)>
+                       makeRequest) {
+        std::atomic<size_t> requests{0};
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> clients;
+        for (size_t c = 0; c < numClients; ++c)
+        {
+            // Build requests up front so that only the server is measured
+            std::vector<std::pair<std::string, std::string>> batches;
+            for (size_t b = 0; b < 16; ++b)
+            {
+                std::vector<LedgerKey> batch;
+                for (size_t k = 0; k < keysPerRequest; ++k)
+                {
+                    batch.emplace_back(keys.at(rand_uniform<size_t>(
+                        0, keys.size() - 1)));
+                }
+                batches.emplace_back(makeRequest(batch));
+            }
+
+            clients.emplace_back([&, batches = std::move(batches)]() {
+                for (size_t i = 0; !stop; ++i)
+                {
+                    auto const& [path, body] = batches[i % batches.size()];
+                    postRequest(port, path, body);
+                    ++requests;
+                }
+            });
+        }
+
+        std::this_thread::sleep_for(duration);
+        stop = true;
+        for (auto& t : clients)
+        {
+            t.join();
+        }
+
+        auto rps = static_cast<double>(requests) / duration.count();
+        CLOG_INFO(Bucket, "{}: {:.0f} requests/s, {:.0f} keys/s", name, rps,
+                  rps * keysPerRequest);
+    };
+
+    run("getledgerentryraw", [](std::vector<LedgerKey> const& batch) {
+        std::string body;
+        for (auto const& k : batch)
+        {
+            body += "key=" + urlEncodedBase64(toOpaqueBase64(k)) + "&";
+        }
+        body.pop_back();
+        return std::make_pair(std::string("getledgerentryraw"), body);
+    });
+
+    run("getledgerentryrawbatch", [](std::vector<LedgerKey> const& batch) {
+        xdr::xvector<LedgerKey> xkeys(batch.begin(), batch.end());
+        auto bytes = xdr::xdr_to_opaque(xkeys);
+        return std::make_pair(std::string("getledgerentryrawbatch"),
+                              std::string(bytes.begin(), bytes.end()));
+    });
+}
@@ -7,6 +7,8 @@
 #include "ledger/LedgerManager.h"
 #include "lib/catch.hpp"
 #include "main/Config.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "scp/QuorumSetUtils.h"
 #include "simulation/ApplyLoad.h"
 #include "simulation/LoadGenerator.h"
@@ -868,6 +870,13 @@ TEST_CASE("apply load", "[loadgen][applyload]")
     auto& cpuInsRatioExclVm = app->getMetrics().NewHistogram(
         {"soroban", "host-fn-op", "invoke-time-fsecs-cpu-insn-ratio-excl-vm"});
     cpuInsRatioExclVm.Clear();
+
+    auto& codeCacheHit = app->getMetrics().NewMeter(
+        {"ledger", "contract-code-cache", "hit"}, "entry");
+    auto& codeCacheMiss = app->getMetrics().NewMeter(
+        {"ledger", "contract-code-cache", "miss"}, "entry");
+    auto codeCacheHitBefore = codeCacheHit.count();
+    auto codeCacheMissBefore = codeCacheMiss.count();
     for (size_t i = 0; i < 100; ++i)
     {
         app->getBucketManager().getBucketList().resolveAllFutures();
@@ -907,4 +916,12 @@ TEST_CASE("apply load", "[loadgen][applyload]")
               al.getReadEntryUtilization().mean() / 1000.0);
     CLOG_INFO(Perf, "Write entry utilization {}%",
               al.getWriteEntryUtilization().mean() / 1000.0);
+
+    // The same contracts are invoked every ledger, so their code is only
+    // loaded again when the cache evicts it
+    auto codeCacheHits = codeCacheHit.count() - codeCacheHitBefore;
+    auto codeCacheMisses = codeCacheMiss.count() - codeCacheMissBefore;
+    CLOG_INFO(Perf, "Contract code cache per ledger: {} hits, {} misses",
+              codeCacheHits / 100.0, codeCacheMisses / 100.0);
+    REQUIRE(codeCacheHits > codeCacheMisses);
 }
@@ -123,8 +123,9 @@ BucketListDepthModifier::~BucketListDepthModifier()
 }
 }
 
-TestInvariantManager::TestInvariantManager(medida::MetricsRegistry& registry)
-    : InvariantManagerImpl(registry)
+TestInvariantManager::TestInvariantManager(medida::MetricsRegistry& registry,
+                                           uint32_t operationCheckThreads)
+    : InvariantManagerImpl(registry, operationCheckThreads)
 {
 }
 
@@ -144,7 +145,8 @@ TestApplication::TestApplication(VirtualClock& clock, Config const& cfg)
 std::unique_ptr<InvariantManager>
 TestApplication::createInvariantManager()
 {
-    return std::make_unique<TestInvariantManager>(getMetrics());
+    return std::make_unique<TestInvariantManager>(
+        getMetrics(), getConfig().INVARIANT_CHECK_THREADS);
 }
 
 TimePoint
@@ -51,7 +51,8 @@ testBucketMetadata(uint32_t protocolVersion)
 class TestInvariantManager : public InvariantManagerImpl
 {
   public:
-    TestInvariantManager(medida::MetricsRegistry& registry);
+    TestInvariantManager(medida::MetricsRegistry& registry,
+                         uint32_t operationCheckThreads = 0);
 
   private:
     virtual void
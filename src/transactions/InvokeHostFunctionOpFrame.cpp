@@ -41,18 +41,16 @@ isCodeKey(LedgerKey const& lk)
     return lk.type() == CONTRACT_CODE;
 }
 
-template <typename T>
-std::vector<uint8_t>
-toVec(T const& t)
-{
-    return std::vector<uint8_t>(xdr::xdr_to_opaque(t));
-}
-
 template <typename T>
 CxxBuf
 toCxxBuf(T const& t)
 {
-    return CxxBuf{std::make_unique<std::vector<uint8_t>>(toVec(t))};
+    // Encode straight into the buffer passed to the host, without going
+    // through a temporary opaque_vec
+    auto buf = std::make_unique<std::vector<uint8_t>>(xdr::xdr_size(t));
+    xdr::xdr_put p(buf->data(), buf->data() + buf->size());
+    xdr::xdr_argpack_archive(p, t);
+    return CxxBuf{std::move(buf)};
 }
 
 CxxLedgerInfo
@@ -126,6 +124,8 @@ struct HostFunctionMetrics
     uint32_t mEmitEvent{0};
     uint32_t mEmitEventByte{0};
 
+    uint32_t mUnchangedWriteEntry{0};
+
     // host runtime metrics
     uint64_t mCpuInsn{0};
     uint64_t mMemByte{0};
@@ -201,6 +201,8 @@ struct HostFunctionMetrics
         mMetrics.mHostFnOpEmitEvent.Mark(mEmitEvent);
         mMetrics.mHostFnOpEmitEventByte.Mark(mEmitEventByte);
 
+        mMetrics.mHostFnOpUnchangedWriteEntry.Mark(mUnchangedWriteEntry);
+
         mMetrics.mHostFnOpCpuInsn.Mark(mCpuInsn);
         mMetrics.mHostFnOpMemByte.Mark(mMemByte);
         mMetrics.mHostFnOpInvokeTimeNsecs.Update(
@@ -335,6 +337,8 @@ InvokeHostFunctionOpFrame::doApply(
     // Get the entries for the footprint
     rust::Vec<CxxBuf> ledgerEntryCxxBufs;
     rust::Vec<CxxBuf> ttlEntryCxxBufs;
+    // Key of each entry of ledgerEntryCxxBufs
+    std::vector<LedgerKey const*> ledgerEntryKeys;
 
     auto const& resources = mParentTx.sorobanResources();
     auto const& footprint = resources.footprint;
@@ -343,10 +347,11 @@ InvokeHostFunctionOpFrame::doApply(
 
     ledgerEntryCxxBufs.reserve(footprintLength);
     ttlEntryCxxBufs.reserve(footprintLength);
+    ledgerEntryKeys.reserve(footprintLength);
 
-    auto addReads = [&ledgerEntryCxxBufs, &ttlEntryCxxBufs, &ltx, &metrics,
-                     &resources, &sorobanConfig, &appConfig, sorobanData, &res,
-                     this](auto const& keys) -> bool {
+    auto addReads = [&ledgerEntryCxxBufs, &ttlEntryCxxBufs, &ledgerEntryKeys,
+                     &ltx, &metrics, &resources, &sorobanConfig, &appConfig,
+                     sorobanData, &res, this](auto const& keys) -> bool {
         for (auto const& lk : keys)
         {
             uint32_t keySize = static_cast<uint32_t>(xdr::xdr_size(lk));
@@ -421,6 +426,7 @@ InvokeHostFunctionOpFrame::doApply(
 
                     ledgerEntryCxxBufs.emplace_back(std::move(leBuf));
                     ttlEntryCxxBufs.emplace_back(std::move(ttlBuf));
+                    ledgerEntryKeys.emplace_back(&lk);
                 }
                 else if (isSorobanEntry(lk))
                 {
@@ -460,6 +466,8 @@ InvokeHostFunctionOpFrame::doApply(
         return false;
     }
 
+    // Entries of ledgerEntryCxxBufs from here on are read-write
+    size_t const readWriteBegin = ledgerEntryCxxBufs.size();
     if (!addReads(footprint.readWrite))
     {
         // Error code set in addReads
@@ -542,22 +550,49 @@ InvokeHostFunctionOpFrame::doApply(
         return false;
     }
 
+    // The host returns every read-write entry that it didn't delete, even
+    // those it left unchanged, which come back with the bytes they were passed
+    // in with. Returns the key of the read-write entry encoded as buf, if any,
+    // so that unchanged entries don't need to be decoded.
+    auto findUnchangedEntry = [&](RustBuf const& buf) -> LedgerKey const* {
+        for (size_t i = readWriteBegin; i < ledgerEntryCxxBufs.size(); ++i)
+        {
+            auto const& in = *ledgerEntryCxxBufs[i].data;
+            if (in.size() == buf.data.size() &&
+                std::equal(in.begin(), in.end(), buf.data.begin()))
+            {
+                return ledgerEntryKeys[i];
+            }
+        }
+        return nullptr;
+    };
+
     // Create or update every entry returned.
     UnorderedSet<LedgerKey> createdAndModifiedKeys;
     UnorderedSet<LedgerKey> createdKeys;
     for (auto const& buf : out.modified_ledger_entries)
     {
-        LedgerEntry le;
-        xdr::xdr_from_opaque(buf.data, le);
-        if (!validateContractLedgerEntry(LedgerEntryKey(le), buf.data.size(),
-                                         sorobanConfig, appConfig, mParentTx,
-                                         *sorobanData))
+        std::optional<LedgerEntry> le;
+        LedgerKey lk;
+        if (auto unchangedKey = findUnchangedEntry(buf))
+        {
+            lk = *unchangedKey;
+            metrics.mUnchangedWriteEntry++;
+        }
+        else
+        {
+            le.emplace();
+            xdr::xdr_from_opaque(buf.data, *le);
+            lk = LedgerEntryKey(*le);
+        }
+
+        if (!validateContractLedgerEntry(lk, buf.data.size(), sorobanConfig,
+                                         appConfig, mParentTx, *sorobanData))
         {
             innerResult(res).code(INVOKE_HOST_FUNCTION_RESOURCE_LIMIT_EXCEEDED);
             return false;
         }
 
-        auto lk = LedgerEntryKey(le);
         createdAndModifiedKeys.insert(lk);
 
         uint32_t keySize = static_cast<uint32_t>(xdr::xdr_size(lk));
@@ -581,14 +616,20 @@ InvokeHostFunctionOpFrame::doApply(
             }
         }
 
+        // Unchanged entries are still loaded, so that they are written with
+        // the ledger like any other entry returned
         auto ltxe = ltx.load(lk);
         if (ltxe)
         {
-            ltxe.current() = le;
+            if (le)
+            {
+                ltxe.current() = *le;
+            }
         }
         else
         {
-            ltx.create(le);
+            releaseAssertOrThrow(le);
+            ltx.create(*le);
             createdKeys.insert(lk);
         }
     }
@@ -1631,7 +1631,14 @@ TransactionFrame::applyOperations(SignatureChecker& signatureChecker,
                 // The operation meta will be empty if the transaction
                 // doesn't succeed so we may as well not do any work in that
                 // case
-                operationMetas.emplace_back(ltxOp.getChanges());
+                if (outerMeta.recordsEntryChanges())
+                {
+                    operationMetas.emplace_back(ltxOp.getChanges());
+                }
+                else
+                {
+                    operationMetas.emplace_back();
+                }
             }
 
             if (txRes ||
@@ -1819,7 +1826,10 @@ TransactionFrame::apply(AppConnector& app, AbstractLedgerTxn& ltx,
         bool signaturesValid =
             processSignatures(cv, signatureChecker, ltxTx, *txResult);
 
-        meta.pushTxChangesBefore(ltxTx.getChanges());
+        if (meta.recordsEntryChanges())
+        {
+            meta.pushTxChangesBefore(ltxTx.getChanges());
+        }
         ltxTx.commit();
 
         bool ok = signaturesValid && cv == ValidationType::kMaybeValid;
@@ -1899,7 +1909,10 @@ TransactionFrame::processRefund(AppConnector& app, AbstractLedgerTxn& ltxOuter,
     // transaction success).
     LedgerTxn ltx(ltxOuter);
     int64_t refund = refundSorobanFee(ltx, feeSource, txResult);
-    meta.pushTxChangesAfter(ltx.getChanges());
+    if (meta.recordsEntryChanges())
+    {
+        meta.pushTxChangesAfter(ltx.getChanges());
+    }
     ltx.commit();
 
     return refund;
@@ -4,6 +4,7 @@
 
 #include "transactions/TransactionMetaFrame.h"
 #include "crypto/SHA.h"
+#include "ledger/MetaFilter.h"
 #include "transactions/TransactionFrameBase.h"
 #include "util/GlobalChecks.h"
 #include "util/MetaUtils.h"
@@ -13,7 +14,9 @@
 
 namespace stellar
 {
-TransactionMetaFrame::TransactionMetaFrame(uint32_t protocolVersion)
+TransactionMetaFrame::TransactionMetaFrame(uint32_t protocolVersion,
+                                           MetaFilter* filter)
+    : mFilter(filter)
 {
     // The TransactionMeta v() switch can be in 4 positions 0, 1, 2, 3. We
     // do not support 0 or 1 at all -- core does not produce it anymore and we
@@ -34,6 +37,12 @@ vecAppend(xdr::xvector<T>& a, xdr::xvector<T>&& b)
     std::move(b.begin(), b.end(), std::back_inserter(a));
 }
 
+bool
+TransactionMetaFrame::recordsEntryChanges() const
+{
+    return !mFilter || mFilter->includes(MetaFilter::Section::ENTRY_CHANGES);
+}
+
 size_t
 TransactionMetaFrame::getNumChangesBefore() const
 {
@@ -79,6 +88,10 @@ TransactionMetaFrame::getChangesAfter() const
 void
 TransactionMetaFrame::pushTxChangesBefore(LedgerEntryChanges&& changes)
 {
+    if (mFilter)
+    {
+        mFilter->filterChanges(changes);
+    }
     switch (mTransactionMeta.v())
     {
     case 2:
@@ -111,6 +124,15 @@ TransactionMetaFrame::clearOperationMetas()
 void
 TransactionMetaFrame::pushOperationMetas(xdr::xvector<OperationMeta>&& opMetas)
 {
+    // Operations stay in the meta even when all of their changes are
+    // filtered out, so that they keep matching the operations of the tx
+    if (mFilter)
+    {
+        for (auto& opMeta : opMetas)
+        {
+            mFilter->filterChanges(opMeta.changes);
+        }
+    }
     switch (mTransactionMeta.v())
     {
     case 2:
@@ -141,6 +163,10 @@ TransactionMetaFrame::getNumOperations() const
 void
 TransactionMetaFrame::pushTxChangesAfter(LedgerEntryChanges&& changes)
 {
+    if (mFilter)
+    {
+        mFilter->filterChanges(changes);
+    }
     switch (mTransactionMeta.v())
     {
     case 2:
@@ -173,6 +199,10 @@ TransactionMetaFrame::clearTxChangesAfter()
 void
 TransactionMetaFrame::pushContractEvents(xdr::xvector<ContractEvent>&& events)
 {
+    if (mFilter && !mFilter->includes(MetaFilter::Section::CONTRACT_EVENTS))
+    {
+        return;
+    }
     switch (mTransactionMeta.v())
     {
     case 2:
@@ -190,6 +220,10 @@ void
 TransactionMetaFrame::pushDiagnosticEvents(
     xdr::xvector<DiagnosticEvent>&& events)
 {
+    if (mFilter && !mFilter->includes(MetaFilter::Section::DIAGNOSTIC_EVENTS))
+    {
+        return;
+    }
     switch (mTransactionMeta.v())
     {
     case 2:
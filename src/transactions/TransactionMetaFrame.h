@@ -9,12 +9,20 @@
 namespace stellar
 {
 
+class MetaFilter;
+
 // Wrapper around TransactionMeta XDR that provides mutable access to fields
-// in the proper version of meta.
+// in the proper version of meta. When given a MetaFilter, parts of the meta
+// the filter excludes are dropped as they are pushed.
 class TransactionMetaFrame
 {
   public:
-    TransactionMetaFrame(uint32_t protocolVersion);
+    TransactionMetaFrame(uint32_t protocolVersion,
+                         MetaFilter* filter = nullptr);
+
+    // False if entry changes are excluded altogether, in which case callers
+    // can skip computing them
+    bool recordsEntryChanges() const;
 
     void pushTxChangesBefore(LedgerEntryChanges&& changes);
     size_t getNumChangesBefore() const;
@@ -38,6 +46,7 @@ class TransactionMetaFrame
   private:
     TransactionMeta mTransactionMeta;
     int mVersion;
+    MetaFilter* mFilter;
 };
 
 }
@@ -1967,6 +1967,46 @@ TEST_CASE("contract storage", "[tx][soroban]")
             client.has("key2", ContractDataDurability::PERSISTENT, false)));
     }
 
+    SECTION("unchanged read-write entries")
+    {
+        auto& unchangedMeter = test.getApp().getMetrics().NewMeter(
+            {"soroban", "host-fn-op", "unchanged-write-entry"}, "entry");
+        auto dataKey = client.getContract().getDataKey(
+            makeSymbolSCVal("key"), ContractDataDurability::PERSISTENT);
+        auto writeSpec =
+            client.writeKeySpec("key", ContractDataDurability::PERSISTENT);
+
+        REQUIRE(isSuccess(
+            client.put("key", ContractDataDurability::PERSISTENT, 1)));
+        auto unchangedCount = unchangedMeter.count();
+
+        // Reading the entry through the read-write footprint leaves it
+        // unchanged, but it's still updated with the ledger
+        auto invocation = client.getContract().prepareInvocation(
+            "get_persistent", {makeSymbolSCVal("key")}, writeSpec);
+        REQUIRE(invocation.withExactNonRefundableResourceFee().invoke());
+        REQUIRE(invocation.getReturnValue().u64() == 1);
+        REQUIRE(unchangedMeter.count() == unchangedCount + 1);
+
+        auto const& changes =
+            invocation.getTxMeta().getXDR().v3().operations.at(0).changes;
+        auto updated = std::find_if(
+            changes.begin(), changes.end(), [&](LedgerEntryChange const& c) {
+                return c.type() == LEDGER_ENTRY_UPDATED &&
+                       LedgerEntryKey(c.updated()) == dataKey;
+            });
+        REQUIRE(updated != changes.end());
+        REQUIRE(updated->updated().data.contractData().val ==
+                makeU64SCVal(1));
+
+        // Modified entries are decoded from the host output
+        REQUIRE(isSuccess(client.put("key", ContractDataDurability::PERSISTENT,
+                                     2, writeSpec)));
+        REQUIRE(unchangedMeter.count() == unchangedCount + 1);
+        REQUIRE(isSuccess(
+            client.get("key", ContractDataDurability::PERSISTENT, 2)));
+    }
+
     SECTION("read bytes limit enforced")
     {
         // Write 5 KB entry.
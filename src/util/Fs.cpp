@@ -389,11 +389,17 @@ remoteName(std::string const& type, std::string const& hexStr,
     return remoteDir(type, hexStr) + "/" + baseName(type, hexStr, suffix);
 }
 
+bool
+hasGzipSuffix(std::string const& filename)
+{
+    static const std::string suf(".gz");
+    return std::filesystem::path(filename).extension().string() == suf;
+}
+
 void
 checkGzipSuffix(std::string const& filename)
 {
-    static const std::string suf(".gz");
-    if (std::filesystem::path(filename).extension().string() != suf)
+    if (!hasGzipSuffix(filename))
     {
         throw std::runtime_error("filename does not end in .gz");
     }
@@ -402,8 +408,7 @@ checkGzipSuffix(std::string const& filename)
 void
 checkNoGzipSuffix(std::string const& filename)
 {
-    static const std::string suf(".gz");
-    if (std::filesystem::path(filename).extension().string() == suf)
+    if (hasGzipSuffix(filename))
     {
         throw std::runtime_error("filename ends in .gz");
     }
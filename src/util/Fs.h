@@ -104,6 +104,8 @@ std::string remoteDir(std::string const& type, std::string const& hexStr);
 std::string remoteName(std::string const& type, std::string const& hexStr,
                        std::string const& suffix);
 
+bool hasGzipSuffix(std::string const& filename);
+
 void checkGzipSuffix(std::string const& filename);
 
 void checkNoGzipSuffix(std::string const& filename);
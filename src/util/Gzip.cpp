@@ -0,0 +1,188 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Gzip.h"
+#include "crypto/ByteSlice.h"
+#include "crypto/SHA.h"
+
+#include <Tracy.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace stellar
+{
+
+namespace
+{
+// Same as `gzip` without arguments
+char const* const COMPRESS_MODE = "wb6";
+size_t const CHUNK_SIZE = 128 * 1024;
+
+struct GzCloser
+{
+    void
+    operator()(gzFile_s* f) const
+    {
+        gzclose(f);
+    }
+};
+using GzPtr = std::unique_ptr<gzFile_s, GzCloser>;
+
+std::string
+gzErrorString(gzFile f)
+{
+    int errnum = Z_OK;
+    char const* msg = gzerror(f, &errnum);
+    return errnum == Z_ERRNO ? std::string(strerror(errno)) : std::string(msg);
+}
+
+// gzread returns 0 rather than an error on a truncated file, check the
+// stream's error state to tell it apart from a clean end of file.
+void
+checkRead(gzFile f, int n, std::string const& name)
+{
+    int errnum = Z_OK;
+    if (n == 0)
+    {
+        gzerror(f, &errnum);
+    }
+    if (n < 0 || errnum != Z_OK)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error decompressing {}: {}"), name,
+                        gzErrorString(f)));
+    }
+}
+
+GzPtr
+openForRead(std::string const& filename)
+{
+    GzPtr f(gzopen(filename.c_str(), "rb"));
+    if (!f)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error opening gzip file {}"), filename));
+    }
+    gzbuffer(f.get(), CHUNK_SIZE);
+    // zlib transparently reads files that aren't compressed, `gzip -d`
+    // doesn't.
+    if (gzdirect(f.get()))
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("{} is not in gzip format"), filename));
+    }
+    return f;
+}
+}
+
+namespace gzip
+{
+
+void
+compressFile(std::string const& src, std::string const& dst)
+{
+    ZoneScoped;
+    std::ifstream in(src, std::ifstream::binary);
+    if (!in)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error opening file {}"), src));
+    }
+    in.exceptions(std::ios::badbit);
+
+    GzPtr out(gzopen(dst.c_str(), COMPRESS_MODE));
+    if (!out)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error opening file {}"), dst));
+    }
+    gzbuffer(out.get(), CHUNK_SIZE);
+
+    std::vector<char> buf(CHUNK_SIZE);
+    while (in)
+    {
+        in.read(buf.data(), buf.size());
+        auto n = static_cast<unsigned>(in.gcount());
+        if (n > 0 && gzwrite(out.get(), buf.data(), n) != static_cast<int>(n))
+        {
+            throw std::runtime_error(
+                fmt::format(FMT_STRING("Error compressing {}: {}"), src,
+                            gzErrorString(out.get())));
+        }
+    }
+
+    // Closing flushes the remaining output, so it can fail too
+    if (gzclose(out.release()) != Z_OK)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error writing {}"), dst));
+    }
+}
+
+void
+decompressFile(std::string const& src, std::string const& dst,
+               SHA256* hasher)
+{
+    ZoneScoped;
+    auto in = openForRead(src);
+    std::ofstream out(dst, std::ofstream::binary | std::ofstream::trunc);
+    if (!out)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error opening file {}"), dst));
+    }
+    out.exceptions(std::ios::failbit | std::ios::badbit);
+
+    std::vector<char> buf(CHUNK_SIZE);
+    int n = 0;
+    while ((n = gzread(in.get(), buf.data(),
+                       static_cast<unsigned>(buf.size()))) > 0)
+    {
+        out.write(buf.data(), n);
+        if (hasher)
+        {
+            hasher->add(ByteSlice(buf.data(), n));
+        }
+    }
+    checkRead(in.get(), n, src);
+    out.close();
+}
+}
+
+GunzipStreamBuf::GunzipStreamBuf(std::string const& filename)
+    : mFile(openForRead(filename).release())
+    , mName(filename)
+    , mBuf(CHUNK_SIZE)
+{
+    setg(mBuf.data(), mBuf.data(), mBuf.data());
+}
+
+GunzipStreamBuf::~GunzipStreamBuf()
+{
+    gzclose(mFile);
+}
+
+GunzipStreamBuf::int_type
+GunzipStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+    int n = gzread(mFile, mBuf.data(), static_cast<unsigned>(mBuf.size()));
+    // Errors surface as badbit (and an exception, if enabled) on the istream
+    checkRead(mFile, n, mName);
+    if (n == 0)
+    {
+        return traits_type::eof();
+    }
+    setg(mBuf.data(), mBuf.data(), mBuf.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+}
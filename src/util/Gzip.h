@@ -0,0 +1,52 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct gzFile_s;
+
+namespace stellar
+{
+
+class SHA256;
+
+// In-process, streaming gzip (de)compression built on zlib. These calls block
+// for the whole duration of the file and are meant to be run on background
+// threads. They throw std::runtime_error on any failure, leaving a partially
+// written destination behind (callers write to a temporary file).
+namespace gzip
+{
+// Compresses `src` into `dst`, overwriting it.
+void compressFile(std::string const& src, std::string const& dst);
+
+// Decompresses `src` into `dst`, overwriting it. When `hasher` is set, the
+// decompressed bytes are fed to it as they are written, which saves reading
+// `dst` back to hash it.
+void decompressFile(std::string const& src, std::string const& dst,
+                    SHA256* hasher = nullptr);
+}
+
+// Read-only stream buffer over the decompressed contents of a gzip file, so
+// that gzipped files can be consumed through a std::istream without writing
+// the uncompressed file first. Seeking is not supported.
+class GunzipStreamBuf : public std::streambuf, NonMovableOrCopyable
+{
+    gzFile_s* mFile;
+    std::string const mName;
+    std::vector<char> mBuf;
+
+  public:
+    explicit GunzipStreamBuf(std::string const& filename);
+    ~GunzipStreamBuf();
+
+  protected:
+    int_type underflow() override;
+};
+}
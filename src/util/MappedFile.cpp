@@ -0,0 +1,88 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/MappedFile.h"
+#include "util/FileSystemException.h"
+
+#include <cstring>
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stellar
+{
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const& path) : mPath(path)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        FileSystemException::failWith(
+            fmt::format("unable to open file {}", path));
+    }
+    mBuffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(mBuffer.data()), mBuffer.size()))
+    {
+        FileSystemException::failWith(
+            fmt::format("unable to read file {}", path));
+    }
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+}
+#else
+MappedFile::MappedFile(std::string const& path) : mPath(path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        FileSystemException::failWithErrno(
+            fmt::format("unable to open file {}: ", path));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+    {
+        std::string err = std::strerror(errno);
+        ::close(fd);
+        FileSystemException::failWith(
+            fmt::format("unable to stat file {}: {}", path, err));
+    }
+    mSize = static_cast<size_t>(st.st_size);
+    if (mSize != 0)
+    {
+        void* addr = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            std::string err = std::strerror(errno);
+            ::close(fd);
+            FileSystemException::failWith(
+                fmt::format("unable to map file {}: {}", path, err));
+        }
+        mData = static_cast<uint8_t const*>(addr);
+    }
+    // The mapping stays valid once the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mData)
+    {
+        ::munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+}
+#endif
+}
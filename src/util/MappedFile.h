@@ -0,0 +1,51 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+// Read-only view of the contents of a file, mapped in memory where the
+// platform allows it and read into a buffer otherwise. Throws
+// FileSystemException if the file can't be opened.
+class MappedFile : NonMovableOrCopyable
+{
+    std::string const mPath;
+    uint8_t const* mData{nullptr};
+    size_t mSize{0};
+#ifdef _WIN32
+    std::vector<uint8_t> mBuffer;
+#endif
+
+  public:
+    explicit MappedFile(std::string const& path);
+    ~MappedFile();
+
+    std::string const&
+    path() const
+    {
+        return mPath;
+    }
+
+    uint8_t const*
+    data() const
+    {
+        return mData;
+    }
+
+    size_t
+    size() const
+    {
+        return mSize;
+    }
+};
+}
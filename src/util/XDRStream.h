@@ -9,6 +9,7 @@
 #include "util/FileSystemException.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/Gzip.h"
 #include "util/Logging.h"
 #include "util/types.h"
 #include "xdrpp/marshal.h"
@@ -16,6 +17,8 @@
 
 #include <filesystem>
 #include <fstream>
+#include <istream>
+#include <memory>
 #include <string>
 #include <vector>
 #ifdef _WIN32
@@ -28,10 +31,16 @@ namespace stellar
 /**
  * Helper for loading a sequence of XDR objects from a file one at a time,
  * rather than all at once.
+ *
+ * Files with a .gz suffix are decompressed on the fly; size() then returns the
+ * compressed size and pos()/seek() are not supported.
  */
 class XDRInputFileStream
 {
-    std::ifstream mIn;
+    std::ifstream mFile;
+    std::unique_ptr<GunzipStreamBuf> mGzBuf;
+    // Reads through either mFile's or mGzBuf's buffer
+    std::istream mIn{nullptr};
     std::vector<char> mBuf;
     size_t mSizeLimit;
     size_t mSize;
@@ -40,31 +49,58 @@ class XDRInputFileStream
     XDRInputFileStream(unsigned int sizeLimit = 0)
         : mSizeLimit{sizeLimit}, mSize{0}
     {
+        mIn.rdbuf(mFile.rdbuf());
     }
 
     void
     close()
     {
         ZoneScoped;
-        mIn.close();
+        mFile.close();
+        if (mGzBuf)
+        {
+            mIn.rdbuf(mFile.rdbuf());
+            mGzBuf.reset();
+        }
     }
 
     void
     open(std::string const& filename)
     {
         ZoneScoped;
-        mIn.open(filename, std::ifstream::binary);
-        if (!mIn)
-        {
+        auto fail = [&](std::string const& reason) {
             std::string msg("failed to open XDR file: ");
             msg += filename;
             msg += ", reason: ";
-            msg += std::to_string(errno);
+            msg += reason;
             CLOG_ERROR(Fs, "{}", msg);
             throw FileSystemException(msg);
+        };
+
+        if (fs::hasGzipSuffix(filename))
+        {
+            try
+            {
+                mGzBuf = std::make_unique<GunzipStreamBuf>(filename);
+            }
+            catch (std::runtime_error const& e)
+            {
+                fail(e.what());
+            }
+            mIn.rdbuf(mGzBuf.get());
+            mSize = fs::size(filename);
+        }
+        else
+        {
+            mFile.open(filename, std::ifstream::binary);
+            if (!mFile)
+            {
+                fail(std::to_string(errno));
+            }
+            mIn.rdbuf(mFile.rdbuf());
+            mSize = fs::size(mFile);
         }
         mIn.exceptions(std::ios::badbit);
-        mSize = fs::size(mIn);
     }
 
     void
@@ -87,6 +123,7 @@ class XDRInputFileStream
     std::streamoff
     pos()
     {
+        releaseAssertOrThrow(!mGzBuf);
         releaseAssertOrThrow(!mIn.fail());
         return mIn.tellg();
     }
@@ -94,6 +131,7 @@ class XDRInputFileStream
     void
     seek(size_t pos)
     {
+        releaseAssertOrThrow(!mGzBuf);
         releaseAssertOrThrow(!mIn.fail());
         mIn.seekg(pos);
     }
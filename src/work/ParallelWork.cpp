@@ -0,0 +1,44 @@
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "work/ParallelWork.h"
+#include "util/GlobalChecks.h"
+#include <Tracy.hpp>
+
+namespace stellar
+{
+
+ParallelWork::ParallelWork(Application& app, std::string name,
+                           std::vector<std::shared_ptr<BasicWork>> works,
+                           size_t maxRetries)
+    : Work(app, std::move(name), maxRetries)
+    , mWorks(works.begin(), works.end())
+{
+}
+
+BasicWork::State
+ParallelWork::doWork()
+{
+    ZoneScoped;
+    if (!mStarted)
+    {
+        for (auto const& w : mWorks)
+        {
+            releaseAssert(w);
+            addWork(nullptr, w);
+        }
+        mStarted = true;
+        return State::WORK_RUNNING;
+    }
+
+    // Children are dropped by Work once done, so check the works themselves
+    return WorkUtils::getWorkStatus(mWorks);
+}
+
+void
+ParallelWork::doReset()
+{
+    mStarted = false;
+}
+}
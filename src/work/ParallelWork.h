@@ -0,0 +1,35 @@
+#pragma once
+
+// Copyright 2024 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "work/Work.h"
+
+#include <list>
+
+namespace stellar
+{
+
+/*
+ * ParallelWork is the counterpart of WorkSequence for works that don't depend
+ * on each other: it runs all of them as children at once, and succeeds once
+ * all of them do. Once one of them has failed, the others are aborted as soon
+ * as none of them is running.
+ */
+class ParallelWork : public Work
+{
+    std::list<std::shared_ptr<BasicWork>> const mWorks;
+    bool mStarted{false};
+
+  public:
+    ParallelWork(Application& app, std::string name,
+                 std::vector<std::shared_ptr<BasicWork>> works,
+                 size_t maxRetries = RETRY_A_FEW);
+    ~ParallelWork() = default;
+
+  protected:
+    State doWork() override;
+    void doReset() override;
+};
+}
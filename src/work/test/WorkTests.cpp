@@ -13,6 +13,7 @@
 #include "historywork/RunCommandWork.h"
 #include "work/BatchWork.h"
 #include "work/ConditionalWork.h"
+#include "work/ParallelWork.h"
 
 #include <thread>
 
@@ -814,6 +815,50 @@ class TestBatchWork : public BatchWork
     }
 };
 
+TEST_CASE("ParallelWork test", "[work]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer appPtr = createTestApplication(clock, cfg);
+    auto& wm = appPtr->getWorkScheduler();
+
+    SECTION("works run side by side")
+    {
+        auto w1 = std::make_shared<TestWaitingWork>(*appPtr, "test-work-1");
+        auto w2 = std::make_shared<TestWaitingWork>(*appPtr, "test-work-2");
+        std::vector<std::shared_ptr<BasicWork>> works{w1, w2};
+
+        auto work = wm.scheduleWork<ParallelWork>("test-parallel-work", works);
+        bool overlapped = false;
+        while (!work->isDone())
+        {
+            overlapped = overlapped ||
+                         (w1->mRunningCount && w2->mRunningCount &&
+                          !w1->mSuccessCount && !w2->mSuccessCount);
+            clock.crank();
+        }
+        REQUIRE(overlapped);
+        REQUIRE(work->getState() == TestBasicWork::State::WORK_SUCCESS);
+        REQUIRE(w1->mSuccessCount == 1);
+        REQUIRE(w2->mSuccessCount == 1);
+    }
+    SECTION("failure aborts the other works")
+    {
+        auto w1 = std::make_shared<TestBasicWork>(*appPtr, "test-work-1", true,
+                                                  1, BasicWork::RETRY_NEVER);
+        auto w2 = std::make_shared<TestWaitingWork>(*appPtr, "test-work-2");
+        std::vector<std::shared_ptr<BasicWork>> works{w1, w2};
+
+        auto work = wm.executeWork<ParallelWork>("test-parallel-work", works,
+                                                 BasicWork::RETRY_NEVER);
+        REQUIRE(work->getState() == TestBasicWork::State::WORK_FAILURE);
+        REQUIRE(w1->getState() == TestBasicWork::State::WORK_FAILURE);
+        REQUIRE(w2->getState() == TestBasicWork::State::WORK_ABORTED);
+        REQUIRE(w2->mAbortCount == 1);
+        REQUIRE_FALSE(w2->mSuccessCount);
+    }
+}
+
 TEST_CASE("Work batching", "[batching][work]")
 {
     VirtualClock clock;